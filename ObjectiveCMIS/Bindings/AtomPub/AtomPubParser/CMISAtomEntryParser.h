@@ -28,6 +28,9 @@
 
 @property (nonatomic, strong, readonly) CMISObjectData *objectData;
 
+// CMISObjectInFolderContainer objects of the feed nested in the entry's 'cmisra:children' element, nil if it has none
+@property (nonatomic, strong, readonly) NSArray *children;
+
 // Designated Initializer
 - (id)initWithData:(NSData *)atomData;
 - (BOOL)parseAndReturnError:(NSError **)error;
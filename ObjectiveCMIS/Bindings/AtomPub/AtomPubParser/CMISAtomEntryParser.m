@@ -16,8 +16,9 @@
 #import "CMISAtomLink.h"
 #import "CMISRenditionData.h"
 #import "CMISAtomParserUtil.h"
+#import "CMISAtomFeedParser.h"
 
-@interface CMISAtomEntryParser ()
+@interface CMISAtomEntryParser () <CMISAtomFeedParserDelegate>
 
 @property (nonatomic, strong, readwrite) CMISObjectData *objectData;
 
@@ -31,6 +32,7 @@
 @property (nonatomic, strong) NSMutableArray *currentRenditions;
 @property (nonatomic, strong) NSMutableString *string;
 
+@property (nonatomic, strong, readwrite) NSArray *children;
 @property (nonatomic, weak) id<NSXMLParserDelegate, CMISAtomEntryParserDelegate> parentDelegate;
 @property (nonatomic, strong) NSDictionary *entryAttributesDict;
 
@@ -56,6 +58,7 @@
 @synthesize currentRendition = _currentRendition;
 @synthesize currentRenditions = _currentRenditions;
 @synthesize string = _string;
+@synthesize children = _children;
 
 // Designated Initializer
 - (id)init
@@ -176,6 +179,11 @@
             // Set object data as the current extensionData object
             [self pushNewCurrentExtensionData:self.objectData];
         }
+        else if ([elementName isEqualToString:kCMISAtomEntryChildren])
+        {
+            // Delegate parsing of the nested feed to a child parser, its entries would otherwise end this one
+            self.childParserDelegate = [CMISAtomFeedParser atomFeedParserWithParentDelegate:self parser:parser];
+        }
     }
     else if ([namespaceURI isEqualToString:kCMISNamespaceAtom])
     {
@@ -351,6 +359,14 @@
     self.string = nil;
 }
 
+#pragma mark -
+#pragma mark CMISAtomFeedParserDelegate Methods
+
+- (void)atomFeedParser:(CMISAtomFeedParser *)feedParser didFinishParsingObjectInFolderContainers:(NSArray *)containers
+{
+    self.children = containers;
+}
+
 #pragma mark -
 #pragma mark CMISAllowableActionsParserDelegate Methods
 
@@ -19,6 +19,14 @@
 #import "CMISProperties.h"
 #import "CMISAtomEntryParser.h"
 
+@class CMISAtomFeedParser;
+
+@protocol CMISAtomFeedParserDelegate <NSObject>
+@optional
+- (void)atomFeedParser:(CMISAtomFeedParser *)feedParser didFinishParsingObjectInFolderContainers:(NSArray *)containers;
+
+@end
+
 @interface CMISAtomFeedParser : NSObject <NSXMLParserDelegate, CMISAtomEntryParserDelegate>
 
 /**
@@ -36,7 +44,16 @@
  */
 @property (readonly) NSInteger numItems;
 
+/**
+ * The entries as CMISObjectInFolderContainer objects, with the entries of their nested children feeds
+ * (of a descendants or folder tree feed).
+ */
+@property (nonatomic, strong, readonly) NSArray *objectInFolderContainers;
+
 - (id)initWithData:(NSData*)feedData;
 - (BOOL)parseAndReturnError:(NSError **)error;
 
+// Initializes a child parser for the feed in a 'cmisra:children' element and takes over parsing control until its end
++ (id)atomFeedParserWithParentDelegate:(id<NSXMLParserDelegate, CMISAtomFeedParserDelegate>)parentDelegate parser:(NSXMLParser *)parser;
+
 @end
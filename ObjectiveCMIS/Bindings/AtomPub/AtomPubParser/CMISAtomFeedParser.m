@@ -14,6 +14,7 @@
 
 #import "CMISAtomFeedParser.h"
 #import "CMISAtomLink.h"
+#import "CMISObjectInFolderContainer.h"
 
 @interface CMISAtomFeedParser ()
 @property (nonatomic, strong, readwrite) NSData *feedData;
@@ -22,6 +23,11 @@
 @property (nonatomic, strong, readwrite) NSMutableSet *feedLinkRelations;
 @property (nonatomic, strong, readwrite) id childParserDelegate;
 @property (nonatomic, strong) NSMutableString *string;
+@property (nonatomic, strong) NSMutableArray *internalObjectInFolderContainers;
+@property (nonatomic, weak) id<NSXMLParserDelegate, CMISAtomFeedParserDelegate> parentDelegate;
+
+// Initializer used if this parser is a delegated child parser
+- (id)initWithParentDelegate:(id<NSXMLParserDelegate, CMISAtomFeedParserDelegate>)parentDelegate parser:(NSXMLParser *)parser;
 @end
 
 @implementation CMISAtomFeedParser
@@ -32,6 +38,8 @@
 @synthesize feedLinkRelations = _feedLinkRelations;
 @synthesize childParserDelegate = _childParserDelegate;
 @synthesize string = _string;
+@synthesize internalObjectInFolderContainers = _internalObjectInFolderContainers;
+@synthesize parentDelegate = _parentDelegate;
 
 - (id)initWithData:(NSData*)feedData
 {
@@ -45,6 +53,31 @@
     return self;
 }
 
+- (id)initWithParentDelegate:(id<NSXMLParserDelegate, CMISAtomFeedParserDelegate>)parentDelegate parser:(NSXMLParser *)parser
+{
+    self = [self initWithData:nil];
+    if (self)
+    {
+        self.internalEntries = [NSMutableArray array];
+        self.internalObjectInFolderContainers = [NSMutableArray array];
+        self.parentDelegate = parentDelegate;
+        
+        // Setting ourself, the feed parser, as the delegate, we reset back to our parent when we're done
+        [parser setDelegate:self];
+    }
+    return self;
+}
+
++ (id)atomFeedParserWithParentDelegate:(id<NSXMLParserDelegate, CMISAtomFeedParserDelegate>)parentDelegate parser:(NSXMLParser *)parser
+{
+    return [[self alloc] initWithParentDelegate:parentDelegate parser:parser];
+}
+
+- (NSArray *)objectInFolderContainers
+{
+    return [NSArray arrayWithArray:self.internalObjectInFolderContainers];
+}
+
 - (NSArray *)entries
 {
     if (self.internalEntries != nil)
@@ -68,6 +101,7 @@
     
     // create objects to populate during parse
     self.internalEntries = [NSMutableArray array];
+    self.internalObjectInFolderContainers = [NSMutableArray array];
     
     // parse the AtomPub data
     NSXMLParser *parser = [[NSXMLParser alloc] initWithData:self.feedData];
@@ -118,6 +152,18 @@
     {
         self.numItems = [self.string integerValue];
     }
+    else if (self.parentDelegate && [elementName isEqualToString:kCMISAtomEntryChildren] && [namespaceURI isEqualToString:kCMISNamespaceCmisRestAtom])
+    {
+        // End of the nested feed: hand the children to the entry they belong to
+        if ([self.parentDelegate respondsToSelector:@selector(atomFeedParser:didFinishParsingObjectInFolderContainers:)])
+        {
+            [self.parentDelegate atomFeedParser:self didFinishParsingObjectInFolderContainers:self.objectInFolderContainers];
+        }
+        
+        // Reseting our parent as the delegate since we're done
+        parser.delegate = self.parentDelegate;
+        self.parentDelegate = nil;
+    }
 
     self.string = nil;
 }
@@ -129,6 +175,14 @@
 - (void)cmisAtomEntryParser:(CMISAtomEntryParser *)entryParser didFinishParsingCMISObjectData:(CMISObjectData *)cmisObjectData
 {
     [self.internalEntries addObject:cmisObjectData];
+    
+    CMISObjectInFolderContainer *container = [[CMISObjectInFolderContainer alloc] init];
+    container.objectData = cmisObjectData;
+    if ([entryParser children] != nil)
+    {
+        container.children = [entryParser children];
+    }
+    [self.internalObjectInFolderContainers addObject:container];
 }
 
 @end
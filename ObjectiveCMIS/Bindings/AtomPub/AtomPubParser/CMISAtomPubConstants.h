@@ -25,6 +25,7 @@ extern NSString * const kCMISAtomEntryRel;
 extern NSString * const kCMISAtomEntryHref;
 extern NSString * const kCMISAtomEntryType;
 extern NSString * const kCMISAtomEntryObject;
+extern NSString * const kCMISAtomEntryChildren;
 extern NSString * const kCMISAtomEntryProperties;
 extern NSString * const kCMISAtomEntryPropertyId;
 extern NSString * const kCMISAtomEntryPropertyString;
@@ -45,6 +46,7 @@ extern NSString * const kCMISAtomEntryAllowableActions;
 
 // Collections
 extern NSString * const kCMISAtomCollectionQuery;
+extern NSString * const kCMISAtomCollectionBulkUpdate;
 
 // Links
 extern NSString * const kCMISLinkRelationDown;
@@ -72,6 +74,7 @@ extern NSString * const kCMISParameterAllVersions;
 extern NSString * const kCMISParameterContinueOnFailure;
 extern NSString * const kCMISParameterUnfileObjects;
 extern NSString * const kCMISParameterRelativePathSegment;
+extern NSString * const kCMISParameterDepth;
 
 
 // Namespaces
@@ -25,6 +25,7 @@ NSString * const kCMISAtomEntryRel = @"rel";
 NSString * const kCMISAtomEntryHref = @"href";
 NSString * const kCMISAtomEntryType = @"type";
 NSString * const kCMISAtomEntryObject = @"object";
+NSString * const kCMISAtomEntryChildren = @"children";
 NSString * const kCMISAtomEntryProperties = @"properties";
 NSString * const kCMISAtomEntryPropertyId = @"propertyId";
 NSString * const kCMISAtomEntryPropertyString = @"propertyString";
@@ -45,6 +46,7 @@ NSString * const kCMISAtomEntryAllowableActions = @"allowableActions";
 
 // Collections
 NSString * const kCMISAtomCollectionQuery = @"query";
+NSString * const kCMISAtomCollectionBulkUpdate = @"update";
 
 // Links
 NSString * const kCMISLinkRelationDown = @"down";
@@ -72,6 +74,7 @@ NSString * const kCMISParameterAllVersions = @"allVersions";
 NSString * const kCMISParameterContinueOnFailure= @"continueOnFailure";
 NSString * const kCMISParameterUnfileObjects = @"unfileObjects";
 NSString * const kCMISParameterRelativePathSegment = @"includeRelativePathSegment";
+NSString * const kCMISParameterDepth = @"depth";
 
 // Namespaces
 NSString * const kCMISNamespaceCmis = @"http://docs.oasis-open.org/ns/cmis/core/200908/";
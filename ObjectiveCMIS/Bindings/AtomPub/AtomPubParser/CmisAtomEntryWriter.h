@@ -25,6 +25,12 @@
 @property (nonatomic, strong) NSString *mimeType;
 @property (nonatomic, strong) CMISProperties *cmisProperties;
 
+/**
+ * CMISObjectIdAndChangeToken objects of the objects to update with the properties, in one CMIS 1.1 bulk update.
+ * If set, the entry holds a bulk update instead of an object.
+ */
+@property (nonatomic, strong) NSArray *bulkUpdateObjectIdsAndChangeTokens;
+
 /**
  * If YES: the xml will be created and stored fully in-memory.
  * If NO: the xml will be streamed to a file on disk.
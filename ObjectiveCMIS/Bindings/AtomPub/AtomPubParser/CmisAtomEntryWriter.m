@@ -19,6 +19,7 @@
 #import "CMISFileUtil.h"
 #import "CMISProperties.h"
 #import "CMISDateUtil.h"
+#import "CMISObjectIdAndChangeToken.h"
 
 
 @implementation NSString (XMLEntities)
@@ -56,6 +57,7 @@
 @synthesize inputStream = _inputStream;
 @synthesize mimeType = _mimeType;
 @synthesize cmisProperties = _cmisProperties;
+@synthesize bulkUpdateObjectIdsAndChangeTokens = _bulkUpdateObjectIdsAndChangeTokens;
 @synthesize generateXmlInMemory = _generateXmlInMemory;
 
 // Internal properties
@@ -126,7 +128,26 @@
 
 - (void)addProperties
 {
-    [self appendStringToReturnResult:@"<cmisra:object><cmis:properties>"];
+    if (self.bulkUpdateObjectIdsAndChangeTokens != nil)
+    {
+        [self appendStringToReturnResult:@"<cmisra:bulkUpdate>"];
+        for (CMISObjectIdAndChangeToken *objectIdAndChangeToken in self.bulkUpdateObjectIdsAndChangeTokens)
+        {
+            [self appendStringToReturnResult:[NSString stringWithFormat:@"<cmis:objectIdAndChangeToken><cmis:id>%@</cmis:id>",
+                                              [objectIdAndChangeToken.objectId stringByAddingXMLEntities]]];
+            if (objectIdAndChangeToken.changeToken != nil)
+            {
+                [self appendStringToReturnResult:[NSString stringWithFormat:@"<cmis:changeToken>%@</cmis:changeToken>",
+                                                  [objectIdAndChangeToken.changeToken stringByAddingXMLEntities]]];
+            }
+            [self appendStringToReturnResult:@"</cmis:objectIdAndChangeToken>"];
+        }
+        [self appendStringToReturnResult:@"<cmis:properties>"];
+    }
+    else
+    {
+        [self appendStringToReturnResult:@"<cmisra:object><cmis:properties>"];
+    }
 
     // TODO: support for multi valued properties
     for (id propertyKey in self.cmisProperties.propertiesDictionary)
@@ -245,7 +266,14 @@
         [self addExtensionElements:self.cmisProperties.extensions];
     }
 
-    [self appendStringToReturnResult:@"</cmis:properties></cmisra:object></entry>"];
+    if (self.bulkUpdateObjectIdsAndChangeTokens != nil)
+    {
+        [self appendStringToReturnResult:@"</cmis:properties></cmisra:bulkUpdate></entry>"];
+    }
+    else
+    {
+        [self appendStringToReturnResult:@"</cmis:properties></cmisra:object></entry>"];
+    }
 }
 
 - (void) addExtensionElements:(NSArray *)extensionElements
@@ -17,6 +17,11 @@
 #import "CMISObjectByIdUriBuilder.h"
 
 @class CMISObjectData;
+@class CMISRequest;
+@class CMISLinkCache;
+@class CMISObjectList;
+@class CMISAtomFeedParser;
+@class CMISPageLinks;
 
 @interface CMISAtomPubBaseService (Protected)
 
@@ -27,6 +32,11 @@
 /** Convenience method with all the defaults for the retrieval parameters */
 - (void)retrieveObjectInternal:(NSString *)objectId completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock;
 
+/** Convenience method with all the defaults, as a step of the operation of the request object */
+- (void)retrieveObjectInternal:(NSString *)objectId
+               completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock
+                 requestObject:(CMISRequest *)requestObject;
+
 /** Full-blown object retrieval version */
 - (void)retrieveObjectInternal:(NSString *)objectId
                          withReturnVersion:(CMISReturnVersion)cmisReturnVersion
@@ -38,6 +48,18 @@
                 andIncludeAllowableActions:(BOOL)includeAllowableActions
                completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock;
 
+/** Full-blown object retrieval version, as a step of the operation of the request object */
+- (void)retrieveObjectInternal:(NSString *)objectId
+             withReturnVersion:(CMISReturnVersion)cmisReturnVersion
+                    withFilter:(NSString *)filter
+       andIncludeRelationShips:(CMISIncludeRelationship)includeRelationship
+           andIncludePolicyIds:(BOOL)includePolicyIds
+            andRenditionFilder:(NSString *)renditionFilter
+                 andIncludeACL:(BOOL)includeACL
+    andIncludeAllowableActions:(BOOL)includeAllowableActions
+               completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock
+                 requestObject:(CMISRequest *)requestObject;
+
 - (void)retrieveObjectByPathInternal:(NSString *)path
                           withFilter:(NSString *)filter
              andIncludeRelationShips:(CMISIncludeRelationship)includeRelationship
@@ -47,6 +69,28 @@
           andIncludeAllowableActions:(BOOL)includeAllowableActions
                      completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock;
 
+/** Object retrieval by path, as a step of the operation of the request object */
+- (void)retrieveObjectByPathInternal:(NSString *)path
+                          withFilter:(NSString *)filter
+             andIncludeRelationShips:(CMISIncludeRelationship)includeRelationship
+                 andIncludePolicyIds:(BOOL)includePolicyIds
+                  andRenditionFilder:(NSString *)renditionFilter
+                       andIncludeACL:(BOOL)includeACL
+          andIncludeAllowableActions:(BOOL)includeAllowableActions
+                     completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock
+                       requestObject:(CMISRequest *)requestObject;
+
+- (CMISLinkCache *)linkCache;
+
+/**
+ * The object list of a parsed feed page. The feed's next link is kept in the page links of the listing, if it has them,
+ * for the request following this page: the one at the skip count after this page, with the same page size.
+ */
+- (CMISObjectList *)objectListFromFeedParser:(CMISAtomFeedParser *)parser
+                                   skipCount:(NSInteger)skipCount
+                                    maxItems:(NSInteger)maxItems
+                                   pageLinks:(CMISPageLinks *)pageLinks;
+
 - (void)retrieveFromCache:(NSString *)cacheKey
           completionBlock:(void (^)(id object, NSError *error))completionBlock;
 
@@ -59,4 +103,16 @@
                     andType:(NSString *)type
             completionBlock:(void (^)(NSString *link, NSError *error))completionBlock;
 
+/** Link lookup as a step of the operation of the request object: a cache miss fetches the object only if it is not cancelled */
+- (void)loadLinkForObjectId:(NSString *)objectId
+                andRelation:(NSString *)rel
+            completionBlock:(void (^)(NSString *link, NSError *error))completionBlock
+              requestObject:(CMISRequest *)requestObject;
+
+- (void)loadLinkForObjectId:(NSString *)objectId
+                andRelation:(NSString *)rel
+                    andType:(NSString *)type
+            completionBlock:(void (^)(NSString *link, NSError *error))completionBlock
+              requestObject:(CMISRequest *)requestObject;
+
 @end
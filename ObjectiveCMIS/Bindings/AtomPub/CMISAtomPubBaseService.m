@@ -24,6 +24,10 @@
 #import "CMISObjectByPathUriBuilder.h"
 #import "CMISTypeByIdUriBuilder.h"
 #import "CMISLinkCache.h"
+#import "CMISRequest.h"
+#import "CMISAtomFeedParser.h"
+#import "CMISObjectList.h"
+#import "CMISPageLinks.h"
 
 @interface CMISAtomPubBaseService ()
 
@@ -87,6 +91,12 @@
                     // Cache collections
                     [self.bindingSession setObject:[workspace collectionHrefForCollectionType:kCMISAtomCollectionQuery] forKey:kCMISBindingSessionKeyQueryCollection];
                     
+                    // only CMIS 1.1 repositories have a bulk update collection
+                    NSString *bulkUpdateCollection = [workspace collectionHrefForCollectionType:kCMISAtomCollectionBulkUpdate];
+                    if (bulkUpdateCollection != nil) {
+                        [self.bindingSession setObject:bulkUpdateCollection forKey:kCMISBindingSessionKeyBulkUpdateCollection];
+                    }
+                    
                     
                     // Cache uri's and uri templates
                     CMISObjectByIdUriBuilder *objectByIdUriBuilder = [[CMISObjectByIdUriBuilder alloc] initWithTemplateUrl:workspace.objectByIdUriTemplate];
@@ -148,10 +158,17 @@
 }
 
 - (void)retrieveObjectInternal:(NSString *)objectId completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock
+{
+    [self retrieveObjectInternal:objectId completionBlock:completionBlock requestObject:nil];
+}
+
+- (void)retrieveObjectInternal:(NSString *)objectId
+               completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock
+                 requestObject:(CMISRequest *)requestObject
 {
     [self retrieveObjectInternal:objectId withReturnVersion:NOT_PROVIDED withFilter:@"" andIncludeRelationShips:CMISIncludeRelationshipNone
              andIncludePolicyIds:NO andRenditionFilder:nil andIncludeACL:NO
-      andIncludeAllowableActions:YES completionBlock:completionBlock];
+      andIncludeAllowableActions:YES completionBlock:completionBlock requestObject:requestObject];
 }
 
 
@@ -164,18 +181,40 @@
                  andIncludeACL:(BOOL)includeACL
     andIncludeAllowableActions:(BOOL)includeAllowableActions
                completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock
+{
+    [self retrieveObjectInternal:objectId
+               withReturnVersion:returnVersion
+                      withFilter:filter
+         andIncludeRelationShips:includeRelationship
+             andIncludePolicyIds:includePolicyIds
+              andRenditionFilder:renditionFilter
+                   andIncludeACL:includeACL
+      andIncludeAllowableActions:includeAllowableActions
+                 completionBlock:completionBlock
+                   requestObject:nil];
+}
+
+- (void)retrieveObjectInternal:(NSString *)objectId
+             withReturnVersion:(CMISReturnVersion)returnVersion
+                    withFilter:(NSString *)filter
+       andIncludeRelationShips:(CMISIncludeRelationship)includeRelationship
+           andIncludePolicyIds:(BOOL)includePolicyIds
+            andRenditionFilder:(NSString *)renditionFilter
+                 andIncludeACL:(BOOL)includeACL
+    andIncludeAllowableActions:(BOOL)includeAllowableActions
+               completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock
+                 requestObject:(CMISRequest *)requestObject
 {
     [self retrieveFromCache:kCMISBindingSessionKeyObjectByIdUriBuilder completionBlock:^(id object, NSError *error) {
         CMISObjectByIdUriBuilder *objectByIdUriBuilder = object;
-        objectByIdUriBuilder.objectId = objectId;
-        objectByIdUriBuilder.filter = filter;
-        objectByIdUriBuilder.includeACL = includeACL;
-        objectByIdUriBuilder.includeAllowableActions = includeAllowableActions;
-        objectByIdUriBuilder.includePolicyIds = includePolicyIds;
-        objectByIdUriBuilder.includeRelationships = includeRelationship;
-        objectByIdUriBuilder.renditionFilter = renditionFilter;
-        objectByIdUriBuilder.returnVersion = returnVersion;
-        NSURL *objectIdUrl = [objectByIdUriBuilder buildUrl];
+        NSURL *objectIdUrl = [objectByIdUriBuilder urlForObjectId:objectId
+                                                           filter:filter
+                                          includeAllowableActions:includeAllowableActions
+                                                 includePolicyIds:includePolicyIds
+                                             includeRelationships:includeRelationship
+                                                       includeACL:includeACL
+                                                  renditionFilter:renditionFilter
+                                                    returnVersion:returnVersion];
         
         // Execute actual call
         [HttpUtil invokeGET:objectIdUrl
@@ -198,7 +237,8 @@
                 } else {
                     completionBlock(nil, error);
                 }
-            }];
+            }
+              requestObject:requestObject];
     }];
 }
 
@@ -210,19 +250,40 @@
                        andIncludeACL:(BOOL)includeACL
           andIncludeAllowableActions:(BOOL)includeAllowableActions
                      completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock
+{
+    [self retrieveObjectByPathInternal:path
+                            withFilter:filter
+               andIncludeRelationShips:includeRelationship
+                   andIncludePolicyIds:includePolicyIds
+                    andRenditionFilder:renditionFilter
+                         andIncludeACL:includeACL
+            andIncludeAllowableActions:includeAllowableActions
+                       completionBlock:completionBlock
+                         requestObject:nil];
+}
+
+- (void)retrieveObjectByPathInternal:(NSString *)path
+                          withFilter:(NSString *)filter
+             andIncludeRelationShips:(CMISIncludeRelationship)includeRelationship
+                 andIncludePolicyIds:(BOOL)includePolicyIds
+                  andRenditionFilder:(NSString *)renditionFilter
+                       andIncludeACL:(BOOL)includeACL
+          andIncludeAllowableActions:(BOOL)includeAllowableActions
+                     completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock
+                       requestObject:(CMISRequest *)requestObject
 {
     [self retrieveFromCache:kCMISBindingSessionKeyObjectByPathUriBuilder completionBlock:^(id object, NSError *error) {
         CMISObjectByPathUriBuilder *objectByPathUriBuilder = object;
-        objectByPathUriBuilder.path = path;
-        objectByPathUriBuilder.filter = filter;
-        objectByPathUriBuilder.includeACL = includeACL;
-        objectByPathUriBuilder.includeAllowableActions = includeAllowableActions;
-        objectByPathUriBuilder.includePolicyIds = includePolicyIds;
-        objectByPathUriBuilder.includeRelationships = includeRelationship;
-        objectByPathUriBuilder.renditionFilter = renditionFilter;
+        NSURL *objectByPathUrl = [objectByPathUriBuilder urlForPath:path
+                                                             filter:filter
+                                            includeAllowableActions:includeAllowableActions
+                                                   includePolicyIds:includePolicyIds
+                                               includeRelationships:includeRelationship
+                                                         includeACL:includeACL
+                                                    renditionFilter:renditionFilter];
         
         // Execute actual call
-        [HttpUtil invokeGET:[objectByPathUriBuilder buildUrl]
+        [HttpUtil invokeGET:objectByPathUrl
                 withSession:self.bindingSession
             completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
                 if (httpResponse) {
@@ -242,7 +303,8 @@
                 } else {
                     completionBlock(nil, error);
                 }
-            }];
+            }
+              requestObject:requestObject];
     }];
 }
 
@@ -250,12 +312,40 @@
     CMISLinkCache *linkCache = [self.bindingSession objectForKey:kCMISBindingSessionKeyLinkCache];
     if (linkCache == nil)
     {
-        linkCache = [[CMISLinkCache alloc] initWithBindingSession:self.bindingSession];
-        [self.bindingSession setObject:linkCache forKey:kCMISBindingSessionKeyLinkCache];
+        // another thread may be creating one too, the first one stored wins
+        linkCache = [self.bindingSession setObject:[[CMISLinkCache alloc] initWithBindingSession:self.bindingSession]
+                                    forKeyIfAbsent:kCMISBindingSessionKeyLinkCache];
     }
     return linkCache;
 }
 
+- (CMISObjectList *)objectListFromFeedParser:(CMISAtomFeedParser *)parser
+                                   skipCount:(NSInteger)skipCount
+                                    maxItems:(NSInteger)maxItems
+                                   pageLinks:(CMISPageLinks *)pageLinks
+{
+    NSString *nextLink = [parser.linkRelations linkHrefForRel:kCMISLinkRelationNext];
+    
+    CMISObjectList *objectList = [[CMISObjectList alloc] init];
+    objectList.hasMoreItems = (nextLink != nil);
+    objectList.numItems = parser.numItems;
+    objectList.objects = parser.entries;
+    
+    // listed objects can be followed up on without looking up their links again
+    CMISLinkCache *linkCache = [self linkCache];
+    for (CMISObjectData *objectData in parser.entries) {
+        if (objectData.identifier != nil && objectData.linkRelations != nil) {
+            [linkCache addLinks:objectData.linkRelations forObjectId:objectData.identifier];
+        }
+    }
+    
+    // the next link is often a server side cursor: following it costs the same for deep pages as for the first one
+    if (nextLink != nil && parser.entries.count > 0) {
+        [pageLinks addLink:nextLink forPageAtSkipCount:skipCount + parser.entries.count maxItems:maxItems];
+    }
+    return objectList;
+}
+
 - (void)clearCacheFromService
 {
     CMISLinkCache *linkCache = [self.bindingSession objectForKey:kCMISBindingSessionKeyLinkCache];
@@ -270,11 +360,27 @@
                 andRelation:(NSString *)rel
             completionBlock:(void (^)(NSString *link, NSError *error))completionBlock
 {
-    [self loadLinkForObjectId:objectId andRelation:rel andType:nil completionBlock:completionBlock];
+    [self loadLinkForObjectId:objectId andRelation:rel andType:nil completionBlock:completionBlock requestObject:nil];
 }
 
-
 - (void)loadLinkForObjectId:(NSString *)objectId andRelation:(NSString *)rel andType:(NSString *)type completionBlock:(void (^)(NSString *link, NSError *error))completionBlock
+{
+    [self loadLinkForObjectId:objectId andRelation:rel andType:type completionBlock:completionBlock requestObject:nil];
+}
+
+- (void)loadLinkForObjectId:(NSString *)objectId
+                andRelation:(NSString *)rel
+            completionBlock:(void (^)(NSString *link, NSError *error))completionBlock
+              requestObject:(CMISRequest *)requestObject
+{
+    [self loadLinkForObjectId:objectId andRelation:rel andType:nil completionBlock:completionBlock requestObject:requestObject];
+}
+
+- (void)loadLinkForObjectId:(NSString *)objectId
+                andRelation:(NSString *)rel
+                    andType:(NSString *)type
+            completionBlock:(void (^)(NSString *link, NSError *error))completionBlock
+              requestObject:(CMISRequest *)requestObject
 {
     CMISLinkCache *linkCache = [self linkCache];
     
@@ -297,7 +403,7 @@
                     completionBlock(link, nil);
                 }
             }
-        }];
+        } requestObject:requestObject];
     }
 }
 
@@ -20,6 +20,8 @@
 #import "CMISAtomFeedParser.h"
 #import "CMISObjectList.h"
 #import "CMISErrors.h"
+#import "CMISAtomPubBaseService+Protected.h"
+#import "CMISPageLinks.h"
 
 @implementation CMISAtomPubDiscoveryService
 
@@ -30,7 +32,26 @@
                             includeAllowableActions:(BOOL)includeAllowableActions
                                            maxItems:(NSNumber *)maxItems
                                           skipCount:(NSNumber *)skipCount
-                                    completionBlock:(void (^)(CMISObjectList *objectList, NSError *error))completionBlock;
+                                    completionBlock:(void (^)(CMISObjectList *objectList, NSError *error))completionBlock
+{
+    [self query:statement searchAllVersions:searchAllVersions
+                       includeRelationShips:includeRelationships
+                            renditionFilter:renditionFilter
+                    includeAllowableActions:includeAllowableActions
+                                   maxItems:maxItems
+                                  skipCount:skipCount
+                                  pageLinks:nil
+                            completionBlock:completionBlock];
+}
+
+- (void)query:(NSString *)statement searchAllVersions:(BOOL)searchAllVersions
+                                 includeRelationShips:(CMISIncludeRelationship)includeRelationships
+                                      renditionFilter:(NSString *)renditionFilter
+                            includeAllowableActions:(BOOL)includeAllowableActions
+                                           maxItems:(NSNumber *)maxItems
+                                          skipCount:(NSNumber *)skipCount
+                                          pageLinks:(CMISPageLinks *)pageLinks
+                                    completionBlock:(void (^)(CMISObjectList *objectList, NSError *error))completionBlock
 {
     // Validate params
     if (statement == nil)
@@ -49,41 +70,63 @@
         return;
     }
     
-    NSURL *queryURL = [NSURL URLWithString:queryUrlString];
-    // Build XML for query
-    CMISQueryAtomEntryWriter *atomEntryWriter = [[CMISQueryAtomEntryWriter alloc] init];
-    atomEntryWriter.statement = statement;
-    atomEntryWriter.searchAllVersions = searchAllVersions;
-    atomEntryWriter.includeAllowableActions = includeAllowableActions;
-    atomEntryWriter.includeRelationships = includeRelationships;
-    atomEntryWriter.renditionFilter = renditionFilter;
-    atomEntryWriter.maxItems = maxItems;
-    atomEntryWriter.skipCount = skipCount;
+    void (^handleResponse)(CMISHttpResponse *, NSError *, void (^)(CMISObjectList *, NSError *)) =
+    ^(CMISHttpResponse *httpResponse, NSError *error, void (^pageCompletionBlock)(CMISObjectList *objectList, NSError *error)) {
+        if (httpResponse) {
+            CMISAtomFeedParser *feedParser = [[CMISAtomFeedParser alloc] initWithData:httpResponse.data];
+            NSError *error = nil;
+            if ([feedParser parseAndReturnError:&error]) {
+                pageCompletionBlock([self objectListFromFeedParser:feedParser skipCount:[skipCount integerValue]
+                                                              maxItems:[maxItems integerValue] pageLinks:pageLinks], nil);
+            } else {
+                pageCompletionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeRuntime]);
+            }
+        } else {
+            pageCompletionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeConnection]);
+        }
+    };
+    
+    void (^postQuery)(void) = ^{
+        NSURL *queryURL = [NSURL URLWithString:queryUrlString];
+        // Build XML for query
+        CMISQueryAtomEntryWriter *atomEntryWriter = [[CMISQueryAtomEntryWriter alloc] init];
+        atomEntryWriter.statement = statement;
+        atomEntryWriter.searchAllVersions = searchAllVersions;
+        atomEntryWriter.includeAllowableActions = includeAllowableActions;
+        atomEntryWriter.includeRelationships = includeRelationships;
+        atomEntryWriter.renditionFilter = renditionFilter;
+        atomEntryWriter.maxItems = maxItems;
+        atomEntryWriter.skipCount = skipCount;
+        
+        // Execute HTTP call
+        [HttpUtil invokePOST:queryURL
+                 withSession:self.bindingSession
+                        body:[[atomEntryWriter generateAtomEntryXML] dataUsingEncoding:NSUTF8StringEncoding]
+                     headers:[NSDictionary dictionaryWithObject:kCMISMediaTypeQuery forKey:@"Content-type"]
+             completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
+                 handleResponse(httpResponse, error, completionBlock);
+             }];
+    };
+    
+    // A next link of the previous page is a plain feed url: get it instead of posting the query again with a skip count
+    NSString *nextPageLink = [pageLinks linkForPageAtSkipCount:[skipCount integerValue] maxItems:[maxItems integerValue]];
+    if (nextPageLink != nil) {
+        [HttpUtil invokeGET:[NSURL URLWithString:nextPageLink] withSession:self.bindingSession completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
+            handleResponse(httpResponse, error, ^(CMISObjectList *objectList, NSError *error) {
+                if (objectList) {
+                    completionBlock(objectList, nil);
+                } else {
+                    // the link may be a cursor the server has let go of: forget it and post the query with the skip count
+                    log(@"Following next link %@ failed, posting the query again: %@", nextPageLink, error.description);
+                    [pageLinks removeLinkForPageAtSkipCount:[skipCount integerValue] maxItems:[maxItems integerValue]];
+                    postQuery();
+                }
+            });
+        }];
+        return;
+    }
     
-    // Execute HTTP call
-    [HttpUtil invokePOST:queryURL
-             withSession:self.bindingSession
-                    body:[[atomEntryWriter generateAtomEntryXML] dataUsingEncoding:NSUTF8StringEncoding]
-                 headers:[NSDictionary dictionaryWithObject:kCMISMediaTypeQuery forKey:@"Content-type"]
-         completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
-             if (httpResponse) {
-                 CMISAtomFeedParser *feedParser = [[CMISAtomFeedParser alloc] initWithData:httpResponse.data];
-                 NSError *error = nil;
-                 if ([feedParser parseAndReturnError:&error]) {
-                     NSString *nextLink = [feedParser.linkRelations linkHrefForRel:kCMISLinkRelationNext];
-                     
-                     CMISObjectList *objectList = [[CMISObjectList alloc] init];
-                     objectList.hasMoreItems = (nextLink != nil);
-                     objectList.numItems = feedParser.numItems;
-                     objectList.objects = feedParser.entries;
-                     completionBlock(objectList, nil);
-                 } else {
-                     completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeRuntime]);
-                 }
-             } else {
-                 completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeConnection]);
-             }
-         }];
+    postQuery();
 }
 
 @end
\ No newline at end of file
@@ -18,8 +18,9 @@
 #import "CMISHttpUtil.h"
 #import "CMISHttpResponse.h"
 #import "CMISErrors.h"
-#import "CMISURLUtil.h"
+#import "CMISURLBuilder.h"
 #import "CMISObjectList.h"
+#import "CMISPageLinks.h"
 
 @implementation CMISAtomPubNavigationService
 
@@ -31,60 +32,99 @@
                 maxItems:(NSNumber *)maxItems
          completionBlock:(void (^)(CMISObjectList *objectList, NSError *error))completionBlock
 {
-    // Get Down link
-    [self loadLinkForObjectId:objectId andRelation:kCMISLinkRelationDown
-                      andType:kCMISMediaTypeChildren completionBlock:^(NSString *downLink, NSError *error) {
-                          if (error)
-                          {
-                              log(@"Could not retrieve down link: %@", error.description);
-                              completionBlock(nil, error);
-                              return;
-                          }
-                          
-                          // Add optional params (CMISUrlUtil will not append if the param name or value is nil)
-                          downLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterFilter withValue:filter toUrlString:downLink];
-                          downLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterOrderBy withValue:orderBy toUrlString:downLink];
-                          downLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterIncludeAllowableActions withValue:(includeAllowableActions ? @"true" : @"false") toUrlString:downLink];
-                          downLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterIncludeRelationships withValue:[CMISEnums stringForIncludeRelationShip:includeRelationship] toUrlString:downLink];
-                          downLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterRenditionFilter withValue:renditionFilter toUrlString:downLink];
-                          downLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterIncludePathSegment withValue:(includePathSegment ? @"true" : @"false") toUrlString:downLink];
-                          downLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterMaxItems withValue:[maxItems stringValue] toUrlString:downLink];
-                          downLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterSkipCount withValue:[skipCount stringValue] toUrlString:downLink];
-                          
-                          // execute the request
-                          [HttpUtil invokeGET:[NSURL URLWithString:downLink]
-                                  withSession:self.bindingSession
-                              completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
-                                  if (httpResponse) {
-                                      if (httpResponse.data == nil) {
-                                          NSError *error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeConnection withDetailedDescription:nil];
-                                          completionBlock(nil, error);
-                                          return;
-                                      }
-                                      
-                                      // Parse the feed (containing entries for the children) you get back
-                                      CMISAtomFeedParser *parser = [[CMISAtomFeedParser alloc] initWithData:httpResponse.data];
-                                      NSError *internalError = nil;
-                                      if ([parser parseAndReturnError:&internalError])
-                                      {
-                                          NSString *nextLink = [parser.linkRelations linkHrefForRel:kCMISLinkRelationNext];
-                                          
-                                          CMISObjectList *objectList = [[CMISObjectList alloc] init];
-                                          objectList.hasMoreItems = (nextLink != nil);
-                                          objectList.numItems = parser.numItems;
-                                          objectList.objects = parser.entries;
-                                          completionBlock(objectList, nil);
-                                      }
-                                      else
-                                      {
-                                          NSError *error = [CMISErrors cmisError:internalError withCMISErrorCode:kCMISErrorCodeRuntime];
-                                          completionBlock(nil, error);
-                                      }
-                                  } else {
-                                      completionBlock(nil, error);
-                                  }
-                              }];
-                      }];
+    [self retrieveChildren:objectId orderBy:orderBy filter:filter includeRelationShips:includeRelationship
+           renditionFilter:renditionFilter includeAllowableActions:includeAllowableActions
+        includePathSegment:includePathSegment skipCount:skipCount maxItems:maxItems
+                 pageLinks:nil completionBlock:completionBlock];
+}
+
+- (void)retrieveChildren:(NSString *)objectId orderBy:(NSString *)orderBy
+                  filter:(NSString *)filter includeRelationShips:(CMISIncludeRelationship)includeRelationship
+         renditionFilter:(NSString *)renditionFilter includeAllowableActions:(BOOL)includeAllowableActions
+      includePathSegment:(BOOL)includePathSegment skipCount:(NSNumber *)skipCount
+                maxItems:(NSNumber *)maxItems
+               pageLinks:(CMISPageLinks *)pageLinks
+         completionBlock:(void (^)(CMISObjectList *objectList, NSError *error))completionBlock
+{
+    void (^retrieveChildrenFromSkipCount)(void) = ^{
+        // Get Down link
+        [self loadLinkForObjectId:objectId andRelation:kCMISLinkRelationDown
+                          andType:kCMISMediaTypeChildren completionBlock:^(NSString *downLink, NSError *error) {
+                              if (error)
+                              {
+                                  log(@"Could not retrieve down link: %@", error.description);
+                                  completionBlock(nil, error);
+                                  return;
+                              }
+                              
+                              // Add optional params (the builder will not append if the param name or value is nil)
+                              CMISURLBuilder *urlBuilder = [[CMISURLBuilder alloc] initWithUrlString:downLink];
+                              [urlBuilder addParameter:kCMISParameterFilter withValue:filter];
+                              [urlBuilder addParameter:kCMISParameterOrderBy withValue:orderBy];
+                              [urlBuilder addParameter:kCMISParameterIncludeAllowableActions withBoolValue:includeAllowableActions];
+                              [urlBuilder addParameter:kCMISParameterIncludeRelationships withValue:[CMISEnums stringForIncludeRelationShip:includeRelationship]];
+                              [urlBuilder addParameter:kCMISParameterRenditionFilter withValue:renditionFilter];
+                              [urlBuilder addParameter:kCMISParameterIncludePathSegment withBoolValue:includePathSegment];
+                              [urlBuilder addParameter:kCMISParameterMaxItems withNumberValue:maxItems];
+                              [urlBuilder addParameter:kCMISParameterSkipCount withNumberValue:skipCount];
+                              
+                              [self retrieveChildrenPage:[urlBuilder url] skipCount:[skipCount integerValue] maxItems:[maxItems integerValue]
+                                               pageLinks:pageLinks completionBlock:completionBlock];
+                          }];
+    };
+    
+    // Follow the next link of the previous page if we have it, rather than having the server skip to the offset
+    NSString *nextPageLink = [pageLinks linkForPageAtSkipCount:[skipCount integerValue] maxItems:[maxItems integerValue]];
+    if (nextPageLink != nil) {
+        [self retrieveChildrenPage:[NSURL URLWithString:nextPageLink] skipCount:[skipCount integerValue] maxItems:[maxItems integerValue]
+                         pageLinks:pageLinks completionBlock:^(CMISObjectList *objectList, NSError *error) {
+                   if (objectList) {
+                       completionBlock(objectList, nil);
+                   } else {
+                       // the link may be a cursor the server has let go of: forget it and ask for the offset instead
+                       log(@"Following next link %@ failed, retrieving the page by skip count: %@", nextPageLink, error.description);
+                       [pageLinks removeLinkForPageAtSkipCount:[skipCount integerValue] maxItems:[maxItems integerValue]];
+                       retrieveChildrenFromSkipCount();
+                   }
+               }];
+        return;
+    }
+    
+    retrieveChildrenFromSkipCount();
+}
+
+- (void)retrieveChildrenPage:(NSURL *)pageUrl
+                   skipCount:(NSInteger)skipCount
+                    maxItems:(NSInteger)maxItems
+                   pageLinks:(CMISPageLinks *)pageLinks
+             completionBlock:(void (^)(CMISObjectList *objectList, NSError *error))completionBlock
+{
+    [HttpUtil invokeGET:pageUrl
+            withSession:self.bindingSession
+        completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
+            if (httpResponse) {
+                if (httpResponse.data == nil) {
+                    NSError *error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeConnection withDetailedDescription:nil];
+                    completionBlock(nil, error);
+                    return;
+                }
+                
+                // Parse the feed (containing entries for the children) you get back
+                CMISAtomFeedParser *parser = [[CMISAtomFeedParser alloc] initWithData:httpResponse.data];
+                NSError *internalError = nil;
+                if ([parser parseAndReturnError:&internalError])
+                {
+                    completionBlock([self objectListFromFeedParser:parser skipCount:skipCount maxItems:maxItems pageLinks:pageLinks], nil);
+                }
+                else
+                {
+                    NSError *error = [CMISErrors cmisError:internalError withCMISErrorCode:kCMISErrorCodeRuntime];
+                    completionBlock(nil, error);
+                }
+            } else {
+                completionBlock(nil, error);
+            }
+        }];
 }
 
 - (void)retrieveParentsForObject:(NSString *)objectId
@@ -104,21 +144,14 @@
         }
         
         // Add optional parameters
-        if (filter != nil)
-        {
-            upLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterFilter withValue:filter toUrlString:upLink];
-        }
-        upLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterIncludeAllowableActions withValue:(includeAllowableActions ? @"true" : @"false") toUrlString:upLink];
-        upLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterIncludeRelationships withValue:[CMISEnums stringForIncludeRelationShip:includeRelationship] toUrlString:upLink];
-        
-        if (renditionFilter != nil)
-        {
-            upLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterRenditionFilter withValue:renditionFilter toUrlString:upLink];
-        }
-        
-        upLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterRelativePathSegment withValue:(includeRelativePathSegment ? @"true" : @"false") toUrlString:upLink];
+        CMISURLBuilder *urlBuilder = [[CMISURLBuilder alloc] initWithUrlString:upLink];
+        [urlBuilder addParameter:kCMISParameterFilter withValue:filter];
+        [urlBuilder addParameter:kCMISParameterIncludeAllowableActions withBoolValue:includeAllowableActions];
+        [urlBuilder addParameter:kCMISParameterIncludeRelationships withValue:[CMISEnums stringForIncludeRelationShip:includeRelationship]];
+        [urlBuilder addParameter:kCMISParameterRenditionFilter withValue:renditionFilter];
+        [urlBuilder addParameter:kCMISParameterRelativePathSegment withBoolValue:includeRelativePathSegment];
         
-        [HttpUtil invokeGET:[NSURL URLWithString:upLink]
+        [HttpUtil invokeGET:[urlBuilder url]
                 withSession:self.bindingSession
             completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
                 if (httpResponse) {
@@ -140,4 +173,94 @@
     }];
 }
 
+- (void)retrieveDescendants:(NSString *)folderId
+                      depth:(NSInteger)depth
+                     filter:(NSString *)filter
+       includeRelationShips:(CMISIncludeRelationship)includeRelationship
+            renditionFilter:(NSString *)renditionFilter
+    includeAllowableActions:(BOOL)includeAllowableActions
+         includePathSegment:(BOOL)includePathSegment
+            completionBlock:(void (^)(NSArray *descendants, NSError *error))completionBlock
+{
+    [self retrieveTreeForFolder:folderId withRelation:kCMISLinkRelationDown andType:kCMISMediaTypeDescendants depth:depth filter:filter
+           includeRelationShips:includeRelationship renditionFilter:renditionFilter includeAllowableActions:includeAllowableActions
+             includePathSegment:includePathSegment completionBlock:completionBlock];
+}
+
+- (void)retrieveFolderTree:(NSString *)folderId
+                     depth:(NSInteger)depth
+                    filter:(NSString *)filter
+      includeRelationShips:(CMISIncludeRelationship)includeRelationship
+           renditionFilter:(NSString *)renditionFilter
+   includeAllowableActions:(BOOL)includeAllowableActions
+        includePathSegment:(BOOL)includePathSegment
+           completionBlock:(void (^)(NSArray *folderTree, NSError *error))completionBlock
+{
+    [self retrieveTreeForFolder:folderId withRelation:kCMISLinkRelationFolderTree andType:nil depth:depth filter:filter
+           includeRelationShips:includeRelationship renditionFilter:renditionFilter includeAllowableActions:includeAllowableActions
+             includePathSegment:includePathSegment completionBlock:completionBlock];
+}
+
+// The tree is a feed with the children of each entry in a nested feed, parsed into containers in one go
+- (void)retrieveTreeForFolder:(NSString *)folderId
+                 withRelation:(NSString *)rel
+                      andType:(NSString *)type
+                        depth:(NSInteger)depth
+                       filter:(NSString *)filter
+         includeRelationShips:(CMISIncludeRelationship)includeRelationship
+              renditionFilter:(NSString *)renditionFilter
+      includeAllowableActions:(BOOL)includeAllowableActions
+           includePathSegment:(BOOL)includePathSegment
+              completionBlock:(void (^)(NSArray *containers, NSError *error))completionBlock
+{
+    if (depth == 0 || depth < -1)
+    {
+        log(@"Depth must be -1 or greater than 0, but was %ld", (long)depth);
+        completionBlock(nil, [CMISErrors createCMISErrorWithCode:kCMISErrorCodeInvalidArgument withDetailedDescription:@"Invalid depth"]);
+        return;
+    }
+    
+    [self loadLinkForObjectId:folderId andRelation:rel andType:type completionBlock:^(NSString *treeLink, NSError *error) {
+        if (error)
+        {
+            log(@"Could not retrieve %@ link: %@", rel, error.description);
+            completionBlock(nil, error);
+            return;
+        }
+        if (treeLink == nil)
+        {
+            completionBlock(nil, [CMISErrors createCMISErrorWithCode:kCMISErrorCodeNotSupported
+                                             withDetailedDescription:[NSString stringWithFormat:@"Folder has no %@ link", rel]]);
+            return;
+        }
+        
+        CMISURLBuilder *urlBuilder = [[CMISURLBuilder alloc] initWithUrlString:treeLink];
+        [urlBuilder addParameter:kCMISParameterDepth withNumberValue:[NSNumber numberWithInteger:depth]];
+        [urlBuilder addParameter:kCMISParameterFilter withValue:filter];
+        [urlBuilder addParameter:kCMISParameterIncludeAllowableActions withBoolValue:includeAllowableActions];
+        [urlBuilder addParameter:kCMISParameterIncludeRelationships withValue:[CMISEnums stringForIncludeRelationShip:includeRelationship]];
+        [urlBuilder addParameter:kCMISParameterRenditionFilter withValue:renditionFilter];
+        [urlBuilder addParameter:kCMISParameterIncludePathSegment withBoolValue:includePathSegment];
+        
+        [HttpUtil invokeGET:[urlBuilder url]
+                withSession:self.bindingSession
+            completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
+                if (httpResponse) {
+                    CMISAtomFeedParser *parser = [[CMISAtomFeedParser alloc] initWithData:httpResponse.data];
+                    NSError *internalError = nil;
+                    if ([parser parseAndReturnError:&internalError])
+                    {
+                        completionBlock(parser.objectInFolderContainers, nil);
+                    }
+                    else
+                    {
+                        completionBlock(nil, [CMISErrors cmisError:internalError withCMISErrorCode:kCMISErrorCodeRuntime]);
+                    }
+                } else {
+                    completionBlock(nil, error);
+                }
+            }];
+    }];
+}
+
 @end
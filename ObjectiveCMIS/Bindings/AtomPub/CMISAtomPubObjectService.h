@@ -15,5 +15,10 @@
 
 @interface CMISAtomPubObjectService : CMISAtomPubBaseService <CMISObjectService>
 
+/**
+ * Whether the error is the refusal of a compressed request body (415 Unsupported Media Type), which is the only
+ * failure after which a compressed upload is sent again uncompressed.
+ */
++ (BOOL)isRequestCompressionRejectedError:(NSError *)error;
 
 @end
@@ -22,20 +22,114 @@
 #import "CMISErrors.h"
 #import "CMISStringInOutParameter.h"
 #import "CMISURLUtil.h"
+#import "CMISURLBuilder.h"
 #import "CMISFileUtil.h"
 #import "CMISRequest.h"
+#import "CMISGzipEncoder.h"
+#import "CMISDownloadResumeRecord.h"
+#import "CMISDownloadSink.h"
+#import "CMISAsyncFileWriter.h"
+#import "CMISAtomFeedParser.h"
+#import "CMISObjectIdAndChangeToken.h"
+
+// atom entries smaller than this are sent uncompressed, as the gain would not be worth the extra file pass
+#define MINIMUM_COMPRESSED_ENTRY_SIZE 65536
+
+// content smaller than this is downloaded as a single stream, even if segments are requested
+#define MINIMUM_SEGMENTED_DOWNLOAD_SIZE 2097152 // 2 mb
+
+// allowable actions checked by the upload preflight
+#define ACTION_CAN_CREATE_DOCUMENT @"canCreateDocument"
+#define ACTION_CAN_SET_CONTENT_STREAM @"canSetContentStream"
+
+// object data older than this is fetched again by the upload preflight, so revoked permissions are noticed
+#define PREFLIGHT_CACHE_TTL 60 // seconds
+
+/**
+ * Object data cached by the upload preflight, with the time it was fetched.
+ */
+@interface CMISPreflightCacheEntry : NSObject
+
+@property (nonatomic, strong) CMISObjectData *objectData;
+@property (nonatomic, strong) NSDate *fetchDate;
+
++ (CMISPreflightCacheEntry *)entryWithObjectData:(CMISObjectData *)objectData;
+
+- (BOOL)isFresh;
+
+@end
+
+@implementation CMISPreflightCacheEntry
+
+@synthesize objectData = _objectData;
+@synthesize fetchDate = _fetchDate;
+
++ (CMISPreflightCacheEntry *)entryWithObjectData:(CMISObjectData *)objectData
+{
+    CMISPreflightCacheEntry *entry = [[CMISPreflightCacheEntry alloc] init];
+    entry.objectData = objectData;
+    entry.fetchDate = [NSDate date];
+    return entry;
+}
+
+- (BOOL)isFresh
+{
+    return -[self.fetchDate timeIntervalSinceNow] < PREFLIGHT_CACHE_TTL;
+}
+
+@end
+
+
+@interface CMISAtomPubObjectService ()
+
+// content urls of objects read by range, keyed by object id and stream id, so every range does not cost a retrieveObject
+@property (nonatomic, strong) NSCache *contentUrlCache;
+
+// path and allowable actions of folders uploaded into (CMISPreflightCacheEntry), keyed by folder id, used by the upload preflight
+@property (nonatomic, strong) NSCache *preflightFolderCache;
+
+// allowable actions of documents (CMISPreflightCacheEntry), keyed by object id, used by the preflight of content changes;
+// also filled by retrieveObject, so changing the content of a document just retrieved costs no extra request
+@property (nonatomic, strong) NSCache *preflightDocumentCache;
+
+@end
 
 @implementation CMISAtomPubObjectService
 
-- (void)retrieveObject:(NSString *)objectId
-            withFilter:(NSString *)filter
-andIncludeRelationShips:(CMISIncludeRelationship)includeRelationship
-   andIncludePolicyIds:(BOOL)includePolicyIds
-    andRenditionFilder:(NSString *)renditionFilter
-         andIncludeACL:(BOOL)includeACL
-andIncludeAllowableActions:(BOOL)includeAllowableActions
-       completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock
+@synthesize contentUrlCache = _contentUrlCache;
+@synthesize preflightFolderCache = _preflightFolderCache;
+@synthesize preflightDocumentCache = _preflightDocumentCache;
+
+- (id)initWithBindingSession:(CMISBindingSession *)session
+{
+    self = [super initWithBindingSession:session];
+    if (self) {
+        self.contentUrlCache = [[NSCache alloc] init];
+        self.preflightFolderCache = [[NSCache alloc] init];
+        self.preflightDocumentCache = [[NSCache alloc] init];
+    }
+    return self;
+}
+
+- (void)clearCacheFromService
+{
+    [super clearCacheFromService];
+    [self.contentUrlCache removeAllObjects];
+    [self.preflightFolderCache removeAllObjects];
+    [self.preflightDocumentCache removeAllObjects];
+}
+
+- (CMISRequest*)retrieveObject:(NSString *)objectId
+                    withFilter:(NSString *)filter
+       andIncludeRelationShips:(CMISIncludeRelationship)includeRelationship
+           andIncludePolicyIds:(BOOL)includePolicyIds
+            andRenditionFilder:(NSString *)renditionFilter
+                 andIncludeACL:(BOOL)includeACL
+    andIncludeAllowableActions:(BOOL)includeAllowableActions
+               completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock
 {
+    CMISRequest *request = [[CMISRequest alloc] init];
+    
     [self retrieveObjectInternal:objectId
                withReturnVersion:NOT_PROVIDED
                       withFilter:filter
@@ -48,9 +142,15 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
                      if (error) {
                          completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
                      } else {
+                         if (objectData.allowableActions && objectData.baseType == CMISBaseTypeDocument && [self isUploadPreflightEnabled]) {
+                             [self.preflightDocumentCache setObject:[CMISPreflightCacheEntry entryWithObjectData:objectData] forKey:objectId];
+                         }
                          completionBlock(objectData, nil);
                      }
-                 }];
+                 }
+                   requestObject:request];
+    
+    return request;
 }
 
 - (void)retrieveObjectByPath:(NSString *)path
@@ -78,12 +178,97 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
                         completionBlock:(void (^)(NSError *error))completionBlock
                           progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
 {
-    NSOutputStream *outputStream = [NSOutputStream outputStreamToFileAtPath:filePath append:NO];
-    return [self downloadContentOfObject:objectId
-                            withStreamId:streamId
-                          toOutputStream:outputStream
+    CMISRequest *request = [[CMISRequest alloc] init];
+    
+    [self retrieveObjectInternal:objectId completionBlock:^(CMISObjectData *objectData, NSError *error) {
+        if (error) {
+            log(@"Error while retrieving CMIS object for object id '%@' : %@", objectId, error.description);
+            if (completionBlock) {
+                completionBlock([CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
+            }
+        } else {
+            NSURL *contentUrl = [self contentUrlForObjectData:objectData withStreamId:streamId];
+            unsigned long long streamLength = [[[objectData.properties.propertiesDictionary objectForKey:kCMISPropertyContentStreamLength] firstValue] unsignedLongLongValue];
+            NSString *changeToken = [[objectData.properties.propertiesDictionary objectForKey:kCMISPropertyChangeToken] firstValue];
+            
+            [self downloadContentFromUrl:contentUrl
+                                  toFile:filePath
+                            streamLength:streamLength
+                             changeToken:changeToken
                          completionBlock:completionBlock
-                           progressBlock:progressBlock];
+                           progressBlock:progressBlock
+                           requestObject:request];
+        }
+    } requestObject:request];
+    
+    return request;
+}
+
+- (CMISRequest*)downloadContentOfObject:(NSString *)objectId
+                           withStreamId:(NSString *)streamId
+                                 toFile:(NSString *)filePath
+                           segmentCount:(NSUInteger)segmentCount
+                        completionBlock:(void (^)(NSError *error))completionBlock
+                          progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+{
+    CMISRequest *request = [[CMISRequest alloc] init];
+    
+    [self retrieveObjectInternal:objectId completionBlock:^(CMISObjectData *objectData, NSError *error) {
+        if (error) {
+            log(@"Error while retrieving CMIS object for object id '%@' : %@", objectId, error.description);
+            if (completionBlock) {
+                completionBlock([CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
+            }
+            return;
+        }
+        
+        NSURL *contentUrl = [self contentUrlForObjectData:objectData withStreamId:streamId];
+        unsigned long long streamLength = [[[objectData.properties.propertiesDictionary objectForKey:kCMISPropertyContentStreamLength] firstValue] unsignedLongLongValue];
+        NSString *changeToken = [[objectData.properties.propertiesDictionary objectForKey:kCMISPropertyChangeToken] firstValue];
+        
+        void (^singleStreamDownload)(void) = ^{
+            [self downloadContentFromUrl:contentUrl
+                                  toFile:filePath
+                            streamLength:streamLength
+                             changeToken:changeToken
+                         completionBlock:completionBlock
+                           progressBlock:progressBlock
+                           requestObject:request];
+        };
+        
+        if (segmentCount < 2 || streamLength < MINIMUM_SEGMENTED_DOWNLOAD_SIZE) {
+            singleStreamDownload();
+            return;
+        }
+        
+        [self checkRangeRequestsSupportedForUrl:contentUrl requestObject:request completionBlock:^(BOOL rangeRequestsSupported, NSError *error) {
+            if (request.isCancelled || error) {
+                if (completionBlock) {
+                    completionBlock(request.isCancelled ? [request cancellationError] : error);
+                }
+                return;
+            }
+            if (!rangeRequestsSupported) {
+                log(@"Server does not accept range requests, downloading %@ as a single stream", filePath);
+                singleStreamDownload();
+                return;
+            }
+            
+            // the file is rewritten from scratch, so any record of an earlier single stream download is stale
+            [[CMISDownloadResumeRecord resumeRecordForFileAtPath:filePath] remove];
+            
+            [HttpUtil invoke:contentUrl
+                 withSession:self.bindingSession
+                toFileAtPath:filePath
+               bytesExpected:streamLength
+                segmentCount:segmentCount
+             completionBlock:completionBlock
+               progressBlock:progressBlock
+               requestObject:request];
+        }];
+    } requestObject:request];
+    
+    return request;
 }
 
 - (CMISRequest*)downloadContentOfObject:(NSString *)objectId
@@ -101,19 +286,103 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
                 completionBlock([CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
             }
         } else {
-            NSURL *contentUrl = objectData.contentUrl;
+            NSURL *contentUrl = [self contentUrlForObjectData:objectData withStreamId:streamId];
+            unsigned long long streamLength = [[[objectData.properties.propertiesDictionary objectForKey:kCMISPropertyContentStreamLength] firstValue] unsignedLongLongValue];
             
-            // This is not spec-compliant!! Took me half a day to find this in opencmis ...
-            if (streamId != nil) {
-                contentUrl = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterStreamId withValue:streamId toUrl:contentUrl];
+            [HttpUtil invoke:contentUrl
+              withHttpMethod:HTTP_GET
+                 withSession:self.bindingSession
+                outputStream:outputStream
+               bytesExpected:streamLength
+             completionBlock:^(CMISHttpResponse *httpResponse, NSError *error)
+             {
+                 if (completionBlock) {
+                     completionBlock(error);
+                 }
+             }
+               progressBlock:progressBlock
+               requestObject:request];
+        }
+    } requestObject:request];
+    
+    return request;
+}
+
+- (CMISRequest*)downloadContentOfObject:(NSString *)objectId
+                           withStreamId:(NSString *)streamId
+                                 toFile:(NSString *)filePath
+                       progressInterval:(NSTimeInterval)progressInterval
+                        completionBlock:(void (^)(NSError *error))completionBlock
+                          progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+{
+    CMISRequest *request = [[CMISRequest alloc] init];
+    
+    [self retrieveObjectInternal:objectId completionBlock:^(CMISObjectData *objectData, NSError *error) {
+        if (error) {
+            log(@"Error while retrieving CMIS object for object id '%@' : %@", objectId, error.description);
+            if (completionBlock) {
+                completionBlock([CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
             }
-            
+            return;
+        }
+        
+        NSURL *contentUrl = [self contentUrlForObjectData:objectData withStreamId:streamId];
+        unsigned long long streamLength = [[[objectData.properties.propertiesDictionary objectForKey:kCMISPropertyContentStreamLength] firstValue] unsignedLongLongValue];
+        
+        CMISAsyncFileWriter *fileWriter = [[CMISAsyncFileWriter alloc] initWithFilePath:filePath bytesExpected:streamLength];
+        if (fileWriter == nil) {
+            if (completionBlock) {
+                completionBlock([CMISErrors createCMISErrorWithCode:kCMISErrorCodeStorage
+                                            withDetailedDescription:[NSString stringWithFormat:@"Could not create file %@", filePath]]);
+            }
+            return;
+        }
+        fileWriter.progressInterval = progressInterval;
+        fileWriter.progressBlock = [HttpUtil progressBlock:progressBlock onCallbackQueueOfSession:self.bindingSession];
+        
+        // progress is reported by the writer, per block on disk rather than per received chunk
+        [HttpUtil invoke:contentUrl
+          withHttpMethod:HTTP_GET
+             withSession:self.bindingSession
+                    sink:fileWriter
+           bytesExpected:streamLength
+         completionBlock:^(CMISHttpResponse *httpResponse, NSError *error)
+         {
+             if (completionBlock) {
+                 completionBlock(error);
+             }
+         }
+           progressBlock:nil
+           requestObject:request];
+    } requestObject:request];
+    
+    return request;
+}
+
+- (CMISRequest*)downloadContentOfObject:(NSString *)objectId
+                           withStreamId:(NSString *)streamId
+                                 toSink:(id<CMISDownloadSink>)sink
+                        completionBlock:(void (^)(NSError *error))completionBlock
+                          progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+{
+    CMISRequest *request = [[CMISRequest alloc] init];
+    
+    [self retrieveObjectInternal:objectId completionBlock:^(CMISObjectData *objectData, NSError *error) {
+        if (error) {
+            log(@"Error while retrieving CMIS object for object id '%@' : %@", objectId, error.description);
+            NSError *cmisError = [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound];
+            [sink closeWithError:cmisError completionBlock:nil];
+            if (completionBlock) {
+                completionBlock(cmisError);
+            }
+        } else {
+            NSURL *contentUrl = [self contentUrlForObjectData:objectData withStreamId:streamId];
             unsigned long long streamLength = [[[objectData.properties.propertiesDictionary objectForKey:kCMISPropertyContentStreamLength] firstValue] unsignedLongLongValue];
             
             [HttpUtil invoke:contentUrl
               withHttpMethod:HTTP_GET
                  withSession:self.bindingSession
-                outputStream:outputStream
+                        sink:sink
                bytesExpected:streamLength
              completionBlock:^(CMISHttpResponse *httpResponse, NSError *error)
              {
@@ -124,11 +393,62 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
                progressBlock:progressBlock
                requestObject:request];
         }
-    }];
+    } requestObject:request];
     
     return request;
 }
 
+- (void)downloadContentOfObject:(NSString *)objectId
+                   withStreamId:(NSString *)streamId
+                     fromOffset:(unsigned long long)offset
+                         length:(unsigned long long)length
+                completionBlock:(void (^)(NSData *data, NSError *error))completionBlock
+{
+    if (length == 0) {
+        completionBlock([NSData data], nil);
+        return;
+    }
+    
+    [self retrieveContentUrlForObject:objectId withStreamId:streamId completionBlock:^(NSURL *contentUrl, NSError *error) {
+        if (error) {
+            completionBlock(nil, error);
+            return;
+        }
+        
+        // without range support every call would transfer the complete content, so ask once and fail fast after that
+        [self checkRangeRequestsSupportedForUrl:contentUrl requestObject:nil completionBlock:^(BOOL rangeRequestsSupported, NSError *error) {
+            if (error) {
+                completionBlock(nil, error);
+                return;
+            }
+            if (!rangeRequestsSupported) {
+                completionBlock(nil, [CMISErrors createCMISErrorWithCode:kCMISErrorCodeNotSupported
+                                                 withDetailedDescription:@"Server does not accept range requests"]);
+                return;
+            }
+            
+            NSString *range = [NSString stringWithFormat:@"bytes=%llu-%llu", offset, offset + length - 1];
+            [HttpUtil invoke:contentUrl
+              withHttpMethod:HTTP_GET
+                 withSession:self.bindingSession
+                        body:nil
+                     headers:[NSDictionary dictionaryWithObject:range forKey:@"Range"]
+             completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
+                 if (error) {
+                     completionBlock(nil, error);
+                 } else if (httpResponse.statusCode == 206) {
+                     completionBlock(httpResponse.data, nil);
+                 } else {
+                     // the server answered the probe with a range but sent the complete content; do not let the next call download it again
+                     [CMISAtomPubObjectService setRangeRequestsSupported:NO forUrl:contentUrl];
+                     completionBlock(nil, [CMISErrors createCMISErrorWithCode:kCMISErrorCodeNotSupported
+                                                      withDetailedDescription:@"Server ignored the requested byte range"]);
+                 }
+             }];
+        }];
+    }];
+}
+
 - (void)deleteContentOfObject:(CMISStringInOutParameter *)objectIdParam
               withChangeToken:(CMISStringInOutParameter *)changeTokenParam
               completionBlock:(void (^)(NSError *error))completionBlock
@@ -235,55 +555,88 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
     objectIdParam.outParameter = nil;
     changeTokenParam.outParameter = nil;
     
+    if ([self isUploadPreflightEnabled]) {
+        // the cached allowable actions no longer tell the truth if the repository refuses the content
+        void (^originalCompletionBlock)(NSError *) = completionBlock;
+        completionBlock = ^(NSError *error) {
+            if ([error.domain isEqualToString:kCMISErrorDomainName]
+                && (error.code == kCMISErrorCodePermissionDenied || error.code == kCMISErrorCodeObjectNotFound)) {
+                [self.preflightDocumentCache removeObjectForKey:objectIdParam.inParameter];
+            }
+            if (originalCompletionBlock) {
+                originalCompletionBlock(error);
+            }
+        };
+    }
+    
     CMISRequest *request = [[CMISRequest alloc] init];
-    // Get edit media link
-    [self loadLinkForObjectId:objectIdParam.inParameter andRelation:kCMISLinkEditMedia completionBlock:^(NSString *editMediaLink, NSError *error) {
-        if (editMediaLink == nil){
-            log(@"Could not retrieve %@ link for object '%@'", kCMISLinkEditMedia, objectIdParam.inParameter);
-            if (completionBlock) {
-                completionBlock([CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
+    void (^uploadContent)(void) = ^{
+        // Get edit media link
+        [self loadLinkForObjectId:objectIdParam.inParameter andRelation:kCMISLinkEditMedia completionBlock:^(NSString *editMediaLink, NSError *error) {
+            if (editMediaLink == nil){
+                log(@"Could not retrieve %@ link for object '%@'", kCMISLinkEditMedia, objectIdParam.inParameter);
+                if (completionBlock) {
+                    completionBlock([CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
+                }
+                return;
             }
-            return;
-        }
-        
-        // Append optional change token parameters
-        if (changeTokenParam != nil && changeTokenParam.inParameter != nil) {
-            editMediaLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterChangeToken
-                                                             withValue:changeTokenParam.inParameter toUrlString:editMediaLink];
-        }
-        
-        // Append overwrite flag
-        editMediaLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterOverwriteFlag
-                                                         withValue:(overwrite ? @"true" : @"false") toUrlString:editMediaLink];
-        
-        // Execute HTTP call on edit media link, passing the a stream to the file
-        NSDictionary *additionalHeader = [NSDictionary dictionaryWithObject:[NSString stringWithFormat:@"attachment; filename=%@",
-                                                                             filename] forKey:@"Content-Disposition"];
-        
-        [HttpUtil invoke:[NSURL URLWithString:editMediaLink]
-          withHttpMethod:HTTP_PUT
-             withSession:self.bindingSession
-             inputStream:inputStream
-                 headers:additionalHeader
-           bytesExpected:bytesExpected
-         completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
-             // Check response status
-             if (httpResponse) {
-                 if (httpResponse.statusCode == 200 || httpResponse.statusCode == 201 || httpResponse.statusCode == 204) {
-                     error = nil;
-                 } else {
-                     log(@"Invalid http response status code when updating content: %d", httpResponse.statusCode);
-                     error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeRuntime
-                                         withDetailedDescription:[NSString stringWithFormat:@"Could not update content: http status code %d", httpResponse.statusCode]];
+            
+            // Append optional change token parameters
+            if (changeTokenParam != nil && changeTokenParam.inParameter != nil) {
+                editMediaLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterChangeToken
+                                                                 withValue:changeTokenParam.inParameter toUrlString:editMediaLink];
+            }
+            
+            // Append overwrite flag
+            editMediaLink = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterOverwriteFlag
+                                                             withValue:(overwrite ? @"true" : @"false") toUrlString:editMediaLink];
+            
+            // Execute HTTP call on edit media link, passing the a stream to the file
+            NSDictionary *additionalHeader = [NSDictionary dictionaryWithObject:[NSString stringWithFormat:@"attachment; filename=%@",
+                                                                                 filename] forKey:@"Content-Disposition"];
+            
+            [HttpUtil invoke:[NSURL URLWithString:editMediaLink]
+              withHttpMethod:HTTP_PUT
+                 withSession:self.bindingSession
+                 inputStream:inputStream
+                     headers:additionalHeader
+               bytesExpected:bytesExpected
+             completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
+                 // Check response status
+                 if (httpResponse) {
+                     if (httpResponse.statusCode == 200 || httpResponse.statusCode == 201 || httpResponse.statusCode == 204) {
+                         error = nil;
+                     } else {
+                         log(@"Invalid http response status code when updating content: %d", httpResponse.statusCode);
+                         error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeRuntime
+                                             withDetailedDescription:[NSString stringWithFormat:@"Could not update content: http status code %d", httpResponse.statusCode]];
+                     }
+                 }
+                 if (completionBlock) {
+                     completionBlock(error);
                  }
              }
-             if (completionBlock) {
-                 completionBlock(error);
-             }
-         }
-           progressBlock:progressBlock
-           requestObject:request];
-    }];
+               progressBlock:progressBlock
+               requestObject:request];
+        } requestObject:request];
+        
+    };
+    
+    if ([self isUploadPreflightEnabled]) {
+        [self preflightChangeContentOfObject:objectIdParam.inParameter requestObject:request completionBlock:^(NSError *preflightError) {
+            if (preflightError) {
+                if (completionBlock) {
+                    completionBlock(preflightError);
+                }
+            } else if (!request.isCancelled) {
+                uploadContent();
+            } else if (completionBlock) {
+                completionBlock([request cancellationError]);
+            }
+        }];
+    } else {
+        uploadContent();
+    }
     
     return request;
 }
@@ -347,28 +700,63 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
         return nil;
     }
     
+    if ([self isUploadPreflightEnabled]) {
+        // the cached folder data no longer tells the truth if the repository refuses the document
+        void (^originalCompletionBlock)(NSString *, NSError *) = completionBlock;
+        completionBlock = ^(NSString *objectId, NSError *error) {
+            if ([error.domain isEqualToString:kCMISErrorDomainName]
+                && (error.code == kCMISErrorCodePermissionDenied || error.code == kCMISErrorCodeObjectNotFound)) {
+                [self.preflightFolderCache removeObjectForKey:folderObjectId];
+            }
+            if (originalCompletionBlock) {
+                originalCompletionBlock(objectId, error);
+            }
+        };
+    }
+    
     CMISRequest *request = [[CMISRequest alloc] init];
-    // Get Down link
-    [self loadLinkForObjectId:folderObjectId andRelation:kCMISLinkRelationDown
-                      andType:kCMISMediaTypeChildren completionBlock:^(NSString *downLink, NSError *error) {
-                          if (error) {
-                              log(@"Could not retrieve down link: %@", error.description);
-                              if (completionBlock) {
-                                  completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
+    void (^createDocument)(void) = ^{
+        // Get Down link
+        [self loadLinkForObjectId:folderObjectId andRelation:kCMISLinkRelationDown
+                          andType:kCMISMediaTypeChildren completionBlock:^(NSString *downLink, NSError *error) {
+                              if (error) {
+                                  log(@"Could not retrieve down link: %@", error.description);
+                                  if (completionBlock) {
+                                      completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
+                                  }
+                              } else {
+                                  [self sendAtomEntryXmlToLink:downLink
+                                         withHttpRequestMethod:HTTP_POST
+                                                withProperties:properties
+                                        withContentInputStream:inputStream
+                                           withContentMimeType:mimeType
+                                                 bytesExpected:bytesExpected
+                                               completionBlock:completionBlock
+                                                 progressBlock:progressBlock
+                                                 requestObject:request];
                               }
-                          } else {
-                              
                           }
-                          [self sendAtomEntryXmlToLink:downLink
-                                 withHttpRequestMethod:HTTP_POST
-                                        withProperties:properties
-                                withContentInputStream:inputStream
-                                   withContentMimeType:mimeType
-                                         bytesExpected:bytesExpected
-                                       completionBlock:completionBlock
-                                         progressBlock:progressBlock
-                                         requestObject:request];
-                      }];
+                    requestObject:request];
+    };
+    
+    if ([self isUploadPreflightEnabled]) {
+        [self preflightCreateDocumentWithName:[properties propertyValueForId:kCMISPropertyName]
+                                     inFolder:folderObjectId
+                                requestObject:request
+                              completionBlock:^(NSError *preflightError) {
+                                  if (preflightError) {
+                                      if (completionBlock) {
+                                          completionBlock(nil, preflightError);
+                                      }
+                                  } else if (!request.isCancelled) {
+                                      createDocument();
+                                  } else if (completionBlock) {
+                                      completionBlock(nil, [request cancellationError]);
+                                  }
+                              }];
+    } else {
+        createDocument();
+    }
     return request;
 }
 
@@ -449,11 +837,12 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
         }
         
         void (^continueWithLink)(NSString *) = ^(NSString *link) {
-            link = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterAllVersions withValue:(allVersions ? @"true" : @"false") toUrlString:link];
-            link = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterUnfileObjects withValue:[CMISEnums stringForUnfileObject:unfileObjects] toUrlString:link];
-            link = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterContinueOnFailure withValue:(continueOnFailure ? @"true" : @"false") toUrlString:link];
+            CMISURLBuilder *urlBuilder = [[CMISURLBuilder alloc] initWithUrlString:link];
+            [urlBuilder addParameter:kCMISParameterAllVersions withBoolValue:allVersions];
+            [urlBuilder addParameter:kCMISParameterUnfileObjects withValue:[CMISEnums stringForUnfileObject:unfileObjects]];
+            [urlBuilder addParameter:kCMISParameterContinueOnFailure withBoolValue:continueOnFailure];
             
-            [HttpUtil invokeDELETE:[NSURL URLWithString:link]
+            [HttpUtil invokeDELETE:[urlBuilder url]
                        withSession:self.bindingSession
                    completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
                        if (httpResponse) {
@@ -483,19 +872,21 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
     }];
 }
 
-- (void)updatePropertiesForObject:(CMISStringInOutParameter *)objectIdParam
-                   withProperties:(CMISProperties *)properties
-                  withChangeToken:(CMISStringInOutParameter *)changeTokenParam
-                  completionBlock:(void (^)(NSError *error))completionBlock
+- (CMISRequest*)updatePropertiesForObject:(CMISStringInOutParameter *)objectIdParam
+                           withProperties:(CMISProperties *)properties
+                          withChangeToken:(CMISStringInOutParameter *)changeTokenParam
+                          completionBlock:(void (^)(NSError *error))completionBlock
 {
     // Validate params
     if (objectIdParam == nil || objectIdParam.inParameter == nil)
     {
         log(@"Object id is nil or inParameter of objectId is nil");
         completionBlock([[NSError alloc] init]); // TODO: properly init error (CmisInvalidArgumentException)
-        return;
+        return nil;
     }
     
+    CMISRequest *request = [[CMISRequest alloc] init];
+    
     // Get self link
     [self loadLinkForObjectId:objectIdParam.inParameter andRelation:kCMISLinkRelationSelf completionBlock:^(NSString *selfLink, NSError *error) {
         if (selfLink == nil)
@@ -512,42 +903,99 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
                                                         withValue:changeTokenParam.inParameter toUrlString:selfLink];
         }
         
+        // Create XML needed as body of html
+        CMISAtomEntryWriter *xmlWriter = [[CMISAtomEntryWriter alloc] init];
+        xmlWriter.cmisProperties = properties;
+        xmlWriter.generateXmlInMemory = YES;
+        
         // Execute request
-        [self sendAtomEntryXmlToLink:selfLink
-               withHttpRequestMethod:HTTP_PUT
-                      withProperties:properties
-                     completionBlock:^(CMISObjectData *objectData, NSError *error) {
-                         // Create XML needed as body of html
-                         
-                         CMISAtomEntryWriter *xmlWriter = [[CMISAtomEntryWriter alloc] init];
-                         xmlWriter.cmisProperties = properties;
-                         xmlWriter.generateXmlInMemory = YES;
-                         
-                         [HttpUtil invokePUT:[NSURL URLWithString:selfLink]
-                                 withSession:self.bindingSession
-                                        body:[xmlWriter.generateAtomEntryXml dataUsingEncoding:NSUTF8StringEncoding]
-                                     headers:[NSDictionary dictionaryWithObject:kCMISMediaTypeEntry forKey:@"Content-type"]
-                             completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
-                                 if (httpResponse) {
-                                     // Object id and changeToken might have changed because of this operation
-                                     CMISAtomEntryParser *atomEntryParser = [[CMISAtomEntryParser alloc] initWithData:httpResponse.data];
-                                     NSError *error = nil;
-                                     if ([atomEntryParser parseAndReturnError:&error])
-                                     {
-                                         objectIdParam.outParameter = [[atomEntryParser.objectData.properties propertyForId:kCMISPropertyObjectId] firstValue];
-                                         
-                                         if (changeTokenParam != nil)
-                                         {
-                                             changeTokenParam.outParameter = [[atomEntryParser.objectData.properties propertyForId:kCMISPropertyChangeToken] firstValue];
-                                         }
-                                     }
-                                     completionBlock(nil);
-                                 } else {
-                                     completionBlock([CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeConnection]);
-                                 }
-                             }];
-                     }];
-    }];
+        [HttpUtil invokePUT:[NSURL URLWithString:selfLink]
+                withSession:self.bindingSession
+                       body:[xmlWriter.generateAtomEntryXml dataUsingEncoding:NSUTF8StringEncoding]
+                    headers:[NSDictionary dictionaryWithObject:kCMISMediaTypeEntry forKey:@"Content-type"]
+            completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
+                if (httpResponse) {
+                    // Object id and changeToken might have changed because of this operation
+                    CMISAtomEntryParser *atomEntryParser = [[CMISAtomEntryParser alloc] initWithData:httpResponse.data];
+                    NSError *error = nil;
+                    if ([atomEntryParser parseAndReturnError:&error])
+                    {
+                        objectIdParam.outParameter = [[atomEntryParser.objectData.properties propertyForId:kCMISPropertyObjectId] firstValue];
+                        
+                        if (changeTokenParam != nil)
+                        {
+                            changeTokenParam.outParameter = [[atomEntryParser.objectData.properties propertyForId:kCMISPropertyChangeToken] firstValue];
+                        }
+                    }
+                    completionBlock(nil);
+                } else {
+                    completionBlock([CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeConnection]);
+                }
+            }
+              requestObject:request];
+    } requestObject:request];
+    
+    return request;
+}
+
+- (CMISRequest*)bulkUpdateProperties:(CMISProperties *)properties
+          forObjectIdsAndChangeTokens:(NSArray *)objectIdsAndChangeTokens
+                      completionBlock:(void (^)(NSArray *updatedObjectIdsAndChangeTokens, NSError *error))completionBlock
+{
+    NSString *bulkUpdateUrlString = [self.bindingSession objectForKey:kCMISBindingSessionKeyBulkUpdateCollection];
+    if (bulkUpdateUrlString == nil)
+    {
+        completionBlock(nil, [CMISErrors createCMISErrorWithCode:kCMISErrorCodeNotSupported
+                                         withDetailedDescription:@"Repository does not support bulk updates"]);
+        return nil;
+    }
+    
+    CMISAtomEntryWriter *xmlWriter = [[CMISAtomEntryWriter alloc] init];
+    xmlWriter.cmisProperties = properties;
+    xmlWriter.bulkUpdateObjectIdsAndChangeTokens = objectIdsAndChangeTokens;
+    xmlWriter.generateXmlInMemory = YES;
+    
+    CMISRequest *request = [[CMISRequest alloc] init];
+    [HttpUtil invokePOST:[NSURL URLWithString:bulkUpdateUrlString]
+             withSession:self.bindingSession
+                    body:[xmlWriter.generateAtomEntryXml dataUsingEncoding:NSUTF8StringEncoding]
+                 headers:[NSDictionary dictionaryWithObject:kCMISMediaTypeEntry forKey:@"Content-type"]
+         completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
+             if (httpResponse) {
+                 // The response feed has an entry for every updated object. If the update created a new version,
+                 // the entry either has the new id next to the old one or, with some repositories, only the new one
+                 CMISAtomFeedParser *feedParser = [[CMISAtomFeedParser alloc] initWithData:httpResponse.data];
+                 NSError *parseError = nil;
+                 if ([feedParser parseAndReturnError:&parseError]) {
+                     NSMutableArray *updatedObjectIdsAndChangeTokens = [NSMutableArray arrayWithCapacity:feedParser.entries.count];
+                     for (CMISObjectData *objectData in feedParser.entries) {
+                         NSString *changeToken = [[objectData.properties propertyForId:kCMISPropertyChangeToken] firstValue];
+                         NSString *versionSeriesId = [[objectData.properties propertyForId:kCMISPropertyVersionSeriesId] firstValue];
+                         NSString *newObjectId = [[objectData.properties propertyForId:kCMISPropertyNewId] firstValue];
+                         CMISObjectIdAndChangeToken *updatedObjectIdAndChangeToken = nil;
+                         if (newObjectId != nil) {
+                             updatedObjectIdAndChangeToken = [[CMISObjectIdAndChangeToken alloc] initWithObjectId:newObjectId
+                                                                                                 previousObjectId:objectData.identifier
+                                                                                                  versionSeriesId:versionSeriesId
+                                                                                                      changeToken:changeToken];
+                         } else {
+                             updatedObjectIdAndChangeToken = [[CMISObjectIdAndChangeToken alloc] initWithObjectId:objectData.identifier
+                                                                                                 previousObjectId:nil
+                                                                                                  versionSeriesId:versionSeriesId
+                                                                                                      changeToken:changeToken];
+                         }
+                         [updatedObjectIdsAndChangeTokens addObject:updatedObjectIdAndChangeToken];
+                     }
+                     completionBlock(updatedObjectIdsAndChangeTokens, nil);
+                 } else {
+                     completionBlock(nil, [CMISErrors cmisError:parseError withCMISErrorCode:kCMISErrorCodeRuntime]);
+                 }
+             } else {
+                 completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeConnection]);
+             }
+         }
+           requestObject:request];
+    return request;
 }
 
 
@@ -570,10 +1018,159 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
 
 #pragma mark Helper methods
 
+/**
+ * Helper method: downloads content to a file over a single connection, continuing an earlier,
+ * interrupted download of the same content if there is one.
+ */
+- (void)downloadContentFromUrl:(NSURL *)contentUrl
+                        toFile:(NSString *)filePath
+                  streamLength:(unsigned long long)streamLength
+                   changeToken:(NSString *)changeToken
+               completionBlock:(void (^)(NSError *error))completionBlock
+                 progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+                 requestObject:(CMISRequest *)request
+{
+    CMISDownloadResumeRecord *resumeRecord = [CMISDownloadResumeRecord resumeRecordForFileAtPath:filePath];
+    if ([resumeRecord canResumeWithContentUrl:contentUrl.absoluteString changeToken:changeToken]
+        && [resumeRecord truncateFileToBytesWritten]) {
+        log(@"Found %llu bytes of an earlier download to %@", resumeRecord.bytesWritten, filePath);
+    } else {
+        [resumeRecord reset];
+        resumeRecord.contentUrl = contentUrl.absoluteString;
+        resumeRecord.changeToken = changeToken;
+    }
+    
+    NSOutputStream *outputStream = [NSOutputStream outputStreamToFileAtPath:filePath append:(resumeRecord.bytesWritten > 0)];
+    [HttpUtil invoke:contentUrl
+      withHttpMethod:HTTP_GET
+         withSession:self.bindingSession
+        outputStream:outputStream
+       bytesExpected:streamLength
+        resumeRecord:resumeRecord
+     completionBlock:^(CMISHttpResponse *httpResponse, NSError *error)
+     {
+         if (completionBlock) {
+             completionBlock(error);
+         }
+     }
+       progressBlock:progressBlock
+       requestObject:request];
+}
+
+/**
+ * Helper method: looks up the url of a content stream, fetching the object only if it is not cached yet.
+ */
+- (void)retrieveContentUrlForObject:(NSString *)objectId
+                       withStreamId:(NSString *)streamId
+                    completionBlock:(void (^)(NSURL *contentUrl, NSError *error))completionBlock
+{
+    NSString *cacheKey = streamId ? [NSString stringWithFormat:@"%@/%@", objectId, streamId] : objectId;
+    NSURL *contentUrl = [self.contentUrlCache objectForKey:cacheKey];
+    if (contentUrl) {
+        completionBlock(contentUrl, nil);
+        return;
+    }
+    
+    [self retrieveObjectInternal:objectId completionBlock:^(CMISObjectData *objectData, NSError *error) {
+        if (error) {
+            log(@"Error while retrieving CMIS object for object id '%@' : %@", objectId, error.description);
+            completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
+        } else if (objectData.contentUrl == nil) {
+            completionBlock(nil, [CMISErrors createCMISErrorWithCode:kCMISErrorCodeConstraint
+                                             withDetailedDescription:[NSString stringWithFormat:@"Object %@ has no content stream", objectId]]);
+        } else {
+            NSURL *contentUrl = [self contentUrlForObjectData:objectData withStreamId:streamId];
+            [self.contentUrlCache setObject:contentUrl forKey:cacheKey];
+            completionBlock(contentUrl, nil);
+        }
+    }];
+}
+
+// the answers of the range probes, by server: it is the server, not the session, that does or does not accept ranges
++ (NSMutableDictionary *)rangeRequestsSupportedByServer
+{
+    static NSMutableDictionary *rangeRequestsSupportedByServer = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        rangeRequestsSupportedByServer = [NSMutableDictionary dictionary];
+    });
+    return rangeRequestsSupportedByServer;
+}
+
++ (NSString *)serverKeyForUrl:(NSURL *)url
+{
+    return [NSString stringWithFormat:@"%@://%@:%@", [url.scheme lowercaseString], [url.host lowercaseString], url.port];
+}
+
++ (void)setRangeRequestsSupported:(BOOL)rangeRequestsSupported forUrl:(NSURL *)url
+{
+    NSMutableDictionary *rangeRequestsSupportedByServer = [self rangeRequestsSupportedByServer];
+    @synchronized(rangeRequestsSupportedByServer) {
+        [rangeRequestsSupportedByServer setObject:[NSNumber numberWithBool:rangeRequestsSupported] forKey:[self serverKeyForUrl:url]];
+    }
+}
+
+/**
+ * Helper method: finds out whether the server accepts byte range requests, by asking it for the first byte of the content.
+ * Accept-Ranges is not used, as servers may accept ranges without sending it. The answer is remembered for the server;
+ * a failing probe is reported with its error and asked again next time. The probe is cancelled with the given request.
+ */
+- (void)checkRangeRequestsSupportedForUrl:(NSURL *)contentUrl
+                            requestObject:(CMISRequest *)request
+                          completionBlock:(void (^)(BOOL rangeRequestsSupported, NSError *error))completionBlock
+{
+    NSMutableDictionary *rangeRequestsSupportedByServer = [CMISAtomPubObjectService rangeRequestsSupportedByServer];
+    NSNumber *rangeRequestsSupported = nil;
+    @synchronized(rangeRequestsSupportedByServer) {
+        rangeRequestsSupported = [rangeRequestsSupportedByServer objectForKey:[CMISAtomPubObjectService serverKeyForUrl:contentUrl]];
+    }
+    if (rangeRequestsSupported) {
+        completionBlock([rangeRequestsSupported boolValue], nil);
+        return;
+    }
+    
+    [HttpUtil invokeRangeProbe:contentUrl
+                   withSession:self.bindingSession
+               completionBlock:^(BOOL supported, NSError *error) {
+                   if (error) {
+                       log(@"Could not determine range request support: %@", error);
+                       completionBlock(NO, error);
+                       return;
+                   }
+                   [CMISAtomPubObjectService setRangeRequestsSupported:supported forUrl:contentUrl];
+                   completionBlock(supported, nil);
+               }
+                 requestObject:request];
+}
+
+- (NSURL *)contentUrlForObjectData:(CMISObjectData *)objectData withStreamId:(NSString *)streamId
+{
+    NSURL *contentUrl = objectData.contentUrl;
+    
+    // This is not spec-compliant!! Took me half a day to find this in opencmis ...
+    if (streamId != nil) {
+        contentUrl = [CMISURLUtil urlStringByAppendingParameter:kCMISParameterStreamId withValue:streamId toUrl:contentUrl];
+    }
+    return contentUrl;
+}
+
+- (void)sendAtomEntryXmlToLink:(NSString *)link
+         withHttpRequestMethod:(CMISHttpRequestMethod)httpRequestMethod
+                withProperties:(CMISProperties *)properties
+               completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock
+{
+    [self sendAtomEntryXmlToLink:link
+           withHttpRequestMethod:httpRequestMethod
+                  withProperties:properties
+                 completionBlock:completionBlock
+                   requestObject:nil];
+}
+
 - (void)sendAtomEntryXmlToLink:(NSString *)link
          withHttpRequestMethod:(CMISHttpRequestMethod)httpRequestMethod
                 withProperties:(CMISProperties *)properties
                completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock
+                 requestObject:(CMISRequest *)request
 {
     // Validate params
     if (link == nil) {
@@ -621,7 +1218,8 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
                  completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeConnection]);
              }
          }
-     }];
+     }
+       requestObject:request];
 }
 
 
@@ -650,61 +1248,287 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
                                         contentMimeType:contentMimeType
                                     isXmlStoredInMemory:NO];
     
-    // Start the asynchronous POST http call
-    NSInputStream *inputStream = [NSInputStream inputStreamWithFileAtPath:writeResult];
-    
     NSError *fileSizeError = nil;
     unsigned long long fileSize = [FileUtil fileSizeForFileAtPath:writeResult error:&fileSizeError];
     if (fileSizeError) {
         log(@"Could not determine file size of %@ : %@", writeResult, [fileSizeError description]);
     }
     
+    // Compress the atom entry, unless the repository is known to reject gzip encoded request bodies
+    NSString *compressedFilePath = nil;
+    if (fileSize >= MINIMUM_COMPRESSED_ENTRY_SIZE && [self isRequestCompressionEnabled]) {
+        compressedFilePath = [writeResult stringByAppendingPathExtension:@"gz"];
+        if (![CMISGzipEncoder encodeContentOfFile:writeResult toFile:compressedFilePath]) {
+            log(@"Could not compress %@, sending it uncompressed", writeResult);
+            compressedFilePath = nil;
+        }
+    }
+    
+    void (^responseBlock)(CMISHttpResponse *, NSError *) = ^(CMISHttpResponse *response, NSError *error) {
+        // delete temporary files
+        for (NSString *temporaryFilePath in [NSArray arrayWithObjects:writeResult, compressedFilePath, nil]) {
+            NSError *fileError = nil;
+            [[NSFileManager defaultManager] removeItemAtPath:temporaryFilePath error:&fileError];
+            if (fileError) {
+                // the upload itself is not impacted by this error, so do not report it in the completion block
+                log(@"Could not delete temporary file %@: %@", temporaryFilePath, [fileError description]);
+            }
+        }
+        
+        if (error) {
+            log(@"HTTP error when creating/uploading content: %@", error);
+            if (completionBlock) {
+                completionBlock(nil, error);
+            }
+        } else if (response.statusCode == 200 || response.statusCode == 201 || response.statusCode == 204) {
+            if (completionBlock) {
+                NSError *parseError = nil;
+                CMISAtomEntryParser *atomEntryParser = [[CMISAtomEntryParser alloc] initWithData:response.data];
+                [atomEntryParser parseAndReturnError:&parseError];
+                if (parseError == nil) {
+                    completionBlock(atomEntryParser.objectData.identifier, nil);
+                } else {
+                    log(@"Error while parsing response: %@", [parseError description]);
+                    completionBlock(nil, [CMISErrors cmisError:parseError withCMISErrorCode:kCMISErrorCodeUpdateConflict]);
+                }
+            }
+        } else {
+            log(@"Invalid http response status code when creating/uploading content: %d", response.statusCode);
+            log(@"Error content: %@", [[NSString alloc] initWithData:response.data encoding:NSUTF8StringEncoding]);
+            if (completionBlock) {
+                completionBlock(nil, [CMISErrors createCMISErrorWithCode:kCMISErrorCodeRuntime
+                                                 withDetailedDescription:[NSString stringWithFormat:@"Could not create content: http status code %d", response.statusCode]]);
+            }
+        }
+    };
+    
+    if (compressedFilePath == nil) {
+        [self sendAtomEntryFile:writeResult
+                         toLink:link
+               uncompressedSize:fileSize
+                     compressed:NO
+                completionBlock:responseBlock
+                  progressBlock:progressBlock
+                  requestObject:request];
+        return;
+    }
+    
+    [self sendAtomEntryFile:compressedFilePath
+                     toLink:link
+           uncompressedSize:fileSize
+                 compressed:YES
+            completionBlock:^(CMISHttpResponse *response, NSError *error) {
+                NSNumber *compressionSupported = [self.bindingSession objectForKey:kCMISBindingSessionKeyRequestCompressionSupported];
+                if (error && compressionSupported == nil && [CMISAtomPubObjectService isRequestCompressionRejectedError:error]) {
+                    // first compressed upload for this repository: it might just not understand gzip, so retry uncompressed
+                    log(@"Compressed upload was rejected (%@), retrying uncompressed", error);
+                    [self sendAtomEntryFile:writeResult
+                                     toLink:link
+                           uncompressedSize:fileSize
+                                 compressed:NO
+                            completionBlock:^(CMISHttpResponse *response, NSError *error) {
+                                if (error == nil) {
+                                    [self.bindingSession setObject:[NSNumber numberWithBool:NO]
+                                                            forKey:kCMISBindingSessionKeyRequestCompressionSupported];
+                                }
+                                responseBlock(response, error);
+                            }
+                              progressBlock:progressBlock
+                              requestObject:request];
+                } else {
+                    if (error == nil) {
+                        [self.bindingSession setObject:[NSNumber numberWithBool:YES]
+                                                forKey:kCMISBindingSessionKeyRequestCompressionSupported];
+                    }
+                    responseBlock(response, error);
+                }
+            }
+              progressBlock:progressBlock
+              requestObject:request];
+}
+
+/**
+ * Helper method: streams an atom entry stored in a file as the body of a POST request.
+ * If the file is gzip compressed, the progress is reported in uncompressed bytes.
+ * The file is read afresh for every attempt, so a retried request does not need to encode the entry again.
+ */
+- (void)sendAtomEntryFile:(NSString *)filePath
+                   toLink:(NSString *)link
+         uncompressedSize:(unsigned long long)uncompressedSize
+               compressed:(BOOL)compressed
+          completionBlock:(void (^)(CMISHttpResponse *response, NSError *error))completionBlock
+            progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock
+            requestObject:(CMISRequest*)request
+{
+    NSMutableDictionary *headers = [NSMutableDictionary dictionaryWithObject:kCMISMediaTypeEntry forKey:@"Content-type"];
+    unsigned long long bodySize = uncompressedSize;
+    void (^bodyProgressBlock)(unsigned long long, unsigned long long) = progressBlock;
+    
+    if (compressed) {
+        [headers setObject:@"gzip" forKey:@"Content-Encoding"];
+        
+        NSError *fileSizeError = nil;
+        bodySize = [FileUtil fileSizeForFileAtPath:filePath error:&fileSizeError];
+        if (fileSizeError) {
+            log(@"Could not determine file size of %@ : %@", filePath, [fileSizeError description]);
+        }
+        
+        if (progressBlock && bodySize > 0) {
+            // base64 encoded content compresses evenly, so scaling the sent bytes by the overall ratio is accurate enough
+            bodyProgressBlock = ^(unsigned long long bytesUploaded, unsigned long long bytesTotal) {
+                unsigned long long uncompressedBytesUploaded = (unsigned long long)((double)bytesUploaded * uncompressedSize / bodySize);
+                progressBlock(MIN(uncompressedBytesUploaded, uncompressedSize), uncompressedSize);
+            };
+        }
+    }
+    
     [HttpUtil invoke:[NSURL URLWithString:link]
       withHttpMethod:HTTP_POST
          withSession:self.bindingSession
-         inputStream:inputStream
-             headers:[NSDictionary dictionaryWithObject:kCMISMediaTypeEntry forKey:@"Content-type"]
-       bytesExpected:fileSize
-     completionBlock:^(CMISHttpResponse *response, NSError *error) {
-         // close stream to and delete temporary file
-         [inputStream close];
-         NSError *fileError = nil;
-         [[NSFileManager defaultManager] removeItemAtPath:writeResult error:&fileError];
-         if (fileError) {
-             // the upload itself is not impacted by this error, so do not report it in the completion block
-             log(@"Could not delete temporary file %@: %@", writeResult, [fileError description]);
-         }
-         
-         if (error) {
-             log(@"HTTP error when creating/uploading content: %@", error);
-             if (completionBlock) {
-                 completionBlock(nil, error);
-             }
-         } else if (response.statusCode == 200 || response.statusCode == 201 || response.statusCode == 204) {
-             if (completionBlock) {
-                 NSError *parseError = nil;
-                 CMISAtomEntryParser *atomEntryParser = [[CMISAtomEntryParser alloc] initWithData:response.data];
-                 [atomEntryParser parseAndReturnError:&parseError];
-                 if (parseError == nil) {
-                     completionBlock(atomEntryParser.objectData.identifier, nil);
-                 } else {
-                     log(@"Error while parsing response: %@", [parseError description]);
-                     completionBlock(nil, [CMISErrors cmisError:parseError withCMISErrorCode:kCMISErrorCodeUpdateConflict]);
-                 }
-             }
-         } else {
-             log(@"Invalid http response status code when creating/uploading content: %d", response.statusCode);
-             log(@"Error content: %@", [[NSString alloc] initWithData:response.data encoding:NSUTF8StringEncoding]);
-             if (completionBlock) {
-                 completionBlock(nil, [CMISErrors createCMISErrorWithCode:kCMISErrorCodeRuntime
-                                                  withDetailedDescription:[NSString stringWithFormat:@"Could not create content: http status code %d", response.statusCode]]);
-             }
-         }
-     }
-       progressBlock:progressBlock
+            bodyFile:filePath
+             headers:headers
+       bytesExpected:bodySize
+     completionBlock:completionBlock
+       progressBlock:bodyProgressBlock
        requestObject:request];
 }
 
+- (BOOL)isUploadPreflightEnabled
+{
+    return [[self.bindingSession objectForKey:kCMISSessionParameterUploadPreflight] boolValue];
+}
+
+/**
+ * Checks, before any content is sent, that a document with the given name can be created in the folder:
+ * the folder must allow canCreateDocument and must not contain an object with that name yet.
+ * The folder data is cached for PREFLIGHT_CACHE_TTL seconds (or until an upload into the folder is refused),
+ * so consecutive uploads into the same folder only cost the name lookup.
+ */
+- (void)preflightCreateDocumentWithName:(NSString *)name
+                               inFolder:(NSString *)folderObjectId
+                          requestObject:(CMISRequest *)request
+                        completionBlock:(void (^)(NSError *error))completionBlock
+{
+    void (^checkFolder)(CMISObjectData *) = ^(CMISObjectData *folderData) {
+        NSSet *allowableActions = folderData.allowableActions.allowableActionsSet;
+        if (allowableActions && ![allowableActions containsObject:ACTION_CAN_CREATE_DOCUMENT]) {
+            log(@"Preflight: not allowed to create documents in folder %@", folderObjectId);
+            completionBlock([CMISErrors createCMISErrorWithCode:kCMISErrorCodePermissionDenied
+                                        withDetailedDescription:@"Not allowed to create documents in this folder"]);
+            return;
+        }
+        
+        NSString *folderPath = [folderData.properties propertyValueForId:kCMISPropertyPath];
+        if (folderPath == nil || name == nil) { // no way to tell, leave it to the repository
+            completionBlock(nil);
+            return;
+        }
+        
+        [self retrieveObjectByPathInternal:[folderPath stringByAppendingPathComponent:name]
+                                withFilter:kCMISPropertyObjectId
+                   andIncludeRelationShips:CMISIncludeRelationshipNone
+                       andIncludePolicyIds:NO
+                        andRenditionFilder:nil
+                             andIncludeACL:NO
+                andIncludeAllowableActions:NO
+                           completionBlock:^(CMISObjectData *existingObject, NSError *error) {
+                               if (existingObject) {
+                                   log(@"Preflight: an object named %@ exists already in folder %@", name, folderObjectId);
+                                   completionBlock([CMISErrors createCMISErrorWithCode:kCMISErrorCodeNameConstraintViolation
+                                                               withDetailedDescription:[NSString stringWithFormat:@"An object named %@ exists already", name]]);
+                               } else {
+                                   completionBlock(nil);
+                               }
+                           }
+                             requestObject:request];
+    };
+    
+    CMISPreflightCacheEntry *cacheEntry = [self.preflightFolderCache objectForKey:folderObjectId];
+    if (cacheEntry.isFresh) {
+        checkFolder(cacheEntry.objectData);
+        return;
+    }
+    
+    [self retrieveObjectInternal:folderObjectId
+               withReturnVersion:NOT_PROVIDED
+                      withFilter:[NSString stringWithFormat:@"%@,%@", kCMISPropertyObjectId, kCMISPropertyPath]
+         andIncludeRelationShips:CMISIncludeRelationshipNone
+             andIncludePolicyIds:NO
+              andRenditionFilder:nil
+                   andIncludeACL:NO
+      andIncludeAllowableActions:YES
+                 completionBlock:^(CMISObjectData *objectData, NSError *error) {
+                     if (error) {
+                         [self.preflightFolderCache removeObjectForKey:folderObjectId];
+                         completionBlock([CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
+                     } else {
+                         [self.preflightFolderCache setObject:[CMISPreflightCacheEntry entryWithObjectData:objectData] forKey:folderObjectId];
+                         checkFolder(objectData);
+                     }
+                 }
+                   requestObject:request];
+}
+
+/**
+ * Checks, before any content is sent, that the content stream of the document may be set.
+ * Like the folder data of the create preflight, the allowable actions of the document are cached for PREFLIGHT_CACHE_TTL
+ * seconds (or until a change of its content is refused), so only the first change of a document costs a request.
+ */
+- (void)preflightChangeContentOfObject:(NSString *)objectId
+                        requestObject:(CMISRequest *)request
+                      completionBlock:(void (^)(NSError *error))completionBlock
+{
+    void (^checkDocument)(CMISObjectData *) = ^(CMISObjectData *objectData) {
+        NSSet *allowableActions = objectData.allowableActions.allowableActionsSet;
+        if (allowableActions && ![allowableActions containsObject:ACTION_CAN_SET_CONTENT_STREAM]) {
+            log(@"Preflight: not allowed to set the content stream of %@", objectId);
+            completionBlock([CMISErrors createCMISErrorWithCode:kCMISErrorCodePermissionDenied
+                                        withDetailedDescription:@"Not allowed to set the content stream"]);
+        } else {
+            completionBlock(nil);
+        }
+    };
+    
+    CMISPreflightCacheEntry *cacheEntry = [self.preflightDocumentCache objectForKey:objectId];
+    if (cacheEntry.isFresh) {
+        checkDocument(cacheEntry.objectData);
+        return;
+    }
+    
+    [self retrieveObjectInternal:objectId
+               withReturnVersion:NOT_PROVIDED
+                      withFilter:kCMISPropertyObjectId
+         andIncludeRelationShips:CMISIncludeRelationshipNone
+             andIncludePolicyIds:NO
+              andRenditionFilder:nil
+                   andIncludeACL:NO
+      andIncludeAllowableActions:YES
+                 completionBlock:^(CMISObjectData *objectData, NSError *error) {
+                     if (error) {
+                         [self.preflightDocumentCache removeObjectForKey:objectId];
+                         completionBlock([CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
+                     } else {
+                         [self.preflightDocumentCache setObject:[CMISPreflightCacheEntry entryWithObjectData:objectData] forKey:objectId];
+                         checkDocument(objectData);
+                     }
+                 }
+                   requestObject:request];
+}
+
+- (BOOL)isRequestCompressionEnabled
+{
+    NSNumber *compressRequestBody = [self.bindingSession objectForKey:kCMISSessionParameterCompressRequestBody];
+    NSNumber *compressionSupported = [self.bindingSession objectForKey:kCMISBindingSessionKeyRequestCompressionSupported];
+    return compressRequestBody.boolValue && (compressionSupported == nil || compressionSupported.boolValue);
+}
+
++ (BOOL)isRequestCompressionRejectedError:(NSError *)error
+{
+    // a 400 or 500 might come after the entry was stored: sending it again could create the document twice
+    NSNumber *statusCode = [error.userInfo objectForKey:kCMISErrorKeyHttpStatusCode];
+    return [error.domain isEqualToString:kCMISErrorDomainName] && statusCode.integerValue == 415;
+}
+
 
 /**
  * Helper method: creates a writer for the xml needed to upload a file.
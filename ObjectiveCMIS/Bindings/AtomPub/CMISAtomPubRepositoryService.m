@@ -22,7 +22,7 @@
 #import "CMISTypeDefinitionAtomEntryParser.h"
 
 @interface CMISAtomPubRepositoryService ()
-@property (nonatomic, strong) NSMutableDictionary *repositories;
+@property (strong) NSDictionary *repositories; // atomic: replaced while concurrent requests read it
 @end
 
 @interface CMISAtomPubRepositoryService (PrivateMethods)
@@ -58,15 +58,16 @@
 
 - (void)internalRetrieveRepositoriesWithCompletionBlock:(void (^)(NSError *error))completionBlock
 {
-    self.repositories = [NSMutableDictionary dictionary];
     [self retrieveCMISWorkspacesWithCompletionBlock:^(NSArray *cmisWorkSpaces, NSError *error) {
+        NSMutableDictionary *repositories = [NSMutableDictionary dictionary];
         if (cmisWorkSpaces != nil)
         {
             for (CMISWorkspace *workspace in cmisWorkSpaces)
             {
-                [self.repositories setObject:workspace.repositoryInfo forKey:workspace.repositoryInfo.identifier];
+                [repositories setObject:workspace.repositoryInfo forKey:workspace.repositoryInfo.identifier];
             }
         }
+        self.repositories = repositories;
         completionBlock(error);
     }];
 }
@@ -83,9 +84,8 @@
     
     [self retrieveFromCache:kCMISBindingSessionKeyTypeByIdUriBuilder completionBlock:^(id object, NSError *error) {
         CMISTypeByIdUriBuilder *typeByIdUriBuilder = object;
-        typeByIdUriBuilder.id = typeId;
         
-        [HttpUtil invokeGET:[typeByIdUriBuilder buildUrl] withSession:self.bindingSession completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
+        [HttpUtil invokeGET:[typeByIdUriBuilder urlForTypeId:typeId] withSession:self.bindingSession completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
             if (httpResponse) {
                 if (httpResponse.data != nil) {
                     CMISTypeDefinitionAtomEntryParser *parser = [[CMISTypeDefinitionAtomEntryParser alloc] initWithData:httpResponse.data];
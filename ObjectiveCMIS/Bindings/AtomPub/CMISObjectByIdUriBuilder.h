@@ -25,18 +25,22 @@ typedef enum
     LATEST_MAJOR
 } CMISReturnVersion;
 
+/**
+ * Builds object by id urls from the template of the repository, compiled once into a CMISURITemplate. Immutable, so one instance can be shared by concurrent requests.
+ */
 @interface CMISObjectByIdUriBuilder : NSObject
 
-@property (nonatomic, strong) NSString *objectId;
-@property (nonatomic, strong) NSString *filter;
-@property BOOL includeAllowableActions;
-@property BOOL includePolicyIds;
-@property CMISIncludeRelationship includeRelationships;
-@property BOOL includeACL;
-@property (nonatomic, strong) NSString *renditionFilter;
-@property CMISReturnVersion returnVersion;
+@property (nonatomic, strong, readonly) NSString *templateUrl;
 
 - (id)initWithTemplateUrl:(NSString *)templateUrl;
-- (NSURL *)buildUrl;
 
-@end
\ No newline at end of file
+- (NSURL *)urlForObjectId:(NSString *)objectId
+                   filter:(NSString *)filter
+  includeAllowableActions:(BOOL)includeAllowableActions
+         includePolicyIds:(BOOL)includePolicyIds
+     includeRelationships:(CMISIncludeRelationship)includeRelationships
+               includeACL:(BOOL)includeACL
+          renditionFilter:(NSString *)renditionFilter
+            returnVersion:(CMISReturnVersion)returnVersion;
+
+@end
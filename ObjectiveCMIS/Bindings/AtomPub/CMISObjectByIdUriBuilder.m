@@ -12,24 +12,20 @@
     limitations under the License.
  */
 #import "CMISObjectByIdUriBuilder.h"
+#import "CMISURITemplate.h"
+#import "CMISURLBuilder.h"
 
 @interface CMISObjectByIdUriBuilder ()
 
-@property (nonatomic, strong) NSString *templateUrl;
+@property (nonatomic, strong, readwrite) NSString *templateUrl;
+@property (nonatomic, strong) CMISURITemplate *uriTemplate;
 
 @end
 
 @implementation CMISObjectByIdUriBuilder
 
 @synthesize templateUrl = _templateUrl;
-@synthesize objectId = _objectId;
-@synthesize filter = _filter;
-@synthesize includeAllowableActions = _includeAllowableActions;
-@synthesize includePolicyIds = _includePolicyIds;
-@synthesize includeRelationships = _includeRelationships;
-@synthesize includeACL = _includeACL;
-@synthesize renditionFilter = _renditionFilter;
-@synthesize returnVersion = _returnVersion;
+@synthesize uriTemplate = _uriTemplate;
 
 - (id)initWithTemplateUrl:(NSString *)templateUrl
 {
@@ -37,37 +33,38 @@
     if (self)
     {
         self.templateUrl = templateUrl;
-
-        // Defaults
-        self.includeAllowableActions = YES;
-        self.includeRelationships = CMISIncludeRelationshipNone;
-        self.returnVersion = NOT_PROVIDED;
+        self.uriTemplate = [CMISURITemplate templateWithString:templateUrl];
     }
     return self;
 }
 
-- (NSURL *)buildUrl
+- (NSURL *)urlForObjectId:(NSString *)objectId
+                   filter:(NSString *)filter
+  includeAllowableActions:(BOOL)includeAllowableActions
+         includePolicyIds:(BOOL)includePolicyIds
+     includeRelationships:(CMISIncludeRelationship)includeRelationships
+               includeACL:(BOOL)includeACL
+          renditionFilter:(NSString *)renditionFilter
+            returnVersion:(CMISReturnVersion)returnVersion
 {
-    NSString *urlString = [self.templateUrl stringByReplacingOccurrencesOfString:@"{id}" withString:self.objectId];
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"{filter}" withString:(self.filter != nil ? self.filter : @"")];
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"{includeAllowableActions}" withString:(self.includeAllowableActions ? @"true" : @"false")];
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"{includePolicyIds}" withString:(self.includePolicyIds ? @"true" : @"false")];
-
-    NSString *includeRelationShipParam = [CMISEnums stringForIncludeRelationShip:self.includeRelationships];
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"{includeRelationships}" withString:includeRelationShipParam];
-
-
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"{includeACL}" withString:(self.includeACL ? @"true" : @"false")];
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"{renditionFilter}" withString:(self.renditionFilter != nil ? self.renditionFilter : @"")];
-
-    if (self.returnVersion != NOT_PROVIDED)
+    NSDictionary *values = [NSDictionary dictionaryWithObjectsAndKeys:
+                            objectId, @"id",
+                            (includeAllowableActions ? @"true" : @"false"), @"includeAllowableActions",
+                            (includePolicyIds ? @"true" : @"false"), @"includePolicyIds",
+                            [CMISEnums stringForIncludeRelationShip:includeRelationships], @"includeRelationships",
+                            (includeACL ? @"true" : @"false"), @"includeACL",
+                            (filter != nil ? filter : @""), @"filter",
+                            (renditionFilter != nil ? renditionFilter : @""), @"renditionFilter", nil];
+    NSString *urlString = [self.uriTemplate expandWithValues:values];
+
+    if (returnVersion != NOT_PROVIDED)
     {
         NSString *returnVersionParam = nil;
-        if (self.returnVersion == THIS)
+        if (returnVersion == THIS)
         {
             returnVersionParam = @"this";
         }
-        else if (self.returnVersion == LATEST)
+        else if (returnVersion == LATEST)
         {
             returnVersionParam = @"latest";
         }
@@ -76,10 +73,12 @@
             returnVersionParam = @"latestmajor";
         }
 
-        urlString = [NSString stringWithFormat:@"%@&returnVersion=%@", urlString, returnVersionParam];
+        CMISURLBuilder *urlBuilder = [[CMISURLBuilder alloc] initWithUrlString:urlString];
+        [urlBuilder addParameter:@"returnVersion" withValue:returnVersionParam];
+        return [urlBuilder url];
     }
 
-    return [NSURL URLWithString:[urlString stringByAddingPercentEscapesUsingEncoding:NSASCIIStringEncoding]];
+    return [NSURL URLWithString:urlString];
 }
 
-@end
\ No newline at end of file
+@end
@@ -16,17 +16,21 @@
 #import "CMISEnums.h"
 
 
+/**
+ * Builds object by path urls from the template of the repository, compiled once into a CMISURITemplate. Immutable, so one instance can be shared by concurrent requests.
+ */
 @interface CMISObjectByPathUriBuilder : NSObject
 
-@property (nonatomic, strong) NSString *path;
-@property (nonatomic, strong) NSString *filter;
-@property BOOL includeAllowableActions;
-@property BOOL includePolicyIds;
-@property CMISIncludeRelationship includeRelationships;
-@property BOOL includeACL;
-@property (nonatomic, strong) NSString *renditionFilter;
+@property (nonatomic, strong, readonly) NSString *templateUrl;
 
 - (id)initWithTemplateUrl:(NSString *)templateUrl;
-- (NSURL *)buildUrl;
 
-@end
\ No newline at end of file
+- (NSURL *)urlForPath:(NSString *)path
+               filter:(NSString *)filter
+includeAllowableActions:(BOOL)includeAllowableActions
+     includePolicyIds:(BOOL)includePolicyIds
+ includeRelationships:(CMISIncludeRelationship)includeRelationships
+           includeACL:(BOOL)includeACL
+      renditionFilter:(NSString *)renditionFilter;
+
+@end
@@ -13,10 +13,12 @@
  */
 
 #import "CMISObjectByPathUriBuilder.h"
+#import "CMISURITemplate.h"
 
 @interface CMISObjectByPathUriBuilder ()
 
-@property (nonatomic, strong) NSString *templateUrl;
+@property (nonatomic, strong, readwrite) NSString *templateUrl;
+@property (nonatomic, strong) CMISURITemplate *uriTemplate;
 
 @end
 
@@ -24,13 +26,7 @@
 @implementation CMISObjectByPathUriBuilder
 
 @synthesize templateUrl = _templateUrl;
-@synthesize path = _path;
-@synthesize filter = _filter;
-@synthesize includeAllowableActions = _includeAllowableActions;
-@synthesize includePolicyIds = _includePolicyIds;
-@synthesize includeRelationships = _includeRelationships;
-@synthesize includeACL = _includeACL;
-@synthesize renditionFilter = _renditionFilter;
+@synthesize uriTemplate = _uriTemplate;
 
 - (id)initWithTemplateUrl:(NSString *)templateUrl
 {
@@ -38,22 +34,29 @@
     if (self)
     {
         self.templateUrl = templateUrl;
+        self.uriTemplate = [CMISURITemplate templateWithString:templateUrl];
     }
     return self;
 }
 
-- (NSURL *)buildUrl
+- (NSURL *)urlForPath:(NSString *)path
+               filter:(NSString *)filter
+includeAllowableActions:(BOOL)includeAllowableActions
+     includePolicyIds:(BOOL)includePolicyIds
+ includeRelationships:(CMISIncludeRelationship)includeRelationships
+           includeACL:(BOOL)includeACL
+      renditionFilter:(NSString *)renditionFilter
 {
-    NSString *urlString = [self.templateUrl stringByReplacingOccurrencesOfString:@"{path}" withString:self.path];
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"{filter}" withString:(self.filter != nil ? self.filter : @"")];
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"{includeAllowableActions}" withString:(self.includeAllowableActions ? @"true" : @"false")];
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"{includePolicyIds}" withString:(self.includePolicyIds ? @"true" : @"false")];
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"{includeRelationships}" withString:[CMISEnums stringForIncludeRelationShip:self.includeRelationships]];
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"{includeACL}" withString:(self.includeACL ? @"true" : @"false")];
-    urlString = [urlString stringByReplacingOccurrencesOfString:@"{renditionFilter}" withString:(self.renditionFilter != nil ? self.renditionFilter : @"")];
-
-    return [NSURL URLWithString:[urlString stringByAddingPercentEscapesUsingEncoding:NSASCIIStringEncoding]];
+    NSDictionary *values = [NSDictionary dictionaryWithObjectsAndKeys:
+                            path, @"path",
+                            (includeAllowableActions ? @"true" : @"false"), @"includeAllowableActions",
+                            (includePolicyIds ? @"true" : @"false"), @"includePolicyIds",
+                            [CMISEnums stringForIncludeRelationShip:includeRelationships], @"includeRelationships",
+                            (includeACL ? @"true" : @"false"), @"includeACL",
+                            (filter != nil ? filter : @""), @"filter",
+                            (renditionFilter != nil ? renditionFilter : @""), @"renditionFilter", nil];
+    return [self.uriTemplate urlWithValues:values];
 }
 
 
-@end
\ No newline at end of file
+@end
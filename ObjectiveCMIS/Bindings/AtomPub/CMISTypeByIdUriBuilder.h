@@ -15,11 +15,15 @@
 #import <Foundation/Foundation.h>
 
 
+/**
+ * Builds type by id urls from the template of the repository, compiled once into a CMISURITemplate. Immutable, so one instance can be shared by concurrent requests.
+ */
 @interface CMISTypeByIdUriBuilder : NSObject
 
-@property (nonatomic, strong) NSString *id;
+@property (nonatomic, strong, readonly) NSString *templateUrl;
 
 - (id)initWithTemplateUrl:(NSString *)templateUrl;
-- (NSURL *)buildUrl;
 
-@end
\ No newline at end of file
+- (NSURL *)urlForTypeId:(NSString *)typeId;
+
+@end
@@ -13,32 +13,35 @@
  */
 
 #import "CMISTypeByIdUriBuilder.h"
+#import "CMISURITemplate.h"
 
 @interface CMISTypeByIdUriBuilder ()
 
-@property (nonatomic, strong) NSString *templateUrl;
+@property (nonatomic, strong, readwrite) NSString *templateUrl;
+@property (nonatomic, strong) CMISURITemplate *uriTemplate;
 
 @end
 
 
 @implementation CMISTypeByIdUriBuilder
 
-@synthesize id = _id;
 @synthesize templateUrl = _templateUrl;
+@synthesize uriTemplate = _uriTemplate;
 
 - (id)initWithTemplateUrl:(NSString *)templateUrl
 {
     self = [super init];
-       if (self)
-       {
-           self.templateUrl = templateUrl;
-       }
-       return self;
+    if (self)
+    {
+        self.templateUrl = templateUrl;
+        self.uriTemplate = [CMISURITemplate templateWithString:templateUrl];
+    }
+    return self;
 }
 
-- (NSURL *)buildUrl
+- (NSURL *)urlForTypeId:(NSString *)typeId
 {
-    return [NSURL URLWithString:[self.templateUrl stringByReplacingOccurrencesOfString:@"{id}" withString:self.id]];
+    return [self.uriTemplate urlWithValues:[NSDictionary dictionaryWithObject:typeId forKey:@"id"]];
 }
 
 
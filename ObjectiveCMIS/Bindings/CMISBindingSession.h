@@ -23,9 +23,18 @@ extern NSString * const kCMISBindingSessionKeyTypeByIdUriBuilder;
 extern NSString * const kCMISBindingSessionKeyQueryUri;
 
 extern NSString * const kCMISBindingSessionKeyQueryCollection;
+extern NSString * const kCMISBindingSessionKeyBulkUpdateCollection;
 
 extern NSString * const kCMISBindingSessionKeyLinkCache;
 
+extern NSString * const kCMISBindingSessionKeyRequestCompressionSupported;
+
+extern NSString * const kCMISBindingSessionKeyRetryPolicy;
+
+/**
+ * The configuration and shared state of a binding. Safe to use from several threads at once:
+ * reads run concurrently, writes are serialized and wait for the reads before them.
+ */
 @interface CMISBindingSession : NSObject
 
 @property (nonatomic, strong, readonly) NSString *username;
@@ -39,6 +48,9 @@ extern NSString * const kCMISBindingSessionKeyLinkCache;
 - (id)objectForKey:(id)key;
 - (id)objectForKey:(id)key withDefaultValue:(id)defaultValue;
 - (void)setObject:(id)object forKey:(id)key;
+
+// stores the object unless the key has a value already; returns the value stored for the key
+- (id)setObject:(id)object forKeyIfAbsent:(id)key;
 - (void)addEntriesFromDictionary:(NSDictionary *)dictionary;
 - (void)removeKey:(id)key;
 
@@ -21,14 +21,20 @@ NSString * const kCMISBindingSessionKeyTypeByIdUriBuilder = @"cmis_session_key_t
 NSString * const kCMISBindingSessionKeyQueryUri = @"cmis_session_key_query_uri";
 
 NSString * const kCMISBindingSessionKeyQueryCollection = @"cmis_session_key_query_collection";
+NSString * const kCMISBindingSessionKeyBulkUpdateCollection = @"cmis_session_key_bulk_update_collection";
 
 NSString * const kCMISBindingSessionKeyLinkCache = @"cmis_session_key_link_cache";
 
+NSString * const kCMISBindingSessionKeyRequestCompressionSupported = @"cmis_session_key_request_compression_supported";
+
+NSString * const kCMISBindingSessionKeyRetryPolicy = @"cmis_session_key_retry_policy";
+
 @interface CMISBindingSession ()
 @property (nonatomic, strong, readwrite) NSString *username;
 @property (nonatomic, strong, readwrite) NSString *repositoryId;
 @property (nonatomic, strong, readwrite) id<CMISAuthenticationProvider> authenticationProvider;
 @property (nonatomic, strong, readwrite) NSMutableDictionary *sessionData;
+@property (nonatomic, assign) dispatch_queue_t sessionDataQueue; // concurrent; writes are barriers
 @end
 
 @implementation CMISBindingSession
@@ -37,6 +43,7 @@ NSString * const kCMISBindingSessionKeyLinkCache = @"cmis_session_key_link_cache
 @synthesize repositoryId = _repositoryId;
 @synthesize authenticationProvider = _authenticationProvider;
 @synthesize sessionData = _sessionData;
+@synthesize sessionDataQueue = _sessionDataQueue;
 
 - (id)initWithSessionParameters:(CMISSessionParameters *)sessionParameters
 {
@@ -44,6 +51,7 @@ NSString * const kCMISBindingSessionKeyLinkCache = @"cmis_session_key_link_cache
     if (self)
     {
         self.sessionData = [[NSMutableDictionary alloc] init];
+        self.sessionDataQueue = dispatch_queue_create("org.apache.chemistry.opencmis.bindingsession", DISPATCH_QUEUE_CONCURRENT);
         
         // grab common data from session parameters
         self.username = sessionParameters.username;
@@ -62,35 +70,69 @@ NSString * const kCMISBindingSessionKeyLinkCache = @"cmis_session_key_link_cache
     return self;
 }
 
+- (void)dealloc
+{
+#if !OS_OBJECT_USE_OBJC
+    dispatch_release(_sessionDataQueue);
+#endif
+}
+
 - (NSArray *)allKeys
 {
-    return [self.sessionData allKeys];
+    __block NSArray *allKeys = nil;
+    dispatch_sync(self.sessionDataQueue, ^{
+        allKeys = [self.sessionData allKeys];
+    });
+    return allKeys;
 }
 
 - (id)objectForKey:(id)key
 {
-    return [self.sessionData objectForKey:key];
+    __block id object = nil;
+    dispatch_sync(self.sessionDataQueue, ^{
+        object = [self.sessionData objectForKey:key];
+    });
+    return object;
 }
 
 - (id)objectForKey:(id)key withDefaultValue:(id)defaultValue
 {
-    NSObject *value = [self.sessionData objectForKey:key];
+    id value = [self objectForKey:key];
     return value != nil ? value : defaultValue;
 }
 
 - (void)setObject:(id)object forKey:(id)key
 {
-    [self.sessionData setObject:object forKey:key];
+    dispatch_barrier_async(self.sessionDataQueue, ^{
+        [self.sessionData setObject:object forKey:key];
+    });
+}
+
+- (id)setObject:(id)object forKeyIfAbsent:(id)key
+{
+    __block id storedObject = nil;
+    dispatch_barrier_sync(self.sessionDataQueue, ^{
+        storedObject = [self.sessionData objectForKey:key];
+        if (storedObject == nil) {
+            [self.sessionData setObject:object forKey:key];
+            storedObject = object;
+        }
+    });
+    return storedObject;
 }
 
 - (void)addEntriesFromDictionary:(NSDictionary *)dictionary
 {
-    [self.sessionData addEntriesFromDictionary:dictionary];
+    dispatch_barrier_async(self.sessionDataQueue, ^{
+        [self.sessionData addEntriesFromDictionary:dictionary];
+    });
 }
 
 - (void)removeKey:(id)key
 {
-    [self.sessionData removeObjectForKey:key];
+    dispatch_barrier_async(self.sessionDataQueue, ^{
+        [self.sessionData removeObjectForKey:key];
+    });
 }
 
 @end
@@ -16,6 +16,7 @@
 #import "CMISEnums.h"
 
 @class CMISObjectList;
+@class CMISPageLinks;
 
 @protocol CMISDiscoveryService <NSObject>
 
@@ -34,4 +35,17 @@
                                             skipCount:(NSNumber *)skipCount
                                       completionBlock:(void (^)(CMISObjectList *objectList, NSError *error))completionBlock;
 
+/**
+ * Executes a query for a listing that keeps the next links of its pages in pageLinks: the page following
+ * a fetched one is read from the link of that page rather than by posting the query again with a skip count.
+ */
+- (void)query:(NSString *)statement searchAllVersions:(BOOL)searchAllVersions
+                                 includeRelationShips:(CMISIncludeRelationship)includeRelationships
+                                      renditionFilter:(NSString *)renditionFilter
+                              includeAllowableActions:(BOOL)includeAllowableActions
+                                             maxItems:(NSNumber *)maxItems
+                                            skipCount:(NSNumber *)skipCount
+                                            pageLinks:(CMISPageLinks *)pageLinks
+                                      completionBlock:(void (^)(CMISObjectList *objectList, NSError *error))completionBlock;
+
 @end
@@ -17,6 +17,7 @@
 
 @class CMISFolder;
 @class CMISObjectList;
+@class CMISPageLinks;
 
 @protocol CMISNavigationService <NSObject>
 
@@ -30,6 +31,18 @@
                 maxItems:(NSNumber *)maxItems
          completionBlock:(void (^)(CMISObjectList *objectList, NSError *error))completionBlock;
 
+/*
+ * Retrieves a page of the children of a listing that keeps the next links of its pages in pageLinks,
+ * following the link of the previous page rather than having the server skip to the offset.
+ */
+- (void)retrieveChildren:(NSString *)objectId orderBy:(NSString *)orderBy
+                  filter:(NSString *)filter includeRelationShips:(CMISIncludeRelationship)includeRelationship
+         renditionFilter:(NSString *)renditionFilter includeAllowableActions:(BOOL)includeAllowableActions
+      includePathSegment:(BOOL)includePathSegment skipCount:(NSNumber *)skipCount
+                maxItems:(NSNumber *)maxItems
+               pageLinks:(CMISPageLinks *)pageLinks
+         completionBlock:(void (^)(CMISObjectList *objectList, NSError *error))completionBlock;
+
 /**
 * Retrieves the parent of a given object.
 * Returns a list of CMISObjectData objects
@@ -44,5 +57,31 @@
   withIncludeRelativePathSegment:(BOOL)includeRelativePathSegment
                  completionBlock:(void (^)(NSArray *parents, NSError *error))completionBlock;
 
+/**
+ * Retrieves the descendants of a folder, down to the given depth (-1 for all levels), in one request.
+ * Returns an array of CMISObjectInFolderContainer objects, one per child, each holding its own children.
+ */
+- (void)retrieveDescendants:(NSString *)folderId
+                      depth:(NSInteger)depth
+                     filter:(NSString *)filter
+       includeRelationShips:(CMISIncludeRelationship)includeRelationship
+            renditionFilter:(NSString *)renditionFilter
+    includeAllowableActions:(BOOL)includeAllowableActions
+         includePathSegment:(BOOL)includePathSegment
+            completionBlock:(void (^)(NSArray *descendants, NSError *error))completionBlock;
+
+/**
+ * Retrieves the folders below a folder, down to the given depth (-1 for all levels), in one request.
+ * Returns an array of CMISObjectInFolderContainer objects, as retrieveDescendants does.
+ */
+- (void)retrieveFolderTree:(NSString *)folderId
+                     depth:(NSInteger)depth
+                    filter:(NSString *)filter
+      includeRelationShips:(CMISIncludeRelationship)includeRelationship
+           renditionFilter:(NSString *)renditionFilter
+   includeAllowableActions:(BOOL)includeAllowableActions
+        includePathSegment:(BOOL)includePathSegment
+           completionBlock:(void (^)(NSArray *folderTree, NSError *error))completionBlock;
+
 
 @end
@@ -0,0 +1,39 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * The identifier and change token of an object, as they are after an update of it.
+ * The identifier differs from the one of the updated object when the update created a new version.
+ */
+@interface CMISObjectIdAndChangeToken : NSObject
+
+@property (nonatomic, strong, readonly) NSString *objectId;
+@property (nonatomic, strong, readonly) NSString *changeToken;
+
+/// The identifier the object had before the update, or nil if the repository did not report it apart from the new one.
+@property (nonatomic, strong, readonly) NSString *previousObjectId;
+
+/// The version series of the object, or nil if the repository did not report it.
+@property (nonatomic, strong, readonly) NSString *versionSeriesId;
+
+- (id)initWithObjectId:(NSString *)objectId changeToken:(NSString *)changeToken;
+
+- (id)initWithObjectId:(NSString *)objectId
+      previousObjectId:(NSString *)previousObjectId
+       versionSeriesId:(NSString *)versionSeriesId
+           changeToken:(NSString *)changeToken;
+
+@end
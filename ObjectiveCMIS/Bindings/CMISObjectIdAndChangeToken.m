@@ -0,0 +1,52 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import "CMISObjectIdAndChangeToken.h"
+
+@interface CMISObjectIdAndChangeToken ()
+@property (nonatomic, strong, readwrite) NSString *objectId;
+@property (nonatomic, strong, readwrite) NSString *changeToken;
+@property (nonatomic, strong, readwrite) NSString *previousObjectId;
+@property (nonatomic, strong, readwrite) NSString *versionSeriesId;
+@end
+
+@implementation CMISObjectIdAndChangeToken
+
+@synthesize objectId = _objectId;
+@synthesize changeToken = _changeToken;
+@synthesize previousObjectId = _previousObjectId;
+@synthesize versionSeriesId = _versionSeriesId;
+
+- (id)initWithObjectId:(NSString *)objectId changeToken:(NSString *)changeToken
+{
+    return [self initWithObjectId:objectId previousObjectId:nil versionSeriesId:nil changeToken:changeToken];
+}
+
+- (id)initWithObjectId:(NSString *)objectId
+      previousObjectId:(NSString *)previousObjectId
+       versionSeriesId:(NSString *)versionSeriesId
+           changeToken:(NSString *)changeToken
+{
+    self = [super init];
+    if (self)
+    {
+        self.objectId = objectId;
+        self.previousObjectId = previousObjectId;
+        self.versionSeriesId = versionSeriesId;
+        self.changeToken = changeToken;
+    }
+    return self;
+}
+
+@end
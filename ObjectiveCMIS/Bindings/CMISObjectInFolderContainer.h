@@ -0,0 +1,31 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+#import <Foundation/Foundation.h>
+
+@class CMISObjectData;
+
+/**
+ * An object of a folder tree or descendants listing, with the objects below it.
+ */
+@interface CMISObjectInFolderContainer : NSObject
+
+@property (nonatomic, strong) CMISObjectData *objectData;
+
+/**
+ * Array of CMISObjectInFolderContainer, for the children of the object. Empty if the object has no children,
+ * or if they are below the depth that was asked for.
+ */
+@property (nonatomic, strong) NSArray *children;
+
+@end
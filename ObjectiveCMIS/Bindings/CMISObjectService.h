@@ -18,21 +18,22 @@
 @class CMISDocument;
 @class CMISStringInOutParameter;
 @class CMISRequest;
+@protocol CMISDownloadSink;
 
 @protocol CMISObjectService <NSObject>
 
 /**
  *Retrieves the object with the given object identifier.
- *
+ *The returned request can be cancelled, or given a deadline.
  */
-- (void)retrieveObject:(NSString *)objectId
-            withFilter:(NSString *)filter
-andIncludeRelationShips:(CMISIncludeRelationship)includeRelationship
-   andIncludePolicyIds:(BOOL)includePolicyIds
-    andRenditionFilder:(NSString *)renditionFilter
-         andIncludeACL:(BOOL)includeACL
-andIncludeAllowableActions:(BOOL)includeAllowableActions
-       completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock;
+- (CMISRequest*)retrieveObject:(NSString *)objectId
+                    withFilter:(NSString *)filter
+       andIncludeRelationShips:(CMISIncludeRelationship)includeRelationship
+           andIncludePolicyIds:(BOOL)includePolicyIds
+            andRenditionFilder:(NSString *)renditionFilter
+                 andIncludeACL:(BOOL)includeACL
+    andIncludeAllowableActions:(BOOL)includeAllowableActions
+               completionBlock:(void (^)(CMISObjectData *objectData, NSError *error))completionBlock;
 
 /**
  *Retrieves an object using its path.
@@ -51,6 +52,8 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
 * Gets the content stream for the specified Document object, or gets a rendition stream for a specified
 * rendition of a document or folder object. Downloads the content to a local file.
 *
+* A sidecar record (<filePath>.cmisresume) is kept while downloading: if an earlier download
+* to the same file was interrupted, it is continued where it stopped, unless the document has changed.
 */
 - (CMISRequest*)downloadContentOfObject:(NSString *)objectId
                            withStreamId:(NSString *)streamId
@@ -58,6 +61,35 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
                         completionBlock:(void (^)(NSError *error))completionBlock
                           progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
 
+/**
+* Gets the content stream for the specified Document object, or gets a rendition stream for a specified
+* rendition of a document or folder object. Downloads the content to a local file.
+*
+* Large content is fetched as segmentCount byte ranges over concurrent connections, each written at its own offset
+* of the (preallocated) file. If the server does not accept Range requests, or the content is too small to be split,
+* this falls back to the regular, resumable single stream download.
+*/
+- (CMISRequest*)downloadContentOfObject:(NSString *)objectId
+                           withStreamId:(NSString *)streamId
+                                 toFile:(NSString *)filePath
+                           segmentCount:(NSUInteger)segmentCount
+                        completionBlock:(void (^)(NSError *error))completionBlock
+                          progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
+
+/**
+* Gets the content stream for the specified Document object, or gets a rendition stream for a specified
+* rendition of a document or folder object. Downloads the content to a local file.
+*
+* The file is written on a background queue in large blocks, and progress (bytes written to the file)
+* is reported at most once per progressInterval. Unlike the other file download, this one is not resumable.
+*/
+- (CMISRequest*)downloadContentOfObject:(NSString *)objectId
+                           withStreamId:(NSString *)streamId
+                                 toFile:(NSString *)filePath
+                       progressInterval:(NSTimeInterval)progressInterval
+                        completionBlock:(void (^)(NSError *error))completionBlock
+                          progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
+
 /**
  * Gets the content stream for the specified Document object, or gets a rendition stream for a specified
  * rendition of a document or folder object. Downloads the content to an output stream.
@@ -69,6 +101,29 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
                         completionBlock:(void (^)(NSError *error))completionBlock
                           progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
 
+/**
+ * Gets the content stream for the specified Document object, or gets a rendition stream for a specified
+ * rendition of a document or folder object. Downloads the content into a sink, which may hold the download back
+ * while it is full. The sink is closed when the download ends, with the error if there is one.
+ */
+- (CMISRequest*)downloadContentOfObject:(NSString *)objectId
+                           withStreamId:(NSString *)streamId
+                                 toSink:(id<CMISDownloadSink>)sink
+                        completionBlock:(void (^)(NSError *error))completionBlock
+                          progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
+
+/**
+ * Gets length bytes of the content stream (or of the given rendition stream), starting at offset, with an HTTP Range request.
+ * The returned data is shorter than requested if the range extends past the end of the content.
+ * Fails with kCMISErrorCodeNotSupported if the server does not accept range requests; whether it does is asked
+ * once per server, with a request for the first byte of the content.
+ */
+- (void)downloadContentOfObject:(NSString *)objectId
+                   withStreamId:(NSString *)streamId
+                     fromOffset:(unsigned long long)offset
+                         length:(unsigned long long)length
+                completionBlock:(void (^)(NSData *data, NSError *error))completionBlock;
+
 /**
  * Deletes the content stream for the specified document object.
   *
@@ -169,11 +224,23 @@ andIncludeAllowableActions:(BOOL)includeAllowableActions
 
 /**
  * Updates the properties of the given object.
+ * The returned request covers the link lookup as well as the update, it can be cancelled or given a deadline.
+ */
+- (CMISRequest*)updatePropertiesForObject:(CMISStringInOutParameter *)objectIdParam
+                           withProperties:(CMISProperties *)properties
+                          withChangeToken:(CMISStringInOutParameter *)changeTokenParam
+                          completionBlock:(void (^)(NSError *error))completionBlock;
+
+/**
+ * Updates the given objects with the same properties, in one CMIS 1.1 bulk update.
+ * objectIdsAndChangeTokens holds the CMISObjectIdAndChangeToken objects of the objects to update. The completion block
+ * is given those of the objects that were updated; objects missing from them were not. If an update created a new version,
+ * the identifier given is the one of the new version, and previousObjectId is the updated one if the repository reported it.
+ * Fails with a kCMISErrorCodeNotSupported error if the repository does not support bulk updates.
  */
-- (void)updatePropertiesForObject:(CMISStringInOutParameter *)objectIdParam
-                   withProperties:(CMISProperties *)properties
-                  withChangeToken:(CMISStringInOutParameter *)changeTokenParam
-                  completionBlock:(void (^)(NSError *error))completionBlock;
+- (CMISRequest*)bulkUpdateProperties:(CMISProperties *)properties
+          forObjectIdsAndChangeTokens:(NSArray *)objectIdsAndChangeTokens
+                      completionBlock:(void (^)(NSArray *updatedObjectIdsAndChangeTokens, NSError *error))completionBlock;
 
 /**
  * Gets the list of associated Renditions for the specified object.
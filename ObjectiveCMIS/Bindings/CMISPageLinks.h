@@ -0,0 +1,32 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * The next links of the pages of one listing, by the skip count and page size of the request each one continues.
+ * The next link is often a server side cursor: following it costs the same for deep pages as for the first one.
+ * A listing (the fetch block of a paged result) owns its page links, so a link is only ever followed by the
+ * listing whose page returned it, never by another one that happens to ask for the same page.
+ */
+@interface CMISPageLinks : NSObject
+
+- (NSString *)linkForPageAtSkipCount:(NSInteger)skipCount maxItems:(NSInteger)maxItems;
+
+- (void)addLink:(NSString *)link forPageAtSkipCount:(NSInteger)skipCount maxItems:(NSInteger)maxItems;
+
+// for a link the server no longer accepts, such as an expired cursor
+- (void)removeLinkForPageAtSkipCount:(NSInteger)skipCount maxItems:(NSInteger)maxItems;
+
+@end
@@ -0,0 +1,62 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import "CMISPageLinks.h"
+
+@interface CMISPageLinks ()
+
+@property (nonatomic, strong) NSMutableDictionary *links;
+
+@end
+
+@implementation CMISPageLinks
+
+@synthesize links = _links;
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        self.links = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (NSString *)keyForPageAtSkipCount:(NSInteger)skipCount maxItems:(NSInteger)maxItems
+{
+    return [NSString stringWithFormat:@"%ld|%ld", (long)skipCount, (long)maxItems];
+}
+
+- (NSString *)linkForPageAtSkipCount:(NSInteger)skipCount maxItems:(NSInteger)maxItems
+{
+    @synchronized(self) {
+        return [self.links objectForKey:[self keyForPageAtSkipCount:skipCount maxItems:maxItems]];
+    }
+}
+
+- (void)addLink:(NSString *)link forPageAtSkipCount:(NSInteger)skipCount maxItems:(NSInteger)maxItems
+{
+    @synchronized(self) {
+        [self.links setObject:link forKey:[self keyForPageAtSkipCount:skipCount maxItems:maxItems]];
+    }
+}
+
+- (void)removeLinkForPageAtSkipCount:(NSInteger)skipCount maxItems:(NSInteger)maxItems
+{
+    @synchronized(self) {
+        [self.links removeObjectForKey:[self keyForPageAtSkipCount:skipCount maxItems:maxItems]];
+    }
+}
+
+@end
@@ -0,0 +1,66 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+// Operation classes, each with its own page size and concurrency limit
+extern NSString * const kCMISOperationClassChildren;
+extern NSString * const kCMISOperationClassQuery;
+
+/**
+ * Tunes page sizes and the number of requests in flight per operation class at runtime, so that each repository
+ * converges to its best throughput without manual tuning.
+ *
+ * The controller works AIMD-style (additive increase, multiplicative decrease): while the latency per item stays
+ * within latencyTolerance times the best seen, the page size grows by pageSizeIncrement and the concurrency limit
+ * by one per window of successful requests. When the latency rises beyond that or the server fails (e.g. with 503),
+ * both are halved.
+ *
+ * Enabled with kCMISSessionParameterAdaptiveConcurrency, the session then owns one controller. Thread-safe.
+ */
+@interface CMISAdaptiveController : NSObject
+
+@property (nonatomic, assign) NSInteger minimumPageSize;   // defaults to 10
+@property (nonatomic, assign) NSInteger maximumPageSize;   // defaults to 1000
+@property (nonatomic, assign) NSInteger pageSizeIncrement; // defaults to 20
+@property (nonatomic, assign) NSUInteger maximumConcurrency; // defaults to 8
+@property (nonatomic, assign) double latencyTolerance;     // defaults to 2.0
+
+// the page size to use next, never more than the requested page size; the first request of a class starts with it
+- (NSInteger)pageSizeForOperationClass:(NSString *)operationClass requestedPageSize:(NSInteger)requestedPageSize;
+
+- (NSUInteger)concurrencyLimitForOperationClass:(NSString *)operationClass;
+
+/**
+ * Runs the block once a slot of the operation class is free. If it has to wait, it runs later on the operation queue
+ * it was called from, or on a private serial queue of the controller if it was not called from an operation queue.
+ * The block is passed the page size to request and must call the completion block once the request is done,
+ * with the number of items it returned.
+ */
+- (void)performOperationOfClass:(NSString *)operationClass
+              requestedPageSize:(NSInteger)requestedPageSize
+                     usingBlock:(void (^)(NSInteger pageSize, void (^completionBlock)(NSUInteger itemCount, NSError *error)))block;
+
+/**
+ * Like the instance method, but simply runs the block with the requested page size if there is no controller.
+ */
++ (void)performOperationOfClass:(NSString *)operationClass
+                 withController:(CMISAdaptiveController *)controller
+              requestedPageSize:(NSInteger)requestedPageSize
+                     usingBlock:(void (^)(NSInteger pageSize, void (^completionBlock)(NSUInteger itemCount, NSError *error)))block;
+
+// items per second, smoothed over the recent requests of the class
+- (double)throughputForOperationClass:(NSString *)operationClass;
+
+@end
@@ -0,0 +1,278 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import "CMISAdaptiveController.h"
+#import "CMISErrors.h"
+
+NSString * const kCMISOperationClassChildren = @"children";
+NSString * const kCMISOperationClassQuery = @"query";
+
+#define DEFAULT_MINIMUM_PAGE_SIZE 10
+#define DEFAULT_MAXIMUM_PAGE_SIZE 1000
+#define DEFAULT_PAGE_SIZE_INCREMENT 20
+#define DEFAULT_MAXIMUM_CONCURRENCY 8
+#define DEFAULT_LATENCY_TOLERANCE 2.0
+
+// weight of a new sample in the smoothed latency and throughput
+#define SMOOTHING_FACTOR 0.2
+
+// the best latency seen slowly loses its weight, so the controller adapts when the repository gets slower for good
+#define BEST_LATENCY_DRIFT 1.01
+
+/**
+ * The state of one operation class.
+ */
+@interface CMISAdaptiveOperationState : NSObject
+
+@property (nonatomic, assign) NSInteger pageSize;
+@property (nonatomic, assign) NSInteger requestedPageSize; // of the latest request; the page size never grows beyond it
+@property (nonatomic, assign) NSUInteger concurrencyLimit;
+@property (nonatomic, assign) NSUInteger operationsInFlight;
+@property (nonatomic, assign) NSUInteger successesSinceIncrease;
+@property (nonatomic, strong) NSMutableArray *waitingOperations; // blocks waiting for a free slot
+@property (nonatomic, assign) double bestItemLatency;
+@property (nonatomic, assign) double smoothedItemLatency;
+@property (nonatomic, assign) double throughput;
+@property (nonatomic, strong) NSDate *lastDecrease;
+
+@end
+
+@implementation CMISAdaptiveOperationState
+
+@synthesize pageSize = _pageSize;
+@synthesize requestedPageSize = _requestedPageSize;
+@synthesize concurrencyLimit = _concurrencyLimit;
+@synthesize operationsInFlight = _operationsInFlight;
+@synthesize successesSinceIncrease = _successesSinceIncrease;
+@synthesize waitingOperations = _waitingOperations;
+@synthesize bestItemLatency = _bestItemLatency;
+@synthesize smoothedItemLatency = _smoothedItemLatency;
+@synthesize throughput = _throughput;
+@synthesize lastDecrease = _lastDecrease;
+
+@end
+
+
+@interface CMISAdaptiveController ()
+
+@property (nonatomic, strong) NSMutableDictionary *operationStates;
+@property (nonatomic, assign) dispatch_queue_t resumeQueue; // runs waiting operations started outside of an operation queue
+
+@end
+
+@implementation CMISAdaptiveController
+
+@synthesize minimumPageSize = _minimumPageSize;
+@synthesize maximumPageSize = _maximumPageSize;
+@synthesize pageSizeIncrement = _pageSizeIncrement;
+@synthesize maximumConcurrency = _maximumConcurrency;
+@synthesize latencyTolerance = _latencyTolerance;
+@synthesize operationStates = _operationStates;
+@synthesize resumeQueue = _resumeQueue;
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        _minimumPageSize = DEFAULT_MINIMUM_PAGE_SIZE;
+        _maximumPageSize = DEFAULT_MAXIMUM_PAGE_SIZE;
+        _pageSizeIncrement = DEFAULT_PAGE_SIZE_INCREMENT;
+        _maximumConcurrency = DEFAULT_MAXIMUM_CONCURRENCY;
+        _latencyTolerance = DEFAULT_LATENCY_TOLERANCE;
+        _operationStates = [NSMutableDictionary dictionary];
+        _resumeQueue = dispatch_queue_create("org.apache.chemistry.objectivecmis.adaptivecontroller", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+#if !OS_OBJECT_USE_OBJC
+    dispatch_release(_resumeQueue);
+#endif
+}
+
+- (NSInteger)pageSizeForOperationClass:(NSString *)operationClass requestedPageSize:(NSInteger)requestedPageSize
+{
+    @synchronized(self) {
+        CMISAdaptiveOperationState *state = [self stateForOperationClass:operationClass];
+        if (state.pageSize == 0) {
+            state.pageSize = MIN(MAX(requestedPageSize, self.minimumPageSize), self.maximumPageSize);
+        }
+        
+        // the caller's maxItemsPerPage is an upper bound, the controller only decides how far below it to stay
+        if (requestedPageSize > 0) {
+            state.requestedPageSize = requestedPageSize;
+            return MIN(state.pageSize, requestedPageSize);
+        }
+        return state.pageSize;
+    }
+}
+
+- (NSUInteger)concurrencyLimitForOperationClass:(NSString *)operationClass
+{
+    @synchronized(self) {
+        return [self stateForOperationClass:operationClass].concurrencyLimit;
+    }
+}
+
+- (double)throughputForOperationClass:(NSString *)operationClass
+{
+    @synchronized(self) {
+        return [self stateForOperationClass:operationClass].throughput;
+    }
+}
+
++ (void)performOperationOfClass:(NSString *)operationClass
+                 withController:(CMISAdaptiveController *)controller
+              requestedPageSize:(NSInteger)requestedPageSize
+                     usingBlock:(void (^)(NSInteger pageSize, void (^completionBlock)(NSUInteger itemCount, NSError *error)))block
+{
+    if (controller) {
+        [controller performOperationOfClass:operationClass requestedPageSize:requestedPageSize usingBlock:block];
+    } else {
+        block(requestedPageSize, ^(NSUInteger itemCount, NSError *error) {});
+    }
+}
+
+- (void)performOperationOfClass:(NSString *)operationClass
+              requestedPageSize:(NSInteger)requestedPageSize
+                     usingBlock:(void (^)(NSInteger pageSize, void (^completionBlock)(NSUInteger itemCount, NSError *error)))block
+{
+    // callback queue threads have no run loop of their own, and other callers' run loops may not be running
+    NSOperationQueue *queue = [NSOperationQueue currentQueue];
+    dispatch_queue_t resumeQueue = self.resumeQueue;
+    void (^operation)(void) = ^{
+        NSInteger pageSize = [self pageSizeForOperationClass:operationClass requestedPageSize:requestedPageSize];
+        NSDate *startDate = [NSDate date];
+        block(pageSize, ^(NSUInteger itemCount, NSError *error) {
+            [self operationOfClass:operationClass didCompleteWithItemCount:itemCount latency:-[startDate timeIntervalSinceNow] error:error];
+        });
+    };
+    
+    BOOL mayStart = NO;
+    @synchronized(self) {
+        CMISAdaptiveOperationState *state = [self stateForOperationClass:operationClass];
+        if (state.operationsInFlight < state.concurrencyLimit) {
+            state.operationsInFlight++;
+            mayStart = YES;
+        } else {
+            // once another one completes, the operation continues on the operation queue it was started from, if any
+            [state.waitingOperations addObject:[^{
+                if (queue) {
+                    [queue addOperationWithBlock:operation];
+                } else {
+                    dispatch_async(resumeQueue, operation);
+                }
+            } copy]];
+        }
+    }
+    
+    if (mayStart) {
+        operation();
+    }
+}
+
+#pragma mark Helpers
+
+- (CMISAdaptiveOperationState *)stateForOperationClass:(NSString *)operationClass
+{
+    CMISAdaptiveOperationState *state = [self.operationStates objectForKey:operationClass];
+    if (state == nil) {
+        state = [[CMISAdaptiveOperationState alloc] init];
+        state.concurrencyLimit = 1;
+        state.waitingOperations = [NSMutableArray array];
+        [self.operationStates setObject:state forKey:operationClass];
+    }
+    return state;
+}
+
+- (void)operationOfClass:(NSString *)operationClass didCompleteWithItemCount:(NSUInteger)itemCount latency:(NSTimeInterval)latency error:(NSError *)error
+{
+    NSMutableArray *operationsToStart = [NSMutableArray array];
+    @synchronized(self) {
+        CMISAdaptiveOperationState *state = [self stateForOperationClass:operationClass];
+        state.operationsInFlight--;
+        
+        if (error) {
+            // connection problems and server errors such as 503 are taken as a sign of overload
+            if ([error.domain isEqualToString:kCMISErrorDomainName]
+                && (error.code == kCMISErrorCodeConnection || error.code == kCMISErrorCodeRuntime)) {
+                [self decreaseState:state latency:latency];
+            }
+        } else {
+            double itemLatency = latency / MAX(itemCount, 1);
+            if (state.bestItemLatency == 0 || itemLatency < state.bestItemLatency) {
+                state.bestItemLatency = itemLatency;
+            } else {
+                state.bestItemLatency *= BEST_LATENCY_DRIFT;
+            }
+            
+            if (state.smoothedItemLatency == 0) {
+                state.smoothedItemLatency = itemLatency;
+                state.throughput = itemCount / MAX(latency, 0.001);
+            } else {
+                state.smoothedItemLatency += SMOOTHING_FACTOR * (itemLatency - state.smoothedItemLatency);
+                state.throughput += SMOOTHING_FACTOR * (itemCount / MAX(latency, 0.001) - state.throughput);
+            }
+            
+            if (state.smoothedItemLatency > self.latencyTolerance * state.bestItemLatency) {
+                [self decreaseState:state latency:latency];
+            } else {
+                [self increaseState:state];
+            }
+        }
+        
+        while (state.waitingOperations.count > 0 && state.operationsInFlight < state.concurrencyLimit) {
+            state.operationsInFlight++;
+            [operationsToStart addObject:[state.waitingOperations objectAtIndex:0]];
+            [state.waitingOperations removeObjectAtIndex:0];
+        }
+    }
+    
+    for (void (^operation)(void) in operationsToStart) {
+        operation();
+    }
+}
+
+// additive increase: a page size step per success, one more request in flight per window of successes
+- (void)increaseState:(CMISAdaptiveOperationState *)state
+{
+    NSInteger pageSizeLimit = self.maximumPageSize;
+    if (state.requestedPageSize > 0) {
+        pageSizeLimit = MIN(pageSizeLimit, MAX(state.requestedPageSize, self.minimumPageSize));
+    }
+    state.pageSize = MIN(state.pageSize + self.pageSizeIncrement, pageSizeLimit);
+    state.successesSinceIncrease++;
+    if (state.successesSinceIncrease >= state.concurrencyLimit) {
+        state.concurrencyLimit = MIN(state.concurrencyLimit + 1, self.maximumConcurrency);
+        state.successesSinceIncrease = 0;
+    }
+}
+
+// multiplicative decrease, at most once per round trip so that the requests already in flight do not halve it again
+- (void)decreaseState:(CMISAdaptiveOperationState *)state latency:(NSTimeInterval)latency
+{
+    if (state.lastDecrease && -[state.lastDecrease timeIntervalSinceNow] < latency) {
+        return;
+    }
+    state.lastDecrease = [NSDate date];
+    state.pageSize = MAX(state.pageSize / 2, self.minimumPageSize);
+    state.concurrencyLimit = MAX(state.concurrencyLimit / 2, 1);
+    state.successesSinceIncrease = 0;
+    state.smoothedItemLatency = state.bestItemLatency; // judge the new settings on their own samples
+    log(@"Backing off: page size %ld, %lu requests in flight", (long)state.pageSize, (unsigned long)state.concurrencyLimit);
+}
+
+@end
@@ -0,0 +1,79 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class CMISDocument;
+
+/**
+ * Gives random access to the content stream of a document without downloading all of it.
+ *
+ * Content is fetched in blocks with HTTP Range requests and kept in a small LRU cache.
+ * When reads are sequential, the blocks following the last read are fetched ahead of time.
+ * Reads fail with kCMISErrorCodeNotSupported if the server does not accept range requests; use one of the
+ * download methods of CMISDocument to read such content from start to end.
+ *
+ * A reader is not thread-safe: its cache is used without locking, so all calls must come from the thread
+ * (or serial queue) its completion blocks are delivered on.
+ */
+@interface CMISContentReader : NSObject
+
+@property (nonatomic, strong, readonly) CMISDocument *document;
+
+// total length of the content stream
+@property (nonatomic, assign, readonly) unsigned long long length;
+
+// position of the next readDataOfLength: call
+@property (nonatomic, assign) unsigned long long offset;
+
+// size of the blocks requested from the server; defaults to 64 kb. Changing it clears the cache,
+// it is ignored while blocks are being fetched
+@property (nonatomic, assign) NSUInteger blockSize;
+
+// number of blocks that are kept in memory; defaults to 32
+@property (nonatomic, assign) NSUInteger cacheCapacity;
+
+// number of blocks fetched ahead of a sequential read; defaults to 4, 0 disables read-ahead
+@property (nonatomic, assign) NSUInteger readAheadBlockCount;
+
+- (id)initWithDocument:(CMISDocument *)document;
+
+/**
+ * Reads the bytes in the given range. The data is shorter than the range if it extends past the end of the content.
+ */
+- (void)readRange:(NSRange)range completionBlock:(void (^)(NSData *data, NSError *error))completionBlock;
+
+/**
+ * Reads length bytes starting at offset.
+ */
+- (void)readDataAtOffset:(unsigned long long)offset
+                  length:(unsigned long long)length
+         completionBlock:(void (^)(NSData *data, NSError *error))completionBlock;
+
+/**
+ * Reads length bytes at the current offset and moves the offset past them.
+ */
+- (void)readDataOfLength:(unsigned long long)length completionBlock:(void (^)(NSData *data, NSError *error))completionBlock;
+
+/**
+ * Moves the offset; a negative offset is taken relative to the end of the content (e.g. -22 for a zip end of central directory).
+ */
+- (void)seekToOffset:(long long)offset;
+
+/**
+ * Drops all cached blocks.
+ */
+- (void)clearCache;
+
+@end
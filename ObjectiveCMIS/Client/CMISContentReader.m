@@ -0,0 +1,286 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import "CMISContentReader.h"
+#import "CMISDocument.h"
+#import "CMISSession+Internal.h"
+#import "CMISBinding.h"
+#import "CMISObjectService.h"
+#import "CMISErrors.h"
+
+#define DEFAULT_BLOCK_SIZE 65536
+#define DEFAULT_CACHE_CAPACITY 32
+#define DEFAULT_READ_AHEAD_BLOCK_COUNT 4
+
+@interface CMISContentReader ()
+
+@property (nonatomic, strong, readwrite) CMISDocument *document;
+@property (nonatomic, assign, readwrite) unsigned long long length;
+
+// block index -> NSData
+@property (nonatomic, strong) NSMutableDictionary *cachedBlocks;
+// block indexes of the cached blocks, least recently used first
+@property (nonatomic, strong) NSMutableArray *cachedBlockOrder;
+// block index -> array of blocks waiting for a block that is being fetched
+@property (nonatomic, strong) NSMutableDictionary *pendingBlocks;
+// block indexes with a range request in flight
+@property (nonatomic, strong) NSMutableSet *fetchingBlocks;
+// where a read has to start to be considered sequential
+@property (nonatomic, assign) unsigned long long sequentialOffset;
+
+@end
+
+
+@implementation CMISContentReader
+
+@synthesize document = _document;
+@synthesize length = _length;
+@synthesize offset = _offset;
+@synthesize blockSize = _blockSize;
+@synthesize cacheCapacity = _cacheCapacity;
+@synthesize readAheadBlockCount = _readAheadBlockCount;
+@synthesize cachedBlocks = _cachedBlocks;
+@synthesize cachedBlockOrder = _cachedBlockOrder;
+@synthesize pendingBlocks = _pendingBlocks;
+@synthesize fetchingBlocks = _fetchingBlocks;
+@synthesize sequentialOffset = _sequentialOffset;
+
+- (id)initWithDocument:(CMISDocument *)document
+{
+    self = [super init];
+    if (self) {
+        self.document = document;
+        self.length = document.contentStreamLength;
+        _blockSize = DEFAULT_BLOCK_SIZE;
+        self.cacheCapacity = DEFAULT_CACHE_CAPACITY;
+        self.readAheadBlockCount = DEFAULT_READ_AHEAD_BLOCK_COUNT;
+        self.cachedBlocks = [NSMutableDictionary dictionary];
+        self.cachedBlockOrder = [NSMutableArray array];
+        self.pendingBlocks = [NSMutableDictionary dictionary];
+        self.fetchingBlocks = [NSMutableSet set];
+    }
+    return self;
+}
+
+- (void)setBlockSize:(NSUInteger)blockSize
+{
+    if (self.fetchingBlocks.count > 0) {
+        log(@"Block size cannot be changed while blocks are being fetched");
+        return;
+    }
+    if (blockSize != _blockSize && blockSize > 0) {
+        _blockSize = blockSize;
+        [self clearCache];
+    }
+}
+
+- (void)clearCache
+{
+    [self.cachedBlocks removeAllObjects];
+    [self.cachedBlockOrder removeAllObjects];
+}
+
+- (void)seekToOffset:(long long)offset
+{
+    if (offset < 0) {
+        offset = MAX(0, (long long)self.length + offset);
+    }
+    self.offset = MIN((unsigned long long)offset, self.length);
+}
+
+- (void)readRange:(NSRange)range completionBlock:(void (^)(NSData *data, NSError *error))completionBlock
+{
+    [self readDataAtOffset:range.location length:range.length completionBlock:completionBlock];
+}
+
+- (void)readDataOfLength:(unsigned long long)length completionBlock:(void (^)(NSData *data, NSError *error))completionBlock
+{
+    unsigned long long offset = self.offset;
+    self.offset = MIN(offset + length, self.length);
+    [self readDataAtOffset:offset length:length completionBlock:completionBlock];
+}
+
+- (void)readDataAtOffset:(unsigned long long)offset
+                  length:(unsigned long long)length
+         completionBlock:(void (^)(NSData *data, NSError *error))completionBlock
+{
+    if (offset >= self.length || length == 0) {
+        completionBlock([NSData data], nil);
+        return;
+    }
+    length = MIN(length, self.length - offset);
+    
+    unsigned long long firstBlock = offset / self.blockSize;
+    unsigned long long lastBlock = (offset + length - 1) / self.blockSize;
+    
+    // the blocks are collected here, so they cannot be evicted from the cache before the data is assembled
+    NSMutableDictionary *blocks = [NSMutableDictionary dictionary];
+    __block NSUInteger remainingBlockCount = (NSUInteger)(lastBlock - firstBlock + 1);
+    __block BOOL failed = NO;
+    NSUInteger blockSize = self.blockSize;
+    
+    void (^blockAvailable)(NSNumber *, NSData *, NSError *) = ^(NSNumber *blockIndex, NSData *blockData, NSError *error) {
+        if (failed) {
+            return;
+        }
+        if (error) {
+            failed = YES;
+            completionBlock(nil, error);
+            return;
+        }
+        
+        [blocks setObject:blockData forKey:blockIndex];
+        remainingBlockCount--;
+        if (remainingBlockCount == 0) {
+            NSMutableData *data = [NSMutableData dataWithCapacity:(NSUInteger)length];
+            for (unsigned long long block = firstBlock; block <= lastBlock; block++) {
+                NSData *currentBlockData = [blocks objectForKey:[NSNumber numberWithUnsignedLongLong:block]];
+                unsigned long long blockStart = block * blockSize;
+                unsigned long long start = MAX(offset, blockStart) - blockStart;
+                unsigned long long end = MIN(offset + length, blockStart + currentBlockData.length) - blockStart;
+                if (end > start) {
+                    [data appendBytes:(const char *)currentBlockData.bytes + start length:(NSUInteger)(end - start)];
+                }
+            }
+            completionBlock(data, nil);
+        }
+    };
+    
+    for (unsigned long long block = firstBlock; block <= lastBlock; block++) {
+        NSNumber *blockIndex = [NSNumber numberWithUnsignedLongLong:block];
+        NSData *blockData = [self cachedBlock:blockIndex];
+        if (blockData) {
+            blockAvailable(blockIndex, blockData, nil);
+        } else {
+            [self waitForBlock:blockIndex completionBlock:^(NSData *blockData, NSError *error) {
+                blockAvailable(blockIndex, blockData, error);
+            }];
+        }
+    }
+    [self fetchMissingBlocksFrom:firstBlock to:lastBlock];
+    
+    // sequential access: fetch the next blocks while the caller is busy with this data
+    if (offset == self.sequentialOffset && self.readAheadBlockCount > 0) {
+        unsigned long long blockCount = (self.length + self.blockSize - 1) / self.blockSize;
+        if (lastBlock + 1 < blockCount) {
+            [self fetchMissingBlocksFrom:lastBlock + 1 to:MIN(lastBlock + self.readAheadBlockCount, blockCount - 1)];
+        }
+    }
+    self.sequentialOffset = offset + length;
+}
+
+#pragma mark Helper methods
+
+- (NSData *)cachedBlock:(NSNumber *)blockIndex
+{
+    NSData *blockData = [self.cachedBlocks objectForKey:blockIndex];
+    if (blockData) {
+        [self.cachedBlockOrder removeObject:blockIndex];
+        [self.cachedBlockOrder addObject:blockIndex];
+    }
+    return blockData;
+}
+
+- (void)cacheBlock:(NSData *)blockData forIndex:(NSNumber *)blockIndex
+{
+    if (self.cacheCapacity == 0) {
+        return;
+    }
+    if ([self.cachedBlocks objectForKey:blockIndex] == nil) {
+        while (self.cachedBlockOrder.count >= self.cacheCapacity) {
+            [self.cachedBlocks removeObjectForKey:[self.cachedBlockOrder objectAtIndex:0]];
+            [self.cachedBlockOrder removeObjectAtIndex:0];
+        }
+    } else {
+        [self.cachedBlockOrder removeObject:blockIndex];
+    }
+    [self.cachedBlocks setObject:blockData forKey:blockIndex];
+    [self.cachedBlockOrder addObject:blockIndex];
+}
+
+- (void)waitForBlock:(NSNumber *)blockIndex completionBlock:(void (^)(NSData *blockData, NSError *error))completionBlock
+{
+    NSMutableArray *waitingBlocks = [self.pendingBlocks objectForKey:blockIndex];
+    if (waitingBlocks == nil) {
+        waitingBlocks = [NSMutableArray array];
+        [self.pendingBlocks setObject:waitingBlocks forKey:blockIndex];
+    }
+    [waitingBlocks addObject:[completionBlock copy]];
+}
+
+/**
+ * Requests every run of consecutive blocks in the given interval that is neither cached nor being fetched with a single range request.
+ */
+- (void)fetchMissingBlocksFrom:(unsigned long long)firstBlock to:(unsigned long long)lastBlock
+{
+    unsigned long long runStart = 0;
+    BOOL inRun = NO;
+    for (unsigned long long block = firstBlock; block <= lastBlock + 1; block++) {
+        NSNumber *blockIndex = [NSNumber numberWithUnsignedLongLong:block];
+        BOOL missing = (block <= lastBlock
+                        && [self.cachedBlocks objectForKey:blockIndex] == nil
+                        && ![self.fetchingBlocks containsObject:blockIndex]);
+        if (missing && !inRun) {
+            runStart = block;
+            inRun = YES;
+        } else if (!missing && inRun) {
+            [self fetchBlocksFrom:runStart to:block - 1];
+            inRun = NO;
+        }
+    }
+}
+
+- (void)fetchBlocksFrom:(unsigned long long)firstBlock to:(unsigned long long)lastBlock
+{
+    for (unsigned long long block = firstBlock; block <= lastBlock; block++) {
+        [self.fetchingBlocks addObject:[NSNumber numberWithUnsignedLongLong:block]];
+    }
+    
+    unsigned long long offset = firstBlock * self.blockSize;
+    unsigned long long length = MIN((lastBlock - firstBlock + 1) * self.blockSize, self.length - offset);
+    NSUInteger blockSize = self.blockSize;
+
+    // the cache is only touched on the callback queue of the session, where the reads are answered
+    [self.document.binding.objectService downloadContentOfObject:self.document.identifier
+                                                    withStreamId:nil
+                                                      fromOffset:offset
+                                                          length:length
+                                                 completionBlock:[self.document.session callbackBlock:^(NSData *data, NSError *error) {
+        if (error == nil && data.length < length) {
+            error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeConnection
+                                withDetailedDescription:[NSString stringWithFormat:@"Received %lu of %llu bytes at offset %llu",
+                                                         (unsigned long)data.length, length, offset]];
+        }
+        
+        for (unsigned long long block = firstBlock; block <= lastBlock; block++) {
+            NSNumber *blockIndex = [NSNumber numberWithUnsignedLongLong:block];
+            [self.fetchingBlocks removeObject:blockIndex];
+            
+            NSData *blockData = nil;
+            if (error == nil) {
+                NSUInteger start = (NSUInteger)((block - firstBlock) * blockSize);
+                blockData = [data subdataWithRange:NSMakeRange(start, MIN(blockSize, data.length - start))];
+                [self cacheBlock:blockData forIndex:blockIndex];
+            }
+            
+            NSArray *waitingBlocks = [self.pendingBlocks objectForKey:blockIndex];
+            [self.pendingBlocks removeObjectForKey:blockIndex];
+            for (void (^waitingBlock)(NSData *, NSError *) in waitingBlocks) {
+                waitingBlock(blockData, error);
+            }
+        }
+    }]];
+}
+
+@end
@@ -0,0 +1,67 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class CMISSession;
+@class CMISFolder;
+@class CMISObject;
+@class CMISOperationContext;
+
+// keys of a crawler checkpoint: arrays of object ids
+extern NSString * const kCMISCrawlerCheckpointPendingFolderIds;
+extern NSString * const kCMISCrawlerCheckpointSeenObjectIds;
+
+/**
+ * Walks all objects below a folder, listing up to maximumConcurrentListings folders at once.
+ *
+ * Every listing has its own deque of folders found while it ran: it continues depth first with the last one it
+ * found, while a listing with nothing left takes the oldest folder of the fullest deque. Objects filed in several
+ * folders are delivered once. The crawl can be cancelled, and resumed later from a checkpoint.
+ */
+@interface CMISCrawler : NSObject
+
+@property (nonatomic, strong, readonly) CMISSession *session;
+
+// number of folders listed at the same time. Defaults to 4
+@property (nonatomic, assign) NSUInteger maximumConcurrentListings;
+
+// used for listing the folders, and retrieving the folders of a checkpoint. Defaults to the default operation context
+@property (nonatomic, strong) CMISOperationContext *operationContext;
+
+// objects for which it returns NO are not delivered, and folders not crawled. May be called concurrently
+@property (nonatomic, copy) BOOL (^filterBlock)(CMISObject *object);
+
+// called for every object found, one call at a time, on the callback queue of the session if it has one,
+// otherwise on the thread of the listing that found it
+@property (nonatomic, copy) void (^objectBlock)(CMISObject *object);
+
+- (id)initWithSession:(CMISSession *)session;
+
+/** Crawls the objects below the folder; the completion block is called once all of them were delivered */
+- (void)crawlFolder:(CMISFolder *)folder completionBlock:(void (^)(NSError *error))completionBlock;
+
+/** Continues the crawl a checkpoint was taken of, delivering only objects that were not delivered before it */
+- (void)resumeFromCheckpoint:(NSDictionary *)checkpoint completionBlock:(void (^)(NSError *error))completionBlock;
+
+/**
+ * The folders still to list, including the ones being listed, and the objects delivered so far, as a property list.
+ * Can be taken at any time, e.g. after cancelling or a failure, and stored to resume the crawl later.
+ */
+- (NSDictionary *)checkpoint;
+
+/** Stops the crawl: no folders are listed any more, and the completion block is called with a cancelled error */
+- (void)cancel;
+
+@end
@@ -0,0 +1,317 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import "CMISCrawler.h"
+#import "CMISSession+Internal.h"
+#import "CMISFolder.h"
+#import "CMISPagedResult.h"
+#import "CMISOperationContext.h"
+#import "CMISErrors.h"
+
+NSString * const kCMISCrawlerCheckpointPendingFolderIds = @"pendingFolderIds";
+NSString * const kCMISCrawlerCheckpointSeenObjectIds = @"seenObjectIds";
+
+#define DEFAULT_MAXIMUM_CONCURRENT_LISTINGS 4
+
+@interface CMISCrawler ()
+
+@property (nonatomic, strong, readwrite) CMISSession *session;
+@property (nonatomic, copy) void (^completionBlock)(NSError *error);
+
+// per listing slot: the folders it found and did not list yet (CMISFolder objects, or folder ids from a checkpoint)
+@property (nonatomic, strong) NSMutableArray *deques;
+// per listing slot: the id of the folder being listed, or NSNull
+@property (nonatomic, strong) NSMutableArray *listedFolderIds;
+@property (nonatomic, strong) NSMutableSet *seenObjectIds;
+@property (nonatomic, assign) BOOL finished;
+// serializes the calls of the object block
+@property (nonatomic, strong) NSObject *deliveryLock;
+
+@end
+
+@implementation CMISCrawler
+
+@synthesize session = _session;
+@synthesize maximumConcurrentListings = _maximumConcurrentListings;
+@synthesize operationContext = _operationContext;
+@synthesize filterBlock = _filterBlock;
+@synthesize objectBlock = _objectBlock;
+@synthesize completionBlock = _completionBlock;
+@synthesize deques = _deques;
+@synthesize listedFolderIds = _listedFolderIds;
+@synthesize seenObjectIds = _seenObjectIds;
+@synthesize finished = _finished;
+@synthesize deliveryLock = _deliveryLock;
+
+- (id)initWithSession:(CMISSession *)session
+{
+    self = [super init];
+    if (self) {
+        self.session = session;
+        self.maximumConcurrentListings = DEFAULT_MAXIMUM_CONCURRENT_LISTINGS;
+        self.operationContext = [CMISOperationContext defaultOperationContext];
+        self.seenObjectIds = [NSMutableSet set];
+        self.deliveryLock = [[NSObject alloc] init];
+    }
+    return self;
+}
+
+- (void)crawlFolder:(CMISFolder *)folder completionBlock:(void (^)(NSError *error))completionBlock
+{
+    completionBlock = [self.session errorCallbackBlock:completionBlock];
+    @synchronized(self) {
+        [self.seenObjectIds addObject:folder.identifier];
+    }
+    [self startWithPendingFolders:[NSArray arrayWithObject:folder] completionBlock:completionBlock];
+}
+
+- (void)resumeFromCheckpoint:(NSDictionary *)checkpoint completionBlock:(void (^)(NSError *error))completionBlock
+{
+    completionBlock = [self.session errorCallbackBlock:completionBlock];
+    @synchronized(self) {
+        [self.seenObjectIds addObjectsFromArray:[checkpoint objectForKey:kCMISCrawlerCheckpointSeenObjectIds]];
+    }
+    
+    // folders being listed when the checkpoint was taken are listed again, their objects delivered then are skipped
+    NSArray *pendingFolderIds = [checkpoint objectForKey:kCMISCrawlerCheckpointPendingFolderIds];
+    [self startWithPendingFolders:(pendingFolderIds != nil ? pendingFolderIds : [NSArray array]) completionBlock:completionBlock];
+}
+
+- (void)startWithPendingFolders:(NSArray *)pendingFolders completionBlock:(void (^)(NSError *error))completionBlock
+{
+    @synchronized(self) {
+        self.completionBlock = completionBlock;
+        self.finished = NO;
+        
+        NSUInteger slotCount = MAX(self.maximumConcurrentListings, (NSUInteger)1);
+        self.deques = [NSMutableArray arrayWithCapacity:slotCount];
+        self.listedFolderIds = [NSMutableArray arrayWithCapacity:slotCount];
+        for (NSUInteger slot = 0; slot < slotCount; slot++) {
+            [self.deques addObject:[NSMutableArray array]];
+            [self.listedFolderIds addObject:[NSNull null]];
+        }
+        
+        // spread the folders of a checkpoint over the slots, so all of them start right away
+        [pendingFolders enumerateObjectsUsingBlock:^(id pendingFolder, NSUInteger index, BOOL *stop) {
+            [[self.deques objectAtIndex:(index % slotCount)] addObject:pendingFolder];
+        }];
+    }
+    
+    [self listPendingFolders];
+}
+
+- (NSDictionary *)checkpoint
+{
+    NSMutableArray *pendingFolderIds = [NSMutableArray array];
+    NSArray *seenObjectIds = nil;
+    @synchronized(self) {
+        for (id listedFolderId in self.listedFolderIds) {
+            if (listedFolderId != [NSNull null]) {
+                [pendingFolderIds addObject:listedFolderId];
+            }
+        }
+        for (NSArray *deque in self.deques) {
+            for (id pendingFolder in deque) {
+                [pendingFolderIds addObject:[CMISCrawler folderIdOfPendingFolder:pendingFolder]];
+            }
+        }
+        seenObjectIds = [self.seenObjectIds allObjects];
+    }
+    return [NSDictionary dictionaryWithObjectsAndKeys:pendingFolderIds, kCMISCrawlerCheckpointPendingFolderIds,
+            seenObjectIds, kCMISCrawlerCheckpointSeenObjectIds, nil];
+}
+
+- (void)cancel
+{
+    [self finishWithError:[CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled withDetailedDescription:@"Crawl was cancelled"]];
+}
+
+#pragma mark -
+#pragma mark Scheduling
+
++ (NSString *)folderIdOfPendingFolder:(id)pendingFolder
+{
+    return [pendingFolder isKindOfClass:[CMISFolder class]] ? [(CMISFolder *)pendingFolder identifier] : pendingFolder;
+}
+
+// must be called while synchronized; the folder a free slot lists next, nil if there is none
+- (id)takePendingFolderForSlot:(NSUInteger)slot
+{
+    // depth first from the slot's own deque, the folders found last are the ones the server most likely still has cached
+    NSMutableArray *deque = [self.deques objectAtIndex:slot];
+    if (deque.count > 0) {
+        id pendingFolder = [deque lastObject];
+        [deque removeLastObject];
+        return pendingFolder;
+    }
+    
+    // steal the oldest folder, the root of the largest unexplored subtree, from the fullest deque
+    NSMutableArray *fullestDeque = nil;
+    for (NSMutableArray *otherDeque in self.deques) {
+        if (otherDeque.count > fullestDeque.count) {
+            fullestDeque = otherDeque;
+        }
+    }
+    if (fullestDeque == nil) {
+        return nil;
+    }
+    id pendingFolder = [fullestDeque objectAtIndex:0];
+    [fullestDeque removeObjectAtIndex:0];
+    return pendingFolder;
+}
+
+- (void)listPendingFolders
+{
+    NSMutableArray *slotsToStart = [NSMutableArray array];
+    NSMutableArray *foldersToList = [NSMutableArray array];
+    BOOL complete = NO;
+    @synchronized(self) {
+        if (self.finished) {
+            return;
+        }
+        
+        BOOL listing = NO;
+        for (NSUInteger slot = 0; slot < self.listedFolderIds.count; slot++) {
+            if ([self.listedFolderIds objectAtIndex:slot] == [NSNull null]) {
+                id pendingFolder = [self takePendingFolderForSlot:slot];
+                if (pendingFolder == nil) {
+                    continue;
+                }
+                [self.listedFolderIds replaceObjectAtIndex:slot withObject:[CMISCrawler folderIdOfPendingFolder:pendingFolder]];
+                [slotsToStart addObject:[NSNumber numberWithUnsignedInteger:slot]];
+                [foldersToList addObject:pendingFolder];
+            }
+            listing = YES;
+        }
+        
+        // done when nothing is being listed, as nothing is left to list then
+        complete = !listing;
+    }
+    
+    if (complete) {
+        [self finishWithError:nil];
+        return;
+    }
+    
+    for (NSUInteger index = 0; index < slotsToStart.count; index++) {
+        [self listPendingFolder:[foldersToList objectAtIndex:index] inSlot:[[slotsToStart objectAtIndex:index] unsignedIntegerValue]];
+    }
+}
+
+- (void)finishWithError:(NSError *)error
+{
+    void (^completionBlock)(NSError *error) = nil;
+    @synchronized(self) {
+        if (self.finished) {
+            return;
+        }
+        self.finished = YES;
+        completionBlock = self.completionBlock;
+        self.completionBlock = nil;
+    }
+    
+    if (completionBlock) {
+        completionBlock(error);
+    }
+}
+
+#pragma mark -
+#pragma mark Listing
+
+- (void)listPendingFolder:(id)pendingFolder inSlot:(NSUInteger)slot
+{
+    if ([pendingFolder isKindOfClass:[CMISFolder class]]) {
+        [self listFolder:pendingFolder inSlot:slot];
+        return;
+    }
+    
+    // a folder of a checkpoint
+    [self.session retrieveObject:pendingFolder withOperationContext:self.operationContext completionBlock:^(CMISObject *object, NSError *error) {
+        if (error) {
+            [self finishWithError:error];
+        } else if (![object isKindOfClass:[CMISFolder class]]) {
+            [self finishWithError:[CMISErrors createCMISErrorWithCode:kCMISErrorCodeInvalidArgument
+                                              withDetailedDescription:[NSString stringWithFormat:@"Checkpoint folder %@ is not a folder", pendingFolder]]];
+        } else {
+            [self listFolder:(CMISFolder *)object inSlot:slot];
+        }
+    }];
+}
+
+- (void)listFolder:(CMISFolder *)folder inSlot:(NSUInteger)slot
+{
+    [folder retrieveChildrenWithOperationContext:self.operationContext completionBlock:^(CMISPagedResult *result, NSError *error) {
+        if (error) {
+            [self finishWithError:error];
+            return;
+        }
+        
+        [result enumerateItemsUsingBlock:^(CMISObject *object, BOOL *stop) {
+            *stop = ![self handleObject:object foundInSlot:slot];
+        } completionBlock:^(NSError *error) {
+            BOOL finished = NO;
+            @synchronized(self) {
+                finished = self.finished;
+                if (!finished) {
+                    [self.listedFolderIds replaceObjectAtIndex:slot withObject:[NSNull null]];
+                }
+            }
+            if (finished) {
+                return; // cancelled or failed meanwhile, this folder stays in the checkpoint
+            }
+            
+            if (error) {
+                [self finishWithError:error];
+            } else {
+                [self listPendingFolders];
+            }
+        }];
+    }];
+}
+
+// NO once the crawl is finished
+- (BOOL)handleObject:(CMISObject *)object foundInSlot:(NSUInteger)slot
+{
+    @synchronized(self) {
+        if (self.finished) {
+            return NO;
+        }
+        if ([self.seenObjectIds containsObject:object.identifier]) {
+            return YES; // multi-filed, found in another folder already
+        }
+        [self.seenObjectIds addObject:object.identifier];
+    }
+    
+    if (self.filterBlock && !self.filterBlock(object)) {
+        return YES;
+    }
+    
+    if (self.objectBlock) {
+        @synchronized(self.deliveryLock) {
+            self.objectBlock(object);
+        }
+    }
+    
+    if ([object isKindOfClass:[CMISFolder class]]) {
+        @synchronized(self) {
+            [[self.deques objectAtIndex:slot] addObject:object];
+        }
+        
+        // a free slot can take it right away
+        [self listPendingFolders];
+    }
+    return YES;
+}
+
+@end
@@ -21,7 +21,7 @@
 #import "CMISFileUtil.h"
 #import "CMISErrors.h"
 #import "CMISRequest.h"
-#import "CMISSession.h"
+#import "CMISSession+Internal.h"
 
 @interface CMISDocument()
 
@@ -76,6 +76,7 @@
 
 - (void)retrieveAllVersionsWithOperationContext:(CMISOperationContext *)operationContext completionBlock:(void (^)(CMISCollection *collection, NSError *error))completionBlock
 {
+    completionBlock = [self.session callbackBlock:completionBlock];
     [self.binding.versioningService retrieveAllVersions:self.identifier
            filter:operationContext.filterString includeAllowableActions:operationContext.isIncludeAllowableActions completionBlock:^(NSArray *objects, NSError *error) {
                if (error) {
@@ -91,6 +92,7 @@
                              completionBlock:(void (^)(NSError *error))completionBlock
                                progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock
 {
+    completionBlock = [self.session errorCallbackBlock:completionBlock];
     return [self.binding.objectService changeContentOfObject:[CMISStringInOutParameter inOutParameterUsingInParameter:self.identifier]
                                              toContentOfFile:filePath
                                        withOverwriteExisting:overwrite
@@ -106,6 +108,7 @@
                                     completionBlock:(void (^)(NSError *error))completionBlock
                                       progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock
 {
+    completionBlock = [self.session errorCallbackBlock:completionBlock];
     return [self.binding.objectService changeContentOfObject:[CMISStringInOutParameter inOutParameterUsingInParameter:self.identifier]
                                       toContentOfInputStream:inputStream
                                                bytesExpected:bytesExpected
@@ -118,6 +121,7 @@
 
 - (void)deleteContentWithCompletionBlock:(void (^)(NSError *error))completionBlock
 {
+    completionBlock = [self.session errorCallbackBlock:completionBlock];
     [self.binding.objectService deleteContentOfObject:[CMISStringInOutParameter inOutParameterUsingInParameter:self.identifier]
                                       withChangeToken:[CMISStringInOutParameter inOutParameterUsingInParameter:self.changeToken]
                                       completionBlock:completionBlock];
@@ -132,6 +136,7 @@
                                  withOperationContext:(CMISOperationContext *)operationContext
                                       completionBlock:(void (^)(CMISDocument *document, NSError *error))completionBlock
 {
+    completionBlock = [self.session callbackBlock:completionBlock];
     [self.binding.versioningService retrieveObjectOfLatestVersion:self.identifier
                                                             major:major filter:operationContext.filterString
                                              includeRelationShips:operationContext.includeRelationShips
@@ -152,16 +157,17 @@
                       completionBlock:(void (^)(NSError *error))completionBlock
                         progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
 {
-    NSOutputStream *outputStream = [NSOutputStream outputStreamToFileAtPath:filePath append:NO];
+    completionBlock = [self.session errorCallbackBlock:completionBlock];
     return [self.binding.objectService downloadContentOfObject:self.identifier
                                                   withStreamId:nil
-                                                toOutputStream:outputStream
+                                                        toFile:filePath
                                                completionBlock:completionBlock
                                                  progressBlock:progressBlock];
 }
 
 - (void)deleteAllVersionsWithCompletionBlock:(void (^)(BOOL documentDeleted, NSError *error))completionBlock
 {
+    completionBlock = [self.session boolCallbackBlock:completionBlock];
     [self.binding.objectService deleteObject:self.identifier allVersions:YES completionBlock:completionBlock];
 }
 
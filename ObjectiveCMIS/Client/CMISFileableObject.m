@@ -15,7 +15,7 @@
 #import "CMISFileableObject.h"
 #import "CMISObjectConverter.h"
 #import "CMISOperationContext.h"
-#import "CMISSession.h"
+#import "CMISSession+Internal.h"
 
 @implementation CMISFileableObject
 
@@ -28,6 +28,7 @@
 - (void)retrieveParentsWithOperationContext:(CMISOperationContext *)operationContext
                             completionBlock:(void (^)(NSArray *parentFolders, NSError *error))completionBlock
 {
+    completionBlock = [self.session callbackBlock:completionBlock];
     [self.binding.navigationService retrieveParentsForObject:self.identifier
                                                   withFilter:operationContext.filterString
                                     withIncludeRelationships:operationContext.includeRelationShips
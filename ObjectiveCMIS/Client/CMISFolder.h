@@ -48,6 +48,24 @@
  */
 - (void)retrieveChildrenWithOperationContext:(CMISOperationContext *)operationContext completionBlock:(void (^)(CMISPagedResult *result, NSError *error))completionBlock;
 
+/**
+ * Retrieves all objects below this folder, down to the given depth (-1 for all levels), in a single request.
+ *
+ * The returned array contains a CMISTree for each child of this folder.
+ */
+- (void)retrieveDescendantsWithDepth:(NSInteger)depth
+                    operationContext:(CMISOperationContext *)operationContext
+                     completionBlock:(void (^)(NSArray *descendants, NSError *error))completionBlock;
+
+/**
+ * Retrieves the folders below this folder, down to the given depth (-1 for all levels), in a single request.
+ *
+ * The returned array contains a CMISTree for each child folder of this folder.
+ */
+- (void)retrieveFolderTreeWithDepth:(NSInteger)depth
+                   operationContext:(CMISOperationContext *)operationContext
+                    completionBlock:(void (^)(NSArray *folderTree, NSError *error))completionBlock;
+
 - (void)createFolder:(NSDictionary *)properties completionBlock:(void (^)(NSString *objectId, NSError *error))completionBlock;
 
 - (void)createDocumentFromFilePath:(NSString *)filePath
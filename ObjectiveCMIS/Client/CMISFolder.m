@@ -19,7 +19,11 @@
 #import "CMISPagedResult.h"
 #import "CMISOperationContext.h"
 #import "CMISObjectList.h"
-#import "CMISSession.h"
+#import "CMISSession+Internal.h"
+#import "CMISAdaptiveController.h"
+#import "CMISObjectInFolderContainer.h"
+#import "CMISTree.h"
+#import "CMISPageLinks.h"
 
 @interface CMISFolder ()
 
@@ -54,6 +58,7 @@
 
 - (void)retrieveFolderParentWithCompletionBlock:(void (^)(CMISFolder *folder, NSError *error))completionBlock
 {
+    completionBlock = [self.session callbackBlock:completionBlock];
     if ([self isRootFolder])
     {
         completionBlock(nil, nil);
@@ -70,30 +75,42 @@
 
 - (void)retrieveChildrenWithOperationContext:(CMISOperationContext *)operationContext completionBlock:(void (^)(CMISPagedResult *result, NSError *error))completionBlock
 {
+    completionBlock = [self.session callbackBlock:completionBlock];
+    // the next links of the pages of this listing, followed by its later pages only
+    CMISPageLinks *pageLinks = [[CMISPageLinks alloc] init];
     CMISFetchNextPageBlock fetchNextPageBlock = ^(int skipCount, int maxItems, CMISFetchNextPageBlockCompletionBlock pageBlockCompletionBlock)
     {
-        // Fetch results through navigationService
-        [self.binding.navigationService retrieveChildren:self.identifier
-                                                 orderBy:operationContext.orderBy
-                                                  filter:operationContext.filterString
-                                    includeRelationShips:operationContext.includeRelationShips
-                                         renditionFilter:operationContext.renditionFilterString
-                                 includeAllowableActions:operationContext.isIncludeAllowableActions
-                                      includePathSegment:operationContext.isIncludePathSegments
-                                               skipCount:[NSNumber numberWithInt:skipCount]
-                                                maxItems:[NSNumber numberWithInt:maxItems]
-                                         completionBlock:^(CMISObjectList *objectList, NSError *error) {
-                                             if (error) {
-                                                 pageBlockCompletionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeConnection]);
-                                             } else {
-                                                 CMISFetchNextPageBlockResult *result = [[CMISFetchNextPageBlockResult alloc] init];
-                                                 result.hasMoreItems = objectList.hasMoreItems;
-                                                 result.numItems = objectList.numItems;
-                                             
-                                                 result.resultArray = [self.session.objectConverter convertObjects:objectList.objects].items;
-                                                 pageBlockCompletionBlock(result, nil);
-                                             }
-                                         }];
+        // pages are handed to the paged result on the callback queue, once converted
+        pageBlockCompletionBlock = [self.session callbackBlock:pageBlockCompletionBlock];
+        [CMISAdaptiveController performOperationOfClass:kCMISOperationClassChildren
+                                         withController:self.session.adaptiveController
+                                      requestedPageSize:maxItems
+                                             usingBlock:^(NSInteger pageSize, void (^operationCompletionBlock)(NSUInteger itemCount, NSError *error)) {
+            // Fetch results through navigationService
+            [self.binding.navigationService retrieveChildren:self.identifier
+                                                     orderBy:operationContext.orderBy
+                                                      filter:operationContext.filterString
+                                        includeRelationShips:operationContext.includeRelationShips
+                                             renditionFilter:operationContext.renditionFilterString
+                                     includeAllowableActions:operationContext.isIncludeAllowableActions
+                                          includePathSegment:operationContext.isIncludePathSegments
+                                                   skipCount:[NSNumber numberWithInt:skipCount]
+                                                    maxItems:[NSNumber numberWithInteger:pageSize]
+                                                   pageLinks:pageLinks
+                                             completionBlock:^(CMISObjectList *objectList, NSError *error) {
+                                                 operationCompletionBlock(objectList.objects.count, error);
+                                                 if (error) {
+                                                     pageBlockCompletionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeConnection]);
+                                                 } else {
+                                                     CMISFetchNextPageBlockResult *result = [[CMISFetchNextPageBlockResult alloc] init];
+                                                     result.hasMoreItems = objectList.hasMoreItems;
+                                                     result.numItems = objectList.numItems;
+                                                 
+                                                     result.resultArray = [self.session.objectConverter convertObjects:objectList.objects].items;
+                                                     pageBlockCompletionBlock(result, nil);
+                                                 }
+                                             }];
+        }];
     };
 
     [CMISPagedResult pagedResultUsingFetchBlock:fetchNextPageBlock
@@ -108,8 +125,61 @@
                           }];
 }
 
+- (void)retrieveDescendantsWithDepth:(NSInteger)depth
+                    operationContext:(CMISOperationContext *)operationContext
+                     completionBlock:(void (^)(NSArray *descendants, NSError *error))completionBlock
+{
+    completionBlock = [self.session callbackBlock:completionBlock];
+    [self.binding.navigationService retrieveDescendants:self.identifier
+                                                  depth:depth
+                                                 filter:operationContext.filterString
+                                   includeRelationShips:operationContext.includeRelationShips
+                                        renditionFilter:operationContext.renditionFilterString
+                                includeAllowableActions:operationContext.isIncludeAllowableActions
+                                     includePathSegment:operationContext.isIncludePathSegments
+                                        completionBlock:^(NSArray *containers, NSError *error) {
+                                            if (error) {
+                                                completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeRuntime]);
+                                            } else {
+                                                completionBlock([self treesForContainers:containers], nil);
+                                            }
+                                        }];
+}
+
+- (void)retrieveFolderTreeWithDepth:(NSInteger)depth
+                   operationContext:(CMISOperationContext *)operationContext
+                    completionBlock:(void (^)(NSArray *folderTree, NSError *error))completionBlock
+{
+    completionBlock = [self.session callbackBlock:completionBlock];
+    [self.binding.navigationService retrieveFolderTree:self.identifier
+                                                 depth:depth
+                                                filter:operationContext.filterString
+                                  includeRelationShips:operationContext.includeRelationShips
+                                       renditionFilter:operationContext.renditionFilterString
+                               includeAllowableActions:operationContext.isIncludeAllowableActions
+                                    includePathSegment:operationContext.isIncludePathSegments
+                                       completionBlock:^(NSArray *containers, NSError *error) {
+                                           if (error) {
+                                               completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeRuntime]);
+                                           } else {
+                                               completionBlock([self treesForContainers:containers], nil);
+                                           }
+                                       }];
+}
+
+- (NSArray *)treesForContainers:(NSArray *)containers
+{
+    NSMutableArray *trees = [NSMutableArray arrayWithCapacity:containers.count];
+    for (CMISObjectInFolderContainer *container in containers) {
+        CMISObject *item = [self.session.objectConverter convertObject:container.objectData];
+        [trees addObject:[[CMISTree alloc] initWithItem:item children:[self treesForContainers:container.children]]];
+    }
+    return trees;
+}
+
 - (void)createFolder:(NSDictionary *)properties completionBlock:(void (^)(NSString *objectId, NSError *error))completionBlock
 {
+    completionBlock = [self.session callbackBlock:completionBlock];
     [self.session.objectConverter convertProperties:properties
                                     forObjectTypeId:[properties objectForKey:kCMISPropertyObjectTypeId]
                                     completionBlock:^(CMISProperties *properties, NSError *error) {
@@ -131,6 +201,7 @@
                    completionBlock:(void (^)(NSString *objectId, NSError *error))completionBlock
                      progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock
 {
+    completionBlock = [self.session callbackBlock:completionBlock];
     [self.session.objectConverter convertProperties:properties
                                     forObjectTypeId:[properties objectForKey:kCMISPropertyObjectTypeId]
                                     completionBlock:^(CMISProperties *convertedProperties, NSError *error) {
@@ -155,6 +226,7 @@
                        withContinueOnFailure:(BOOL)continueOnFailure
                              completionBlock:(void (^)(NSArray *failedObjects, NSError *error))completionBlock
 {
+    completionBlock = [self.session callbackBlock:completionBlock];
     [self.binding.objectService deleteTree:self.identifier allVersion:deleteAllversions
                                     unfileObjects:unfileObjects continueOnFailure:continueOnFailure completionBlock:completionBlock];
 }
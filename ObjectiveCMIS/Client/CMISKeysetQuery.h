@@ -0,0 +1,50 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class CMISTypeDefinition;
+@class CMISOperationContext;
+
+/**
+ * The statement of an object query paged by key: a page following one already fetched asks for the objects after
+ * the last one of that page, which the repository can seek to instead of scanning past all skipped objects.
+ *
+ * CMIS only allows ranges (<, >) on date, integer and decimal properties; ids can only be compared with =, <> and IN.
+ * So the key is a date property, and objects sharing the key value of the last one of a page are excluded by id.
+ */
+@interface CMISKeysetQuery : NSObject
+
+@property (nonatomic, strong, readonly) NSString *keyProperty;
+
+/** The string as a query literal, quotes and backslashes escaped */
++ (NSString *)stringLiteral:(NSString *)string;
+
+/**
+ * Whether objects of the type can be paged by the property: it must be a queryable and orderable date.
+ * If not, the query should page by skip count.
+ */
++ (BOOL)canPageTypeDefinition:(CMISTypeDefinition *)typeDefinition byProperty:(NSString *)keyProperty;
+
+- (id)initWithTypeDefinition:(CMISTypeDefinition *)typeDefinition
+                 whereClause:(NSString *)whereClause
+            operationContext:(CMISOperationContext *)operationContext;
+
+/** The statement for the page at the skip count, and the skip count to send with it: 0 if it continues a fetched page */
+- (NSString *)statementForSkipCount:(NSInteger)skipCount remainingSkipCount:(NSInteger *)remainingSkipCount;
+
+/** Records the fetched page (CMISObjects), so the page following it can be asked for by key */
+- (void)addPage:(NSArray *)objects atSkipCount:(NSInteger)skipCount;
+
+@end
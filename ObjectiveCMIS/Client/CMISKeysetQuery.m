@@ -0,0 +1,211 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import "CMISKeysetQuery.h"
+#import "CMISConstants.h"
+#import "CMISTypeDefinition.h"
+#import "CMISPropertyDefinition.h"
+#import "CMISOperationContext.h"
+#import "CMISObject.h"
+#import "CMISProperties.h"
+#import "CMISPropertyData.h"
+
+/**
+ * Where a fetched page ended: the key value of its last object, as sent in a query, and the ids of all objects
+ * delivered so far with that value. The next page asks for key values from there on, without those ids.
+ */
+@interface CMISKeysetPosition : NSObject
+
+@property (nonatomic, strong) NSString *timestamp;
+@property (nonatomic, strong) NSMutableArray *objectIds;
+
+@end
+
+@implementation CMISKeysetPosition
+
+@synthesize timestamp = _timestamp;
+@synthesize objectIds = _objectIds;
+
+@end
+
+
+@interface CMISKeysetQuery ()
+
+@property (nonatomic, strong, readwrite) NSString *keyProperty;
+@property (nonatomic, assign) BOOL orderByObjectId; // breaks ties of the key for pages asked for by skip count
+@property (nonatomic, strong) NSString *selectAndFromClause;
+@property (nonatomic, strong) NSString *whereClause;
+@property (nonatomic, strong) NSMutableDictionary *positionsBySkipCount; // position after a fetched page, by the skip count following it
+@property (nonatomic, strong) NSMutableDictionary *usedPositionsBySkipCount; // position a page in flight continues from, by its skip count
+
+@end
+
+@implementation CMISKeysetQuery
+
+@synthesize keyProperty = _keyProperty;
+@synthesize orderByObjectId = _orderByObjectId;
+@synthesize selectAndFromClause = _selectAndFromClause;
+@synthesize whereClause = _whereClause;
+@synthesize positionsBySkipCount = _positionsBySkipCount;
+@synthesize usedPositionsBySkipCount = _usedPositionsBySkipCount;
+
++ (NSDateFormatter *)timestampFormatter
+{
+    static dispatch_once_t predicate = 0;
+    __strong static NSDateFormatter *dateFormatter = nil;
+    dispatch_once(&predicate, ^{
+        dateFormatter = [[NSDateFormatter alloc] init];
+        dateFormatter.locale = [NSLocale systemLocale];
+        dateFormatter.calendar = [[NSCalendar alloc] initWithCalendarIdentifier:NSGregorianCalendar];
+        NSTimeZone *timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+        dateFormatter.calendar.timeZone = timeZone;
+        dateFormatter.timeZone = timeZone;
+        // keys must keep the milliseconds, or objects created in the same second would be taken for ties
+        dateFormatter.dateFormat = @"yyyy'-'MM'-'dd'T'HH':'mm':'ss'.'SSS'Z'";
+    });
+    return dateFormatter;
+}
+
++ (NSString *)stringLiteral:(NSString *)string
+{
+    NSString *escapedString = [string stringByReplacingOccurrencesOfString:@"\\" withString:@"\\\\"];
+    escapedString = [escapedString stringByReplacingOccurrencesOfString:@"'" withString:@"\\'"];
+    return [NSString stringWithFormat:@"'%@'", escapedString];
+}
+
++ (BOOL)canPageTypeDefinition:(CMISTypeDefinition *)typeDefinition byProperty:(NSString *)keyProperty
+{
+    CMISPropertyDefinition *propertyDefinition = [typeDefinition propertyDefinitionForId:keyProperty];
+    return propertyDefinition != nil
+        && propertyDefinition.propertyType == CMISPropertyTypeDateTime
+        && propertyDefinition.cardinality == CMISCardinalitySingle
+        && propertyDefinition.isQueryable
+        && propertyDefinition.isOrderable;
+}
+
+- (id)initWithTypeDefinition:(CMISTypeDefinition *)typeDefinition
+                 whereClause:(NSString *)whereClause
+            operationContext:(CMISOperationContext *)operationContext
+{
+    self = [super init];
+    if (self) {
+        self.keyProperty = operationContext.keysetPagingProperty;
+        self.orderByObjectId = [typeDefinition propertyDefinitionForId:kCMISPropertyObjectId].isOrderable;
+        self.whereClause = whereClause;
+        self.positionsBySkipCount = [NSMutableDictionary dictionary];
+        self.usedPositionsBySkipCount = [NSMutableDictionary dictionary];
+        
+        // the key and the id of the last object must come back with it
+        NSMutableString *selectList = [NSMutableString stringWithString:(operationContext.filterString != nil ? operationContext.filterString : @"*")];
+        if (![selectList isEqualToString:@"*"]) {
+            if ([selectList rangeOfString:kCMISPropertyObjectId options:NSCaseInsensitiveSearch].location == NSNotFound) {
+                [selectList appendFormat:@",%@", kCMISPropertyObjectId];
+            }
+            if ([selectList rangeOfString:self.keyProperty options:NSCaseInsensitiveSearch].location == NSNotFound) {
+                [selectList appendFormat:@",%@", self.keyProperty];
+            }
+        }
+        self.selectAndFromClause = [NSString stringWithFormat:@"SELECT %@ FROM %@", selectList, typeDefinition.queryName];
+        
+        if (operationContext.orderBy != nil) {
+            log(@"Ignoring order by '%@': keyset paging orders by %@", operationContext.orderBy, self.keyProperty);
+        }
+    }
+    return self;
+}
+
+- (NSString *)conditionAfterPosition:(CMISKeysetPosition *)position
+{
+    NSMutableArray *literals = [NSMutableArray arrayWithCapacity:position.objectIds.count];
+    for (NSString *objectId in position.objectIds) {
+        [literals addObject:[CMISKeysetQuery stringLiteral:objectId]];
+    }
+    return [NSString stringWithFormat:@"%@ >= TIMESTAMP '%@' AND %@ NOT IN (%@)",
+            self.keyProperty, position.timestamp, kCMISPropertyObjectId, [literals componentsJoinedByString:@","]];
+}
+
+- (NSString *)statementForSkipCount:(NSInteger)skipCount remainingSkipCount:(NSInteger *)remainingSkipCount
+{
+    CMISKeysetPosition *position = nil;
+    @synchronized(self) {
+        // each page is fetched once by an enumeration, the positions of the pages before it are not needed any more
+        NSNumber *key = [NSNumber numberWithInteger:skipCount];
+        position = [self.positionsBySkipCount objectForKey:key];
+        [self.positionsBySkipCount removeObjectForKey:key];
+        if (position != nil) {
+            [self.usedPositionsBySkipCount setObject:position forKey:key];
+        }
+    }
+    NSString *keyCondition = (position != nil ? [self conditionAfterPosition:position] : nil);
+    
+    NSMutableString *statement = [NSMutableString stringWithString:self.selectAndFromClause];
+    if (self.whereClause != nil && keyCondition != nil) {
+        [statement appendFormat:@" WHERE (%@) AND %@", self.whereClause, keyCondition];
+    } else if (self.whereClause != nil) {
+        [statement appendFormat:@" WHERE %@", self.whereClause];
+    } else if (keyCondition != nil) {
+        [statement appendFormat:@" WHERE %@", keyCondition];
+    }
+    
+    [statement appendFormat:@" ORDER BY %@ ASC", self.keyProperty];
+    if (self.orderByObjectId) {
+        [statement appendFormat:@",%@ ASC", kCMISPropertyObjectId];
+    }
+    
+    // without a key (a page not following a fetched one), the order still makes skipping correct, as far as it is stable
+    *remainingSkipCount = (keyCondition != nil ? 0 : skipCount);
+    return statement;
+}
+
+// nil if the object has no value for the key
+- (NSString *)timestampOfObject:(CMISObject *)object
+{
+    NSDate *keyValue = [object.properties propertyValueForId:self.keyProperty];
+    return (keyValue != nil ? [[CMISKeysetQuery timestampFormatter] stringFromDate:keyValue] : nil);
+}
+
+- (void)addPage:(NSArray *)objects atSkipCount:(NSInteger)skipCount
+{
+    NSNumber *key = [NSNumber numberWithInteger:skipCount];
+    CMISKeysetPosition *usedPosition = nil;
+    @synchronized(self) {
+        usedPosition = [self.usedPositionsBySkipCount objectForKey:key];
+        [self.usedPositionsBySkipCount removeObjectForKey:key];
+    }
+    
+    NSString *timestamp = [self timestampOfObject:[objects lastObject]];
+    if (timestamp == nil) {
+        return; // the page after it is asked for by skip count
+    }
+    
+    // ties are compared as sent, so a finer precision on the client cannot let an object through twice
+    CMISKeysetPosition *position = [[CMISKeysetPosition alloc] init];
+    position.timestamp = timestamp;
+    position.objectIds = [NSMutableArray array];
+    for (CMISObject *object in objects) {
+        if ([[self timestampOfObject:object] isEqualToString:timestamp]) {
+            [position.objectIds addObject:object.identifier];
+        }
+    }
+    // objects of earlier pages with the same key value were excluded from this one, and must stay excluded
+    if ([usedPosition.timestamp isEqualToString:timestamp]) {
+        [position.objectIds addObjectsFromArray:usedPosition.objectIds];
+    }
+    
+    @synchronized(self) {
+        [self.positionsBySkipCount setObject:position forKey:[NSNumber numberWithInteger:(skipCount + objects.count)]];
+    }
+}
+
+@end
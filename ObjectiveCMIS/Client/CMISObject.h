@@ -18,6 +18,7 @@
 #import "CMISObjectId.h"
 
 @class CMISSession;
+@class CMISRequest;
 
 @interface CMISObject : CMISObjectId
 
@@ -50,8 +51,10 @@
  *                   but keep in mind that this can trigger another remote call to the server to fetch the type info.
  *
  * @return the updated object (a repository might have created a new version of the object)
+ *         in the completion block. The returned request covers the conversion, the update and the retrieval
+ *         of the updated object: once it is cancelled or its deadline passes, no further step is started.
 */
-- (void)updateProperties:(NSDictionary *)properties completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock;
+- (CMISRequest*)updateProperties:(NSDictionary *)properties completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock;
 
 /**
  * Returns the extensions for the given level as an array of CMISExtensionElement
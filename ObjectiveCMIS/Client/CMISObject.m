@@ -17,9 +17,10 @@
 #import "CMISErrors.h"
 #import "CMISObjectConverter.h"
 #import "CMISStringInOutParameter.h"
-#import "CMISSession.h"
+#import "CMISSession+Internal.h"
 #import "CMISRenditionData.h"
 #import "CMISRendition.h"
+#import "CMISRequest.h"
 
 @interface CMISObject ()
 
@@ -107,31 +108,46 @@
     return ((aArray == nil) ? [NSArray array] : aArray);
 }
 
-- (void)updateProperties:(NSDictionary *)properties completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock
+- (CMISRequest*)updateProperties:(NSDictionary *)properties completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock
 {
+    completionBlock = [self.session callbackBlock:completionBlock];
     // Validate properties param
         if (!properties || properties.count == 0)
     {
         completionBlock(nil, [CMISErrors createCMISErrorWithCode:kCMISErrorCodeInvalidArgument withDetailedDescription:@"Properties cannot be nil or empty"]);
-        return;
+        return nil;
     }
 
+    // every step runs as the current http request of this one, so cancelling it stops whichever step is in flight
+    CMISRequest *request = [[CMISRequest alloc] init];
+    
     // Convert properties to an understandable format for the service
     [self.session.objectConverter convertProperties:properties forObjectTypeId:self.objectType completionBlock:^(CMISProperties *convertedProperties, NSError *error) {
-        if (convertedProperties)
+        if (request.isCancelled)
+        {
+            completionBlock(nil, [request cancellationError]);
+        }
+        else if (convertedProperties)
         {
             CMISStringInOutParameter *objectIdInOutParam = [CMISStringInOutParameter inOutParameterUsingInParameter:self.identifier];
             CMISStringInOutParameter *changeTokenInOutParam = [CMISStringInOutParameter inOutParameterUsingInParameter:self.changeToken];
-            [self.binding.objectService
+            request.httpRequest = [self.binding.objectService
              updatePropertiesForObject:objectIdInOutParam
              withProperties:convertedProperties
              withChangeToken:changeTokenInOutParam
              completionBlock:^(NSError *error) {
-                 if (objectIdInOutParam.outParameter) {
-                     [self.session retrieveObject:objectIdInOutParam.outParameter
-                                  completionBlock:^(CMISObject *object, NSError *error) {
-                                      completionBlock(object, error);
-                                  }];
+                 if (request.isCancelled) {
+                     completionBlock(nil, [request cancellationError]);
+                 }
+                 else if (objectIdInOutParam.outParameter) {
+                     request.httpRequest = [self.session retrieveObject:objectIdInOutParam.outParameter
+                                                        completionBlock:^(CMISObject *object, NSError *error) {
+                                                            if (request.isCancelled) {
+                                                                completionBlock(nil, [request cancellationError]);
+                                                            } else {
+                                                                completionBlock(object, error);
+                                                            }
+                                                        }];
                  }
                  else
                  {
@@ -144,6 +160,8 @@
             completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeRuntime]);
         }
     }];
+    
+    return request;
 }
 
 - (NSArray *)extensionsForExtensionLevel:(CMISExtensionLevel)extensionLevel
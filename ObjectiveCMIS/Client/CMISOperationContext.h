@@ -29,6 +29,14 @@
 @property NSInteger maxItemsPerPage;
 @property NSInteger skipCount;
 
+/**
+ * Property to page object queries by, continuing after the last item seen instead of skipping to an offset.
+ * It must be a single valued date that the type lets be queried and ordered by, such as kCMISPropertyCreationDate;
+ * ids cannot be compared with > in a query. The results are then ordered by that key and orderBy is ignored.
+ * If the type does not allow it, or for nil (the default), queries page by skip count.
+ */
+@property (nonatomic, strong) NSString *keysetPagingProperty;
+
 + (CMISOperationContext *)defaultOperationContext;
 
 @end
\ No newline at end of file
@@ -27,6 +27,7 @@
 @synthesize skipCount = _skipCount;
 @synthesize orderBy = _orderBy;
 @synthesize isIncludePathSegments = _isIncludePathSegments;
+@synthesize keysetPagingProperty = _keysetPagingProperty;
 
 + (CMISOperationContext *)defaultOperationContext
 {
@@ -41,6 +42,7 @@
     defaultContext.isIncludePathSegments = NO;
     defaultContext.maxItemsPerPage = 100;
     defaultContext.skipCount = 0;
+    defaultContext.keysetPagingProperty = nil;
     return defaultContext;
 }
 
@@ -39,6 +39,12 @@ typedef void (^CMISFetchNextPageBlock)(int skipCount, int maxItems, CMISFetchNex
 @property (readonly) BOOL hasMoreItems;
 @property (readonly) NSInteger numItems;
 
+// number of pages enumerateItemsUsingBlock: fetches ahead of the page being enumerated (1 for double buffering,
+// 2 for triple buffering). The default of 0 fetches a page only once the previous one is enumerated. Pages fetched
+// with fetchNextPageWithCompletionBlock: inherit the depth. The enumeration keeps at most this many pages plus the
+// one being enumerated in memory, however long the listing is.
+@property (nonatomic, assign) NSUInteger prefetchDepth;
+
 + (void)pagedResultUsingFetchBlock:(CMISFetchNextPageBlock)fetchNextPageBlock
                 andLimitToMaxItems:(NSInteger)maxItems andStartFromSkipCount:(NSInteger)skipCount
                    completionBlock:(void (^)(CMISPagedResult *result, NSError *error))completionBlock;
@@ -47,4 +53,18 @@ typedef void (^CMISFetchNextPageBlock)(int skipCount, int maxItems, CMISFetchNex
 - (void)enumerateItemsUsingBlock:(void (^)(CMISObject *object, BOOL *stop))enumerationBlock
                  completionBlock:(void (^)(NSError *error))completionBlock;
 
+/**
+ * Enumerates the items of this page and all pages after it, fetching up to concurrentPageCount pages at once.
+ * This needs numItems: the skip counts of all remaining pages follow from it. Without it, or with a concurrentPageCount
+ * below 2, this is the same as enumerateItemsUsingBlock:completionBlock:.
+ *
+ * If ordered, items are enumerated in the order of the listing, otherwise page by page as the pages arrive.
+ * The enumeration block is never called concurrently, but may be called on the thread of any of the fetches.
+ * Setting stop cancels the enumeration: fetches still in flight are ignored.
+ */
+- (void)enumerateItemsWithConcurrentPageCount:(NSUInteger)concurrentPageCount
+                                      ordered:(BOOL)ordered
+                                   usingBlock:(void (^)(CMISObject *object, BOOL *stop))enumerationBlock
+                              completionBlock:(void (^)(NSError *error))completionBlock;
+
 @end
\ No newline at end of file
@@ -13,8 +13,12 @@
  */
 
 #import "CMISPagedResult.h"
+#import "CMISPagedResult+Internal.h"
 #import "CMISErrors.h"
 
+// pages fetched in parallel may get ahead of the enumeration by this many times the number of concurrent fetches
+#define PARALLEL_BUFFERED_PAGES_FACTOR 2
+
 /**
  * Implementation of the wrapper class for the returned results
  */
@@ -26,6 +30,172 @@
 
 @end
 
+
+/**
+ * Keeps up to prefetchDepth pages following a paged result fetched, while the pages before them are enumerated.
+ * Pages are fetched one after the other, as the skip count of a page is only known once the previous one arrived.
+ * Only the pages not taken yet are referenced: a page is released as soon as the enumeration is done with it.
+ */
+@interface CMISPagedResultPrefetcher : NSObject
+
+@property (nonatomic, copy) CMISFetchNextPageBlock fetchNextPageBlock;
+@property (nonatomic, assign) NSInteger maxItems;
+@property (nonatomic, assign) NSInteger nextSkipCount;
+@property (nonatomic, assign) NSUInteger prefetchDepth;
+@property (nonatomic, strong) NSMutableArray *fetchedPages;
+@property (nonatomic, strong) NSError *error;
+@property (nonatomic, assign) BOOL fetching;
+@property (nonatomic, assign) BOOL pageNeeded; // the enumeration asked for a page beyond the prefetched ones
+@property (nonatomic, assign) BOOL exhausted;
+@property (nonatomic, copy) void (^waitingBlock)(CMISPagedResult *page, NSError *error);
+
+- (id)initWithPagedResult:(CMISPagedResult *)pagedResult prefetchDepth:(NSUInteger)prefetchDepth;
+
+// returns YES with the next page in order if it is there (nil once all pages were delivered, or the fetch failed);
+// otherwise returns NO and calls the completion block when it arrives
+- (BOOL)takeNextPage:(CMISPagedResult **)page
+               error:(NSError **)error
+orWaitWithCompletionBlock:(void (^)(CMISPagedResult *page, NSError *error))completionBlock;
+
+// pages fetched or arriving from now on are dropped
+- (void)cancel;
+
+@end
+
+@implementation CMISPagedResultPrefetcher
+
+@synthesize fetchNextPageBlock = _fetchNextPageBlock;
+@synthesize maxItems = _maxItems;
+@synthesize nextSkipCount = _nextSkipCount;
+@synthesize prefetchDepth = _prefetchDepth;
+@synthesize fetchedPages = _fetchedPages;
+@synthesize error = _error;
+@synthesize fetching = _fetching;
+@synthesize pageNeeded = _pageNeeded;
+@synthesize exhausted = _exhausted;
+@synthesize waitingBlock = _waitingBlock;
+
+- (id)initWithPagedResult:(CMISPagedResult *)pagedResult prefetchDepth:(NSUInteger)prefetchDepth
+{
+    self = [super init];
+    if (self) {
+        self.fetchNextPageBlock = pagedResult.fetchNextPageBlock;
+        self.maxItems = pagedResult.maxItems;
+        self.nextSkipCount = pagedResult.skipCount + pagedResult.resultArray.count;
+        self.prefetchDepth = prefetchDepth;
+        self.fetchedPages = [NSMutableArray arrayWithCapacity:prefetchDepth];
+        self.exhausted = !pagedResult.hasMoreItems;
+        [self fetchAhead];
+    }
+    return self;
+}
+
+- (void)fetchAhead
+{
+    NSInteger skipCount = 0;
+    @synchronized(self) {
+        if (self.fetching || self.exhausted || (self.fetchedPages.count >= self.prefetchDepth && !self.pageNeeded)) {
+            return;
+        }
+        self.fetching = YES;
+        skipCount = self.nextSkipCount;
+    }
+    
+    NSUInteger prefetchDepth = self.prefetchDepth;
+    [CMISPagedResult pagedResultUsingFetchBlock:self.fetchNextPageBlock
+                             andLimitToMaxItems:self.maxItems
+                          andStartFromSkipCount:skipCount
+                                completionBlock:^(CMISPagedResult *result, NSError *error) {
+        result.prefetchDepth = prefetchDepth;
+        void (^waitingBlock)(CMISPagedResult *page, NSError *error) = nil;
+        CMISPagedResult *deliveredPage = nil;
+        @synchronized(self) {
+            self.fetching = NO;
+            if (self.exhausted) {
+                return; // cancelled meanwhile
+            }
+            if (error) {
+                self.error = error;
+                self.exhausted = YES;
+            } else {
+                self.nextSkipCount = skipCount + result.resultArray.count;
+                self.exhausted = !result.hasMoreItems || result.resultArray.count == 0;
+                [self.fetchedPages addObject:result];
+            }
+            self.pageNeeded = NO;
+            
+            waitingBlock = self.waitingBlock;
+            self.waitingBlock = nil;
+            if (waitingBlock && self.fetchedPages.count > 0) {
+                deliveredPage = [self.fetchedPages objectAtIndex:0];
+                [self.fetchedPages removeObjectAtIndex:0];
+            }
+        }
+        
+        [self fetchAhead];
+        if (waitingBlock) {
+            waitingBlock(deliveredPage, deliveredPage ? nil : self.error);
+        }
+    }];
+}
+
+- (BOOL)takeNextPage:(CMISPagedResult **)page
+               error:(NSError **)error
+orWaitWithCompletionBlock:(void (^)(CMISPagedResult *page, NSError *error))completionBlock
+{
+    BOOL pageTaken = NO;
+    @synchronized(self) {
+        pageTaken = [self takeFetchedPage:page error:error];
+        if (!pageTaken) {
+            self.pageNeeded = YES;
+        }
+    }
+    
+    // taking a page frees a slot for the next one; a page needed now is fetched even without prefetching
+    [self fetchAhead];
+    if (pageTaken) {
+        return YES;
+    }
+    
+    // the fetch may have completed right away: return the page then, rather than continuing the enumeration
+    // from inside the fetch, which would nest one level deeper with every page
+    @synchronized(self) {
+        pageTaken = [self takeFetchedPage:page error:error];
+        if (!pageTaken) {
+            self.waitingBlock = completionBlock;
+        }
+    }
+    return pageTaken;
+}
+
+// must be called while synchronized
+- (BOOL)takeFetchedPage:(CMISPagedResult **)page error:(NSError **)error
+{
+    if (self.fetchedPages.count > 0) {
+        *page = [self.fetchedPages objectAtIndex:0];
+        [self.fetchedPages removeObjectAtIndex:0];
+        return YES;
+    } else if (self.exhausted) {
+        *page = nil;
+        *error = self.error;
+        return YES;
+    }
+    return NO;
+}
+
+- (void)cancel
+{
+    @synchronized(self) {
+        self.exhausted = YES;
+        self.error = nil;
+        [self.fetchedPages removeAllObjects];
+        self.waitingBlock = nil;
+    }
+}
+
+@end
+
+
 /**
  * Private interface for CMISPagedResult
  */
@@ -41,6 +211,275 @@
 
 @end
 
+
+/**
+ * Enumerates the items of a listing whose size is known, fetching the remaining ranges of skip counts concurrently.
+ *
+ * A fetch may return fewer items than asked for (a server side page limit) or more (a page size chosen by the adaptive
+ * controller): the surplus is dropped and the rest of a short range is fetched again, so every offset is delivered once.
+ * The enumeration block is called for one page at a time, on the thread of the fetch that completed it.
+ */
+@interface CMISPagedResultParallelEnumeration : NSObject
+
+@property (nonatomic, copy) CMISFetchNextPageBlock fetchNextPageBlock;
+@property (nonatomic, assign) NSUInteger concurrentPageCount;
+@property (nonatomic, assign) BOOL ordered;
+@property (nonatomic, copy) void (^enumerationBlock)(CMISObject *object, BOOL *stop);
+@property (nonatomic, copy) void (^completionBlock)(NSError *error);
+
+@property (nonatomic, strong) NSMutableArray *pendingRanges; // NSValue wrapped NSRanges, by ascending location
+@property (nonatomic, strong) NSMutableDictionary *arrivedPages; // items by offset
+@property (nonatomic, strong) NSMutableDictionary *arrivedPageLengths; // offsets covered by the items, by offset
+@property (nonatomic, strong) NSMutableArray *arrivedPageOffsets; // in order of arrival
+@property (nonatomic, assign) NSUInteger nextOffset; // of the next page to deliver, when ordered
+@property (nonatomic, assign) NSUInteger inFlightCount;
+@property (nonatomic, assign) BOOL delivering;
+@property (nonatomic, assign) BOOL finished;
+@property (nonatomic, strong) NSError *error;
+
+- (id)initWithPagedResult:(CMISPagedResult *)pagedResult
+      concurrentPageCount:(NSUInteger)concurrentPageCount
+                  ordered:(BOOL)ordered
+         enumerationBlock:(void (^)(CMISObject *object, BOOL *stop))enumerationBlock
+          completionBlock:(void (^)(NSError *error))completionBlock;
+
+- (void)start;
+
+@end
+
+@implementation CMISPagedResultParallelEnumeration
+
+@synthesize fetchNextPageBlock = _fetchNextPageBlock;
+@synthesize concurrentPageCount = _concurrentPageCount;
+@synthesize ordered = _ordered;
+@synthesize enumerationBlock = _enumerationBlock;
+@synthesize completionBlock = _completionBlock;
+@synthesize pendingRanges = _pendingRanges;
+@synthesize arrivedPages = _arrivedPages;
+@synthesize arrivedPageLengths = _arrivedPageLengths;
+@synthesize arrivedPageOffsets = _arrivedPageOffsets;
+@synthesize nextOffset = _nextOffset;
+@synthesize inFlightCount = _inFlightCount;
+@synthesize delivering = _delivering;
+@synthesize finished = _finished;
+@synthesize error = _error;
+
+- (id)initWithPagedResult:(CMISPagedResult *)pagedResult
+      concurrentPageCount:(NSUInteger)concurrentPageCount
+                  ordered:(BOOL)ordered
+         enumerationBlock:(void (^)(CMISObject *object, BOOL *stop))enumerationBlock
+          completionBlock:(void (^)(NSError *error))completionBlock
+{
+    self = [super init];
+    if (self) {
+        self.fetchNextPageBlock = pagedResult.fetchNextPageBlock;
+        self.concurrentPageCount = concurrentPageCount;
+        self.ordered = ordered;
+        self.enumerationBlock = enumerationBlock;
+        self.completionBlock = completionBlock;
+        self.arrivedPages = [NSMutableDictionary dictionary];
+        self.arrivedPageLengths = [NSMutableDictionary dictionary];
+        self.arrivedPageOffsets = [NSMutableArray array];
+        
+        // the page at hand is delivered first, the rest of the listing is split into ranges of the page size
+        NSUInteger firstOffset = (NSUInteger)pagedResult.skipCount;
+        [self addArrivedItems:pagedResult.resultArray atOffset:firstOffset length:pagedResult.resultArray.count];
+        self.nextOffset = firstOffset;
+        
+        NSUInteger pageSize = pagedResult.maxItems > 0 ? (NSUInteger)pagedResult.maxItems : MAX(pagedResult.resultArray.count, (NSUInteger)1);
+        self.pendingRanges = [NSMutableArray array];
+        for (NSUInteger offset = firstOffset + pagedResult.resultArray.count; offset < (NSUInteger)pagedResult.numItems; offset += pageSize) {
+            NSRange range = NSMakeRange(offset, MIN(pageSize, (NSUInteger)pagedResult.numItems - offset));
+            [self.pendingRanges addObject:[NSValue valueWithRange:range]];
+        }
+    }
+    return self;
+}
+
+- (void)start
+{
+    [self fetchPages];
+    [self deliverPages];
+}
+
+// must be called while synchronized
+- (void)addArrivedItems:(NSArray *)items atOffset:(NSUInteger)offset length:(NSUInteger)length
+{
+    NSNumber *key = [NSNumber numberWithUnsignedInteger:offset];
+    [self.arrivedPages setObject:items forKey:key];
+    [self.arrivedPageLengths setObject:[NSNumber numberWithUnsignedInteger:length] forKey:key];
+    [self.arrivedPageOffsets addObject:key];
+}
+
+- (void)fetchPages
+{
+    NSMutableArray *rangesToFetch = [NSMutableArray array];
+    @synchronized(self) {
+        NSUInteger maximumBufferedPages = self.concurrentPageCount * PARALLEL_BUFFERED_PAGES_FACTOR;
+        while (!self.finished && self.error == nil && self.pendingRanges.count > 0 && self.inFlightCount < self.concurrentPageCount) {
+            NSRange range = [[self.pendingRanges objectAtIndex:0] rangeValue];
+            
+            // do not run too far ahead of the enumeration, but never hold back the page it waits for
+            BOOL neededNext = self.ordered && range.location <= self.nextOffset;
+            if (self.arrivedPageOffsets.count + self.inFlightCount >= maximumBufferedPages && !neededNext) {
+                break;
+            }
+            
+            [self.pendingRanges removeObjectAtIndex:0];
+            [rangesToFetch addObject:[NSValue valueWithRange:range]];
+            self.inFlightCount++;
+        }
+    }
+    
+    for (NSValue *rangeValue in rangesToFetch) {
+        NSRange range = [rangeValue rangeValue];
+        self.fetchNextPageBlock((int)range.location, (int)range.length, ^(CMISFetchNextPageBlockResult *result, NSError *error) {
+            [self handleResult:result error:error forRange:range];
+        });
+    }
+}
+
+- (void)handleResult:(CMISFetchNextPageBlockResult *)result error:(NSError *)error forRange:(NSRange)range
+{
+    @synchronized(self) {
+        self.inFlightCount--;
+        if (self.finished) {
+            return;
+        }
+        
+        if (error) {
+            if (self.error == nil) {
+                self.error = [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeRuntime];
+            }
+        } else {
+            NSArray *items = result.resultArray;
+            if (items.count > range.length) {
+                items = [items subarrayWithRange:NSMakeRange(0, range.length)];
+            }
+            
+            if (items.count == 0 && result.hasMoreItems) {
+                // nothing at an offset the server says is followed by more: fetching it again would not end,
+                // and taking it as covered would skip the items of the range without a word
+                log(@"Fetch of %lu items at %lu returned no items, but more are said to follow", (unsigned long)range.length, (unsigned long)range.location);
+                if (self.error == nil) {
+                    self.error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeRuntime
+                                             withDetailedDescription:@"Server returned an empty page in the middle of the listing"];
+                }
+            } else if (items.count < range.length && result.hasMoreItems) {
+                // short page: the rest of the range is fetched again, before any range after it
+                NSRange remainingRange = NSMakeRange(range.location + items.count, range.length - items.count);
+                NSUInteger index = 0;
+                while (index < self.pendingRanges.count && [[self.pendingRanges objectAtIndex:index] rangeValue].location < remainingRange.location) {
+                    index++;
+                }
+                [self.pendingRanges insertObject:[NSValue valueWithRange:remainingRange] atIndex:index];
+                [self addArrivedItems:items atOffset:range.location length:items.count];
+            } else {
+                if (!result.hasMoreItems) {
+                    // the listing ends here (it may have shrunk since numItems was reported)
+                    NSUInteger end = range.location + items.count;
+                    NSIndexSet *rangesAfterEnd = [self.pendingRanges indexesOfObjectsPassingTest:^BOOL(id rangeValue, NSUInteger index, BOOL *stop) {
+                        return [rangeValue rangeValue].location >= end;
+                    }];
+                    [self.pendingRanges removeObjectsAtIndexes:rangesAfterEnd];
+                }
+                [self addArrivedItems:items atOffset:range.location length:range.length];
+            }
+        }
+    }
+    
+    [self deliverPages];
+    [self fetchPages];
+}
+
+// must be called while synchronized; nil if the next page to deliver has not arrived
+- (NSArray *)takeDeliverablePage
+{
+    NSNumber *key = nil;
+    if (self.ordered) {
+        key = [NSNumber numberWithUnsignedInteger:self.nextOffset];
+        if ([self.arrivedPages objectForKey:key] == nil) {
+            // a range that ended the listing early covers the offsets after its items too
+            return nil;
+        }
+        self.nextOffset += [[self.arrivedPageLengths objectForKey:key] unsignedIntegerValue];
+    } else if (self.arrivedPageOffsets.count > 0) {
+        key = [self.arrivedPageOffsets objectAtIndex:0];
+    } else {
+        return nil;
+    }
+    
+    NSArray *items = [self.arrivedPages objectForKey:key];
+    [self.arrivedPages removeObjectForKey:key];
+    [self.arrivedPageLengths removeObjectForKey:key];
+    [self.arrivedPageOffsets removeObject:key];
+    return items;
+}
+
+- (void)deliverPages
+{
+    while (YES) {
+        NSArray *items = nil;
+        NSError *completionError = nil;
+        BOOL complete = NO;
+        @synchronized(self) {
+            if (self.delivering || self.finished) {
+                return;
+            }
+            
+            if (self.error) {
+                completionError = self.error;
+                complete = YES;
+            } else {
+                items = [self takeDeliverablePage];
+                if (items == nil) {
+                    if (self.pendingRanges.count > 0 || self.inFlightCount > 0) {
+                        return; // the fetch completing the next page continues the delivery
+                    }
+                    complete = YES;
+                }
+            }
+            
+            if (complete) {
+                self.finished = YES;
+            } else {
+                self.delivering = YES;
+            }
+        }
+        
+        if (complete) {
+            self.completionBlock(completionError);
+            return;
+        }
+        
+        BOOL stop = NO;
+        for (CMISObject *object in items) {
+            self.enumerationBlock(object, &stop);
+            if (stop) {
+                break;
+            }
+        }
+        
+        @synchronized(self) {
+            self.delivering = NO;
+            if (stop) {
+                self.finished = YES;
+            }
+        }
+        
+        if (stop) {
+            self.completionBlock([CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled withDetailedDescription:@"Item enumeration was stopped"]);
+            return;
+        }
+        
+        // delivering a page made room in the buffer
+        [self fetchPages];
+    }
+}
+
+@end
+
+
 /**
  * The implementation of the result when fetching a new page.
  */
@@ -52,6 +491,7 @@
 @synthesize fetchNextPageBlock = _fetchNextPageBlock;
 @synthesize maxItems = _maxItems;
 @synthesize skipCount = _skipCount;
+@synthesize prefetchDepth = _prefetchDepth;
 
 
 /** Internal init */
@@ -95,33 +535,79 @@
 
 - (void)fetchNextPageWithCompletionBlock:(void (^)(CMISPagedResult *result, NSError *error))completionBlock
 {
+    NSUInteger prefetchDepth = self.prefetchDepth;
     [CMISPagedResult pagedResultUsingFetchBlock:self.fetchNextPageBlock
                              andLimitToMaxItems:self.maxItems
                           andStartFromSkipCount:(self.skipCount + self.resultArray.count)
-                                completionBlock:completionBlock];
+                                completionBlock:^(CMISPagedResult *result, NSError *error) {
+                                    result.prefetchDepth = prefetchDepth;
+                                    completionBlock(result, error);
+                                }];
 }
 
 - (void)enumerateItemsUsingBlock:(void (^)(CMISObject *object, BOOL *stop))enumerationBlock completionBlock:(void (^)(NSError *error))completionBlock
 {
-    BOOL stop = NO;
-    for (CMISObject *object in self.resultArray) {
-        enumerationBlock(object, &stop);
-        if (stop) {
-            NSError *error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled withDetailedDescription:@"Item enumeration was stopped"];
-            completionBlock(error);
-            return;
-        }
+    // iterate rather than recurse into the next page, so consumed pages are released as the enumeration goes
+    CMISPagedResultPrefetcher *prefetcher = [[CMISPagedResultPrefetcher alloc] initWithPagedResult:self prefetchDepth:self.prefetchDepth];
+    [CMISPagedResult enumeratePage:self withPrefetcher:prefetcher usingBlock:enumerationBlock completionBlock:completionBlock];
+}
+
+- (void)enumerateItemsWithConcurrentPageCount:(NSUInteger)concurrentPageCount
+                                      ordered:(BOOL)ordered
+                                   usingBlock:(void (^)(CMISObject *object, BOOL *stop))enumerationBlock
+                              completionBlock:(void (^)(NSError *error))completionBlock
+{
+    BOOL remainingItemsKnown = self.hasMoreItems && self.numItems > self.skipCount + (NSInteger)self.resultArray.count;
+    if (concurrentPageCount < 2 || !remainingItemsKnown) {
+        [self enumerateItemsUsingBlock:enumerationBlock completionBlock:completionBlock];
+        return;
     }
-    if (self.hasMoreItems) {
-        [self fetchNextPageWithCompletionBlock:^(CMISPagedResult *result, NSError *error) {
-            if (error) {
+    
+    CMISPagedResultParallelEnumeration *enumeration = [[CMISPagedResultParallelEnumeration alloc] initWithPagedResult:self
+                                                                                                   concurrentPageCount:concurrentPageCount
+                                                                                                               ordered:ordered
+                                                                                                      enumerationBlock:enumerationBlock
+                                                                                                       completionBlock:completionBlock];
+    [enumeration start];
+}
+
+// enumerates the given page and the ones after it, taking pages from the prefetcher as long as they are already there
++ (void)enumeratePage:(CMISPagedResult *)page
+       withPrefetcher:(CMISPagedResultPrefetcher *)prefetcher
+           usingBlock:(void (^)(CMISObject *object, BOOL *stop))enumerationBlock
+      completionBlock:(void (^)(NSError *error))completionBlock
+{
+    while (page) {
+        BOOL stop = NO;
+        for (CMISObject *object in page.resultArray) {
+            enumerationBlock(object, &stop);
+            if (stop) {
+                [prefetcher cancel];
+                NSError *error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled withDetailedDescription:@"Item enumeration was stopped"];
                 completionBlock(error);
+                return;
+            }
+        }
+        
+        CMISPagedResult *nextPage = nil;
+        NSError *nextPageError = nil;
+        BOOL nextPageAvailable = [prefetcher takeNextPage:&nextPage error:&nextPageError orWaitWithCompletionBlock:^(CMISPagedResult *fetchedPage, NSError *error) {
+            // the page arrived later, continue from the fetch callback
+            if (fetchedPage) {
+                [self enumeratePage:fetchedPage withPrefetcher:prefetcher usingBlock:enumerationBlock completionBlock:completionBlock];
             } else {
-                [result enumerateItemsUsingBlock:enumerationBlock completionBlock:completionBlock];
+                completionBlock(error);
             }
         }];
-    } else {
-        completionBlock(nil);
+        
+        if (!nextPageAvailable) {
+            return;
+        }
+        if (nextPage == nil) {
+            completionBlock(nextPageError);
+            return;
+        }
+        page = nextPage;
     }
 }
 
@@ -0,0 +1,56 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class CMISPagedResult;
+@class CMISObject;
+
+/**
+ * Random access to the items of a paged result, e.g. for a virtualized list over a large folder.
+ * An index is mapped to the page holding it, which is fetched with the skip count of its first item. Only the most
+ * recently used pages are kept, so scrolling to any position costs one page fetch and memory stays bounded.
+ */
+@interface CMISPagedView : NSObject
+
+// number of pages kept in memory, the least recently used ones are dropped first. Defaults to 10
+@property (nonatomic, assign) NSUInteger maximumResidentPages;
+
+// number of pages fetched on each side of the visible range. Defaults to 1
+@property (nonatomic, assign) NSUInteger prefetchPageCount;
+
+// called with the range of indexes of a page that was fetched, on the thread its fetch completed on
+// (the callback queue, for a session that has one)
+@property (nonatomic, copy) void (^pageLoadedBlock)(NSRange range);
+
+// the number of items: numItems if the server reported it or the last page was fetched, otherwise the number of
+// items known so far, which grows as pages after them are fetched (see isCountExact)
+@property (readonly) NSUInteger count;
+@property (readonly) BOOL isCountExact;
+
+@property (readonly) NSUInteger residentPageCount;
+
+/** Starts with the items of the given page, at index 0; the view fetches pages of the same size after them */
+- (id)initWithPagedResult:(CMISPagedResult *)pagedResult;
+
+/** The item at the index if its page is in memory, otherwise nil and the page is fetched */
+- (CMISObject *)objectAtIndex:(NSUInteger)index;
+
+/** Calls the completion block with the item at the index once its page is in memory (nil beyond the last item) */
+- (void)retrieveObjectAtIndex:(NSUInteger)index completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock;
+
+/** Fetches the pages of the visible range and the ones around it, and keeps them from being dropped first */
+- (void)setVisibleRange:(NSRange)visibleRange;
+
+@end
@@ -0,0 +1,287 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import "CMISPagedView.h"
+#import "CMISPagedResult+Internal.h"
+#import "CMISErrors.h"
+
+#define DEFAULT_MAXIMUM_RESIDENT_PAGES 10
+#define DEFAULT_PREFETCH_PAGE_COUNT 1
+
+@interface CMISPagedView ()
+
+@property (nonatomic, copy) CMISFetchNextPageBlock fetchNextPageBlock;
+@property (nonatomic, assign) NSInteger firstSkipCount;
+@property (nonatomic, assign) NSUInteger pageSize;
+@property (nonatomic, strong) NSMutableDictionary *residentPages; // items by page index
+@property (nonatomic, strong) NSMutableArray *pageUseOrder; // indexes of the resident pages, least recently used first
+@property (nonatomic, strong) NSMutableDictionary *pageLoadBlocks; // blocks waiting for a page being fetched, by page index
+@property (readwrite) NSUInteger count;
+@property (readwrite) BOOL isCountExact;
+@property (nonatomic, assign) NSUInteger knownItemCount; // up to the last item fetched so far
+@property (nonatomic, assign) NSUInteger countUpperBound; // the start of the first page found empty past the end
+
+@end
+
+@implementation CMISPagedView
+
+@synthesize maximumResidentPages = _maximumResidentPages;
+@synthesize prefetchPageCount = _prefetchPageCount;
+@synthesize pageLoadedBlock = _pageLoadedBlock;
+@synthesize count = _count;
+@synthesize isCountExact = _isCountExact;
+@synthesize fetchNextPageBlock = _fetchNextPageBlock;
+@synthesize firstSkipCount = _firstSkipCount;
+@synthesize pageSize = _pageSize;
+@synthesize residentPages = _residentPages;
+@synthesize pageUseOrder = _pageUseOrder;
+@synthesize pageLoadBlocks = _pageLoadBlocks;
+@synthesize knownItemCount = _knownItemCount;
+@synthesize countUpperBound = _countUpperBound;
+
+- (id)initWithPagedResult:(CMISPagedResult *)pagedResult
+{
+    self = [super init];
+    if (self) {
+        self.maximumResidentPages = DEFAULT_MAXIMUM_RESIDENT_PAGES;
+        self.prefetchPageCount = DEFAULT_PREFETCH_PAGE_COUNT;
+        self.fetchNextPageBlock = pagedResult.fetchNextPageBlock;
+        self.firstSkipCount = pagedResult.skipCount;
+        self.pageSize = pagedResult.maxItems > 0 ? (NSUInteger)pagedResult.maxItems : MAX(pagedResult.resultArray.count, (NSUInteger)1);
+        self.residentPages = [NSMutableDictionary dictionary];
+        self.pageUseOrder = [NSMutableArray array];
+        self.pageLoadBlocks = [NSMutableDictionary dictionary];
+        self.countUpperBound = NSUIntegerMax;
+        
+        [self updateCountWithPageItems:pagedResult.resultArray atPageIndex:0
+                          hasMoreItems:pagedResult.hasMoreItems numItems:pagedResult.numItems];
+        
+        // a short first page (a server side limit) is fetched again when needed, pages are always complete
+        if (pagedResult.resultArray.count == self.pageSize || !pagedResult.hasMoreItems) {
+            [self storePageItems:pagedResult.resultArray atPageIndex:0];
+        }
+    }
+    return self;
+}
+
+- (NSUInteger)residentPageCount
+{
+    @synchronized(self) {
+        return self.residentPages.count;
+    }
+}
+
+- (CMISObject *)objectAtIndex:(NSUInteger)index
+{
+    NSUInteger pageIndex = index / self.pageSize;
+    NSArray *items = [self residentPageItemsAtPageIndex:pageIndex];
+    if (items == nil) {
+        [self loadPageAtIndex:pageIndex completionBlock:nil];
+        items = [self residentPageItemsAtPageIndex:pageIndex]; // the fetch may have completed right away
+    }
+    
+    NSUInteger indexInPage = index % self.pageSize;
+    return indexInPage < items.count ? [items objectAtIndex:indexInPage] : nil;
+}
+
+- (void)retrieveObjectAtIndex:(NSUInteger)index completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock
+{
+    NSUInteger indexInPage = index % self.pageSize;
+    [self loadPageAtIndex:(index / self.pageSize) completionBlock:^(NSArray *items, NSError *error) {
+        if (error) {
+            completionBlock(nil, error);
+        } else {
+            completionBlock(indexInPage < items.count ? [items objectAtIndex:indexInPage] : nil, nil);
+        }
+    }];
+}
+
+- (void)setVisibleRange:(NSRange)visibleRange
+{
+    if (visibleRange.length == 0) {
+        return;
+    }
+    
+    // never more pages than can stay in memory, or the first ones fetched would be dropped by the last ones;
+    // the visible pages come first, the pages around them get what is left
+    NSUInteger maximumResidentPages = MAX(self.maximumResidentPages, (NSUInteger)1);
+    NSUInteger firstVisiblePage = visibleRange.location / self.pageSize;
+    NSUInteger lastVisiblePage = MIN((NSMaxRange(visibleRange) - 1) / self.pageSize, firstVisiblePage + maximumResidentPages - 1);
+    NSUInteger sparePageCount = maximumResidentPages - (lastVisiblePage - firstVisiblePage + 1);
+    NSUInteger pageCountBefore = MIN(MIN(self.prefetchPageCount, firstVisiblePage), sparePageCount / 2);
+    NSUInteger pageCountAfter = MIN(self.prefetchPageCount, sparePageCount - pageCountBefore);
+    NSUInteger firstPage = firstVisiblePage - pageCountBefore;
+    NSUInteger lastPage = lastVisiblePage + pageCountAfter;
+    
+    // visible pages are asked for first, and touched last so they are the last ones to be dropped
+    for (NSUInteger pageIndex = firstVisiblePage; pageIndex <= lastVisiblePage; pageIndex++) {
+        [self loadPageAtIndex:pageIndex completionBlock:nil];
+    }
+    for (NSUInteger pageIndex = firstPage; pageIndex <= lastPage; pageIndex++) {
+        if (pageIndex < firstVisiblePage || pageIndex > lastVisiblePage) {
+            [self loadPageAtIndex:pageIndex completionBlock:nil];
+        }
+    }
+    for (NSUInteger pageIndex = firstVisiblePage; pageIndex <= lastVisiblePage; pageIndex++) {
+        [self residentPageItemsAtPageIndex:pageIndex];
+    }
+}
+
+#pragma mark -
+#pragma mark Pages
+
+// the items of a resident page, marked as used; nil if the page is not in memory
+- (NSArray *)residentPageItemsAtPageIndex:(NSUInteger)pageIndex
+{
+    NSNumber *key = [NSNumber numberWithUnsignedInteger:pageIndex];
+    @synchronized(self) {
+        NSArray *items = [self.residentPages objectForKey:key];
+        if (items) {
+            [self.pageUseOrder removeObject:key];
+            [self.pageUseOrder addObject:key];
+        }
+        return items;
+    }
+}
+
+- (void)loadPageAtIndex:(NSUInteger)pageIndex completionBlock:(void (^)(NSArray *items, NSError *error))completionBlock
+{
+    NSNumber *key = [NSNumber numberWithUnsignedInteger:pageIndex];
+    NSArray *items = nil;
+    BOOL startFetch = NO;
+    @synchronized(self) {
+        items = [self residentPageItemsAtPageIndex:pageIndex];
+        BOOL beyondLastItem = (self.isCountExact && pageIndex * self.pageSize >= self.count) || pageIndex * self.pageSize >= self.countUpperBound;
+        if (items == nil && beyondLastItem) {
+            items = [NSArray array]; // beyond the last item
+        } else if (items == nil) {
+            // a page already being fetched is not fetched again, the block waits for it
+            NSMutableArray *blocks = [self.pageLoadBlocks objectForKey:key];
+            if (blocks == nil) {
+                blocks = [NSMutableArray array];
+                [self.pageLoadBlocks setObject:blocks forKey:key];
+                startFetch = YES;
+            }
+            if (completionBlock) {
+                [blocks addObject:[completionBlock copy]];
+            }
+        }
+    }
+    
+    if (items) {
+        if (completionBlock) {
+            completionBlock(items, nil);
+        }
+    } else if (startFetch) {
+        [self fetchPageAtIndex:pageIndex itemsSoFar:[NSArray array]];
+    }
+}
+
+- (void)fetchPageAtIndex:(NSUInteger)pageIndex itemsSoFar:(NSArray *)itemsSoFar
+{
+    int skipCount = (int)(self.firstSkipCount + pageIndex * self.pageSize + itemsSoFar.count);
+    int maxItems = (int)(self.pageSize - itemsSoFar.count);
+    self.fetchNextPageBlock(skipCount, maxItems, ^(CMISFetchNextPageBlockResult *result, NSError *error) {
+        if (error) {
+            [self completePageAtIndex:pageIndex withItems:nil error:[CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeRuntime]];
+            return;
+        }
+        
+        NSArray *resultItems = result.resultArray;
+        if (resultItems.count > (NSUInteger)maxItems) {
+            resultItems = [resultItems subarrayWithRange:NSMakeRange(0, maxItems)];
+        }
+        NSArray *items = [itemsSoFar arrayByAddingObjectsFromArray:resultItems];
+        
+        // a short page (a server side limit) is completed before it is stored, so indexes map to pages by division
+        if (items.count < self.pageSize && result.hasMoreItems && resultItems.count > 0) {
+            [self fetchPageAtIndex:pageIndex itemsSoFar:items];
+            return;
+        }
+        
+        [self updateCountWithPageItems:items atPageIndex:pageIndex hasMoreItems:result.hasMoreItems numItems:result.numItems];
+        [self completePageAtIndex:pageIndex withItems:items error:nil];
+    });
+}
+
+- (void)completePageAtIndex:(NSUInteger)pageIndex withItems:(NSArray *)items error:(NSError *)error
+{
+    NSArray *blocks = nil;
+    @synchronized(self) {
+        NSNumber *key = [NSNumber numberWithUnsignedInteger:pageIndex];
+        blocks = [self.pageLoadBlocks objectForKey:key];
+        [self.pageLoadBlocks removeObjectForKey:key];
+        if (items) {
+            [self storePageItems:items atPageIndex:pageIndex];
+        }
+    }
+    
+    for (void (^block)(NSArray *items, NSError *error) in blocks) {
+        block(items, error);
+    }
+    if (items.count > 0 && self.pageLoadedBlock) {
+        self.pageLoadedBlock(NSMakeRange(pageIndex * self.pageSize, items.count));
+    }
+}
+
+- (void)storePageItems:(NSArray *)items atPageIndex:(NSUInteger)pageIndex
+{
+    NSNumber *key = [NSNumber numberWithUnsignedInteger:pageIndex];
+    @synchronized(self) {
+        [self.residentPages setObject:items forKey:key];
+        [self.pageUseOrder removeObject:key];
+        [self.pageUseOrder addObject:key];
+        
+        NSUInteger maximumResidentPages = MAX(self.maximumResidentPages, (NSUInteger)1);
+        while (self.pageUseOrder.count > maximumResidentPages) {
+            [self.residentPages removeObjectForKey:[self.pageUseOrder objectAtIndex:0]];
+            [self.pageUseOrder removeObjectAtIndex:0];
+        }
+    }
+}
+
+- (void)updateCountWithPageItems:(NSArray *)items atPageIndex:(NSUInteger)pageIndex
+                    hasMoreItems:(BOOL)hasMoreItems numItems:(NSInteger)numItems
+{
+    NSUInteger pageStart = pageIndex * self.pageSize;
+    NSUInteger pageEnd = pageStart + items.count;
+    @synchronized(self) {
+        if (items.count > 0) {
+            self.knownItemCount = MAX(self.knownItemCount, pageEnd);
+        }
+        if (!hasMoreItems && (items.count > 0 || pageIndex == 0)) {
+            // the page holds the last item
+            self.count = pageEnd;
+            self.isCountExact = YES;
+        } else if (!hasMoreItems) {
+            // an empty page past the end only tells the last item comes before it
+            self.countUpperBound = MIN(self.countUpperBound, pageStart);
+            if (self.knownItemCount >= self.countUpperBound) {
+                self.count = self.countUpperBound;
+                self.isCountExact = YES;
+            } else if (self.isCountExact && self.count > self.countUpperBound) {
+                // the listing has shrunk since its size was reported
+                self.count = self.knownItemCount;
+                self.isCountExact = NO;
+            }
+        } else if (numItems > self.firstSkipCount) {
+            self.count = numItems - self.firstSkipCount;
+            self.isCountExact = YES;
+        } else if (!self.isCountExact) {
+            self.count = MAX(self.count, pageEnd);
+        }
+    }
+}
+
+@end
@@ -15,7 +15,7 @@
 #import "CMISRendition.h"
 #import "CMISDocument.h"
 #import "CMISOperationContext.h"
-#import "CMISSession.h"
+#import "CMISSession+Internal.h"
 
 @interface CMISRendition ()
 
@@ -48,6 +48,7 @@
 - (void)retrieveRenditionDocumentWithOperationContext:(CMISOperationContext *)operationContext
                                       completionBlock:(void (^)(CMISDocument *document, NSError *error))completionBlock
 {
+    completionBlock = [self.session callbackBlock:completionBlock];
     if (self.renditionDocumentId == nil)
     {
         log(@"Cannot retrieve rendition document: no renditionDocumentId was returned by the server.");
@@ -70,6 +71,7 @@
                        completionBlock:(void (^)(NSError *error))completionBlock
                          progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
 {
+    completionBlock = [self.session errorCallbackBlock:completionBlock];
     if (self.objectId == nil || self.streamId == nil)
     {
         log(@"Object id or stream id is nil. Both are needed when fetching the content of a rendition");
@@ -87,6 +89,7 @@
                                completionBlock:(void (^)(NSError *error))completionBlock
                                  progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
 {
+    completionBlock = [self.session errorCallbackBlock:completionBlock];
     if (self.objectId == nil || self.streamId == nil)
     {
         log(@"Object id or stream id is nil. Both are needed when fetching the content of a rendition");
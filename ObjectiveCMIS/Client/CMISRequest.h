@@ -14,13 +14,54 @@
 
 #import <Foundation/Foundation.h>
 
-@class CMISHttpRequest;
+/**
+ * Anything that can be cancelled on behalf of a CMISRequest: a single http request,
+ * a group of http requests transferring one content stream, or another CMISRequest.
+ */
+@protocol CMISCancellableRequest <NSObject>
+
+- (void)cancel;
+
+@optional
+
+// stops the transfer without giving up the connection, until resume is called
+- (void)suspend;
+
+- (void)resume;
+
+@end
 
-@interface CMISRequest : NSObject
 
-@property (nonatomic, weak) CMISHttpRequest *httpRequest;
-@property (nonatomic, readonly, getter = isCancelled) BOOL cancelled;
+/**
+ * Handle on an operation, which may take several http requests. The operation checks the request before each step,
+ * so once it is cancelled (or its deadline has passed) no further request is sent and no further response is parsed.
+ */
+@interface CMISRequest : NSObject <CMISCancellableRequest>
+
+// the step in flight; when it is a CMISRequest itself, it is held strongly and gets this request's deadline
+@property (nonatomic, weak) id<CMISCancellableRequest> httpRequest;
+@property (nonatomic, readonly, getter = isCancelled) BOOL cancelled; // also YES once the deadline has passed
+@property (nonatomic, readonly, getter = isSuspended) BOOL suspended;
 
+// the request is cancelled when the deadline passes; nil (the default) for no deadline
+@property (strong) NSDate *deadline;
+@property (nonatomic, readonly, getter = isTimedOut) BOOL timedOut;
+
+// called from a thread other than the one of the http request, the cancel is done on that one and so completes later
 - (void)cancel;
 
+// sets the deadline to the given interval from now
+- (void)cancelAfterTimeInterval:(NSTimeInterval)timeInterval;
+
+// time left until the deadline, negative once passed; DBL_MAX without deadline
+- (NSTimeInterval)remainingTime;
+
+// the error reported for the work abandoned because the request was cancelled or timed out
+- (NSError *)cancellationError;
+
+// suspends the current http request if it supports it; a request started later while suspended starts suspended
+- (void)suspend;
+
+- (void)resume;
+
 @end
@@ -13,11 +13,16 @@
  */
 
 #import "CMISRequest.h"
+#import "CMISNetworkThread.h"
 #import "CMISHttpRequest.h"
+#import "CMISErrors.h"
 
 @interface CMISRequest ()
 
 @property (nonatomic, getter = isCancelled) BOOL cancelled;
+@property (nonatomic, getter = isSuspended) BOOL suspended;
+@property (nonatomic, assign) BOOL httpRequestOnNetworkThread; // the http request must then be controlled from there
+@property (nonatomic, strong) CMISRequest *innerRequest; // the current http request when it is a request of its own
 
 @end
 
@@ -26,20 +31,152 @@
 
 @synthesize httpRequest = _httpRequest;
 @synthesize cancelled = _cancelled;
+@synthesize suspended = _suspended;
+@synthesize httpRequestOnNetworkThread = _httpRequestOnNetworkThread;
+@synthesize deadline = _deadline;
+@synthesize innerRequest = _innerRequest;
+
+- (BOOL)isCancelled
+{
+    return _cancelled || self.isTimedOut;
+}
+
+- (BOOL)isTimedOut
+{
+    return self.deadline != nil && [self.deadline timeIntervalSinceNow] <= 0;
+}
 
 - (void)cancel
 {
     self.cancelled = YES;
     
-    [self.httpRequest cancel];
+    [self performOnHttpRequestThread:^{
+        [self.httpRequest cancel];
+    }];
+}
+
+- (void)suspend
+{
+    self.suspended = YES;
+    
+    [self performOnHttpRequestThread:^{
+        if ([self.httpRequest respondsToSelector:@selector(suspend)]) {
+            [self.httpRequest suspend];
+        }
+    }];
+}
+
+- (void)resume
+{
+    self.suspended = NO;
+    
+    [self performOnHttpRequestThread:^{
+        if ([self.httpRequest respondsToSelector:@selector(resume)]) {
+            [self.httpRequest resume];
+        }
+    }];
+}
+
+- (NSDate *)deadline
+{
+    @synchronized(self) {
+        return _deadline;
+    }
+}
+
+- (void)setDeadline:(NSDate *)deadline
+{
+    CMISRequest *innerRequest = nil;
+    @synchronized(self) {
+        _deadline = deadline;
+        innerRequest = self.innerRequest;
+    }
+    if (deadline == nil) {
+        return;
+    }
+    [CMISRequest passDeadline:deadline toRequest:innerRequest];
+    
+    // the in-flight http request is cancelled when the deadline passes, the next step is refused by isCancelled.
+    // The timer fires on a global queue, the cancel itself is handed to the run loop of the http request
+    __weak CMISRequest *weakSelf = self;
+    int64_t delay = (int64_t)(MAX([deadline timeIntervalSinceNow], 0) * NSEC_PER_SEC);
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, delay), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        CMISRequest *request = weakSelf;
+        if (request && request.deadline == deadline && !request->_cancelled) {
+            log(@"Deadline of request passed, cancelling it");
+            [request cancel];
+        }
+    });
 }
 
-- (void)setHttpRequest:(CMISHttpRequest *)httpRequest
+// an inner request keeps its own deadline when that is the earlier one
++ (void)passDeadline:(NSDate *)deadline toRequest:(CMISRequest *)request
+{
+    NSDate *requestDeadline = request.deadline;
+    if (request && (requestDeadline == nil || [requestDeadline compare:deadline] == NSOrderedDescending)) {
+        request.deadline = deadline;
+    }
+}
+
+- (void)cancelAfterTimeInterval:(NSTimeInterval)timeInterval
+{
+    self.deadline = [NSDate dateWithTimeIntervalSinceNow:timeInterval];
+}
+
+- (NSTimeInterval)remainingTime
+{
+    return self.deadline ? [self.deadline timeIntervalSinceNow] : DBL_MAX;
+}
+
+- (NSError *)cancellationError
+{
+    return [CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled
+                       withDetailedDescription:(self.isTimedOut ? @"Request deadline passed" : @"Request was cancelled")];
+}
+
+- (void)setHttpRequest:(id<CMISCancellableRequest>)httpRequest
 {
     _httpRequest = httpRequest;
+    self.httpRequestOnNetworkThread = [CMISNetworkThread isCurrentThread];
+    
+    // a request of an inner operation is held strongly, as nothing else references it between its own steps,
+    // and it times out with this one
+    CMISRequest *innerRequest = [httpRequest isKindOfClass:[CMISRequest class]] ? (CMISRequest *)httpRequest : nil;
+    NSDate *deadline = nil;
+    @synchronized(self) {
+        self.innerRequest = innerRequest;
+        deadline = _deadline;
+    }
+    if (deadline) {
+        [CMISRequest passDeadline:deadline toRequest:innerRequest];
+    }
     
     if (self.isCancelled) {
         [httpRequest cancel];
+    } else if (self.isSuspended && [httpRequest respondsToSelector:@selector(suspend)]) {
+        [httpRequest suspend];
+    }
+}
+
+- (void)performOnHttpRequestThread:(void (^)(void))block
+{
+    if (self.httpRequestOnNetworkThread) {
+        [CMISNetworkThread performBlockAndWait:block];
+        return;
+    }
+    
+    // a connection is only controlled from the run loop delivering its callbacks, so it can not be cancelled
+    // while one of them is running; from another thread, e.g. the deadline timer, the block is queued on that run loop
+    NSRunLoop *runLoop = nil;
+    if ([self.httpRequest isKindOfClass:[CMISHttpRequest class]]) {
+        runLoop = ((CMISHttpRequest *)self.httpRequest).runLoop;
+    }
+    if (runLoop == nil || runLoop == [NSRunLoop currentRunLoop]) {
+        block();
+    } else {
+        CFRunLoopRef cfRunLoop = [runLoop getCFRunLoop];
+        CFRunLoopPerformBlock(cfRunLoop, kCFRunLoopCommonModes, block);
+        CFRunLoopWakeUp(cfRunLoop);
     }
 }
 
@@ -0,0 +1,34 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import "CMISSession.h"
+
+/**
+ * How the classes of the client deliver their results: the blocks of the application are called on the callback queue
+ * of the session (kCMISSessionParameterCallbackQueue) when it has one, once the response has been parsed and converted.
+ * Without a callback queue the blocks are returned as they are.
+ */
+@interface CMISSession (Internal)
+
+/// Calls the block on the callback queue, or right away when there is none or it is the current queue.
+- (void)performCallback:(void (^)(void))block;
+
+/// A block that calls the completion block with its result and error through performCallback:.
+- (void (^)(id result, id error))callbackBlock:(void (^)(id result, id error))completionBlock;
+
+- (void (^)(NSError *error))errorCallbackBlock:(void (^)(NSError *error))completionBlock;
+
+- (void (^)(BOOL result, NSError *error))boolCallbackBlock:(void (^)(BOOL result, NSError *error))completionBlock;
+
+@end
@@ -22,6 +22,7 @@
 @class CMISPagedResult;
 @class CMISTypeDefinition;
 @class CMISObjectConverter;
+@class CMISAdaptiveController;
 
 @interface CMISSession : NSObject
 
@@ -40,6 +41,9 @@
 //used for converting properties. This can be set to a custom object converter
 @property (nonatomic, strong, readonly) CMISObjectConverter *objectConverter;
 
+// tunes page sizes and concurrency, nil unless enabled with kCMISSessionParameterAdaptiveConcurrency
+@property (nonatomic, strong, readonly) CMISAdaptiveController *adaptiveController;
+
 // *** setup ***
 
 // returns an array of CMISRepositoryInfo objects representing the repositories available at the endpoint.
@@ -65,16 +69,44 @@
  
 /**
   * Retrieves the object with the given identifier.
+  * The returned request can be cancelled, or given a deadline.
   */
-- (void)retrieveObject:(NSString *)objectId
-       completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock;
+- (CMISRequest*)retrieveObject:(NSString *)objectId
+               completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock;
 
 /**
   * Retrieves the object with the given identifier, using the provided operation context.
+  * The returned request can be cancelled, or given a deadline.
+  */
+- (CMISRequest*)retrieveObject:(NSString *)objectId
+          withOperationContext:(CMISOperationContext *)operationContext
+               completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock;
+
+/**
+  * Retrieves the objects with the given identifiers, using the provided operation context.
+  * Where the repository can query, the ids are looked up in batches of 'cmis:objectId IN (...)' queries, selecting
+  * the properties of the filter of the operation context; any id not found that way is retrieved on its own, with a
+  * few requests in flight at a time. A context asking for ACLs or policies, which queries do not return, or filtering
+  * on properties of subtypes, has all objects retrieved by id.
+  * The objects array is in the order of the given ids, holding NSNull for each id that could not be retrieved;
+  * the errors dictionary holds the NSError for each of those, keyed by object id.
+  */
+- (void)retrieveObjects:(NSArray *)objectIds
+   withOperationContext:(CMISOperationContext *)operationContext
+        completionBlock:(void (^)(NSArray *objects, NSDictionary *errors))completionBlock;
+
+/**
+  * Updates the given CMISObject instances with the same properties, without retrieving them again.
+  * Where the repository supports CMIS 1.1 bulk updates, objects are updated in batches; otherwise each object is
+  * updated on its own, with a few requests in flight at a time.
+  * The results array is in the order of the given objects, holding the CMISObjectIdAndChangeToken of each updated
+  * object, or NSNull for each object that was not updated; the errors dictionary holds the NSError for each of those,
+  * keyed by object id. An object missing from the response of a bulk update, under its id or its version series, is
+  * reported as not updated.
   */
-- (void)retrieveObject:(NSString *)objectId
-  withOperationContext:(CMISOperationContext *)operationContext
-       completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock;
+- (void)bulkUpdateProperties:(NSDictionary *)properties
+                  forObjects:(NSArray *)objects
+             completionBlock:(void (^)(NSArray *results, NSDictionary *errors))completionBlock;
 
 /**
   * Retrieves the object for the given path.
@@ -116,6 +148,8 @@
 /**
  * Queries for a specific type of objects.
  * Returns a paged result set, containing CMISObject instances.
+ * With a keysetPagingProperty in the operation context, every page after the first one starts after the key of
+ * the last object seen, so deep pages cost the server the same as the first one.
  */
 - (void)queryObjectsWithTypeid:(NSString *)typeId
                withWhereClause:(NSString *)whereClause
@@ -140,6 +174,16 @@
                             completionBlock:(void (^)(NSError *error))completionBlock
                               progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
 
+/**
+ * Downloads the content of object with the provided object id to the given path,
+ * fetching up to segmentCount byte ranges of it concurrently if the server supports this.
+ */
+- (CMISRequest*)downloadContentOfCMISObject:(NSString *)objectId
+                                     toFile:(NSString *)filePath
+                               segmentCount:(NSUInteger)segmentCount
+                            completionBlock:(void (^)(NSError *error))completionBlock
+                              progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
+
 /**
  * Downloads the content of object with the provided object id to the given stream.
  */
@@ -148,15 +192,35 @@
                             completionBlock:(void (^)(NSError *error))completionBlock
                               progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
 
+/**
+ * Downloads the content of object with the provided object id to the given path, writing to disk on a background queue.
+ * Progress is reported at most once per progressInterval.
+ */
+- (CMISRequest*)downloadContentOfCMISObject:(NSString *)objectId
+                                     toFile:(NSString *)filePath
+                           progressInterval:(NSTimeInterval)progressInterval
+                            completionBlock:(void (^)(NSError *error))completionBlock
+                              progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
+
+/**
+ * Returns a stream delivering the content of the object with the provided object id as it is downloaded.
+ * At most bufferSize bytes (0 for the default) are held in memory: the download waits while the consumer is behind.
+ * Closing the stream early stops the download. The completion block is called when the download has ended.
+ * See CMISContentInputStream for how the stream may be read.
+ */
+- (NSInputStream *)inputStreamForContentOfCMISObject:(NSString *)objectId
+                                          bufferSize:(NSUInteger)bufferSize
+                                     completionBlock:(void (^)(NSError *error))completionBlock;
+
 /**
  * Creates a cmis document using the content from the file path.
  */
-- (void)createDocumentFromFilePath:(NSString *)filePath
-                      withMimeType:(NSString *)mimeType
-                    withProperties:(NSDictionary *)properties
-                          inFolder:(NSString *)folderObjectId
-                   completionBlock:(void (^)(NSString *objectId, NSError *error))completionBlock
-                     progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock;
+- (CMISRequest*)createDocumentFromFilePath:(NSString *)filePath
+                              withMimeType:(NSString *)mimeType
+                            withProperties:(NSDictionary *)properties
+                                  inFolder:(NSString *)folderObjectId
+                           completionBlock:(void (^)(NSString *objectId, NSError *error))completionBlock
+                             progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock;
 
 /**
  * Creates a cmis document using the content from the given stream.
@@ -13,6 +13,7 @@
  */
 
 #import "CMISSession.h"
+#import "CMISSession+Internal.h"
 #import "CMISConstants.h"
 #import "CMISObjectConverter.h"
 #import "CMISStandardAuthenticationProvider.h"
@@ -23,12 +24,21 @@
 #import "CMISOperationContext.h"
 #import "CMISPagedResult.h"
 #import "CMISTypeDefinition.h"
+#import "CMISContentInputStream.h"
+#import "CMISAdaptiveController.h"
+#import "CMISObject.h"
+#import "CMISDocument.h"
+#import "CMISStringInOutParameter.h"
+#import "CMISObjectIdAndChangeToken.h"
+#import "CMISKeysetQuery.h"
+#import "CMISPageLinks.h"
 
 @interface CMISSession ()
 @property (nonatomic, strong, readwrite) CMISObjectConverter *objectConverter;
 @property (nonatomic, assign, readwrite) BOOL isAuthenticated;
 @property (nonatomic, strong, readwrite) id<CMISBinding> binding;
 @property (nonatomic, strong, readwrite) CMISRepositoryInfo *repositoryInfo;
+@property (nonatomic, strong, readwrite) CMISAdaptiveController *adaptiveController;
 // Returns a CMISSession using the given session parameters.
 - (id)initWithSessionParameters:(CMISSessionParameters *)sessionParameters;
 
@@ -40,6 +50,611 @@
 - (BOOL)authenticateAndReturnError:(NSError **)error;
 @end
 
+
+#define RETRIEVE_OBJECTS_QUERY_BATCH_SIZE 50
+#define RETRIEVE_OBJECTS_MAX_CONCURRENT_REQUESTS 4
+
+/**
+ * Resolves a list of object ids with as few round trips as possible: ids are first looked up in batches through
+ * 'cmis:objectId IN (...)' queries, per base type, and whatever the queries did not return is retrieved by id,
+ * with a bounded number of requests in flight. Contexts asking for ACLs or policies, or filtering on properties
+ * outside the cmis: namespace, skip the queries since a query result cannot carry them.
+ */
+@interface CMISObjectsRetrieval : NSObject
+
+@property (nonatomic, strong) CMISSession *session;
+@property (nonatomic, strong) CMISOperationContext *operationContext;
+@property (nonatomic, strong) NSArray *objectIds;
+@property (nonatomic, strong) NSMutableArray *pendingObjectIds; // unique ids not resolved yet, in requested order
+@property (nonatomic, strong) NSMutableArray *unrequestedObjectIds; // pending ids not retrieved by id yet
+@property (nonatomic, strong) NSMutableDictionary *objectsById;
+@property (nonatomic, strong) NSMutableDictionary *errorsById;
+@property (nonatomic, assign) NSUInteger runningRequestCount;
+@property (nonatomic, copy) void (^completionBlock)(NSArray *objects, NSDictionary *errors);
+
+// the queries of the base type being looked up
+@property (nonatomic, strong) NSString *queryBaseTypeId;
+@property (nonatomic, strong) NSArray *remainingQueryBaseTypeIds;
+@property (nonatomic, strong) NSArray *queryBatches; // arrays of ids
+@property (nonatomic, assign) NSUInteger nextQueryBatchIndex;
+@property (nonatomic, assign) NSUInteger completedQueryBatchCount;
+@property (nonatomic, assign) BOOL queryFailed;
+@property (nonatomic, strong) NSString *querySelectList;
+
+- (id)initWithSession:(CMISSession *)session
+            objectIds:(NSArray *)objectIds
+     operationContext:(CMISOperationContext *)operationContext
+      completionBlock:(void (^)(NSArray *objects, NSDictionary *errors))completionBlock;
+
+- (void)start;
+
+@end
+
+@implementation CMISObjectsRetrieval
+
+@synthesize session = _session;
+@synthesize operationContext = _operationContext;
+@synthesize objectIds = _objectIds;
+@synthesize pendingObjectIds = _pendingObjectIds;
+@synthesize unrequestedObjectIds = _unrequestedObjectIds;
+@synthesize objectsById = _objectsById;
+@synthesize errorsById = _errorsById;
+@synthesize runningRequestCount = _runningRequestCount;
+@synthesize completionBlock = _completionBlock;
+@synthesize queryBaseTypeId = _queryBaseTypeId;
+@synthesize remainingQueryBaseTypeIds = _remainingQueryBaseTypeIds;
+@synthesize queryBatches = _queryBatches;
+@synthesize nextQueryBatchIndex = _nextQueryBatchIndex;
+@synthesize completedQueryBatchCount = _completedQueryBatchCount;
+@synthesize queryFailed = _queryFailed;
+@synthesize querySelectList = _querySelectList;
+
+- (id)initWithSession:(CMISSession *)session
+            objectIds:(NSArray *)objectIds
+     operationContext:(CMISOperationContext *)operationContext
+      completionBlock:(void (^)(NSArray *objects, NSDictionary *errors))completionBlock
+{
+    self = [super init];
+    if (self) {
+        self.session = session;
+        self.objectIds = objectIds;
+        self.operationContext = operationContext;
+        self.completionBlock = completionBlock;
+        self.objectsById = [NSMutableDictionary dictionaryWithCapacity:objectIds.count];
+        self.errorsById = [NSMutableDictionary dictionary];
+        
+        self.pendingObjectIds = [NSMutableArray arrayWithCapacity:objectIds.count];
+        NSMutableSet *uniqueObjectIds = [NSMutableSet setWithCapacity:objectIds.count];
+        for (NSString *objectId in objectIds) {
+            if (![uniqueObjectIds containsObject:objectId]) {
+                [uniqueObjectIds addObject:objectId];
+                [self.pendingObjectIds addObject:objectId];
+            }
+        }
+    }
+    return self;
+}
+
+- (BOOL)repositorySupportsMetadataQuery
+{
+    NSString *capabilityQuery = [self.session.repositoryInfo.repositoryCapabilities valueForKeyPath:@"capabilityQuery"];
+    // repositories not advertising the capability are given a try: a failing query falls back to retrieval by id
+    return !([capabilityQuery isEqualToString:@"none"] || [capabilityQuery isEqualToString:@"fulltextonly"]);
+}
+
+// the properties of the filter plus the ones needed to build the objects, or nil if the filter can not be expressed
+// as a select list on the base types; properties of one base type only make the query of the other fail over to the ids
+- (NSString *)selectListForFilter:(NSString *)filter
+{
+    if (filter == nil || [[filter stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]] isEqualToString:@"*"]) {
+        return @"*";
+    }
+    
+    NSMutableArray *properties = [NSMutableArray arrayWithObjects:kCMISPropertyObjectId, kCMISPropertyObjectTypeId, kCMISPropertyBaseTypeId, nil];
+    for (NSString *filterItem in [filter componentsSeparatedByString:@","]) {
+        NSString *property = [filterItem stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        if ([property isEqualToString:@"*"]) {
+            return @"*";
+        } else if (![property hasPrefix:@"cmis:"]) {
+            return nil; // a property of a subtype, not selectable from a base type
+        } else if (![properties containsObject:property]) {
+            [properties addObject:property];
+        }
+    }
+    return [properties componentsJoinedByString:@","];
+}
+
+- (void)start
+{
+    // a query returns neither ACLs nor policy ids, so those are only had by retrieving the objects by id
+    BOOL queryable = !self.operationContext.isIncluseACLs && !self.operationContext.isIncludePolicies;
+    if (queryable) {
+        self.querySelectList = [self selectListForFilter:self.operationContext.filterString];
+        queryable = (self.querySelectList != nil);
+    }
+    
+    if (self.pendingObjectIds.count > 0 && queryable && [self repositorySupportsMetadataQuery]) {
+        NSArray *baseTypeIds = [NSArray arrayWithObjects:kCMISPropertyObjectTypeIdValueDocument, kCMISPropertyObjectTypeIdValueFolder, nil];
+        [self queryPendingObjectsOfBaseTypes:baseTypeIds];
+    } else {
+        [self retrievePendingObjects];
+    }
+}
+
+#pragma mark Batched queries
+
+- (void)queryPendingObjectsOfBaseTypes:(NSArray *)baseTypeIds
+{
+    if (baseTypeIds.count == 0 || self.pendingObjectIds.count == 0) {
+        [self retrievePendingObjects];
+        return;
+    }
+    
+    NSUInteger concurrentBatchCount = 0;
+    @synchronized(self) {
+        self.queryBaseTypeId = [baseTypeIds objectAtIndex:0];
+        self.remainingQueryBaseTypeIds = [baseTypeIds subarrayWithRange:NSMakeRange(1, baseTypeIds.count - 1)];
+        
+        NSMutableArray *batches = [NSMutableArray array];
+        for (NSUInteger index = 0; index < self.pendingObjectIds.count; index += RETRIEVE_OBJECTS_QUERY_BATCH_SIZE) {
+            NSUInteger length = MIN(RETRIEVE_OBJECTS_QUERY_BATCH_SIZE, self.pendingObjectIds.count - index);
+            [batches addObject:[self.pendingObjectIds subarrayWithRange:NSMakeRange(index, length)]];
+        }
+        self.queryBatches = batches;
+        self.nextQueryBatchIndex = 0;
+        self.completedQueryBatchCount = 0;
+        self.queryFailed = NO;
+        concurrentBatchCount = MIN(RETRIEVE_OBJECTS_MAX_CONCURRENT_REQUESTS, batches.count);
+    }
+    
+    for (NSUInteger i = 0; i < concurrentBatchCount; i++) {
+        [self queryNextBatch];
+    }
+}
+
+// a completed batch starts the next one, the last one to complete moves on to the next base type
+- (void)queryNextBatch
+{
+    NSArray *batch = nil;
+    NSString *baseTypeId = nil;
+    @synchronized(self) {
+        if (self.nextQueryBatchIndex >= self.queryBatches.count || self.queryFailed) {
+            return;
+        }
+        batch = [self.queryBatches objectAtIndex:self.nextQueryBatchIndex++];
+        baseTypeId = self.queryBaseTypeId;
+    }
+    
+    [self queryObjectIds:batch ofBaseType:baseTypeId completionBlock:^(NSError *error) {
+        BOOL baseTypeCompleted = NO;
+        BOOL queryFailed = NO;
+        NSArray *remainingBaseTypeIds = nil;
+        @synchronized(self) {
+            self.completedQueryBatchCount++;
+            if (error) {
+                log(@"Querying objects by id failed, retrieving them one by one instead: %@", error.description);
+                self.queryFailed = YES;
+            }
+            queryFailed = self.queryFailed;
+            baseTypeCompleted = (self.completedQueryBatchCount == self.nextQueryBatchIndex
+                                 && (queryFailed || self.nextQueryBatchIndex == self.queryBatches.count));
+            remainingBaseTypeIds = self.remainingQueryBaseTypeIds;
+        }
+        
+        if (!baseTypeCompleted) {
+            [self queryNextBatch];
+        } else if (queryFailed) {
+            [self retrievePendingObjects];
+        } else {
+            [self queryPendingObjectsOfBaseTypes:remainingBaseTypeIds];
+        }
+    }];
+}
+
+- (void)queryObjectIds:(NSArray *)objectIds ofBaseType:(NSString *)baseTypeId completionBlock:(void (^)(NSError *error))completionBlock
+{
+    NSMutableArray *literals = [NSMutableArray arrayWithCapacity:objectIds.count];
+    for (NSString *objectId in objectIds) {
+        [literals addObject:[CMISKeysetQuery stringLiteral:objectId]];
+    }
+    NSString *statement = [NSString stringWithFormat:@"SELECT %@ FROM %@ WHERE %@ IN (%@)",
+                           self.querySelectList, baseTypeId, kCMISPropertyObjectId, [literals componentsJoinedByString:@","]];
+    
+    [self.session.binding.discoveryService query:statement
+                               searchAllVersions:NO
+                            includeRelationShips:self.operationContext.includeRelationShips
+                                 renditionFilter:self.operationContext.renditionFilterString
+                         includeAllowableActions:self.operationContext.isIncludeAllowableActions
+                                        maxItems:[NSNumber numberWithUnsignedInteger:objectIds.count]
+                                       skipCount:[NSNumber numberWithInt:0]
+                                 completionBlock:^(CMISObjectList *objectList, NSError *error) {
+                                     if (error) {
+                                         completionBlock(error);
+                                         return;
+                                     }
+                                     for (CMISObjectData *objectData in objectList.objects) {
+                                         CMISObject *object = [self.session.objectConverter convertObject:objectData];
+                                         // ids of the result may differ from the requested ones, e.g. for versions: those are retrieved by id
+                                         if (object != nil && [objectIds containsObject:objectData.identifier]) {
+                                             [self resolveObjectId:objectData.identifier withObject:object error:nil];
+                                         }
+                                     }
+                                     completionBlock(nil);
+                                 }];
+}
+
+#pragma mark Retrieval by id
+
+- (void)retrievePendingObjects
+{
+    NSUInteger concurrentRequestCount = 0;
+    @synchronized(self) {
+        self.unrequestedObjectIds = [self.pendingObjectIds mutableCopy];
+        concurrentRequestCount = MIN(RETRIEVE_OBJECTS_MAX_CONCURRENT_REQUESTS, self.unrequestedObjectIds.count);
+    }
+    if (concurrentRequestCount == 0) {
+        [self complete];
+        return;
+    }
+    for (NSUInteger i = 0; i < concurrentRequestCount; i++) {
+        [self retrieveNextPendingObject];
+    }
+}
+
+- (void)retrieveNextPendingObject
+{
+    NSString *objectId = nil;
+    @synchronized(self) {
+        if (self.unrequestedObjectIds.count > 0) {
+            objectId = [self.unrequestedObjectIds objectAtIndex:0];
+            [self.unrequestedObjectIds removeObjectAtIndex:0];
+            self.runningRequestCount++;
+        }
+    }
+    if (objectId == nil) {
+        return;
+    }
+    
+    [self.session retrieveObject:objectId withOperationContext:self.operationContext completionBlock:^(CMISObject *object, NSError *error) {
+        if (object == nil && error == nil) {
+            error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeObjectNotFound withDetailedDescription:objectId];
+        }
+        [self resolveObjectId:objectId withObject:object error:error];
+        
+        BOOL completed = NO;
+        @synchronized(self) {
+            self.runningRequestCount--;
+            completed = (self.unrequestedObjectIds.count == 0 && self.runningRequestCount == 0);
+        }
+        if (completed) {
+            [self complete];
+        } else {
+            [self retrieveNextPendingObject];
+        }
+    }];
+}
+
+#pragma mark Results
+
+- (void)resolveObjectId:(NSString *)objectId withObject:(CMISObject *)object error:(NSError *)error
+{
+    @synchronized(self) {
+        if (object != nil) {
+            [self.objectsById setObject:object forKey:objectId];
+        } else {
+            [self.errorsById setObject:error forKey:objectId];
+        }
+        [self.pendingObjectIds removeObject:objectId];
+    }
+}
+
+- (void)complete
+{
+    NSMutableArray *objects = [NSMutableArray arrayWithCapacity:self.objectIds.count];
+    @synchronized(self) {
+        for (NSString *objectId in self.objectIds) {
+            id object = [self.objectsById objectForKey:objectId];
+            [objects addObject:(object != nil ? object : [NSNull null])];
+        }
+    }
+    self.completionBlock(objects, [self.errorsById copy]);
+    self.completionBlock = nil;
+}
+
+@end
+
+
+#define BULK_UPDATE_BATCH_SIZE 100
+#define BULK_UPDATE_MAX_CONCURRENT_REQUESTS 4
+
+/**
+ * Updates a list of objects with the same properties. The properties are converted once per object type, so a type
+ * definition is looked up once rather than for every object. Objects of a type are sent in batches of CMIS 1.1 bulk
+ * updates; a repository without those gets one update per object instead. Updated objects are not retrieved again.
+ */
+@interface CMISBulkPropertiesUpdate : NSObject
+
+@property (nonatomic, strong) CMISSession *session;
+@property (nonatomic, strong) NSDictionary *properties;
+@property (nonatomic, strong) NSArray *objects;
+@property (nonatomic, strong) NSMutableArray *objectTypes; // types of the objects, in order of first appearance
+@property (nonatomic, strong) NSMutableDictionary *objectsByObjectType;
+@property (nonatomic, strong) NSMutableDictionary *convertedPropertiesByObjectType;
+@property (nonatomic, strong) NSMutableArray *pendingBatches; // arrays of objects of one type, not requested yet
+@property (nonatomic, strong) NSMutableDictionary *resultsById;
+@property (nonatomic, strong) NSMutableDictionary *errorsById;
+@property (nonatomic, assign) NSUInteger runningRequestCount;
+@property (nonatomic, assign) BOOL bulkUpdateSupported;
+@property (nonatomic, copy) void (^completionBlock)(NSArray *results, NSDictionary *errors);
+
+- (id)initWithSession:(CMISSession *)session
+           properties:(NSDictionary *)properties
+              objects:(NSArray *)objects
+      completionBlock:(void (^)(NSArray *results, NSDictionary *errors))completionBlock;
+
+- (void)start;
+
+@end
+
+@implementation CMISBulkPropertiesUpdate
+
+@synthesize session = _session;
+@synthesize properties = _properties;
+@synthesize objects = _objects;
+@synthesize objectTypes = _objectTypes;
+@synthesize objectsByObjectType = _objectsByObjectType;
+@synthesize convertedPropertiesByObjectType = _convertedPropertiesByObjectType;
+@synthesize pendingBatches = _pendingBatches;
+@synthesize resultsById = _resultsById;
+@synthesize errorsById = _errorsById;
+@synthesize runningRequestCount = _runningRequestCount;
+@synthesize bulkUpdateSupported = _bulkUpdateSupported;
+@synthesize completionBlock = _completionBlock;
+
+- (id)initWithSession:(CMISSession *)session
+           properties:(NSDictionary *)properties
+              objects:(NSArray *)objects
+      completionBlock:(void (^)(NSArray *results, NSDictionary *errors))completionBlock
+{
+    self = [super init];
+    if (self) {
+        self.session = session;
+        self.properties = properties;
+        self.objects = objects;
+        self.completionBlock = completionBlock;
+        self.convertedPropertiesByObjectType = [NSMutableDictionary dictionary];
+        self.pendingBatches = [NSMutableArray array];
+        self.resultsById = [NSMutableDictionary dictionaryWithCapacity:objects.count];
+        self.errorsById = [NSMutableDictionary dictionary];
+        self.bulkUpdateSupported = YES;
+        
+        // every object is updated once, even if it is in the list more than once
+        self.objectTypes = [NSMutableArray array];
+        self.objectsByObjectType = [NSMutableDictionary dictionary];
+        NSMutableSet *objectIds = [NSMutableSet setWithCapacity:objects.count];
+        for (CMISObject *object in objects) {
+            if ([objectIds containsObject:object.identifier]) {
+                continue;
+            }
+            [objectIds addObject:object.identifier];
+            
+            NSMutableArray *objectsOfType = [self.objectsByObjectType objectForKey:object.objectType];
+            if (objectsOfType == nil) {
+                objectsOfType = [NSMutableArray array];
+                [self.objectsByObjectType setObject:objectsOfType forKey:object.objectType];
+                [self.objectTypes addObject:object.objectType];
+            }
+            [objectsOfType addObject:object];
+        }
+    }
+    return self;
+}
+
+- (void)start
+{
+    [self convertPropertiesForObjectTypeAtIndex:0];
+}
+
+- (void)convertPropertiesForObjectTypeAtIndex:(NSUInteger)index
+{
+    if (index >= self.objectTypes.count) {
+        [self updateObjects];
+        return;
+    }
+    
+    NSString *objectType = [self.objectTypes objectAtIndex:index];
+    [self.session.objectConverter convertProperties:self.properties forObjectTypeId:objectType completionBlock:^(CMISProperties *convertedProperties, NSError *error) {
+        NSArray *objectsOfType = [self.objectsByObjectType objectForKey:objectType];
+        if (convertedProperties) {
+            [self.convertedPropertiesByObjectType setObject:convertedProperties forKey:objectType];
+            for (NSUInteger i = 0; i < objectsOfType.count; i += BULK_UPDATE_BATCH_SIZE) {
+                NSUInteger length = MIN(BULK_UPDATE_BATCH_SIZE, objectsOfType.count - i);
+                [self.pendingBatches addObject:[objectsOfType subarrayWithRange:NSMakeRange(i, length)]];
+            }
+        } else {
+            NSError *conversionError = [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeRuntime];
+            for (CMISObject *object in objectsOfType) {
+                [self.errorsById setObject:conversionError forKey:object.identifier];
+            }
+        }
+        [self convertPropertiesForObjectTypeAtIndex:(index + 1)];
+    }];
+}
+
+#pragma mark Updates
+
+- (void)updateObjects
+{
+    if (self.pendingBatches.count == 0) {
+        [self complete];
+        return;
+    }
+    [self startRequests];
+}
+
+- (void)startRequests
+{
+    for (NSUInteger i = 0; i < BULK_UPDATE_MAX_CONCURRENT_REQUESTS; i++) {
+        [self updateNextBatch];
+    }
+}
+
+- (void)updateNextBatch
+{
+    NSArray *batch = nil;
+    BOOL useBulkUpdate = NO;
+    @synchronized(self) {
+        if (self.runningRequestCount >= BULK_UPDATE_MAX_CONCURRENT_REQUESTS || self.pendingBatches.count == 0) {
+            return;
+        }
+        batch = [self.pendingBatches objectAtIndex:0];
+        [self.pendingBatches removeObjectAtIndex:0];
+        
+        // without bulk updates, every object of a batch gets a request of its own
+        useBulkUpdate = self.bulkUpdateSupported;
+        if (!useBulkUpdate && batch.count > 1) {
+            for (NSUInteger i = batch.count - 1; i > 0; i--) {
+                [self.pendingBatches insertObject:[NSArray arrayWithObject:[batch objectAtIndex:i]] atIndex:0];
+            }
+            batch = [NSArray arrayWithObject:[batch objectAtIndex:0]];
+        }
+        self.runningRequestCount++;
+    }
+    
+    if (useBulkUpdate) {
+        [self bulkUpdateObjects:batch];
+    } else {
+        [self updateObject:[batch objectAtIndex:0]];
+    }
+}
+
+- (void)bulkUpdateObjects:(NSArray *)objects
+{
+    NSMutableArray *objectIdsAndChangeTokens = [NSMutableArray arrayWithCapacity:objects.count];
+    for (CMISObject *object in objects) {
+        [objectIdsAndChangeTokens addObject:[[CMISObjectIdAndChangeToken alloc] initWithObjectId:object.identifier changeToken:object.changeToken]];
+    }
+    
+    CMISObject *firstObject = [objects objectAtIndex:0];
+    [self.session.binding.objectService bulkUpdateProperties:[self.convertedPropertiesByObjectType objectForKey:firstObject.objectType]
+                                 forObjectIdsAndChangeTokens:objectIdsAndChangeTokens
+                                             completionBlock:^(NSArray *updatedObjectIdsAndChangeTokens, NSError *error) {
+        if ([error.domain isEqualToString:kCMISErrorDomainName] && error.code == kCMISErrorCodeNotSupported) {
+            // the batch is requested again, one object at a time, by as many requests as allowed
+            @synchronized(self) {
+                self.bulkUpdateSupported = NO;
+                [self.pendingBatches insertObject:objects atIndex:0];
+                self.runningRequestCount--;
+            }
+            [self startRequests];
+            return;
+        }
+        
+        if (error) {
+            for (CMISObject *object in objects) {
+                [self object:object updatedWithResult:nil error:error];
+            }
+        } else {
+            // a result is only ever taken for the object it names, by id or version series; the bulk update response
+            // lists the updated objects in no particular order, so an object without a matching result was not updated
+            NSMutableArray *unmatchedResults = [updatedObjectIdsAndChangeTokens mutableCopy];
+            for (CMISObject *object in objects) {
+                CMISObjectIdAndChangeToken *result = [self resultForObject:object inResults:unmatchedResults];
+                if (result != nil) {
+                    [unmatchedResults removeObjectIdenticalTo:result];
+                    [self object:object updatedWithResult:result error:nil];
+                } else {
+                    [self object:object updatedWithResult:nil error:[CMISErrors createCMISErrorWithCode:kCMISErrorCodeUpdateConflict
+                                                                                withDetailedDescription:@"Object was not updated by the bulk update"]];
+                }
+            }
+        }
+        [self requestCompleted];
+    }];
+}
+
+// an update creating a new version gives the object another id, the result of it is found by the old id or the version series
+- (CMISObjectIdAndChangeToken *)resultForObject:(CMISObject *)object inResults:(NSArray *)results
+{
+    for (CMISObjectIdAndChangeToken *result in results) {
+        NSString *updatedObjectId = (result.previousObjectId != nil ? result.previousObjectId : result.objectId);
+        if ([updatedObjectId isEqualToString:object.identifier]) {
+            return result;
+        }
+    }
+    
+    if ([object isKindOfClass:[CMISDocument class]]) {
+        NSString *versionSeriesId = ((CMISDocument *)object).versionSeriesId;
+        for (CMISObjectIdAndChangeToken *result in results) {
+            if (versionSeriesId != nil && [result.versionSeriesId isEqualToString:versionSeriesId]) {
+                return result;
+            }
+        }
+    }
+    return nil;
+}
+
+- (void)updateObject:(CMISObject *)object
+{
+    CMISStringInOutParameter *objectIdInOutParam = [CMISStringInOutParameter inOutParameterUsingInParameter:object.identifier];
+    CMISStringInOutParameter *changeTokenInOutParam = [CMISStringInOutParameter inOutParameterUsingInParameter:object.changeToken];
+    [self.session.binding.objectService updatePropertiesForObject:objectIdInOutParam
+                                                   withProperties:[self.convertedPropertiesByObjectType objectForKey:object.objectType]
+                                                  withChangeToken:changeTokenInOutParam
+                                                  completionBlock:^(NSError *error) {
+        CMISObjectIdAndChangeToken *result = nil;
+        if (error == nil) {
+            // the updated object is not retrieved: its id and change token come with the response of the update
+            NSString *objectId = (objectIdInOutParam.outParameter != nil ? objectIdInOutParam.outParameter : object.identifier);
+            result = [[CMISObjectIdAndChangeToken alloc] initWithObjectId:objectId changeToken:changeTokenInOutParam.outParameter];
+        }
+        [self object:object updatedWithResult:result error:error];
+        [self requestCompleted];
+    }];
+}
+
+#pragma mark Results
+
+- (void)object:(CMISObject *)object updatedWithResult:(CMISObjectIdAndChangeToken *)result error:(NSError *)error
+{
+    @synchronized(self) {
+        if (result != nil) {
+            [self.resultsById setObject:result forKey:object.identifier];
+        } else {
+            [self.errorsById setObject:[CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeUpdateConflict] forKey:object.identifier];
+        }
+    }
+}
+
+- (void)requestCompleted
+{
+    BOOL completed = NO;
+    @synchronized(self) {
+        self.runningRequestCount--;
+        completed = (self.pendingBatches.count == 0 && self.runningRequestCount == 0);
+    }
+    if (completed) {
+        [self complete];
+    } else {
+        [self updateNextBatch];
+    }
+}
+
+- (void)complete
+{
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:self.objects.count];
+    @synchronized(self) {
+        for (CMISObject *object in self.objects) {
+            id result = [self.resultsById objectForKey:object.identifier];
+            [results addObject:(result != nil ? result : [NSNull null])];
+        }
+    }
+    self.completionBlock(results, [self.errorsById copy]);
+    self.completionBlock = nil;
+}
+
+@end
+
 @implementation CMISSession
 
 @synthesize isAuthenticated = _isAuthenticated;
@@ -47,6 +662,7 @@
 @synthesize repositoryInfo = _repositoryInfo;
 @synthesize sessionParameters = _sessionParameters;
 @synthesize objectConverter = _objectConverter;
+@synthesize adaptiveController = _adaptiveController;
 
 #pragma mark -
 #pragma mark Setup
@@ -54,6 +670,7 @@
 + (void)arrayOfRepositories:(CMISSessionParameters *)sessionParameters completionBlock:(void (^)(NSArray *repositories, NSError *error))completionBlock
 {
     CMISSession *session = [[CMISSession alloc] initWithSessionParameters:sessionParameters];
+    completionBlock = [session callbackBlock:completionBlock];
     
     // TODO: validate session parameters?
     
@@ -116,6 +733,11 @@
         {
             self.objectConverter = [[CMISObjectConverter alloc] initWithSession:self];
         }
+        
+        if ([[self.sessionParameters objectForKey:kCMISSessionParameterAdaptiveConcurrency] boolValue])
+        {
+            self.adaptiveController = [[CMISAdaptiveController alloc] init];
+        }
     
         // TODO: setup locale
         // TODO: setup default session parameters
@@ -127,6 +749,7 @@
 
 - (void)authenticateWithCompletionBlock:(void (^)(CMISSession *session, NSError * error))completionBlock
 {
+    completionBlock = [self callbackBlock:completionBlock];
     // TODO: validate session parameters, extract the checks below?
     
     // check repository id is present
@@ -181,6 +804,7 @@
 
 - (void)retrieveFolderWithOperationContext:(CMISOperationContext *)operationContext completionBlock:(void (^)(CMISFolder *folder, NSError *error))completionBlock
 {
+    completionBlock = [self callbackBlock:completionBlock];
     NSString *rootFolderId = self.repositoryInfo.rootFolderId;
     [self retrieveObject:rootFolderId withOperationContext:operationContext completionBlock:^(CMISObject *rootFolder, NSError *error) {
         if (rootFolder != nil && ![rootFolder isKindOfClass:[CMISFolder class]]) {
@@ -191,39 +815,83 @@
     }];
 }
 
-- (void)retrieveObject:(NSString *)objectId completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock
+- (CMISRequest*)retrieveObject:(NSString *)objectId completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock
 {
-    [self retrieveObject:objectId withOperationContext:[CMISOperationContext defaultOperationContext] completionBlock:completionBlock];
+    return [self retrieveObject:objectId withOperationContext:[CMISOperationContext defaultOperationContext] completionBlock:completionBlock];
 }
 
-- (void)retrieveObject:(NSString *)objectId withOperationContext:(CMISOperationContext *)operationContext completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock
+- (CMISRequest*)retrieveObject:(NSString *)objectId withOperationContext:(CMISOperationContext *)operationContext completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock
 {
+    completionBlock = [self callbackBlock:completionBlock];
     if (objectId == nil)
     {
         completionBlock(nil, [CMISErrors createCMISErrorWithCode:kCMISErrorCodeInvalidArgument withDetailedDescription:@"Must provide object id"]);
-        return;
+        return nil;
     }
 
     // TODO: cache the object
 
-    [self.binding.objectService retrieveObject:objectId
-                                    withFilter:operationContext.filterString
-                       andIncludeRelationShips:operationContext.includeRelationShips
-                           andIncludePolicyIds:operationContext.isIncludePolicies
-                            andRenditionFilder:operationContext.renditionFilterString
-                                 andIncludeACL:operationContext.isIncluseACLs
-                    andIncludeAllowableActions:operationContext.isIncludeAllowableActions
-                               completionBlock:^(CMISObjectData *objectData, NSError *error) {
-                                            if (error) {
-                                                completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
-                                            } else {
-                                                CMISObject *object = nil;
-                                                if (objectData) {
-                                                    object = [self.objectConverter convertObject:objectData];
-                                                }
-                                                completionBlock(object, nil);
-                                            }
-                                        }];
+    return [self.binding.objectService retrieveObject:objectId
+                                           withFilter:operationContext.filterString
+                              andIncludeRelationShips:operationContext.includeRelationShips
+                                  andIncludePolicyIds:operationContext.isIncludePolicies
+                                   andRenditionFilder:operationContext.renditionFilterString
+                                        andIncludeACL:operationContext.isIncluseACLs
+                           andIncludeAllowableActions:operationContext.isIncludeAllowableActions
+                                      completionBlock:^(CMISObjectData *objectData, NSError *error) {
+                                                   if (error) {
+                                                       completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeObjectNotFound]);
+                                                   } else {
+                                                       CMISObject *object = nil;
+                                                       if (objectData) {
+                                                           object = [self.objectConverter convertObject:objectData];
+                                                       }
+                                                       completionBlock(object, nil);
+                                                   }
+                                               }];
+}
+
+- (void)retrieveObjects:(NSArray *)objectIds
+  withOperationContext:(CMISOperationContext *)operationContext
+       completionBlock:(void (^)(NSArray *objects, NSDictionary *errors))completionBlock
+{
+    completionBlock = [self callbackBlock:completionBlock];
+    if (objectIds == nil)
+    {
+        completionBlock(nil, [NSDictionary dictionary]);
+        return;
+    }
+    
+    CMISObjectsRetrieval *retrieval = [[CMISObjectsRetrieval alloc] initWithSession:self
+                                                                          objectIds:objectIds
+                                                                   operationContext:operationContext
+                                                                    completionBlock:completionBlock];
+    [retrieval start];
+}
+
+- (void)bulkUpdateProperties:(NSDictionary *)properties
+                  forObjects:(NSArray *)objects
+             completionBlock:(void (^)(NSArray *results, NSDictionary *errors))completionBlock
+{
+    completionBlock = [self callbackBlock:completionBlock];
+    if (!properties || properties.count == 0)
+    {
+        NSError *error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeInvalidArgument withDetailedDescription:@"Properties cannot be nil or empty"];
+        NSMutableArray *results = [NSMutableArray arrayWithCapacity:objects.count];
+        NSMutableDictionary *errors = [NSMutableDictionary dictionaryWithCapacity:objects.count];
+        for (CMISObject *object in objects) {
+            [results addObject:[NSNull null]];
+            [errors setObject:error forKey:object.identifier];
+        }
+        completionBlock(results, errors);
+        return;
+    }
+    
+    CMISBulkPropertiesUpdate *update = [[CMISBulkPropertiesUpdate alloc] initWithSession:self
+                                                                              properties:properties
+                                                                                 objects:objects
+                                                                         completionBlock:completionBlock];
+    [update start];
 }
 
 - (void)retrieveObjectByPath:(NSString *)path completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock
@@ -233,6 +901,7 @@
 
 - (void)retrieveObjectByPath:(NSString *)path withOperationContext:(CMISOperationContext *)operationContext completionBlock:(void (^)(CMISObject *object, NSError *error))completionBlock
 {
+    completionBlock = [self callbackBlock:completionBlock];
     [self.binding.objectService retrieveObjectByPath:path
                                           withFilter:operationContext.filterString
                              andIncludeRelationShips:operationContext.includeRelationShips
@@ -254,6 +923,7 @@
 
 - (void)retrieveTypeDefinition:(NSString *)typeId completionBlock:(void (^)(CMISTypeDefinition *typeDefinition, NSError *error))completionBlock
 {
+    completionBlock = [self callbackBlock:completionBlock];
     return [self.binding.repositoryService retrieveTypeDefinition:typeId completionBlock:completionBlock];
 }
 
@@ -266,34 +936,46 @@
                                      operationContext:(CMISOperationContext *)operationContext
                                       completionBlock:(void (^)(CMISPagedResult *pagedResult, NSError *error))completionBlock
 {
+    completionBlock = [self callbackBlock:completionBlock];
+    // pages after the first follow the next link of the page before them, kept for this query only
+    CMISPageLinks *pageLinks = [[CMISPageLinks alloc] init];
     CMISFetchNextPageBlock fetchNextPageBlock = ^(int skipCount, int maxItems, CMISFetchNextPageBlockCompletionBlock pageBlockCompletionBlock)
     {
-        // Fetch results through discovery service
-        [self.binding.discoveryService query:statement
-                                                  searchAllVersions:searchAllVersion
-                                                  includeRelationShips:operationContext.includeRelationShips
-                                                  renditionFilter:operationContext.renditionFilterString
-                                                  includeAllowableActions:operationContext.isIncludeAllowableActions
-                                                  maxItems:[NSNumber numberWithInt:maxItems]
-                                                  skipCount:[NSNumber numberWithInt:skipCount]
-                                                  completionBlock:^(CMISObjectList *objectList, NSError *error) {
-                                                      if (error) {
-                                                          pageBlockCompletionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeRuntime]);
-                                                      } else {
-                                                          // Fill up return result
-                                                          CMISFetchNextPageBlockResult *result = [[CMISFetchNextPageBlockResult alloc] init];
-                                                          result.hasMoreItems = objectList.hasMoreItems;
-                                                          result.numItems = objectList.numItems;
-                                                          
-                                                          NSMutableArray *resultArray = [[NSMutableArray alloc] init];
-                                                          result.resultArray = resultArray;
-                                                          for (CMISObjectData *objectData in objectList.objects)
-                                                          {
-                                                              [resultArray addObject:[CMISQueryResult queryResultUsingCmisObjectData:objectData andWithSession:self]];
-                                                          }
-                                                          pageBlockCompletionBlock(result, nil);
-                                                      }
-                                                  }];
+        // the paged result keeps its pages on the callback queue, where its completion block is called too
+        pageBlockCompletionBlock = [self callbackBlock:pageBlockCompletionBlock];
+        [CMISAdaptiveController performOperationOfClass:kCMISOperationClassQuery
+                                         withController:self.adaptiveController
+                                      requestedPageSize:maxItems
+                                             usingBlock:^(NSInteger pageSize, void (^operationCompletionBlock)(NSUInteger itemCount, NSError *error)) {
+            // Fetch results through discovery service
+            [self.binding.discoveryService query:statement
+                               searchAllVersions:searchAllVersion
+                            includeRelationShips:operationContext.includeRelationShips
+                                 renditionFilter:operationContext.renditionFilterString
+                         includeAllowableActions:operationContext.isIncludeAllowableActions
+                                        maxItems:[NSNumber numberWithInteger:pageSize]
+                                       skipCount:[NSNumber numberWithInt:skipCount]
+                                       pageLinks:pageLinks
+                                 completionBlock:^(CMISObjectList *objectList, NSError *error) {
+                                     operationCompletionBlock(objectList.objects.count, error);
+                                     if (error) {
+                                         pageBlockCompletionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeRuntime]);
+                                     } else {
+                                         // Fill up return result
+                                         CMISFetchNextPageBlockResult *result = [[CMISFetchNextPageBlockResult alloc] init];
+                                         result.hasMoreItems = objectList.hasMoreItems;
+                                         result.numItems = objectList.numItems;
+                                         
+                                         NSMutableArray *resultArray = [[NSMutableArray alloc] init];
+                                         result.resultArray = resultArray;
+                                         for (CMISObjectData *objectData in objectList.objects)
+                                         {
+                                             [resultArray addObject:[CMISQueryResult queryResultUsingCmisObjectData:objectData andWithSession:self]];
+                                         }
+                                         pageBlockCompletionBlock(result, nil);
+                                     }
+                                 }];
+        }];
     };
 
     [CMISPagedResult pagedResultUsingFetchBlock:fetchNextPageBlock
@@ -315,6 +997,16 @@
                       operationContext:(CMISOperationContext *)operationContext
                        completionBlock:(void (^)(CMISPagedResult *result, NSError *error))completionBlock
 {
+    completionBlock = [self callbackBlock:completionBlock];
+    CMISKeysetQuery *keysetQuery = nil;
+    if (operationContext.keysetPagingProperty != nil) {
+        if ([CMISKeysetQuery canPageTypeDefinition:typeDefinition byProperty:operationContext.keysetPagingProperty]) {
+            keysetQuery = [[CMISKeysetQuery alloc] initWithTypeDefinition:typeDefinition whereClause:whereClause operationContext:operationContext];
+        } else {
+            log(@"Cannot page %@ by %@, paging by skip count instead", typeDefinition.queryName, operationContext.keysetPagingProperty);
+        }
+    }
+    
     // Creating the cmis query using the input params
     NSMutableString *statement = [[NSMutableString alloc] init];
     
@@ -336,35 +1028,54 @@
         [statement appendFormat:@" ORDER BY %@", operationContext.orderBy];
     }
     
+    // A next link continues the statement of its page, so with keyset paging, where every page has its own, there are none to follow
+    CMISPageLinks *pageLinks = (keysetQuery == nil ? [[CMISPageLinks alloc] init] : nil);
+    
     // Fetch block for paged results
     CMISFetchNextPageBlock fetchNextPageBlock = ^(int skipCount, int maxItems, CMISFetchNextPageBlockCompletionBlock pageBlockCompletionBlock)
     {
-        // Fetch results through discovery service
-        [self.binding.discoveryService query:statement
-                           searchAllVersions:searchAllVersion
-                        includeRelationShips:operationContext.includeRelationShips
-                             renditionFilter:operationContext.renditionFilterString
-                     includeAllowableActions:operationContext.isIncludeAllowableActions
-                                    maxItems:[NSNumber numberWithInt:maxItems]
-                                   skipCount:[NSNumber numberWithInt:skipCount]
-                             completionBlock:^(CMISObjectList *objectList, NSError *error) {
-                                 if (error) {
-                                     pageBlockCompletionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeRuntime]);
-                                 } else {
-                                     // Fill up return result
-                                     CMISFetchNextPageBlockResult *result = [[CMISFetchNextPageBlockResult alloc] init];
-                                     result.hasMoreItems = objectList.hasMoreItems;
-                                     result.numItems = objectList.numItems;
-                                     
-                                     NSMutableArray *resultArray = [[NSMutableArray alloc] init];
-                                     result.resultArray = resultArray;
-                                     for (CMISObjectData *objectData in objectList.objects)
-                                     {
-                                         [resultArray addObject:[self.objectConverter convertObject:objectData]];
+        pageBlockCompletionBlock = [self callbackBlock:pageBlockCompletionBlock];
+        [CMISAdaptiveController performOperationOfClass:kCMISOperationClassQuery
+                                         withController:self.adaptiveController
+                                      requestedPageSize:maxItems
+                                             usingBlock:^(NSInteger pageSize, void (^operationCompletionBlock)(NSUInteger itemCount, NSError *error)) {
+            // With keyset paging, a page following a fetched one is asked for by key rather than by skip count
+            NSString *pageStatement = statement;
+            NSInteger pageSkipCount = skipCount;
+            if (keysetQuery != nil) {
+                pageStatement = [keysetQuery statementForSkipCount:skipCount remainingSkipCount:&pageSkipCount];
+            }
+            
+            // Fetch results through discovery service
+            [self.binding.discoveryService query:pageStatement
+                               searchAllVersions:searchAllVersion
+                            includeRelationShips:operationContext.includeRelationShips
+                                 renditionFilter:operationContext.renditionFilterString
+                         includeAllowableActions:operationContext.isIncludeAllowableActions
+                                        maxItems:[NSNumber numberWithInteger:pageSize]
+                                       skipCount:[NSNumber numberWithInteger:pageSkipCount]
+                                       pageLinks:pageLinks
+                                 completionBlock:^(CMISObjectList *objectList, NSError *error) {
+                                     operationCompletionBlock(objectList.objects.count, error);
+                                     if (error) {
+                                         pageBlockCompletionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeRuntime]);
+                                     } else {
+                                         // Fill up return result
+                                         CMISFetchNextPageBlockResult *result = [[CMISFetchNextPageBlockResult alloc] init];
+                                         result.hasMoreItems = objectList.hasMoreItems;
+                                         result.numItems = objectList.numItems;
+                                         
+                                         NSMutableArray *resultArray = [[NSMutableArray alloc] init];
+                                         result.resultArray = resultArray;
+                                         for (CMISObjectData *objectData in objectList.objects)
+                                         {
+                                             [resultArray addObject:[self.objectConverter convertObject:objectData]];
+                                         }
+                                         [keysetQuery addPage:resultArray atSkipCount:skipCount];
+                                         pageBlockCompletionBlock(result, nil);
                                      }
-                                     pageBlockCompletionBlock(result, nil);
-                                 }
-                             }];
+                                 }];
+        }];
     };
     
     [CMISPagedResult pagedResultUsingFetchBlock:fetchNextPageBlock
@@ -386,6 +1097,7 @@
               operationContext:(CMISOperationContext *)operationContext
                completionBlock:(void (^)(CMISPagedResult *result, NSError *error))completionBlock
 {
+    completionBlock = [self callbackBlock:completionBlock];
     [self retrieveTypeDefinition:typeId
                  completionBlock:^(CMISTypeDefinition *typeDefinition, NSError *internalError) {
                      if (internalError != nil) {
@@ -405,6 +1117,7 @@
             inFolder:(NSString *)folderObjectId
      completionBlock:(void (^)(NSString *objectId, NSError *error))completionBlock
 {
+    completionBlock = [self callbackBlock:completionBlock];
     [self.objectConverter convertProperties:properties
                             forObjectTypeId:[properties objectForKey:kCMISPropertyObjectTypeId]
                             completionBlock:^(CMISProperties *convertedProperties, NSError *error) {
@@ -425,6 +1138,7 @@
                             completionBlock:(void (^)(NSError *error))completionBlock
                               progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
 {
+    completionBlock = [self errorCallbackBlock:completionBlock];
     return [self.binding.objectService downloadContentOfObject:objectId
                                                   withStreamId:nil
                                                         toFile:filePath
@@ -432,11 +1146,27 @@
                                                  progressBlock:progressBlock];
 }
 
+- (CMISRequest*)downloadContentOfCMISObject:(NSString *)objectId
+                                     toFile:(NSString *)filePath
+                               segmentCount:(NSUInteger)segmentCount
+                            completionBlock:(void (^)(NSError *error))completionBlock
+                              progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+{
+    completionBlock = [self errorCallbackBlock:completionBlock];
+    return [self.binding.objectService downloadContentOfObject:objectId
+                                                  withStreamId:nil
+                                                        toFile:filePath
+                                                  segmentCount:segmentCount
+                                               completionBlock:completionBlock
+                                                 progressBlock:progressBlock];
+}
+
 - (CMISRequest*)downloadContentOfCMISObject:(NSString *)objectId
                              toOutputStream:(NSOutputStream *)outputStream
                             completionBlock:(void (^)(NSError *error))completionBlock
                               progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
 {
+    completionBlock = [self errorCallbackBlock:completionBlock];
     return [self.binding.objectService downloadContentOfObject:objectId
                                                   withStreamId:nil
                                                 toOutputStream:outputStream
@@ -444,12 +1174,43 @@
                                                  progressBlock:progressBlock];
 }
 
+- (CMISRequest*)downloadContentOfCMISObject:(NSString *)objectId
+                                     toFile:(NSString *)filePath
+                           progressInterval:(NSTimeInterval)progressInterval
+                            completionBlock:(void (^)(NSError *error))completionBlock
+                              progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+{
+    completionBlock = [self errorCallbackBlock:completionBlock];
+    return [self.binding.objectService downloadContentOfObject:objectId
+                                                  withStreamId:nil
+                                                        toFile:filePath
+                                              progressInterval:progressInterval
+                                               completionBlock:completionBlock
+                                                 progressBlock:progressBlock];
+}
+
+- (NSInputStream *)inputStreamForContentOfCMISObject:(NSString *)objectId
+                                          bufferSize:(NSUInteger)bufferSize
+                                     completionBlock:(void (^)(NSError *error))completionBlock
+{
+    completionBlock = [self errorCallbackBlock:completionBlock];
+    CMISContentInputStream *inputStream = [[CMISContentInputStream alloc] initWithBufferSize:bufferSize];
+    [self.binding.objectService downloadContentOfObject:objectId
+                                           withStreamId:nil
+                                                 toSink:inputStream
+                                        completionBlock:completionBlock
+                                          progressBlock:nil];
+    return inputStream;
+}
+
 
-- (void)createDocumentFromFilePath:(NSString *)filePath withMimeType:(NSString *)mimeType
-                    withProperties:(NSDictionary *)properties inFolder:(NSString *)folderObjectId
-                   completionBlock:(void (^)(NSString *objectId, NSError *error))completionBlock
-                     progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock
+- (CMISRequest*)createDocumentFromFilePath:(NSString *)filePath withMimeType:(NSString *)mimeType
+                            withProperties:(NSDictionary *)properties inFolder:(NSString *)folderObjectId
+                           completionBlock:(void (^)(NSString *objectId, NSError *error))completionBlock
+                             progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock
 {
+    completionBlock = [self callbackBlock:completionBlock];
+    CMISRequest *request = [[CMISRequest alloc] init];
     [self.objectConverter convertProperties:properties
                             forObjectTypeId:[properties objectForKey:kCMISPropertyObjectTypeId]
                             completionBlock:^(CMISProperties *convertedProperties, NSError *error) {
@@ -458,15 +1219,21 @@
             if (completionBlock) {
                 completionBlock(nil, [CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeRuntime]);
             }
+        } else if (request.isCancelled) {
+            if (completionBlock) {
+                completionBlock(nil, [request cancellationError]);
+            }
         } else {
-            [self.binding.objectService createDocumentFromFilePath:filePath
-                                                      withMimeType:mimeType
-                                                    withProperties:convertedProperties
-                                                      inFolder:folderObjectId
-                                                   completionBlock:completionBlock
-                                                     progressBlock:progressBlock];
+            // our request holds the object service request and passes its deadline on to it
+            request.httpRequest = [self.binding.objectService createDocumentFromFilePath:filePath
+                                                                            withMimeType:mimeType
+                                                                          withProperties:convertedProperties
+                                                                                inFolder:folderObjectId
+                                                                         completionBlock:completionBlock
+                                                                           progressBlock:progressBlock];
         }
     }];
+    return request;
 }
 
 - (void)createDocumentFromInputStream:(NSInputStream *)inputStream
@@ -477,6 +1244,7 @@
                       completionBlock:(void (^)(NSString *objectId, NSError *error))completionBlock
                         progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock
 {
+    completionBlock = [self callbackBlock:completionBlock];
     [self.objectConverter convertProperties:properties
                             forObjectTypeId:[properties objectForKey:kCMISPropertyObjectTypeId]
                             completionBlock:^(CMISProperties *convertedProperties, NSError *error) {
@@ -498,3 +1266,53 @@
 }
 
 @end
+
+@implementation CMISSession (Internal)
+
+- (void)performCallback:(void (^)(void))block
+{
+    NSOperationQueue *callbackQueue = [self.sessionParameters objectForKey:kCMISSessionParameterCallbackQueue];
+    if (callbackQueue == nil || [NSOperationQueue currentQueue] == callbackQueue) {
+        block();
+    } else {
+        [callbackQueue addOperationWithBlock:block];
+    }
+}
+
+- (void (^)(id result, id error))callbackBlock:(void (^)(id result, id error))completionBlock
+{
+    if (completionBlock == nil || [self.sessionParameters objectForKey:kCMISSessionParameterCallbackQueue] == nil) {
+        return completionBlock;
+    }
+    return ^(id result, id error) {
+        [self performCallback:^{
+            completionBlock(result, error);
+        }];
+    };
+}
+
+- (void (^)(NSError *error))errorCallbackBlock:(void (^)(NSError *error))completionBlock
+{
+    if (completionBlock == nil || [self.sessionParameters objectForKey:kCMISSessionParameterCallbackQueue] == nil) {
+        return completionBlock;
+    }
+    return ^(NSError *error) {
+        [self performCallback:^{
+            completionBlock(error);
+        }];
+    };
+}
+
+- (void (^)(BOOL result, NSError *error))boolCallbackBlock:(void (^)(BOOL result, NSError *error))completionBlock
+{
+    if (completionBlock == nil || [self.sessionParameters objectForKey:kCMISSessionParameterCallbackQueue] == nil) {
+        return completionBlock;
+    }
+    return ^(BOOL result, NSError *error) {
+        [self performCallback:^{
+            completionBlock(result, error);
+        }];
+    };
+}
+
+@end
@@ -0,0 +1,137 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class CMISSession;
+@class CMISTransfer;
+
+typedef enum
+{
+    CMISTransferTypeUpload,
+    CMISTransferTypeDownload
+} CMISTransferType;
+
+typedef enum
+{
+    CMISTransferStateQueued,
+    CMISTransferStateRunning,
+    CMISTransferStateCompleted,
+    CMISTransferStateFailed,
+    CMISTransferStateCancelled
+} CMISTransferState;
+
+typedef void (^CMISTransferCompletionBlock)(CMISTransfer *transfer, NSError *error);
+typedef void (^CMISTransferProgressBlock)(unsigned long long bytesTransferred, unsigned long long bytesTotal);
+
+/**
+ * An upload or download queued in a CMISTransferManager.
+ */
+@interface CMISTransfer : NSObject
+
+@property (nonatomic, strong, readonly) NSString *identifier;
+@property (nonatomic, assign, readonly) CMISTransferType type;
+@property (nonatomic, strong, readonly) NSString *filePath;
+
+// the object downloaded, or the document created by a completed upload
+@property (nonatomic, strong, readonly) NSString *objectId;
+
+// upload parameters
+@property (nonatomic, strong, readonly) NSString *folderObjectId;
+@property (nonatomic, strong, readonly) NSString *mimeType;
+@property (nonatomic, strong, readonly) NSDictionary *properties;
+
+// transfers with a higher priority are started first, equal priorities in the order they were queued
+@property (nonatomic, assign, readonly) NSInteger priority;
+
+// bytes per second, 0 for unlimited. Can be changed while the transfer runs
+@property (nonatomic, assign) double bandwidthLimit;
+
+@property (nonatomic, assign, readonly) CMISTransferState state;
+@property (nonatomic, assign, readonly) unsigned long long bytesTransferred;
+@property (nonatomic, assign, readonly) unsigned long long bytesTotal;
+@property (nonatomic, strong, readonly) NSError *error;
+
+@property (nonatomic, copy) CMISTransferCompletionBlock completionBlock;
+@property (nonatomic, copy) CMISTransferProgressBlock progressBlock;
+
+@end
+
+
+/**
+ * Runs uploads and downloads of a session in one queue: at most maximumConcurrentTransfers at once, highest priority first,
+ * with the transfer rate shaped by token buckets, globally and per transfer. A transfer over its rate is suspended
+ * until the bucket has refilled, which holds the server back through TCP flow control.
+ *
+ * The queued and running transfers are kept in a journal (a property list at journalPath), written whenever a transfer
+ * is queued or finishes, so a new manager can pick them up after the process was restarted.
+ * Downloads then continue where they stopped (see the resume record of CMISObjectService); uploads start again,
+ * unless an upload that had been sent already finds a document of its name and size in the target folder, which
+ * it then reports as its result rather than creating a duplicate.
+ *
+ * The manager must be used from a single thread with a running run loop, the one the transfers are performed on.
+ * If the session has a callback queue (kCMISSessionParameterCallbackQueue), use the main queue and the main thread.
+ */
+@interface CMISTransferManager : NSObject
+
+@property (nonatomic, strong, readonly) CMISSession *session;
+@property (nonatomic, strong, readonly) NSString *journalPath;
+
+// Defaults to 2
+@property (nonatomic, assign) NSUInteger maximumConcurrentTransfers;
+
+// bytes per second shared by all transfers, 0 for unlimited (the default)
+@property (nonatomic, assign) double globalBandwidthLimit;
+
+// the queued and running transfers
+@property (nonatomic, strong, readonly) NSArray *transfers;
+
+// journalPath can be nil, in which case nothing is persisted
+- (id)initWithSession:(CMISSession *)session journalPath:(NSString *)journalPath;
+
+/**
+ * Queues the creation of a document from the given file. The properties are journaled, so they should
+ * only contain property list types; otherwise the transfer runs but is not recovered after a restart.
+ */
+- (CMISTransfer *)enqueueUploadOfFile:(NSString *)filePath
+                         withMimeType:(NSString *)mimeType
+                       withProperties:(NSDictionary *)properties
+                             inFolder:(NSString *)folderObjectId
+                             priority:(NSInteger)priority
+                       bandwidthLimit:(double)bandwidthLimit
+                      completionBlock:(CMISTransferCompletionBlock)completionBlock
+                        progressBlock:(CMISTransferProgressBlock)progressBlock;
+
+/**
+ * Queues the download of the content of the given object to the given file.
+ */
+- (CMISTransfer *)enqueueDownloadOfObject:(NSString *)objectId
+                                   toFile:(NSString *)filePath
+                                 priority:(NSInteger)priority
+                           bandwidthLimit:(double)bandwidthLimit
+                          completionBlock:(CMISTransferCompletionBlock)completionBlock
+                            progressBlock:(CMISTransferProgressBlock)progressBlock;
+
+/**
+ * Queues again the transfers left unfinished in the journal, by an earlier manager or process,
+ * and returns them. The completion block is set on each of them.
+ */
+- (NSArray *)resumeJournaledTransfersWithCompletionBlock:(CMISTransferCompletionBlock)completionBlock;
+
+// the completion block of a cancelled transfer is called with a kCMISErrorCodeCancelled error
+- (void)cancelTransfer:(CMISTransfer *)transfer;
+
+- (void)cancelAllTransfers;
+
+@end
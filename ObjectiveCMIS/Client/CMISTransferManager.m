@@ -0,0 +1,511 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISTransferManager.h"
+#import "CMISSession.h"
+#import "CMISRequest.h"
+#import "CMISTokenBucket.h"
+#import "CMISDownloadResumeRecord.h"
+#import "CMISErrors.h"
+#import "CMISConstants.h"
+#import "CMISFolder.h"
+#import "CMISDocument.h"
+#import "CMISFileUtil.h"
+
+#define DEFAULT_MAXIMUM_CONCURRENT_TRANSFERS 2
+
+// journal entry keys
+NSString * const kCMISTransferJournalIdentifier = @"identifier";
+NSString * const kCMISTransferJournalType = @"type";
+NSString * const kCMISTransferJournalFilePath = @"filePath";
+NSString * const kCMISTransferJournalObjectId = @"objectId";
+NSString * const kCMISTransferJournalFolderObjectId = @"folderObjectId";
+NSString * const kCMISTransferJournalMimeType = @"mimeType";
+NSString * const kCMISTransferJournalProperties = @"properties";
+NSString * const kCMISTransferJournalPriority = @"priority";
+NSString * const kCMISTransferJournalBandwidthLimit = @"bandwidthLimit";
+NSString * const kCMISTransferJournalUploadStarted = @"uploadStarted";
+
+@interface CMISTransfer ()
+
+@property (nonatomic, strong, readwrite) NSString *identifier;
+@property (nonatomic, assign, readwrite) CMISTransferType type;
+@property (nonatomic, strong, readwrite) NSString *filePath;
+@property (nonatomic, strong, readwrite) NSString *objectId;
+@property (nonatomic, strong, readwrite) NSString *folderObjectId;
+@property (nonatomic, strong, readwrite) NSString *mimeType;
+@property (nonatomic, strong, readwrite) NSDictionary *properties;
+@property (nonatomic, assign, readwrite) NSInteger priority;
+@property (nonatomic, assign, readwrite) CMISTransferState state;
+@property (nonatomic, assign, readwrite) unsigned long long bytesTransferred;
+@property (nonatomic, assign, readwrite) unsigned long long bytesTotal;
+@property (nonatomic, strong, readwrite) NSError *error;
+@property (nonatomic, strong) CMISTokenBucket *bucket;
+@property (nonatomic, strong) CMISRequest *request;
+@property (nonatomic, strong) NSTimer *throttleTimer;
+@property (nonatomic, assign, getter = isJournaled) BOOL journaled;
+// the upload was sent at least once, so the document may exist although no response arrived
+@property (nonatomic, assign, getter = isUploadStarted) BOOL uploadStarted;
+
+@end
+
+@implementation CMISTransfer
+
+@synthesize identifier = _identifier;
+@synthesize type = _type;
+@synthesize filePath = _filePath;
+@synthesize objectId = _objectId;
+@synthesize folderObjectId = _folderObjectId;
+@synthesize mimeType = _mimeType;
+@synthesize properties = _properties;
+@synthesize priority = _priority;
+@synthesize bandwidthLimit = _bandwidthLimit;
+@synthesize state = _state;
+@synthesize bytesTransferred = _bytesTransferred;
+@synthesize bytesTotal = _bytesTotal;
+@synthesize error = _error;
+@synthesize completionBlock = _completionBlock;
+@synthesize progressBlock = _progressBlock;
+@synthesize bucket = _bucket;
+@synthesize request = _request;
+@synthesize throttleTimer = _throttleTimer;
+@synthesize journaled = _journaled;
+@synthesize uploadStarted = _uploadStarted;
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        _identifier = [[NSProcessInfo processInfo] globallyUniqueString];
+        _state = CMISTransferStateQueued;
+        _bucket = [[CMISTokenBucket alloc] initWithRate:0];
+    }
+    return self;
+}
+
+- (void)setBandwidthLimit:(double)bandwidthLimit
+{
+    _bandwidthLimit = bandwidthLimit;
+    self.bucket.rate = bandwidthLimit;
+}
+
+- (NSDictionary *)journalEntry
+{
+    NSMutableDictionary *entry = [NSMutableDictionary dictionary];
+    [entry setObject:self.identifier forKey:kCMISTransferJournalIdentifier];
+    [entry setObject:[NSNumber numberWithInt:self.type] forKey:kCMISTransferJournalType];
+    [entry setObject:self.filePath forKey:kCMISTransferJournalFilePath];
+    [entry setObject:[NSNumber numberWithInteger:self.priority] forKey:kCMISTransferJournalPriority];
+    [entry setObject:[NSNumber numberWithDouble:self.bandwidthLimit] forKey:kCMISTransferJournalBandwidthLimit];
+    if (self.objectId) {
+        [entry setObject:self.objectId forKey:kCMISTransferJournalObjectId];
+    }
+    if (self.folderObjectId) {
+        [entry setObject:self.folderObjectId forKey:kCMISTransferJournalFolderObjectId];
+    }
+    if (self.mimeType) {
+        [entry setObject:self.mimeType forKey:kCMISTransferJournalMimeType];
+    }
+    if (self.properties) {
+        [entry setObject:self.properties forKey:kCMISTransferJournalProperties];
+    }
+    if (self.isUploadStarted) {
+        [entry setObject:[NSNumber numberWithBool:YES] forKey:kCMISTransferJournalUploadStarted];
+    }
+    return entry;
+}
+
++ (CMISTransfer *)transferWithJournalEntry:(NSDictionary *)entry
+{
+    CMISTransfer *transfer = [[CMISTransfer alloc] init];
+    transfer.identifier = [entry objectForKey:kCMISTransferJournalIdentifier];
+    transfer.type = [[entry objectForKey:kCMISTransferJournalType] intValue];
+    transfer.filePath = [entry objectForKey:kCMISTransferJournalFilePath];
+    transfer.objectId = [entry objectForKey:kCMISTransferJournalObjectId];
+    transfer.folderObjectId = [entry objectForKey:kCMISTransferJournalFolderObjectId];
+    transfer.mimeType = [entry objectForKey:kCMISTransferJournalMimeType];
+    transfer.properties = [entry objectForKey:kCMISTransferJournalProperties];
+    transfer.priority = [[entry objectForKey:kCMISTransferJournalPriority] integerValue];
+    transfer.bandwidthLimit = [[entry objectForKey:kCMISTransferJournalBandwidthLimit] doubleValue];
+    transfer.uploadStarted = [[entry objectForKey:kCMISTransferJournalUploadStarted] boolValue];
+    transfer.journaled = YES;
+    return transfer;
+}
+
+@end
+
+
+@interface CMISTransferManager ()
+
+@property (nonatomic, strong, readwrite) CMISSession *session;
+@property (nonatomic, strong, readwrite) NSString *journalPath;
+@property (nonatomic, strong) NSMutableArray *queuedTransfers; // in the order they were queued
+@property (nonatomic, strong) NSMutableArray *runningTransfers;
+@property (nonatomic, strong) CMISTokenBucket *globalBucket;
+@property (nonatomic, strong) NSMutableArray *unresumedJournalEntries; // left by an earlier manager, kept until resumed
+
+@end
+
+@implementation CMISTransferManager
+
+@synthesize session = _session;
+@synthesize journalPath = _journalPath;
+@synthesize maximumConcurrentTransfers = _maximumConcurrentTransfers;
+@synthesize globalBandwidthLimit = _globalBandwidthLimit;
+@synthesize queuedTransfers = _queuedTransfers;
+@synthesize runningTransfers = _runningTransfers;
+@synthesize globalBucket = _globalBucket;
+@synthesize unresumedJournalEntries = _unresumedJournalEntries;
+
+- (id)initWithSession:(CMISSession *)session journalPath:(NSString *)journalPath
+{
+    self = [super init];
+    if (self) {
+        _session = session;
+        _journalPath = journalPath;
+        _maximumConcurrentTransfers = DEFAULT_MAXIMUM_CONCURRENT_TRANSFERS;
+        _queuedTransfers = [NSMutableArray array];
+        _runningTransfers = [NSMutableArray array];
+        _globalBucket = [[CMISTokenBucket alloc] initWithRate:0];
+        _unresumedJournalEntries = [NSMutableArray array];
+        if (journalPath) {
+            [_unresumedJournalEntries addObjectsFromArray:[NSArray arrayWithContentsOfFile:journalPath]];
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    for (CMISTransfer *transfer in self.runningTransfers) {
+        [transfer.throttleTimer invalidate];
+    }
+}
+
+- (void)setGlobalBandwidthLimit:(double)globalBandwidthLimit
+{
+    _globalBandwidthLimit = globalBandwidthLimit;
+    self.globalBucket.rate = globalBandwidthLimit;
+}
+
+- (void)setMaximumConcurrentTransfers:(NSUInteger)maximumConcurrentTransfers
+{
+    _maximumConcurrentTransfers = maximumConcurrentTransfers;
+    [self startQueuedTransfers];
+}
+
+- (NSArray *)transfers
+{
+    return [self.runningTransfers arrayByAddingObjectsFromArray:self.queuedTransfers];
+}
+
+#pragma mark Queueing
+
+- (CMISTransfer *)enqueueUploadOfFile:(NSString *)filePath
+                         withMimeType:(NSString *)mimeType
+                       withProperties:(NSDictionary *)properties
+                             inFolder:(NSString *)folderObjectId
+                             priority:(NSInteger)priority
+                       bandwidthLimit:(double)bandwidthLimit
+                      completionBlock:(CMISTransferCompletionBlock)completionBlock
+                        progressBlock:(CMISTransferProgressBlock)progressBlock
+{
+    CMISTransfer *transfer = [[CMISTransfer alloc] init];
+    transfer.type = CMISTransferTypeUpload;
+    transfer.filePath = filePath;
+    transfer.mimeType = mimeType;
+    transfer.properties = properties;
+    transfer.folderObjectId = folderObjectId;
+    transfer.priority = priority;
+    transfer.bandwidthLimit = bandwidthLimit;
+    transfer.completionBlock = completionBlock;
+    transfer.progressBlock = progressBlock;
+    transfer.journaled = [NSPropertyListSerialization propertyList:properties isValidForFormat:NSPropertyListBinaryFormat_v1_0];
+    if (!transfer.isJournaled) {
+        log(@"Properties of upload %@ are not property list types, it will not be journaled", filePath);
+    }
+    
+    [self enqueueTransfer:transfer];
+    return transfer;
+}
+
+- (CMISTransfer *)enqueueDownloadOfObject:(NSString *)objectId
+                                   toFile:(NSString *)filePath
+                                 priority:(NSInteger)priority
+                           bandwidthLimit:(double)bandwidthLimit
+                          completionBlock:(CMISTransferCompletionBlock)completionBlock
+                            progressBlock:(CMISTransferProgressBlock)progressBlock
+{
+    CMISTransfer *transfer = [[CMISTransfer alloc] init];
+    transfer.type = CMISTransferTypeDownload;
+    transfer.objectId = objectId;
+    transfer.filePath = filePath;
+    transfer.priority = priority;
+    transfer.bandwidthLimit = bandwidthLimit;
+    transfer.completionBlock = completionBlock;
+    transfer.progressBlock = progressBlock;
+    transfer.journaled = YES;
+    
+    [self enqueueTransfer:transfer];
+    return transfer;
+}
+
+- (NSArray *)resumeJournaledTransfersWithCompletionBlock:(CMISTransferCompletionBlock)completionBlock
+{
+    NSMutableArray *resumedTransfers = [NSMutableArray array];
+    for (NSDictionary *entry in self.unresumedJournalEntries) {
+        CMISTransfer *transfer = [CMISTransfer transferWithJournalEntry:entry];
+        if (transfer.identifier == nil || transfer.filePath == nil) {
+            log(@"Skipping invalid transfer journal entry %@", entry);
+            continue;
+        }
+        
+        if (transfer.type == CMISTransferTypeDownload) {
+            // the bytes already on disk were counted by the earlier process
+            transfer.bytesTransferred = [CMISDownloadResumeRecord resumeRecordForFileAtPath:transfer.filePath].bytesWritten;
+        }
+        transfer.completionBlock = completionBlock;
+        [self.queuedTransfers addObject:transfer];
+        [resumedTransfers addObject:transfer];
+    }
+    [self.unresumedJournalEntries removeAllObjects];
+    
+    log(@"Resuming %lu journaled transfers", (unsigned long)resumedTransfers.count);
+    [self startQueuedTransfers];
+    return resumedTransfers;
+}
+
+- (void)enqueueTransfer:(CMISTransfer *)transfer
+{
+    [self.queuedTransfers addObject:transfer];
+    if (transfer.isJournaled) {
+        [self writeJournal];
+    }
+    [self startQueuedTransfers];
+}
+
+- (void)cancelTransfer:(CMISTransfer *)transfer
+{
+    if (transfer.state != CMISTransferStateQueued && transfer.state != CMISTransferStateRunning) {
+        return;
+    }
+    
+    CMISRequest *request = transfer.request;
+    NSError *error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled withDetailedDescription:@"Transfer was cancelled"];
+    [self finishTransfer:transfer withObjectId:nil error:error];
+    
+    // the request reports the cancellation too, which is ignored as the transfer is finished already
+    [request cancel];
+}
+
+- (void)cancelAllTransfers
+{
+    for (CMISTransfer *transfer in self.transfers) {
+        [self cancelTransfer:transfer];
+    }
+}
+
+#pragma mark Running
+
+- (CMISTransfer *)nextQueuedTransfer
+{
+    CMISTransfer *nextTransfer = nil;
+    for (CMISTransfer *transfer in self.queuedTransfers) {
+        if (nextTransfer == nil || transfer.priority > nextTransfer.priority) {
+            nextTransfer = transfer;
+        }
+    }
+    return nextTransfer;
+}
+
+- (void)startQueuedTransfers
+{
+    while (self.runningTransfers.count < self.maximumConcurrentTransfers && self.queuedTransfers.count > 0) {
+        CMISTransfer *transfer = [self nextQueuedTransfer];
+        [self.queuedTransfers removeObject:transfer];
+        [self.runningTransfers addObject:transfer];
+        transfer.state = CMISTransferStateRunning;
+        [self startTransfer:transfer];
+    }
+}
+
+- (void)startTransfer:(CMISTransfer *)transfer
+{
+    __weak CMISTransferManager *weakSelf = self;
+    void (^progressBlock)(unsigned long long, unsigned long long) = ^(unsigned long long bytesTransferred, unsigned long long bytesTotal) {
+        [weakSelf transfer:transfer didTransferBytes:bytesTransferred ofTotal:bytesTotal];
+    };
+    
+    if (transfer.type == CMISTransferTypeUpload && transfer.isUploadStarted) {
+        // the process may have ended after the document was created but before the journal learned about it
+        [self findUploadedDocumentOfTransfer:transfer completionBlock:^(NSString *objectId) {
+            if (transfer.state != CMISTransferStateRunning) {
+                return; // cancelled in the meantime
+            }
+            if (objectId) {
+                log(@"Upload of %@ had completed before the restart, document %@", transfer.filePath, objectId);
+                [weakSelf finishTransfer:transfer withObjectId:objectId error:nil];
+            } else {
+                transfer.uploadStarted = NO;
+                [weakSelf startTransfer:transfer];
+            }
+        }];
+    } else if (transfer.type == CMISTransferTypeUpload) {
+        transfer.bytesTransferred = 0; // an upload always starts from the beginning
+        if (transfer.isJournaled) {
+            transfer.uploadStarted = YES;
+            [self writeJournal];
+        }
+        transfer.request = [self.session createDocumentFromFilePath:transfer.filePath
+                                                       withMimeType:transfer.mimeType
+                                                     withProperties:transfer.properties
+                                                           inFolder:transfer.folderObjectId
+                                                    completionBlock:^(NSString *objectId, NSError *error) {
+                                                        [weakSelf finishTransfer:transfer withObjectId:objectId error:error];
+                                                    }
+                                                      progressBlock:progressBlock];
+    } else {
+        transfer.request = [self.session downloadContentOfCMISObject:transfer.objectId
+                                                              toFile:transfer.filePath
+                                                     completionBlock:^(NSError *error) {
+                                                         [weakSelf finishTransfer:transfer withObjectId:transfer.objectId error:error];
+                                                     }
+                                                       progressBlock:progressBlock];
+    }
+}
+
+/**
+ * Looks in the target folder for a document with the name and size of the upload; calls the completion block
+ * with its id, or with nil if there is none (or it can not be told).
+ */
+- (void)findUploadedDocumentOfTransfer:(CMISTransfer *)transfer completionBlock:(void (^)(NSString *objectId))completionBlock
+{
+    NSString *name = [transfer.properties objectForKey:kCMISPropertyName];
+    NSError *fileError = nil;
+    unsigned long long fileSize = [FileUtil fileSizeForFileAtPath:transfer.filePath error:&fileError];
+    if (name == nil || transfer.folderObjectId == nil || fileError) {
+        completionBlock(nil);
+        return;
+    }
+    
+    transfer.request = [self.session retrieveObject:transfer.folderObjectId completionBlock:^(CMISObject *object, NSError *error) {
+        NSString *folderPath = [object isKindOfClass:[CMISFolder class]] ? ((CMISFolder *)object).path : nil;
+        if (folderPath == nil || transfer.state != CMISTransferStateRunning) {
+            completionBlock(nil);
+            return;
+        }
+        
+        [self.session retrieveObjectByPath:[folderPath stringByAppendingPathComponent:name] completionBlock:^(CMISObject *object, NSError *error) {
+            // a document of another size is someone else's, the upload has to fail on the name conflict then
+            if ([object isKindOfClass:[CMISDocument class]] && ((CMISDocument *)object).contentStreamLength == fileSize) {
+                completionBlock(object.identifier);
+            } else {
+                completionBlock(nil);
+            }
+        }];
+    }];
+}
+
+- (void)transfer:(CMISTransfer *)transfer didTransferBytes:(unsigned long long)bytesTransferred ofTotal:(unsigned long long)bytesTotal
+{
+    if (transfer.state != CMISTransferStateRunning) {
+        return;
+    }
+    
+    // the count goes back when a request is retried, the bytes sent again are not charged
+    unsigned long long newBytes = bytesTransferred > transfer.bytesTransferred ? bytesTransferred - transfer.bytesTransferred : 0;
+    transfer.bytesTransferred = bytesTransferred;
+    transfer.bytesTotal = bytesTotal;
+    
+    if (transfer.progressBlock) {
+        transfer.progressBlock(bytesTransferred, bytesTotal);
+    }
+    
+    // both buckets are charged, the transfer waits for the one deepest in debt
+    NSTimeInterval globalDelay = [self.globalBucket consume:newBytes];
+    NSTimeInterval transferDelay = [transfer.bucket consume:newBytes];
+    NSTimeInterval delay = MAX(globalDelay, transferDelay);
+    if (delay > 0 && transfer.throttleTimer == nil) {
+        [transfer.request suspend];
+        transfer.throttleTimer = [NSTimer scheduledTimerWithTimeInterval:delay
+                                                                  target:self
+                                                                selector:@selector(throttleTimerFired:)
+                                                                userInfo:transfer
+                                                                 repeats:NO];
+    }
+}
+
+- (void)throttleTimerFired:(NSTimer *)timer
+{
+    CMISTransfer *transfer = timer.userInfo;
+    transfer.throttleTimer = nil;
+    [transfer.request resume];
+}
+
+- (void)finishTransfer:(CMISTransfer *)transfer withObjectId:(NSString *)objectId error:(NSError *)error
+{
+    if (transfer.state != CMISTransferStateQueued && transfer.state != CMISTransferStateRunning) {
+        return;
+    }
+    
+    [transfer.throttleTimer invalidate];
+    transfer.throttleTimer = nil;
+    transfer.request = nil;
+    [self.queuedTransfers removeObject:transfer];
+    [self.runningTransfers removeObject:transfer];
+    
+    if (error) {
+        transfer.error = error;
+        transfer.state = error.code == kCMISErrorCodeCancelled ? CMISTransferStateCancelled : CMISTransferStateFailed;
+        log(@"Transfer of %@ did not complete: %@", transfer.filePath, error.description);
+    } else {
+        transfer.objectId = objectId;
+        transfer.state = CMISTransferStateCompleted;
+    }
+    
+    if (transfer.isJournaled) {
+        [self writeJournal];
+    }
+    
+    if (transfer.completionBlock) {
+        transfer.completionBlock(transfer, error);
+    }
+    
+    [self startQueuedTransfers];
+}
+
+#pragma mark Journal
+
+- (void)writeJournal
+{
+    if (!self.journalPath) {
+        return;
+    }
+    
+    NSMutableArray *entries = [NSMutableArray array];
+    for (CMISTransfer *transfer in self.transfers) {
+        if (transfer.isJournaled) {
+            [entries addObject:[transfer journalEntry]];
+        }
+    }
+    [entries addObjectsFromArray:self.unresumedJournalEntries];
+    
+    if (entries.count == 0) {
+        [[NSFileManager defaultManager] removeItemAtPath:self.journalPath error:nil];
+    } else if (![entries writeToFile:self.journalPath atomically:YES]) {
+        log(@"Could not write transfer journal to %@", self.journalPath);
+    }
+}
+
+@end
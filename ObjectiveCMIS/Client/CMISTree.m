@@ -0,0 +1,38 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import "CMISTree.h"
+
+@interface CMISTree ()
+@property (nonatomic, strong, readwrite) CMISObject *item;
+@property (nonatomic, strong, readwrite) NSArray *children;
+@end
+
+@implementation CMISTree
+
+@synthesize item = _item;
+@synthesize children = _children;
+
+- (id)initWithItem:(CMISObject *)item children:(NSArray *)children
+{
+    self = [super init];
+    if (self)
+    {
+        self.item = item;
+        self.children = (children != nil ? children : [NSArray array]);
+    }
+    return self;
+}
+
+@end
@@ -34,6 +34,7 @@ extern NSString * const kCMISPropertyIsMajorVersion;
 extern NSString * const kCMISPropertyIsLatestMajorVersion;
 extern NSString * const kCMISPropertyChangeToken;
 extern NSString * const kCMISPropertyBaseTypeId;
+extern NSString * const kCMISPropertyNewId;
 
 // Property values
 extern NSString * const kCMISPropertyObjectTypeIdValueDocument;
@@ -35,6 +35,7 @@ NSString * const kCMISPropertyIsMajorVersion = @"cmis:isMajorVersion";
 NSString * const kCMISPropertyIsLatestMajorVersion = @"cmis:isLatestMajorVersion";
 NSString * const kCMISPropertyChangeToken = @"cmis:changeToken";
 NSString * const kCMISPropertyBaseTypeId = @"cmis:baseTypeId";
+NSString * const kCMISPropertyNewId = @"cmis:newId"; // only in the results of a bulk update
 
 // Property values
 
@@ -66,6 +66,8 @@ typedef enum
 
 
 extern NSString * const kCMISErrorDomainName;
+// userInfo key of the HTTP status code, as an NSNumber, for errors created from an HTTP response
+extern NSString * const kCMISErrorKeyHttpStatusCode;
 //to be used in the userInfo dictionary as Localized error description
 //Basic Errors
 extern NSString * const kCMISErrorDescriptionNoReturn;
@@ -15,6 +15,7 @@
 #import "CMISErrors.h"
 
 NSString * const kCMISErrorDomainName = @"org.apache.chemistry.objectivecmis";
+NSString * const kCMISErrorKeyHttpStatusCode = @"org.apache.chemistry.objectivecmis.httpstatuscode";
 //to be used in the userInfo dictionary as Localized error description
 
 /**
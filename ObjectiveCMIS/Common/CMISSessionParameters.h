@@ -33,6 +33,83 @@ extern NSString * const kCMISSessionParameterObjectConverterClassName;
  */
 extern NSString * const kCMISSessionParameterLinkCacheSize;
 
+/**
+ * Key for enabling gzip compression of atom entry request bodies (Content-Encoding: gzip).
+ * Value should be an NSNumber wrapping a BOOL, defaults to NO.
+ * The first compressed upload acts as a probe: if the repository rejects it, the upload is
+ * retried uncompressed and compression is switched off for the rest of the session.
+ * Applications using this option need to link against libz.
+ */
+extern NSString * const kCMISSessionParameterCompressRequestBody;
+
+/**
+ * Key for enabling "Expect: 100-continue" on uploads.
+ * Value should be an NSNumber with the body size in bytes from which on uploads first ask the
+ * repository whether it accepts the request, so that a rejected upload (e.g. a permission
+ * problem or name conflict) does not send the whole body. Not set by default (disabled).
+ * This has a cost: NSURLConnection does not report the interim 100 response, so every accepted upload
+ * above the threshold starts sending its body only after kCMISSessionParameterExpectContinueTimeout.
+ * Set the threshold high enough that this delay is small next to the time the body takes to send.
+ */
+extern NSString * const kCMISSessionParameterExpectContinueThreshold;
+
+/**
+ * Key for the number of seconds an upload waits for an early response before the body is sent anyway,
+ * needed for servers that ignore the Expect header. Value should be an NSNumber, defaults to 1 second.
+ */
+extern NSString * const kCMISSessionParameterExpectContinueTimeout;
+
+/**
+ * Key for enabling preflight checks before content is uploaded.
+ * Value should be an NSNumber wrapping a BOOL, defaults to NO.
+ * When enabled, creating a document checks the canCreateDocument allowable action of the folder and
+ * whether the name is taken already, and changing the content stream checks canSetContentStream,
+ * before any content is transferred. Allowable actions are cached for a minute, so repeated uploads into
+ * a folder or of a document (also one just retrieved) do not ask for them again.
+ */
+extern NSString * const kCMISSessionParameterUploadPreflight;
+
+/**
+ * Key for setting the policy that decides which failed requests are sent again.
+ * Value should be a CMISHttpRetryPolicy instance, which also collects the retry metrics of the session.
+ * If not set, a policy with the default settings is used; set one with maxAttempts = 1 to switch retries off.
+ */
+extern NSString * const kCMISSessionParameterRetryPolicy;
+
+/**
+ * Key for enabling hedged metadata reads: a GET whose response has not started after a percentile of the usual
+ * latency is sent a second time, and the first answer is used.
+ * Value should be a CMISHedgingPolicy instance, which sets the percentile and the extra load allowed and collects
+ * the hedging metrics of the session. Not set by default (disabled).
+ */
+extern NSString * const kCMISSessionParameterHedgingPolicy;
+
+/**
+ * Key for letting the session tune the page size of retrieveChildren and query and the number of those requests
+ * in flight at runtime, based on the latency and throughput measured (see CMISAdaptiveController).
+ * Value should be an NSNumber wrapping a BOOL, defaults to NO. When enabled, maxItemsPerPage of the operation
+ * context is only the starting point.
+ */
+extern NSString * const kCMISSessionParameterAdaptiveConcurrency;
+
+/**
+ * Key for running the HTTP connections of the session on a dedicated network thread (see CMISNetworkThread)
+ * instead of the run loop of the calling thread. Responses are then parsed and converted on a concurrent
+ * worker pool, where the completion and progress blocks are called too, unless kCMISSessionParameterCallbackQueue is set.
+ * Requests are handed to the network thread without waiting for their connection to start.
+ * Value should be an NSNumber wrapping a BOOL, defaults to NO.
+ */
+extern NSString * const kCMISSessionParameterNetworkThread;
+
+/**
+ * Key for the queue the completion and progress blocks of the application are called on, e.g. [NSOperationQueue mainQueue].
+ * Setting it implies kCMISSessionParameterNetworkThread: responses are parsed and converted into objects on the worker pool,
+ * and only the finished results are handed to this queue. The callbacks of one request are delivered in order,
+ * also on a concurrent queue.
+ * Value should be an NSOperationQueue. Not set by default: everything runs on the run loop of the calling thread.
+ */
+extern NSString * const kCMISSessionParameterCallbackQueue;
+
 // TODO: Temporary, must be extracted into separate project
 extern NSString * const kCMISSessionParameterMode;
 
@@ -18,6 +18,22 @@ NSString * const kCMISSessionParameterObjectConverterClassName = @"session_param
 
 NSString * const kCMISSessionParameterLinkCacheSize =@"session_param_cache_size_links";
 
+NSString * const kCMISSessionParameterCompressRequestBody = @"session_param_compress_request_body";
+
+NSString * const kCMISSessionParameterExpectContinueThreshold = @"session_param_expect_continue_threshold";
+
+NSString * const kCMISSessionParameterExpectContinueTimeout = @"session_param_expect_continue_timeout";
+
+NSString * const kCMISSessionParameterUploadPreflight = @"session_param_upload_preflight";
+
+NSString * const kCMISSessionParameterRetryPolicy = @"session_param_retry_policy";
+
+NSString * const kCMISSessionParameterHedgingPolicy = @"session_param_hedging_policy";
+
+NSString * const kCMISSessionParameterAdaptiveConcurrency = @"session_param_adaptive_concurrency";
+NSString * const kCMISSessionParameterNetworkThread = @"session_param_network_thread";
+NSString * const kCMISSessionParameterCallbackQueue = @"session_param_callback_queue";
+
 NSString * const kCMISSessionParameterMode = @"session_param_mode";
 
 @interface CMISSessionParameters ()
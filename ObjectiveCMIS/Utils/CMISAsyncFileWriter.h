@@ -0,0 +1,46 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+#import "CMISDownloadSink.h"
+
+/**
+ * Download sink writing to a file on a dedicated writer queue, so disk writes never hold up the connection callbacks.
+ *
+ * Received chunks are passed to the writer through a lock-free ring buffer and written in large, page aligned
+ * blocks. The file is preallocated to the expected length up front. Progress counts the bytes on disk and is
+ * reported at most once per progressInterval, on the run loop of the thread feeding the writer (the connection's).
+ * If the download or a write fails, the file is removed rather than left with a zero-filled tail.
+ */
+@interface CMISAsyncFileWriter : NSObject <CMISDownloadSink>
+
+@property (nonatomic, strong, readonly) NSString *filePath;
+@property (nonatomic, assign, readonly) unsigned long long bytesExpected;
+// bytes on disk so far; may be read from any thread while the writer is busy
+@property (nonatomic, assign, readonly) unsigned long long bytesWritten;
+
+// minimum time between two progress reports; defaults to 0.25 seconds
+@property (nonatomic, assign) NSTimeInterval progressInterval;
+
+@property (nonatomic, copy) void (^progressBlock)(unsigned long long bytesWritten, unsigned long long bytesTotal);
+
+@property (nonatomic, copy) void (^spaceAvailableBlock)(void);
+
+/**
+ * Creates (or truncates) the file. bytesExpected may be 0 if the length is unknown.
+ * Returns nil if the file can not be created.
+ */
+- (id)initWithFilePath:(NSString *)filePath bytesExpected:(unsigned long long)bytesExpected;
+
+@end
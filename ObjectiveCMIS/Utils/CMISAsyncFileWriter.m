@@ -0,0 +1,298 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISAsyncFileWriter.h"
+#import "CMISRingBuffer.h"
+#import "CMISErrors.h"
+#import "CMISFileUtil.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define RING_BUFFER_SIZE 4194304 // 4 mb
+#define WRITE_BLOCK_SIZE 1048576 // 1 mb, a multiple of the page size
+#define WRITE_BUFFER_ALIGNMENT 4096
+#define DEFAULT_PROGRESS_INTERVAL 0.25
+
+// sets the flag to desired if it holds expected, with a full barrier; returns whether it did
+static inline BOOL CMISCompareAndSwapFlag(int32_t *flag, int32_t expected, int32_t desired)
+{
+    return __atomic_compare_exchange_n(flag, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static inline BOOL CMISFlagIsSet(int32_t *flag)
+{
+    return __atomic_load_n(flag, __ATOMIC_ACQUIRE) != 0;
+}
+
+@interface CMISAsyncFileWriter ()
+{
+    // flags shared between the producer and the writer queue, read and changed with atomic operations only
+    int32_t _drainScheduled;
+    int32_t _producerWaiting;
+    int32_t _closing;
+    int32_t _failed;
+}
+
+@property (nonatomic, strong, readwrite) NSString *filePath;
+@property (nonatomic, assign, readwrite) unsigned long long bytesExpected;
+@property (nonatomic, assign, readwrite) unsigned long long bytesWritten; // atomic, set on the writer queue and read anywhere
+@property (nonatomic, assign) int fileDescriptor;
+@property (nonatomic, strong) CMISRingBuffer *ringBuffer;
+@property (nonatomic, assign) uint8_t *writeBuffer;
+@property (nonatomic, assign) dispatch_queue_t writerQueue;
+@property (nonatomic, strong) NSRunLoop *callbackRunLoop;
+@property (nonatomic, strong) NSDate *lastProgressDate;
+@property (nonatomic, strong) NSError *writeError;
+@property (nonatomic, assign) BOOL downloadFailed; // set before the close is announced, read on the writer queue after it
+@property (nonatomic, copy) void (^closeCompletionBlock)(NSError *sinkError);
+
+@end
+
+
+@implementation CMISAsyncFileWriter
+
+@synthesize filePath = _filePath;
+@synthesize bytesExpected = _bytesExpected;
+@synthesize bytesWritten = _bytesWritten;
+@synthesize progressInterval = _progressInterval;
+@synthesize progressBlock = _progressBlock;
+@synthesize spaceAvailableBlock = _spaceAvailableBlock;
+@synthesize fileDescriptor = _fileDescriptor;
+@synthesize ringBuffer = _ringBuffer;
+@synthesize writeBuffer = _writeBuffer;
+@synthesize writerQueue = _writerQueue;
+@synthesize callbackRunLoop = _callbackRunLoop;
+@synthesize lastProgressDate = _lastProgressDate;
+@synthesize writeError = _writeError;
+@synthesize closeCompletionBlock = _closeCompletionBlock;
+
+- (id)initWithFilePath:(NSString *)filePath bytesExpected:(unsigned long long)bytesExpected
+{
+    self = [super init];
+    if (self) {
+        _filePath = filePath;
+        _bytesExpected = bytesExpected;
+        _progressInterval = DEFAULT_PROGRESS_INTERVAL;
+        
+        _fileDescriptor = open([filePath fileSystemRepresentation], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (_fileDescriptor < 0) {
+            log(@"Could not create %@: %s", filePath, strerror(errno));
+            return nil;
+        }
+        [self preallocate];
+        
+        void *writeBuffer = NULL;
+        if (posix_memalign(&writeBuffer, WRITE_BUFFER_ALIGNMENT, WRITE_BLOCK_SIZE) != 0) {
+            close(_fileDescriptor);
+            return nil;
+        }
+        _writeBuffer = writeBuffer;
+        
+        _ringBuffer = [[CMISRingBuffer alloc] initWithCapacity:RING_BUFFER_SIZE];
+        _writerQueue = dispatch_queue_create("org.apache.chemistry.opencmis.asyncfilewriter", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (_fileDescriptor >= 0) {
+        close(_fileDescriptor);
+    }
+    free(_writeBuffer);
+#if !OS_OBJECT_USE_OBJC
+    dispatch_release(_writerQueue);
+#endif
+}
+
+- (unsigned long long)bytesWritten
+{
+    return __atomic_load_n(&_bytesWritten, __ATOMIC_ACQUIRE);
+}
+
+- (void)setBytesWritten:(unsigned long long)bytesWritten
+{
+    __atomic_store_n(&_bytesWritten, bytesWritten, __ATOMIC_RELEASE);
+}
+
+#pragma mark CMISDownloadSink (producer side)
+
+- (NSInteger)writeBytes:(const uint8_t *)bytes maxLength:(NSUInteger)length
+{
+    if (CMISFlagIsSet(&_failed) || CMISFlagIsSet(&_closing)) {
+        return -1;
+    }
+    
+    // the writer may have been created on a thread without a running run loop, the feeding thread has one
+    if (self.callbackRunLoop == nil) {
+        self.callbackRunLoop = [NSRunLoop currentRunLoop];
+    }
+    
+    NSUInteger bytesAccepted = [self.ringBuffer writeBytes:bytes maxLength:length];
+    if (bytesAccepted < length) {
+        // announce the wait before looking again, so the writer can not free space unnoticed in between
+        CMISCompareAndSwapFlag(&_producerWaiting, 0, 1);
+        bytesAccepted += [self.ringBuffer writeBytes:bytes + bytesAccepted maxLength:length - bytesAccepted];
+    }
+    
+    if (self.ringBuffer.bytesAvailable >= WRITE_BLOCK_SIZE) {
+        [self scheduleDrain];
+    }
+    return bytesAccepted;
+}
+
+- (void)closeWithError:(NSError *)error completionBlock:(void (^)(NSError *sinkError))completionBlock
+{
+    if (error) {
+        log(@"Download to %@ ended with an error, removing the partial file", self.filePath);
+        self.downloadFailed = YES;
+    }
+    if (self.callbackRunLoop == nil) {
+        self.callbackRunLoop = [NSRunLoop currentRunLoop];
+    }
+    self.spaceAvailableBlock = nil;
+    self.closeCompletionBlock = completionBlock;
+    CMISCompareAndSwapFlag(&_closing, 0, 1);
+    [self scheduleDrain];
+}
+
+#pragma mark Writer queue
+
+- (void)scheduleDrain
+{
+    if (CMISCompareAndSwapFlag(&_drainScheduled, 0, 1)) {
+        dispatch_async(self.writerQueue, ^{
+            [self drain];
+        });
+    }
+}
+
+- (void)drain
+{
+    BOOL closing = CMISFlagIsSet(&_closing);
+    
+    // write whole blocks only, unless everything has arrived; what is left of a failed download is not worth writing
+    while (!CMISFlagIsSet(&_failed) && !(closing && self.downloadFailed)
+           && (self.ringBuffer.bytesAvailable >= WRITE_BLOCK_SIZE || (closing && self.ringBuffer.bytesAvailable > 0))) {
+        NSUInteger blockLength = [self.ringBuffer readBytes:self.writeBuffer maxLength:WRITE_BLOCK_SIZE];
+        [self writeBlockOfLength:blockLength];
+        
+        if (CMISCompareAndSwapFlag(&_producerWaiting, 1, 0)) {
+            [self performOnCallbackRunLoop:self.spaceAvailableBlock];
+        }
+        [self reportProgressIfDue:NO];
+    }
+    
+    if (closing) {
+        [self finish];
+        return;
+    }
+    
+    CMISCompareAndSwapFlag(&_drainScheduled, 1, 0);
+    // data or the close may have arrived after the last check, while the drain was still marked as scheduled
+    if (self.ringBuffer.bytesAvailable >= WRITE_BLOCK_SIZE || CMISFlagIsSet(&_closing)) {
+        [self scheduleDrain];
+    }
+}
+
+- (void)writeBlockOfLength:(NSUInteger)blockLength
+{
+    NSUInteger offset = 0;
+    while (offset < blockLength) {
+        ssize_t written = pwrite(self.fileDescriptor, self.writeBuffer + offset, blockLength - offset, (off_t)(self.bytesWritten + offset));
+        if (written < 0 && errno == EINTR) {
+            continue;
+        } else if (written <= 0) {
+            self.writeError = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeStorage
+                                          withDetailedDescription:[NSString stringWithFormat:@"Could not write to %@: %s", self.filePath, strerror(errno)]];
+            CMISCompareAndSwapFlag(&_failed, 0, 1);
+            // a waiting producer has to find out that the writer failed
+            [self performOnCallbackRunLoop:self.spaceAvailableBlock];
+            return;
+        }
+        offset += written;
+    }
+    self.bytesWritten += blockLength;
+}
+
+- (void)finish
+{
+    BOOL complete = (self.writeError == nil && !self.downloadFailed);
+    if (complete && self.bytesWritten != self.bytesExpected) {
+        // the preallocated length was a guess; the file must end where the content does
+        ftruncate(self.fileDescriptor, (off_t)self.bytesWritten);
+    }
+    close(self.fileDescriptor);
+    self.fileDescriptor = -1;
+    
+    // a partial file would pass for the content, with the zero-filled tail of its preallocation
+    if (!complete) {
+        [[NSFileManager defaultManager] removeItemAtPath:self.filePath error:nil];
+    }
+    
+    [self reportProgressIfDue:YES];
+    
+    void (^closeCompletionBlock)(NSError *sinkError) = self.closeCompletionBlock;
+    self.closeCompletionBlock = nil;
+    NSError *writeError = self.writeError;
+    if (closeCompletionBlock) {
+        [self performOnCallbackRunLoop:^{
+            closeCompletionBlock(writeError);
+        }];
+    }
+}
+
+#pragma mark Helpers
+
+- (void)preallocate
+{
+    if (self.bytesExpected == 0) {
+        return;
+    }
+    
+    if (![FileUtil preallocateFileDescriptor:self.fileDescriptor length:self.bytesExpected]) {
+        log(@"Could not preallocate %llu bytes for %@: %s", self.bytesExpected, self.filePath, strerror(errno));
+    }
+}
+
+- (void)reportProgressIfDue:(BOOL)force
+{
+    void (^progressBlock)(unsigned long long bytesWritten, unsigned long long bytesTotal) = self.progressBlock;
+    if (progressBlock == nil) {
+        return;
+    }
+    
+    NSDate *now = [NSDate date];
+    if (force || self.lastProgressDate == nil || [now timeIntervalSinceDate:self.lastProgressDate] >= self.progressInterval) {
+        self.lastProgressDate = now;
+        unsigned long long bytesWritten = self.bytesWritten;
+        unsigned long long bytesTotal = MAX(self.bytesExpected, bytesWritten);
+        [self performOnCallbackRunLoop:^{
+            progressBlock(bytesWritten, bytesTotal);
+        }];
+    }
+}
+
+- (void)performOnCallbackRunLoop:(void (^)(void))block
+{
+    if (block == nil) {
+        return;
+    }
+    CFRunLoopRef cfRunLoop = [self.callbackRunLoop getCFRunLoop];
+    CFRunLoopPerformBlock(cfRunLoop, kCFRunLoopCommonModes, block);
+    CFRunLoopWakeUp(cfRunLoop);
+}
+
+@end
@@ -0,0 +1,36 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+#import "CMISDownloadSink.h"
+
+/**
+ * Input stream delivering downloaded content through a bounded buffer.
+ *
+ * The download writes into the stream as a CMISDownloadSink and is paused while the buffer is full,
+ * so memory use stays at the buffer size however slowly the content is consumed.
+ * Closing the stream before the end of the content aborts the download, which then ends with kCMISErrorCodeCancelled.
+ *
+ * The stream can be scheduled in a run loop and read on NSStreamEventHasBytesAvailable, or be read
+ * from a background thread, in which case read:maxLength: blocks until data arrives. It must not be read
+ * synchronously on the thread that runs the download, as that would block the download itself.
+ */
+@interface CMISContentInputStream : NSInputStream <CMISDownloadSink>
+
+@property (nonatomic, copy) void (^spaceAvailableBlock)(void);
+
+// a bufferSize of 0 selects the default of 256 kb
+- (id)initWithBufferSize:(NSUInteger)bufferSize;
+
+@end
@@ -0,0 +1,317 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISContentInputStream.h"
+#import "CMISRingBuffer.h"
+#import "CMISErrors.h"
+
+#define DEFAULT_BUFFER_SIZE 262144 // 256 kb
+
+@interface CMISContentInputStream ()
+
+@property (nonatomic, strong) CMISRingBuffer *buffer;
+@property (nonatomic, strong) NSCondition *condition; // guards all state below
+@property (nonatomic, assign) NSStreamStatus status;
+@property (nonatomic, strong) NSError *error;
+@property (nonatomic, assign) BOOL contentComplete;
+@property (nonatomic, assign) BOOL writerWaitingForSpace;
+@property (nonatomic, weak) id<NSStreamDelegate> streamDelegate;
+@property (nonatomic, strong) NSRunLoop *runLoop;
+@property (nonatomic, strong) NSString *runLoopMode;
+@property (nonatomic, assign) BOOL eventPending;
+@property (nonatomic, assign) BOOL finalEventPosted;
+
+@end
+
+
+@implementation CMISContentInputStream
+
+@synthesize spaceAvailableBlock = _spaceAvailableBlock;
+@synthesize buffer = _buffer;
+@synthesize condition = _condition;
+@synthesize status = _status;
+@synthesize error = _error;
+@synthesize contentComplete = _contentComplete;
+@synthesize writerWaitingForSpace = _writerWaitingForSpace;
+@synthesize streamDelegate = _streamDelegate;
+@synthesize runLoop = _runLoop;
+@synthesize runLoopMode = _runLoopMode;
+@synthesize eventPending = _eventPending;
+@synthesize finalEventPosted = _finalEventPosted;
+
+- (id)initWithBufferSize:(NSUInteger)bufferSize
+{
+    self = [super init];
+    if (self) {
+        _buffer = [[CMISRingBuffer alloc] initWithCapacity:(bufferSize > 0 ? bufferSize : DEFAULT_BUFFER_SIZE)];
+        _condition = [[NSCondition alloc] init];
+        _status = NSStreamStatusNotOpen;
+    }
+    return self;
+}
+
+#pragma mark NSStream
+
+- (void)open
+{
+    [self.condition lock];
+    if (self.status == NSStreamStatusNotOpen) {
+        self.status = NSStreamStatusOpen;
+    }
+    [self.condition unlock];
+    [self postEvent:NSStreamEventOpenCompleted];
+    [self postStateEvent];
+}
+
+- (void)close
+{
+    [self.condition lock];
+    if (self.status != NSStreamStatusError) {
+        self.status = NSStreamStatusClosed;
+    }
+    [self.condition broadcast];
+    [self.condition unlock];
+    
+    // the producer is either waiting for space or will fail its next write; either way it must find out now
+    [self notifySpaceAvailable];
+}
+
+- (NSStreamStatus)streamStatus
+{
+    [self.condition lock];
+    NSStreamStatus status = self.status;
+    if (status == NSStreamStatusOpen && self.contentComplete && self.buffer.bytesAvailable == 0) {
+        status = NSStreamStatusAtEnd;
+    }
+    [self.condition unlock];
+    return status;
+}
+
+- (NSError *)streamError
+{
+    return self.error;
+}
+
+- (id<NSStreamDelegate>)delegate
+{
+    return self.streamDelegate;
+}
+
+- (void)setDelegate:(id<NSStreamDelegate>)delegate
+{
+    self.streamDelegate = delegate;
+}
+
+- (void)scheduleInRunLoop:(NSRunLoop *)runLoop forMode:(NSString *)mode
+{
+    self.runLoop = runLoop;
+    self.runLoopMode = mode;
+    [self postStateEvent];
+}
+
+- (void)removeFromRunLoop:(NSRunLoop *)runLoop forMode:(NSString *)mode
+{
+    if (self.runLoop == runLoop) {
+        self.runLoop = nil;
+        self.runLoopMode = nil;
+    }
+}
+
+- (id)propertyForKey:(NSString *)key
+{
+    return nil;
+}
+
+- (BOOL)setProperty:(id)property forKey:(NSString *)key
+{
+    return NO;
+}
+
+#pragma mark NSInputStream
+
+- (NSInteger)read:(uint8_t *)buffer maxLength:(NSUInteger)len
+{
+    [self.condition lock];
+    while (self.status == NSStreamStatusOpen && self.buffer.bytesAvailable == 0 && !self.contentComplete) {
+        [self.condition wait];
+    }
+    
+    NSInteger bytesRead;
+    if (self.status == NSStreamStatusError) {
+        bytesRead = -1;
+    } else if (self.status != NSStreamStatusOpen) {
+        bytesRead = 0;
+    } else {
+        bytesRead = [self.buffer readBytes:buffer maxLength:len];
+    }
+    
+    // wake the producer once half of the buffer is free again, rather than for every read
+    BOOL wakeWriter = self.writerWaitingForSpace && self.buffer.spaceAvailable >= self.buffer.capacity / 2;
+    if (wakeWriter) {
+        self.writerWaitingForSpace = NO;
+    }
+    [self.condition unlock];
+    
+    if (wakeWriter) {
+        [self notifySpaceAvailable];
+    }
+    return bytesRead;
+}
+
+- (BOOL)getBuffer:(uint8_t **)buffer length:(NSUInteger *)len
+{
+    return NO;
+}
+
+- (BOOL)hasBytesAvailable
+{
+    [self.condition lock];
+    BOOL hasBytesAvailable = self.status == NSStreamStatusOpen && (self.buffer.bytesAvailable > 0 || !self.contentComplete);
+    [self.condition unlock];
+    return hasBytesAvailable;
+}
+
+#pragma mark CMISDownloadSink
+
+- (NSInteger)writeBytes:(const uint8_t *)bytes maxLength:(NSUInteger)length
+{
+    [self.condition lock];
+    if (self.status == NSStreamStatusClosed || self.status == NSStreamStatusError || self.contentComplete) {
+        [self.condition unlock];
+        return -1;
+    }
+    
+    NSInteger bytesWritten = [self.buffer writeBytes:bytes maxLength:length];
+    if (bytesWritten < length) {
+        self.writerWaitingForSpace = YES;
+    }
+    [self.condition broadcast];
+    [self.condition unlock];
+    
+    if (bytesWritten > 0) {
+        [self postEvent:NSStreamEventHasBytesAvailable];
+    }
+    return bytesWritten;
+}
+
+- (void)closeWithError:(NSError *)error completionBlock:(void (^)(NSError *sinkError))completionBlock
+{
+    [self.condition lock];
+    self.contentComplete = YES;
+    if (error && self.status != NSStreamStatusClosed) {
+        self.error = error;
+        self.status = NSStreamStatusError;
+    }
+    [self.condition broadcast];
+    [self.condition unlock];
+    
+    self.spaceAvailableBlock = nil;
+    [self postStateEvent];
+    
+    if (completionBlock) {
+        completionBlock(nil); // whatever is still buffered belongs to the consumer now
+    }
+}
+
+- (BOOL)isClosedByConsumer
+{
+    [self.condition lock];
+    BOOL closed = (self.status == NSStreamStatusClosed);
+    [self.condition unlock];
+    return closed;
+}
+
+#pragma mark Helpers
+
+- (void)notifySpaceAvailable
+{
+    void (^spaceAvailableBlock)(void) = self.spaceAvailableBlock;
+    if (spaceAvailableBlock) {
+        spaceAvailableBlock();
+    }
+}
+
+// posts the event that describes the current state to a scheduled delegate
+- (void)postStateEvent
+{
+    NSStreamStatus status = self.streamStatus;
+    if (status == NSStreamStatusError) {
+        [self postEvent:NSStreamEventErrorOccurred];
+    } else if (status == NSStreamStatusAtEnd) {
+        [self postEvent:NSStreamEventEndEncountered];
+    } else if (status == NSStreamStatusOpen) {
+        [self.condition lock];
+        BOOL hasBytes = self.buffer.bytesAvailable > 0;
+        [self.condition unlock];
+        if (hasBytes) {
+            [self postEvent:NSStreamEventHasBytesAvailable];
+        }
+    }
+}
+
+- (void)postEvent:(NSStreamEvent)event
+{
+    NSRunLoop *runLoop = self.runLoop;
+    NSString *mode = self.runLoopMode;
+    if (runLoop == nil || self.streamDelegate == nil) {
+        return;
+    }
+    
+    if (event == NSStreamEventEndEncountered || event == NSStreamEventErrorOccurred) {
+        [self.condition lock];
+        BOOL alreadyPosted = self.finalEventPosted;
+        self.finalEventPosted = YES;
+        [self.condition unlock];
+        if (alreadyPosted) {
+            return;
+        }
+    } else if (event == NSStreamEventHasBytesAvailable) {
+        // one pending notification is enough, the delegate reads everything it wants when it gets it
+        [self.condition lock];
+        BOOL alreadyPending = self.eventPending;
+        self.eventPending = YES;
+        [self.condition unlock];
+        if (alreadyPending) {
+            return;
+        }
+    }
+    
+    CFRunLoopRef cfRunLoop = [runLoop getCFRunLoop];
+    CFRunLoopPerformBlock(cfRunLoop, (__bridge CFStringRef)mode, ^{
+        if (event != NSStreamEventHasBytesAvailable) {
+            [self.streamDelegate stream:self handleEvent:event];
+            return;
+        }
+        
+        [self.condition lock];
+        self.eventPending = NO;
+        NSUInteger bytesBefore = (self.status == NSStreamStatusOpen) ? self.buffer.bytesAvailable : 0;
+        [self.condition unlock];
+        
+        if (bytesBefore > 0) {
+            [self.streamDelegate stream:self handleEvent:event];
+        }
+        
+        // notify again if the delegate took some data but left the rest behind, or report the end
+        [self.condition lock];
+        BOOL madeProgress = bytesBefore > 0 && self.buffer.bytesAvailable < bytesBefore;
+        [self.condition unlock];
+        if (madeProgress || bytesBefore == 0) {
+            [self postStateEvent];
+        }
+    });
+    CFRunLoopWakeUp(cfRunLoop);
+}
+
+@end
@@ -0,0 +1,51 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Sidecar record kept next to a partially downloaded file, allowing an interrupted download
+ * to be resumed with a Range request instead of starting again from byte 0.
+ *
+ * The record is stored in a property list at <filePath>.cmisresume and removed once the download completed.
+ */
+@interface CMISDownloadResumeRecord : NSObject
+
+@property (nonatomic, strong, readonly) NSString *filePath;
+@property (nonatomic, strong) NSString *contentUrl;
+@property (nonatomic, strong) NSString *changeToken;
+@property (nonatomic, strong) NSString *eTag;
+@property (nonatomic, assign) unsigned long long bytesWritten;
+
+// Loads the record stored next to the given file, or returns an empty record if there is none
++ (CMISDownloadResumeRecord *)resumeRecordForFileAtPath:(NSString *)filePath;
+
++ (NSString *)recordPathForFileAtPath:(NSString *)filePath;
+
+// Returns YES if the partial file still belongs to the given content and can be continued.
+// Requires a matching change token or, without change tokens, a recorded ETag: otherwise a modified document
+// could not be told apart and its new content would be appended to the old one
+- (BOOL)canResumeWithContentUrl:(NSString *)contentUrl changeToken:(NSString *)changeToken;
+
+// Truncates the file to the recorded number of bytes, discarding anything written after the last checkpoint
+- (BOOL)truncateFileToBytesWritten;
+
+// Forgets the progress and empties the file, so the download starts from scratch
+- (void)reset;
+
+- (void)save;
+
+- (void)remove;
+
+@end
@@ -0,0 +1,123 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISDownloadResumeRecord.h"
+#import "CMISFileUtil.h"
+
+NSString * const kCMISDownloadResumeRecordContentUrl = @"contentUrl";
+NSString * const kCMISDownloadResumeRecordChangeToken = @"changeToken";
+NSString * const kCMISDownloadResumeRecordETag = @"eTag";
+NSString * const kCMISDownloadResumeRecordBytesWritten = @"bytesWritten";
+
+@interface CMISDownloadResumeRecord ()
+
+@property (nonatomic, strong, readwrite) NSString *filePath;
+
+@end
+
+
+@implementation CMISDownloadResumeRecord
+
+@synthesize filePath = _filePath;
+@synthesize contentUrl = _contentUrl;
+@synthesize changeToken = _changeToken;
+@synthesize eTag = _eTag;
+@synthesize bytesWritten = _bytesWritten;
+
++ (CMISDownloadResumeRecord *)resumeRecordForFileAtPath:(NSString *)filePath
+{
+    CMISDownloadResumeRecord *record = [[CMISDownloadResumeRecord alloc] init];
+    record.filePath = filePath;
+    
+    NSDictionary *recordDictionary = [NSDictionary dictionaryWithContentsOfFile:[self recordPathForFileAtPath:filePath]];
+    if (recordDictionary) {
+        record.contentUrl = [recordDictionary objectForKey:kCMISDownloadResumeRecordContentUrl];
+        record.changeToken = [recordDictionary objectForKey:kCMISDownloadResumeRecordChangeToken];
+        record.eTag = [recordDictionary objectForKey:kCMISDownloadResumeRecordETag];
+        record.bytesWritten = [[recordDictionary objectForKey:kCMISDownloadResumeRecordBytesWritten] unsignedLongLongValue];
+    }
+    
+    return record;
+}
+
++ (NSString *)recordPathForFileAtPath:(NSString *)filePath
+{
+    return [filePath stringByAppendingPathExtension:@"cmisresume"];
+}
+
+- (BOOL)canResumeWithContentUrl:(NSString *)contentUrl changeToken:(NSString *)changeToken
+{
+    if (self.bytesWritten == 0 || ![self.contentUrl isEqualToString:contentUrl]) {
+        return NO;
+    }
+    
+    if (self.changeToken || changeToken) {
+        if (![self.changeToken isEqualToString:changeToken]) {
+            return NO;
+        }
+    } else if (self.eTag == nil) {
+        // without a change token, only the ETag sent in If-Range lets the server detect a modified document
+        return NO;
+    }
+    
+    NSError *error = nil;
+    unsigned long long fileSize = [FileUtil fileSizeForFileAtPath:self.filePath error:&error];
+    return error == nil && fileSize >= self.bytesWritten;
+}
+
+- (BOOL)truncateFileToBytesWritten
+{
+    if (self.bytesWritten == 0 && ![[NSFileManager defaultManager] fileExistsAtPath:self.filePath]) {
+        return YES; // nothing to truncate
+    }
+    
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForUpdatingAtPath:self.filePath];
+    if (fileHandle == nil) {
+        log(@"Could not open %@ to resume download", self.filePath);
+        return NO;
+    }
+    [fileHandle truncateFileAtOffset:self.bytesWritten];
+    [fileHandle closeFile];
+    return YES;
+}
+
+- (void)reset
+{
+    self.bytesWritten = 0;
+    self.eTag = nil;
+    [self truncateFileToBytesWritten];
+}
+
+- (void)save
+{
+    NSMutableDictionary *recordDictionary = [NSMutableDictionary dictionary];
+    [recordDictionary setValue:self.contentUrl forKey:kCMISDownloadResumeRecordContentUrl];
+    [recordDictionary setValue:self.changeToken forKey:kCMISDownloadResumeRecordChangeToken];
+    [recordDictionary setValue:self.eTag forKey:kCMISDownloadResumeRecordETag];
+    [recordDictionary setValue:[NSNumber numberWithUnsignedLongLong:self.bytesWritten] forKey:kCMISDownloadResumeRecordBytesWritten];
+    
+    if (![recordDictionary writeToFile:[CMISDownloadResumeRecord recordPathForFileAtPath:self.filePath] atomically:YES]) {
+        log(@"Could not write resume record for %@", self.filePath);
+    }
+}
+
+- (void)remove
+{
+    NSString *recordPath = [CMISDownloadResumeRecord recordPathForFileAtPath:self.filePath];
+    if ([[NSFileManager defaultManager] fileExistsAtPath:recordPath]) {
+        [[NSFileManager defaultManager] removeItemAtPath:recordPath error:nil];
+    }
+}
+
+@end
@@ -0,0 +1,45 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Destination of a download that may not accept data as fast as it arrives.
+ *
+ * When the sink is full, the download is paused (no more data is read from the connection) until the
+ * sink reports free space through the spaceAvailableBlock, so the consumer sets the pace of the transfer.
+ */
+@protocol CMISDownloadSink <NSObject>
+
+// called by the sink, from any thread, when space has become available after a write was short
+@property (nonatomic, copy) void (^spaceAvailableBlock)(void);
+
+/**
+ * Accepts up to length bytes. Returns the number of bytes taken, which is 0 if the sink is full,
+ * or -1 if the sink can not take any more data (e.g. it was closed by its consumer).
+ */
+- (NSInteger)writeBytes:(const uint8_t *)bytes maxLength:(NSUInteger)length;
+
+/**
+ * Ends the download; error is nil if all data was delivered. The completion block is called once the sink
+ * has dealt with all data it accepted, with an error if it could not.
+ */
+- (void)closeWithError:(NSError *)error completionBlock:(void (^)(NSError *sinkError))completionBlock;
+
+@optional
+
+// YES once the consumer has given up on the content; a failed write is then reported as a cancellation, not a storage error
+- (BOOL)isClosedByConsumer;
+
+@end
@@ -0,0 +1,30 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Output stream writing a byte range of a file at its own offset with pwrite(),
+ * so several segments of the same file can be written concurrently through one file descriptor.
+ * The stream does not own the file descriptor: it is neither opened nor closed by the stream.
+ */
+@interface CMISFileSegmentOutputStream : NSOutputStream
+
+@property (nonatomic, assign, readonly) unsigned long long offset;
+@property (nonatomic, assign, readonly) unsigned long long length;
+@property (nonatomic, assign, readonly) unsigned long long bytesWritten;
+
+- (id)initWithFileDescriptor:(int)fileDescriptor offset:(unsigned long long)offset length:(unsigned long long)length;
+
+@end
@@ -0,0 +1,131 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISFileSegmentOutputStream.h"
+#include <unistd.h>
+#include <errno.h>
+
+@interface CMISFileSegmentOutputStream ()
+
+@property (nonatomic, assign) int fileDescriptor;
+@property (nonatomic, assign, readwrite) unsigned long long offset;
+@property (nonatomic, assign, readwrite) unsigned long long length;
+@property (nonatomic, assign, readwrite) unsigned long long bytesWritten;
+@property (nonatomic, assign) NSStreamStatus status;
+@property (nonatomic, strong) NSError *error;
+
+@end
+
+
+@implementation CMISFileSegmentOutputStream
+
+@synthesize fileDescriptor = _fileDescriptor;
+@synthesize offset = _offset;
+@synthesize length = _length;
+@synthesize bytesWritten = _bytesWritten;
+@synthesize status = _status;
+@synthesize error = _error;
+
+- (id)initWithFileDescriptor:(int)fileDescriptor offset:(unsigned long long)offset length:(unsigned long long)length
+{
+    self = [super init];
+    if (self) {
+        _fileDescriptor = fileDescriptor;
+        _offset = offset;
+        _length = length;
+        _status = NSStreamStatusNotOpen;
+    }
+    return self;
+}
+
+- (void)open
+{
+    self.status = (self.fileDescriptor >= 0) ? NSStreamStatusOpen : NSStreamStatusError;
+}
+
+- (void)close
+{
+    if (self.status != NSStreamStatusError) {
+        self.status = NSStreamStatusClosed;
+    }
+}
+
+- (NSInteger)write:(const uint8_t *)buffer maxLength:(NSUInteger)len
+{
+    if (self.status != NSStreamStatusOpen) {
+        return -1;
+    }
+    
+    // never write past the end of the segment: that would overwrite the next one
+    unsigned long long remaining = self.length - self.bytesWritten;
+    if (remaining == 0) {
+        log(@"Received more data than expected for segment at offset %llu", self.offset);
+        self.status = NSStreamStatusError;
+        return -1;
+    }
+    size_t bytesToWrite = (size_t)MIN((unsigned long long)len, remaining);
+    
+    ssize_t written;
+    do {
+        written = pwrite(self.fileDescriptor, buffer, bytesToWrite, (off_t)(self.offset + self.bytesWritten));
+    } while (written < 0 && errno == EINTR);
+    
+    if (written < 0) {
+        self.error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+        self.status = NSStreamStatusError;
+        return -1;
+    }
+    
+    self.bytesWritten += written;
+    return written;
+}
+
+- (BOOL)hasSpaceAvailable
+{
+    return self.status == NSStreamStatusOpen && self.bytesWritten < self.length;
+}
+
+- (NSStreamStatus)streamStatus
+{
+    return self.status;
+}
+
+- (NSError *)streamError
+{
+    return self.error;
+}
+
+- (id)propertyForKey:(NSString *)key
+{
+    if ([key isEqualToString:NSStreamFileCurrentOffsetKey]) {
+        return [NSNumber numberWithUnsignedLongLong:self.offset + self.bytesWritten];
+    }
+    return nil;
+}
+
+- (BOOL)setProperty:(id)property forKey:(NSString *)key
+{
+    return NO;
+}
+
+- (void)scheduleInRunLoop:(NSRunLoop *)aRunLoop forMode:(NSString *)mode
+{
+    // writes never block, so there is nothing to schedule
+}
+
+- (void)removeFromRunLoop:(NSRunLoop *)aRunLoop forMode:(NSString *)mode
+{
+}
+
+@end
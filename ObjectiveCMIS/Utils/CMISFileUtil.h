@@ -21,4 +21,10 @@
 
 + (unsigned long long)fileSizeForFileAtPath:(NSString *)filePath error:(NSError * *)outError;
 
+/**
+ * Reserves length bytes for the open file (contiguous if the file system can) and extends the file to that length.
+ * Returns NO if the file could not be extended; errno is set in that case.
+ */
++ (BOOL)preallocateFileDescriptor:(int)fileDescriptor length:(unsigned long long)length;
+
 @end
\ No newline at end of file
@@ -13,6 +13,8 @@
  */
 
 #import "CMISFileUtil.h"
+#include <fcntl.h>
+#include <unistd.h>
 
 
 @implementation FileUtil
@@ -42,4 +44,17 @@
     return 0LL;
 }
 
++ (BOOL)preallocateFileDescriptor:(int)fileDescriptor length:(unsigned long long)length
+{
+#ifdef F_PREALLOCATE
+    // reserving up front keeps blocks that are written out of order (or concurrently) from fragmenting the file
+    fstore_t store = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, (off_t)length, 0};
+    if (fcntl(fileDescriptor, F_PREALLOCATE, &store) == -1) {
+        store.fst_flags = F_ALLOCATEALL;
+        fcntl(fileDescriptor, F_PREALLOCATE, &store);
+    }
+#endif
+    return ftruncate(fileDescriptor, (off_t)length) == 0;
+}
+
 @end
\ No newline at end of file
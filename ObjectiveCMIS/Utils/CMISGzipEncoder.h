@@ -0,0 +1,26 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@interface CMISGzipEncoder : NSObject
+
+/**
+ * Compresses the content of the source file into the destination file using the gzip format.
+ * The file is processed in chunks, so memory usage does not depend on the size of the source file.
+ * Returns NO if the file could not be read, written or compressed.
+ */
++ (BOOL)encodeContentOfFile:(NSString *)sourceFilePath toFile:(NSString *)destinationFilePath;
+
+@end
@@ -0,0 +1,92 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+ */
+
+#import "CMISGzipEncoder.h"
+#import <zlib.h>
+
+#define CMIS_GZIP_CHUNK_SIZE 524288 // 512 kb
+
+@implementation CMISGzipEncoder
+
++ (BOOL)encodeContentOfFile:(NSString *)sourceFilePath toFile:(NSString *)destinationFilePath
+{
+    NSInputStream *inputStream = [NSInputStream inputStreamWithFileAtPath:sourceFilePath];
+    NSOutputStream *outputStream = [NSOutputStream outputStreamToFileAtPath:destinationFilePath append:NO];
+    if (inputStream == nil || outputStream == nil) {
+        log(@"Could not open %@ for compression into %@", sourceFilePath, destinationFilePath);
+        return NO;
+    }
+
+    z_stream zStream;
+    memset(&zStream, 0, sizeof(z_stream));
+    // window bits 15 + 16 makes zlib write a gzip header and trailer instead of a zlib wrapper
+    if (deflateInit2(&zStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        log(@"Could not initialize gzip compression");
+        return NO;
+    }
+
+    [inputStream open];
+    [outputStream open];
+
+    uint8_t *inputBuffer = malloc(CMIS_GZIP_CHUNK_SIZE);
+    uint8_t *outputBuffer = malloc(CMIS_GZIP_CHUNK_SIZE);
+    BOOL success = YES;
+    int flush = Z_NO_FLUSH;
+
+    do {
+        NSInteger bytesRead = [inputStream read:inputBuffer maxLength:CMIS_GZIP_CHUNK_SIZE];
+        if (bytesRead < 0) {
+            log(@"Error while reading %@ for compression", sourceFilePath);
+            success = NO;
+            break;
+        }
+        flush = (bytesRead == 0) ? Z_FINISH : Z_NO_FLUSH;
+        zStream.next_in = inputBuffer;
+        zStream.avail_in = (uInt)bytesRead;
+
+        // drain the deflater until it has consumed the whole chunk
+        do {
+            zStream.next_out = outputBuffer;
+            zStream.avail_out = CMIS_GZIP_CHUNK_SIZE;
+            if (deflate(&zStream, flush) == Z_STREAM_ERROR) {
+                success = NO;
+                break;
+            }
+            NSUInteger compressedLength = CMIS_GZIP_CHUNK_SIZE - zStream.avail_out;
+            NSUInteger offset = 0;
+            while (offset < compressedLength) {
+                NSInteger written = [outputStream write:&outputBuffer[offset] maxLength:compressedLength - offset];
+                if (written <= 0) {
+                    log(@"Error while writing compressed data to %@", destinationFilePath);
+                    success = NO;
+                    break;
+                }
+                offset += written;
+            }
+        } while (success && zStream.avail_out == 0);
+    } while (success && flush != Z_FINISH);
+
+    deflateEnd(&zStream);
+    free(inputBuffer);
+    free(outputBuffer);
+    [inputStream close];
+    [outputStream close];
+
+    if (!success) {
+        [[NSFileManager defaultManager] removeItemAtPath:destinationFilePath error:nil];
+    }
+    return success;
+}
+
+@end
@@ -0,0 +1,42 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+#import "CMISRequest.h"
+
+@class CMISHttpRequest;
+@class CMISHttpResponse;
+@class CMISHedgingPolicy;
+
+/**
+ * An idempotent request that is sent a second time if its response does not start within the delay given by the
+ * hedging policy. The first of both to answer is reported, the other one is cancelled.
+ */
+@interface CMISHedgedRequest : NSObject <CMISCancellableRequest>
+
+/**
+ * The start block sends one copy of the request and returns it; it is called once, or twice if the request is hedged.
+ * Must be called on a thread with a run loop, the completion block is called on the same thread.
+ *
+ * The hedged request becomes the http request of the given request object (a new one if nil), which is returned:
+ * cancelling it cancels both copies.
+ */
++ (CMISRequest *)startRequestWithHedgingPolicy:(CMISHedgingPolicy *)hedgingPolicy
+                                    startBlock:(CMISHttpRequest * (^)(void (^completionBlock)(CMISHttpResponse *httpResponse, NSError *error)))startBlock
+                               completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+                                 requestObject:(CMISRequest *)requestObject;
+
+- (void)cancel;
+
+@end
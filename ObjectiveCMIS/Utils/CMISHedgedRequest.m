@@ -0,0 +1,167 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISHedgedRequest.h"
+#import "CMISHedgingPolicy.h"
+#import "CMISHttpRequest.h"
+#import "CMISHttpResponse.h"
+#import "CMISErrors.h"
+
+@interface CMISHedgedRequest ()
+
+@property (nonatomic, strong) CMISHedgingPolicy *hedgingPolicy;
+@property (nonatomic, copy) CMISHttpRequest * (^startBlock)(void (^)(CMISHttpResponse *, NSError *));
+@property (nonatomic, copy) void (^completionBlock)(CMISHttpResponse *httpResponse, NSError *error);
+@property (nonatomic, strong) NSMutableArray *requests; // the original request and, if sent, the hedge
+@property (nonatomic, strong) NSMutableDictionary *requestStartDates; // of the requests whose response has not started yet
+@property (nonatomic, strong) NSTimer *hedgeTimer;
+@property (nonatomic, assign) BOOL responseStarted;
+
+@end
+
+@implementation CMISHedgedRequest
+
+@synthesize hedgingPolicy = _hedgingPolicy;
+@synthesize startBlock = _startBlock;
+@synthesize completionBlock = _completionBlock;
+@synthesize requests = _requests;
+@synthesize requestStartDates = _requestStartDates;
+@synthesize hedgeTimer = _hedgeTimer;
+@synthesize responseStarted = _responseStarted;
+
++ (CMISRequest *)startRequestWithHedgingPolicy:(CMISHedgingPolicy *)hedgingPolicy
+                                    startBlock:(CMISHttpRequest * (^)(void (^completionBlock)(CMISHttpResponse *httpResponse, NSError *error)))startBlock
+                               completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+                                 requestObject:(CMISRequest *)requestObject
+{
+    if (requestObject == nil) {
+        requestObject = [[CMISRequest alloc] init];
+    }
+    
+    CMISHedgedRequest *hedgedRequest = [[self alloc] init];
+    hedgedRequest.hedgingPolicy = hedgingPolicy;
+    hedgedRequest.startBlock = startBlock;
+    hedgedRequest.completionBlock = completionBlock;
+    hedgedRequest.requests = [NSMutableArray arrayWithCapacity:2];
+    hedgedRequest.requestStartDates = [NSMutableDictionary dictionaryWithCapacity:2];
+    
+    // the request object only holds on weakly; the timer and the pending requests keep the hedged request alive
+    requestObject.httpRequest = hedgedRequest;
+    
+    NSTimeInterval hedgeDelay = [hedgingPolicy hedgeDelayForNewRequest];
+    [hedgedRequest sendRequest];
+    if (hedgeDelay >= 0 && hedgedRequest.completionBlock) {
+        hedgedRequest.hedgeTimer = [NSTimer scheduledTimerWithTimeInterval:hedgeDelay
+                                                                     target:hedgedRequest
+                                                                   selector:@selector(hedgeTimerFired:)
+                                                                   userInfo:nil
+                                                                    repeats:NO];
+    }
+    return requestObject;
+}
+
+- (void)cancel
+{
+    if (self.completionBlock) {
+        [self finishWithResponse:nil error:[CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled
+                                                       withDetailedDescription:@"Request was cancelled"]];
+    }
+}
+
+#pragma mark Helpers
+
+- (void)sendRequest
+{
+    NSUInteger index = self.requests.count;
+    NSDate *startDate = [NSDate date];
+    __block CMISHttpRequest *request = nil;
+    
+    request = self.startBlock(^(CMISHttpResponse *httpResponse, NSError *error) {
+        [self request:request didCompleteWithResponse:httpResponse error:error isHedge:(index > 0)];
+    });
+    if (request) {
+        [self.requests addObject:request];
+        NSValue *requestKey = [NSValue valueWithNonretainedObject:request];
+        [self.requestStartDates setObject:startDate forKey:requestKey];
+        request.responseReceivedBlock = ^(NSHTTPURLResponse *response) {
+            self.responseStarted = YES;
+            [self.requestStartDates removeObjectForKey:requestKey];
+            [self.hedgingPolicy recordLatency:-[startDate timeIntervalSinceNow]];
+        };
+    }
+}
+
+- (void)hedgeTimerFired:(NSTimer *)timer
+{
+    self.hedgeTimer = nil;
+    if (self.completionBlock && !self.responseStarted && [self.hedgingPolicy acquireHedge]) {
+        log(@"No response after %.3f seconds, hedging the request", timer.timeInterval);
+        [self sendRequest];
+    }
+}
+
+- (void)request:(CMISHttpRequest *)request didCompleteWithResponse:(CMISHttpResponse *)httpResponse error:(NSError *)error isHedge:(BOOL)isHedge
+{
+    if (self.completionBlock == nil) {
+        return; // the other request has answered already, this is the cancellation of the loser
+    }
+    
+    if (request) {
+        [self.requests removeObject:request];
+    }
+    
+    // a connection failure may be specific to the node that was hit, so wait for the other request if there is one
+    BOOL otherPending = self.requests.count > 0 || self.hedgeTimer != nil;
+    if ([error.domain isEqualToString:kCMISErrorDomainName] && error.code == kCMISErrorCodeConnection && otherPending) {
+        if (self.hedgeTimer && !self.responseStarted && [self.hedgingPolicy acquireHedge]) {
+            [self.hedgeTimer invalidate];
+            self.hedgeTimer = nil;
+            [self sendRequest];
+        }
+        if (self.requests.count > 0) {
+            return;
+        }
+    }
+    
+    if (isHedge && error == nil) {
+        [self.hedgingPolicy recordHedgeWin];
+    }
+    [self finishWithResponse:httpResponse error:error];
+}
+
+- (void)finishWithResponse:(CMISHttpResponse *)httpResponse error:(NSError *)error
+{
+    void (^completionBlock)(CMISHttpResponse *httpResponse, NSError *error) = self.completionBlock;
+    self.completionBlock = nil;
+    self.startBlock = nil;
+    
+    [self.hedgeTimer invalidate];
+    self.hedgeTimer = nil;
+    
+    NSArray *requests = [self.requests copy];
+    [self.requests removeAllObjects];
+    for (CMISHttpRequest *request in requests) {
+        // the loser has waited this long without a response: leaving that out would make the node look faster than it is
+        NSDate *startDate = [self.requestStartDates objectForKey:[NSValue valueWithNonretainedObject:request]];
+        if (startDate && error == nil) {
+            [self.hedgingPolicy recordLatency:-[startDate timeIntervalSinceNow]];
+        }
+        [request cancel];
+    }
+    [self.requestStartDates removeAllObjects];
+    
+    completionBlock(httpResponse, error);
+}
+
+@end
@@ -0,0 +1,56 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Opt-in hedging of metadata reads: if the response to a GET has not started after a delay derived from
+ * the latencies seen so far, a second identical request is sent and whichever answers first is used.
+ * This cuts the tail latency caused by an occasional slow node, at the price of a bounded amount of extra load.
+ *
+ * Enable it by setting an instance with kCMISSessionParameterHedgingPolicy. The policy is thread-safe.
+ */
+@interface CMISHedgingPolicy : NSObject
+
+// the latency percentile after which a request is hedged. Defaults to 0.95
+@property (nonatomic, assign) double percentile;
+
+// hedges are never sent earlier than this. Defaults to 0.05 seconds
+@property (nonatomic, assign) NSTimeInterval minimumDelay;
+
+// the extra requests allowed, as a fraction of all requests. Defaults to 0.05.
+// Unused budget is not saved up beyond a single hedge, so quiet times do not allow a burst of hedges later
+@property (nonatomic, assign) double maxExtraLoad;
+
+// number of recent latencies the percentile is computed from; no hedges are sent until half of them are known. Defaults to 100
+@property (nonatomic, assign) NSUInteger sampleSize;
+
+// metrics
+@property (nonatomic, assign, readonly) unsigned long long requestCount;
+@property (nonatomic, assign, readonly) unsigned long long hedgeCount;
+@property (nonatomic, assign, readonly) unsigned long long hedgeWinCount; // hedges that answered before the original request
+
+// records the time between sending a request and the start of its response, or, for a request cancelled
+// before its response started, the time it had waited until then
+- (void)recordLatency:(NSTimeInterval)latency;
+
+// Called for every new request; returns the delay after which it should be hedged, or a negative value if it should not
+- (NSTimeInterval)hedgeDelayForNewRequest;
+
+// Called when the delay has passed without a response; returns YES if the hedge fits in the budget
+- (BOOL)acquireHedge;
+
+- (void)recordHedgeWin;
+
+@end
@@ -0,0 +1,108 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISHedgingPolicy.h"
+
+#define DEFAULT_PERCENTILE 0.95
+#define DEFAULT_MINIMUM_DELAY 0.05
+#define DEFAULT_MAX_EXTRA_LOAD 0.05
+#define DEFAULT_SAMPLE_SIZE 100
+#define MAX_SAVED_HEDGES 1.0 // a hedge saved up in quiet times; more would allow bursts beyond maxExtraLoad
+
+@interface CMISHedgingPolicy ()
+
+@property (nonatomic, assign, readwrite) unsigned long long requestCount;
+@property (nonatomic, assign, readwrite) unsigned long long hedgeCount;
+@property (nonatomic, assign, readwrite) unsigned long long hedgeWinCount;
+@property (nonatomic, strong) NSMutableArray *latencies; // ring of the most recent latencies
+@property (nonatomic, assign) NSUInteger nextLatencyIndex;
+@property (nonatomic, assign) double budget;
+
+@end
+
+@implementation CMISHedgingPolicy
+
+@synthesize percentile = _percentile;
+@synthesize minimumDelay = _minimumDelay;
+@synthesize maxExtraLoad = _maxExtraLoad;
+@synthesize sampleSize = _sampleSize;
+@synthesize requestCount = _requestCount;
+@synthesize hedgeCount = _hedgeCount;
+@synthesize hedgeWinCount = _hedgeWinCount;
+@synthesize latencies = _latencies;
+@synthesize nextLatencyIndex = _nextLatencyIndex;
+@synthesize budget = _budget;
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        _percentile = DEFAULT_PERCENTILE;
+        _minimumDelay = DEFAULT_MINIMUM_DELAY;
+        _maxExtraLoad = DEFAULT_MAX_EXTRA_LOAD;
+        _sampleSize = DEFAULT_SAMPLE_SIZE;
+        _latencies = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)recordLatency:(NSTimeInterval)latency
+{
+    @synchronized(self) {
+        NSNumber *sample = [NSNumber numberWithDouble:latency];
+        if (self.latencies.count < self.sampleSize) {
+            [self.latencies addObject:sample];
+        } else {
+            [self.latencies replaceObjectAtIndex:self.nextLatencyIndex % self.latencies.count withObject:sample];
+        }
+        self.nextLatencyIndex = (self.nextLatencyIndex + 1) % self.sampleSize;
+    }
+}
+
+- (NSTimeInterval)hedgeDelayForNewRequest
+{
+    @synchronized(self) {
+        self.requestCount++;
+        self.budget = MIN(self.budget + self.maxExtraLoad, MAX_SAVED_HEDGES);
+        
+        NSUInteger count = self.latencies.count;
+        if (count < MAX(self.sampleSize / 2, 1)) {
+            return -1; // not enough data to tell slow from normal
+        }
+        NSArray *sortedLatencies = [self.latencies sortedArrayUsingSelector:@selector(compare:)];
+        NSUInteger index = MIN((NSUInteger)(self.percentile * count), count - 1);
+        return MAX([[sortedLatencies objectAtIndex:index] doubleValue], self.minimumDelay);
+    }
+}
+
+- (BOOL)acquireHedge
+{
+    @synchronized(self) {
+        if (self.budget < 1.0) {
+            return NO;
+        }
+        self.budget -= 1.0;
+        self.hedgeCount++;
+        return YES;
+    }
+}
+
+- (void)recordHedgeWin
+{
+    @synchronized(self) {
+        self.hedgeWinCount++;
+    }
+}
+
+@end
@@ -14,21 +14,49 @@
 
 #import "CMISHttpRequest.h"
 
+@class CMISDownloadResumeRecord;
+@protocol CMISDownloadSink;
+
 @interface CMISHttpDownloadRequest : CMISHttpRequest
 
 // the outputStream should be unopened but if it is already open it will not be reset but used as is;
 // it is closed on completion; if no outputStream is provided, download goes to httpResponse.data
 @property (nonatomic, strong) NSOutputStream *outputStream;
 
+// alternative to the outputStream; if the sink is full, the connection is suspended until the sink has space again
+@property (nonatomic, strong) id<CMISDownloadSink> sink;
+
 // optional; if not set, expected content length from HTTP header is used
 @property (nonatomic, assign) unsigned long long bytesExpected;
 
 @property (nonatomic, readonly) unsigned long long bytesDownloaded;
 
+// optional; only for downloads to a file. If the record holds a number of written bytes, the download
+// continues at that offset with a Range request. If the server sends the complete content instead
+// (e.g. because the document changed), the file is emptied and the download starts from scratch.
+@property (nonatomic, strong) CMISDownloadResumeRecord *resumeRecord;
+
++ (CMISHttpDownloadRequest*)startRequest:(NSMutableURLRequest*)urlRequest
+                          withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+                            outputStream:(NSOutputStream*)outputStream
+                           bytesExpected:(unsigned long long)bytesExpected
+                  authenticationProvider:(id<CMISAuthenticationProvider>) authenticationProvider
+                         completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+                           progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
+
 + (CMISHttpDownloadRequest*)startRequest:(NSMutableURLRequest*)urlRequest
                           withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
                             outputStream:(NSOutputStream*)outputStream
                            bytesExpected:(unsigned long long)bytesExpected
+                            resumeRecord:(CMISDownloadResumeRecord*)resumeRecord
+                  authenticationProvider:(id<CMISAuthenticationProvider>) authenticationProvider
+                         completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+                           progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
+
++ (CMISHttpDownloadRequest*)startRequest:(NSMutableURLRequest*)urlRequest
+                          withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+                                    sink:(id<CMISDownloadSink>)sink
+                           bytesExpected:(unsigned long long)bytesExpected
                   authenticationProvider:(id<CMISAuthenticationProvider>) authenticationProvider
                          completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
                            progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
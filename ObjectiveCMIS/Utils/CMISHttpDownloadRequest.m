@@ -13,12 +13,23 @@
  */
 
 #import "CMISHttpDownloadRequest.h"
+#import "CMISHttpResponse.h"
+#import "CMISDownloadResumeRecord.h"
+#import "CMISDownloadSink.h"
 #import "CMISErrors.h"
 
+// the resume record is persisted every time this many bytes have been written
+#define RESUME_RECORD_CHECKPOINT_INTERVAL 4194304 // 4 mb
+
 @interface CMISHttpDownloadRequest ()
 
 @property (nonatomic, copy) void (^progressBlock)(unsigned long long bytesDownloaded, unsigned long long bytesTotal);
 @property (nonatomic, assign) unsigned long long bytesDownloaded;
+@property (nonatomic, assign) BOOL isReceivingContent; // NO if the server answered with an error, whose body is kept in memory
+@property (nonatomic, assign) unsigned long long bytesCheckpointed;
+// received data the sink could not take yet. A single slot is enough: the connection is suspended whenever it is
+// filled, and data that still arrives (e.g. after a resume from outside) is appended to it, never written past it
+@property (nonatomic, strong) NSData *pendingData;
 
 @end
 
@@ -29,6 +40,11 @@
 @synthesize progressBlock = _progressBlock;
 @synthesize bytesDownloaded = _bytesDownloaded;
 @synthesize bytesExpected = _bytesExpected;
+@synthesize resumeRecord = _resumeRecord;
+@synthesize isReceivingContent = _isReceivingContent;
+@synthesize bytesCheckpointed = _bytesCheckpointed;
+@synthesize sink = _sink;
+@synthesize pendingData = _pendingData;
 
 + (CMISHttpDownloadRequest*)startRequest:(NSMutableURLRequest *)urlRequest
                           withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
@@ -37,12 +53,33 @@
                   authenticationProvider:(id<CMISAuthenticationProvider>) authenticationProvider
                          completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
                            progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
+{
+    return [self startRequest:urlRequest
+               withHttpMethod:httpRequestMethod
+                 outputStream:outputStream
+                bytesExpected:bytesExpected
+                 resumeRecord:nil
+       authenticationProvider:authenticationProvider
+              completionBlock:completionBlock
+                progressBlock:progressBlock];
+}
+
+
++ (CMISHttpDownloadRequest*)startRequest:(NSMutableURLRequest *)urlRequest
+                          withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+                            outputStream:(NSOutputStream*)outputStream
+                           bytesExpected:(unsigned long long)bytesExpected
+                            resumeRecord:(CMISDownloadResumeRecord*)resumeRecord
+                  authenticationProvider:(id<CMISAuthenticationProvider>) authenticationProvider
+                         completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+                           progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
 {
     CMISHttpDownloadRequest *httpRequest = [[self alloc] initWithHttpMethod:httpRequestMethod
                                                             completionBlock:completionBlock
                                                               progressBlock:progressBlock];
     httpRequest.outputStream = outputStream;
     httpRequest.bytesExpected = bytesExpected;
+    httpRequest.resumeRecord = resumeRecord;
     httpRequest.authenticationProvider = authenticationProvider;
     
     if ([httpRequest startRequest:urlRequest] == NO) {
@@ -53,6 +90,31 @@
 }
 
 
++ (CMISHttpDownloadRequest*)startRequest:(NSMutableURLRequest *)urlRequest
+                          withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+                                    sink:(id<CMISDownloadSink>)sink
+                           bytesExpected:(unsigned long long)bytesExpected
+                  authenticationProvider:(id<CMISAuthenticationProvider>) authenticationProvider
+                         completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+                           progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+{
+    CMISHttpDownloadRequest *httpRequest = [[self alloc] initWithHttpMethod:httpRequestMethod
+                                                            completionBlock:completionBlock
+                                                              progressBlock:progressBlock];
+    httpRequest.sink = sink;
+    httpRequest.bytesExpected = bytesExpected;
+    httpRequest.authenticationProvider = authenticationProvider;
+    
+    if ([httpRequest startRequest:urlRequest] == NO) {
+        [sink closeWithError:[CMISErrors createCMISErrorWithCode:kCMISErrorCodeConnection withDetailedDescription:@"Could not start download"]
+             completionBlock:nil];
+        httpRequest = nil;
+    };
+    
+    return httpRequest;
+}
+
+
 - (id)initWithHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
          completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
            progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
@@ -66,9 +128,36 @@
 }
 
 
+- (BOOL)startRequest:(NSMutableURLRequest*)urlRequest
+{
+    if (self.resumeRecord.bytesWritten > 0) {
+        [urlRequest setValue:[NSString stringWithFormat:@"bytes=%llu-", self.resumeRecord.bytesWritten] forHTTPHeaderField:@"Range"];
+        if (self.resumeRecord.eTag) {
+            // the server ignores the range and sends the complete content if the entity has changed meanwhile
+            [urlRequest setValue:self.resumeRecord.eTag forHTTPHeaderField:@"If-Range"];
+        }
+    } else {
+        // a request started again from the beginning must not keep the range of an earlier attempt
+        [urlRequest setValue:nil forHTTPHeaderField:@"Range"];
+        [urlRequest setValue:nil forHTTPHeaderField:@"If-Range"];
+    }
+    
+    if (self.sink) {
+        __weak CMISHttpDownloadRequest *weakSelf = self;
+        self.sink.spaceAvailableBlock = ^{
+            [weakSelf sinkHasSpaceAvailable];
+        };
+    }
+    
+    return [super startRequest:urlRequest];
+}
+
+
 - (void)cancel
 {
     [self.outputStream close];
+    [self checkpointResumeRecord];
+    [self closeSinkWithError:[CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled withDetailedDescription:@"Request was cancelled"]];
     
     self.progressBlock = nil;
     
@@ -80,14 +169,52 @@
 {
     [super connection:connection didReceiveResponse:response];
     
+    NSInteger statusCode = self.response.statusCode;
+    unsigned long long resumeOffset = self.resumeRecord.bytesWritten;
+    if (resumeOffset > 0) {
+        if (statusCode == 416 && [self contentRangeCompleteLength] == (long long)resumeOffset) {
+            // the previous attempt received everything but could not record it
+            log(@"Content was already complete at byte %llu", resumeOffset);
+            [connection cancel];
+            [self completeResumedDownload];
+            return;
+        } else if (statusCode == 416 || (statusCode == 206 && [self contentRangeStart] != resumeOffset)) {
+            log(@"Server can not continue the download at byte %llu, starting from scratch", resumeOffset);
+            [connection cancel];
+            [self restartDownload];
+            return;
+        } else if (statusCode == 206) {
+            log(@"Resuming download at byte %llu", resumeOffset);
+        } else if (statusCode >= 200 && statusCode < 300) {
+            // the server ignored the range, most likely because the document has changed since the last attempt
+            log(@"Server sent the complete content, starting from scratch");
+            [self.outputStream close];
+            [self.resumeRecord reset];
+            self.outputStream = [NSOutputStream outputStreamToFileAtPath:self.resumeRecord.filePath append:NO];
+            resumeOffset = 0;
+        }
+    }
+    
+    // error responses are kept in memory so they can be reported, rather than written to the output stream
+    self.isReceivingContent = (self.response == nil || statusCode < 300);
+    
     // update statistics
     if (self.bytesExpected == 0 && response.expectedContentLength != NSURLResponseUnknownLength) {
-        self.bytesExpected = response.expectedContentLength;
+        self.bytesExpected = resumeOffset + response.expectedContentLength;
+    }
+    self.bytesDownloaded = resumeOffset;
+    self.bytesCheckpointed = resumeOffset;
+    
+    if (self.resumeRecord && self.isReceivingContent) {
+        NSString *eTag = [CMISHttpResponse valueForHeaderField:@"ETag" inHeaders:self.response.allHeaderFields];
+        if (eTag) {
+            self.resumeRecord.eTag = eTag;
+        }
+        [self.resumeRecord save];
     }
-    self.bytesDownloaded = 0;
 
     // set up output stream if available
-    if (self.outputStream) { // otherwise store data in memory in self.data
+    if (self.outputStream && self.isReceivingContent) { // otherwise store data in memory in self.data
         // create file for downloaded content
         BOOL isStreamReady = self.outputStream.streamStatus == NSStreamStatusOpen;
         if (!isStreamReady) {
@@ -96,14 +223,7 @@
         }
     
         if (!isStreamReady) {
-            [connection cancel];
-            
-            if (self.completionBlock)
-            {
-                NSError *cmisError = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeStorage
-                                                 withDetailedDescription:@"Could not open output stream"];
-                self.completionBlock(nil, cmisError);
-            }
+            [self cancelWithStorageError:@"Could not open output stream"];
         }
     }
 }
@@ -111,17 +231,32 @@
 
 - (void)connection:(NSURLConnection *)connection didReceiveData:(NSData *)data
 {
-    if (self.outputStream == nil) { // if there is no outputStream then store data in memory in self.data
+    if (self.sink && self.isReceivingContent) {
+        if (self.pendingData) {
+            NSMutableData *pendingData = [self.pendingData mutableCopy];
+            [pendingData appendData:data];
+            self.pendingData = pendingData;
+            [self suspend];
+            return;
+        }
+        if (![self writeDataToSink:data]) {
+            return;
+        }
+    } else if (self.outputStream == nil || !self.isReceivingContent) { // if there is no outputStream then store data in memory in self.data
         [super connection:connection didReceiveData:data];
+        if (!self.isReceivingContent) {
+            return;
+        }
     } else {
         const uint8_t *bytes = data.bytes;
         NSUInteger length = data.length;
         NSUInteger offset = 0;
         do {
-            NSUInteger written = [self.outputStream write:&bytes[offset] maxLength:length - offset];
+            // -1 is a write error, 0 a stream that has reached its capacity; neither will take the rest
+            NSInteger written = [self.outputStream write:&bytes[offset] maxLength:length - offset];
             if (written <= 0) {
                 log(@"Error while writing downloaded data to file");
-                [connection cancel];
+                [self cancelWithStorageError:@"Could not write to output stream"];
                 return;
             } else {
                 offset += written;
@@ -131,6 +266,9 @@
     
     // update statistics
     self.bytesDownloaded += data.length;
+    if (self.resumeRecord && self.bytesDownloaded - self.bytesCheckpointed >= RESUME_RECORD_CHECKPOINT_INTERVAL) {
+        [self checkpointResumeRecord];
+    }
     // pass progress to progressBlock
     if (self.progressBlock) {
         self.progressBlock(self.bytesDownloaded, self.bytesExpected);
@@ -141,7 +279,13 @@
 
 - (void)connection:(NSURLConnection *)connection didFailWithError:(NSError *)error
 {
+    if ([self retryAfterError:error]) {
+        return;
+    }
+    
     [self.outputStream close];
+    [self checkpointResumeRecord];
+    [self closeSinkWithError:[CMISErrors cmisError:error withCMISErrorCode:kCMISErrorCodeConnection]];
 
     self.progressBlock = nil;
 
@@ -151,11 +295,223 @@
 
 - (void)connectionDidFinishLoading:(NSURLConnection *)connection
 {
+    if ([self retryAfterError:nil]) {
+        return;
+    }
+    
     [self.outputStream close];
+    
+    if (self.isReceivingContent) {
+        [self.resumeRecord remove]; // download is complete
+    } else {
+        [self.resumeRecord save];
+    }
 
     self.progressBlock = nil;
 
+    if (self.sink) {
+        // the sink may still be writing data it accepted; the download is only complete once it is done
+        id<CMISDownloadSink> sink = self.sink;
+        self.sink = nil;
+        sink.spaceAvailableBlock = nil;
+        NSError *downloadError = self.isReceivingContent ? nil : [CMISErrors createCMISErrorWithCode:kCMISErrorCodeConnection
+                                                                             withDetailedDescription:@"Server returned an error"];
+        [sink closeWithError:downloadError completionBlock:^(NSError *sinkError) {
+            if (sinkError && self.completionBlock) {
+                void (^completionBlock)(CMISHttpResponse *httpResponse, NSError *error) = self.completionBlock;
+                self.completionBlock = nil;
+                self.connection = nil;
+                completionBlock(nil, [CMISErrors cmisError:sinkError withCMISErrorCode:kCMISErrorCodeStorage]);
+            } else {
+                [super connectionDidFinishLoading:connection];
+            }
+        }];
+        return;
+    }
+
     [super connectionDidFinishLoading:connection];
 }
 
+#pragma mark Retries
+
+- (BOOL)canRetry
+{
+    if (self.bytesDownloaded == 0 || self.resumeRecord) {
+        return YES; // nothing written yet, or the download can continue with a Range request
+    }
+    return self.sink == nil && self.outputStream == nil; // content in memory is simply received again
+}
+
+- (void)prepareForRetry
+{
+    if (self.resumeRecord && self.bytesDownloaded > self.resumeRecord.bytesWritten) {
+        [self.outputStream close];
+        [self checkpointResumeRecord];
+        self.outputStream = [NSOutputStream outputStreamToFileAtPath:self.resumeRecord.filePath append:YES];
+    }
+}
+
+#pragma mark Helpers
+
+- (void)cancelWithStorageError:(NSString *)detailedDescription
+{
+    [self cancelWithError:[CMISErrors createCMISErrorWithCode:kCMISErrorCodeStorage withDetailedDescription:detailedDescription]];
+}
+
+
+- (void)cancelWithError:(NSError *)error
+{
+    void (^completionBlock)(CMISHttpResponse *httpResponse, NSError *error) = self.completionBlock;
+    self.completionBlock = nil; // the connection must not report the cancellation
+    
+    [self.connection cancel];
+    self.connection = nil;
+    [self.outputStream close];
+    [self checkpointResumeRecord];
+    [self closeSinkWithError:error];
+    self.progressBlock = nil;
+    
+    if (completionBlock) {
+        completionBlock(nil, error);
+    }
+}
+
+
+// Hands data to the sink. If the sink is full, the rest is kept and the connection suspended until the sink
+// has space again. Returns NO if the sink failed and the download has been aborted
+- (BOOL)writeDataToSink:(NSData *)data
+{
+    const uint8_t *bytes = data.bytes;
+    NSUInteger length = data.length;
+    NSUInteger offset = 0;
+    while (offset < length) {
+        NSInteger written = [self.sink writeBytes:&bytes[offset] maxLength:length - offset];
+        if (written < 0) {
+            id<CMISDownloadSink> sink = self.sink;
+            if ([sink respondsToSelector:@selector(isClosedByConsumer)] && [sink isClosedByConsumer]) {
+                [self cancelWithError:[CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled
+                                                  withDetailedDescription:@"Content was closed by its consumer"]];
+            } else {
+                [self cancelWithStorageError:@"Download sink does not accept any more data"];
+            }
+            return NO;
+        } else if (written == 0) {
+            self.pendingData = [data subdataWithRange:NSMakeRange(offset, length - offset)];
+            [self suspend];
+            return YES;
+        }
+        offset += written;
+    }
+    return YES;
+}
+
+
+- (void)sinkHasSpaceAvailable
+{
+    // the sink may call from its consumer's thread; the connection belongs to the run loop it was started on
+    CFRunLoopRef cfRunLoop = [self.runLoop getCFRunLoop];
+    CFRunLoopPerformBlock(cfRunLoop, kCFRunLoopCommonModes, ^{
+        [self writePendingDataToSink];
+    });
+    CFRunLoopWakeUp(cfRunLoop);
+}
+
+
+- (void)writePendingDataToSink
+{
+    NSData *pendingData = self.pendingData;
+    if (pendingData == nil || self.sink == nil) {
+        return;
+    }
+    self.pendingData = nil;
+    
+    if ([self writeDataToSink:pendingData] && self.pendingData == nil) {
+        [self resume];
+    }
+}
+
+
+- (void)closeSinkWithError:(NSError *)error
+{
+    id<CMISDownloadSink> sink = self.sink;
+    self.sink = nil;
+    self.pendingData = nil;
+    sink.spaceAvailableBlock = nil;
+    [sink closeWithError:error completionBlock:nil];
+}
+
+
+- (void)checkpointResumeRecord
+{
+    if (self.resumeRecord && self.isReceivingContent) {
+        self.resumeRecord.bytesWritten = self.bytesDownloaded;
+        [self.resumeRecord save];
+        self.bytesCheckpointed = self.bytesDownloaded;
+    }
+}
+
+
+- (void)restartDownload
+{
+    [self.outputStream close];
+    [self.resumeRecord reset];
+    [self.resumeRecord save];
+    self.outputStream = [NSOutputStream outputStreamToFileAtPath:self.resumeRecord.filePath append:NO];
+    
+    [self startRequest:self.urlRequest];
+}
+
+
+- (void)completeResumedDownload
+{
+    [self.outputStream close];
+    self.outputStream = nil;
+    [self.resumeRecord truncateFileToBytesWritten]; // drops anything written after the last checkpoint
+    [self.resumeRecord remove];
+    
+    self.bytesDownloaded = self.resumeRecord.bytesWritten;
+    if (self.progressBlock) {
+        self.progressBlock(self.bytesDownloaded, self.bytesDownloaded);
+    }
+    self.progressBlock = nil;
+    
+    void (^completionBlock)(CMISHttpResponse *httpResponse, NSError *error) = self.completionBlock;
+    self.completionBlock = nil;
+    self.connection = nil;
+    if (completionBlock) {
+        completionBlock([CMISHttpResponse responseUsingURLHTTPResponse:self.response andData:nil], nil);
+    }
+}
+
+
+// Returns the complete length of the Content-Range header ("bytes */2000" or "bytes 0-999/2000"), or -1 if unknown
+- (long long)contentRangeCompleteLength
+{
+    NSString *contentRange = [CMISHttpResponse valueForHeaderField:@"Content-Range" inHeaders:self.response.allHeaderFields];
+    NSRange slash = [contentRange rangeOfString:@"/"];
+    if (slash.location != NSNotFound) {
+        NSScanner *scanner = [NSScanner scannerWithString:[contentRange substringFromIndex:slash.location + 1]];
+        long long length = 0;
+        if ([scanner scanLongLong:&length]) {
+            return length;
+        }
+    }
+    return -1;
+}
+
+
+// Returns the first byte position of the Content-Range header ("bytes 1000-1999/2000"), or -1 if absent
+- (long long)contentRangeStart
+{
+    NSString *contentRange = [CMISHttpResponse valueForHeaderField:@"Content-Range" inHeaders:self.response.allHeaderFields];
+    if (contentRange) {
+        NSScanner *scanner = [NSScanner scannerWithString:contentRange];
+        long long start = 0;
+        if ([scanner scanString:@"bytes" intoString:NULL] && [scanner scanLongLong:&start]) {
+            return start;
+        }
+    }
+    return -1;
+}
+
 @end
@@ -14,10 +14,12 @@
 
 #import <Foundation/Foundation.h>
 #import "CMISHttpUtil.h"
+#import "CMISRequest.h"
 
 @class CMISAuthenticationProvider;
+@class CMISHttpRetryPolicy;
 
-@interface CMISHttpRequest : NSObject <NSURLConnectionDataDelegate>
+@interface CMISHttpRequest : NSObject <NSURLConnectionDataDelegate, CMISCancellableRequest>
 
 @property (nonatomic, assign) CMISHttpRequestMethod requestMethod;
 @property (nonatomic, strong) NSURLConnection *connection;
@@ -27,6 +29,12 @@
 @property (nonatomic, strong) NSHTTPURLResponse *response;
 @property (nonatomic, strong) id<CMISAuthenticationProvider> authenticationProvider;
 @property (nonatomic, copy) void (^completionBlock)(CMISHttpResponse *httpResponse, NSError *error);
+@property (nonatomic, strong, readonly) NSRunLoop *runLoop; // the run loop delivering the connection callbacks
+@property (nonatomic, assign, readonly, getter = isSuspended) BOOL suspended;
+@property (nonatomic, strong) NSMutableURLRequest *urlRequest; // the request as last started, before the session headers, used to send it again
+@property (nonatomic, strong) CMISHttpRetryPolicy *retryPolicy; // optional; without one, failed requests are not retried
+@property (nonatomic, assign, readonly) NSUInteger attemptCount;
+@property (nonatomic, copy) void (^responseReceivedBlock)(NSHTTPURLResponse *response); // optional; called when the response starts
 
 + (CMISHttpRequest*)startRequest:(NSMutableURLRequest *)urlRequest
               withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
@@ -42,4 +50,28 @@
 
 - (void)cancel;
 
+// stops reading from the connection, so the server is held back by TCP flow control, until resume is called
+- (void)suspend;
+
+- (void)resume;
+
+/**
+ * Asks the retry policy whether the failed request should be sent again and if so, schedules it and returns YES.
+ * The error is the transport error, if any; otherwise the status of the response is checked.
+ * Subclasses overriding the connection callbacks call this before tearing down their state.
+ */
+- (BOOL)retryAfterError:(NSError *)error;
+
+// subclasses return NO once the request can not be repeated, e.g. because the body has been consumed
+- (BOOL)canRetry;
+
+// called before a retry is started, subclasses reset their state for the new attempt
+- (void)prepareForRetry;
+
+/**
+ * Returns NO if the status of the response is not a success for the method, and sets the error to the matching
+ * CMIS error, with the status under kCMISErrorKeyHttpStatusCode in its userInfo.
+ */
+- (BOOL)checkStatusCodeForResponse:(CMISHttpResponse *)response withHttpRequestMethod:(CMISHttpRequestMethod)httpRequestMethod error:(NSError **)error;
+
 @end
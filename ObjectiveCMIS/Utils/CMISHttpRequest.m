@@ -17,6 +17,7 @@
 #import "CMISHttpResponse.h"
 #import "CMISErrors.h"
 #import "CMISAuthenticationProvider.h"
+#import "CMISHttpRetryPolicy.h"
 
 //Exception names as returned in the <!--exception> tag
 NSString * const kCMISExceptionInvalidArgument         = @"invalidArgument";
@@ -34,6 +35,17 @@ NSString * const kCMISExceptionUpdateConflict          = @"updateConflict";
 NSString * const kCMISExceptionVersioning              = @"versioning";
 
 
+@interface CMISHttpRequest ()
+
+@property (nonatomic, strong, readwrite) NSRunLoop *runLoop;
+@property (nonatomic, assign, readwrite, getter = isSuspended) BOOL suspended;
+@property (nonatomic, assign, readwrite) NSUInteger attemptCount;
+@property (nonatomic, strong) NSTimer *retryTimer;
+@property (nonatomic, assign) BOOL retryDeclined; // the policy has been asked for this attempt already
+
+@end
+
+
 @implementation CMISHttpRequest
 
 @synthesize requestMethod = _requestMethod;
@@ -44,6 +56,14 @@ NSString * const kCMISExceptionVersioning              = @"versioning";
 @synthesize authenticationProvider = _authenticationProvider;
 @synthesize completionBlock = _completionBlock;
 @synthesize connection = _connection;
+@synthesize runLoop = _runLoop;
+@synthesize suspended = _suspended;
+@synthesize urlRequest = _urlRequest;
+@synthesize retryPolicy = _retryPolicy;
+@synthesize attemptCount = _attemptCount;
+@synthesize retryTimer = _retryTimer;
+@synthesize retryDeclined = _retryDeclined;
+@synthesize responseReceivedBlock = _responseReceivedBlock;
 
 + (CMISHttpRequest*)startRequest:(NSMutableURLRequest *)urlRequest
                   withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
@@ -84,6 +104,9 @@ NSString * const kCMISExceptionVersioning              = @"versioning";
         [urlRequest setHTTPBody:self.requestBody];
     }
     
+    // kept without the headers added below, so sending it again does not add them twice
+    self.urlRequest = [urlRequest mutableCopy];
+    
     [self.authenticationProvider.httpHeadersToApply enumerateKeysAndObjectsUsingBlock:^(NSString *headerName, NSString *header, BOOL *stop) {
         [urlRequest addValue:header forHTTPHeaderField:headerName];
     }];
@@ -92,6 +115,10 @@ NSString * const kCMISExceptionVersioning              = @"versioning";
         [urlRequest addValue:header forHTTPHeaderField:headerName];
     }];
     
+    self.attemptCount++;
+    self.retryDeclined = NO;
+    self.runLoop = [NSRunLoop currentRunLoop]; // connectionWithRequest:delegate: schedules the connection here
+    self.suspended = NO;
     self.connection = [NSURLConnection connectionWithRequest:urlRequest delegate:self];
     if (self.connection) {
         return YES;
@@ -107,18 +134,39 @@ NSString * const kCMISExceptionVersioning              = @"versioning";
 
 - (void)cancel
 {
-    if (self.connection) {
+    if (self.connection || self.retryTimer) {
         void (^completionBlock)(CMISHttpResponse *httpResponse, NSError *error);
         completionBlock = self.completionBlock; // remember completion block in order to invoke it after the connection was cancelled
         
         self.completionBlock = nil; // prevent potential NSURLConnection delegate callbacks to invoke the completion block redundantly
         
+        [self.retryTimer invalidate]; // the request may be waiting for a retry
+        self.retryTimer = nil;
         [self.connection cancel];
         
         self.connection = nil;
         
-        NSError *cmisError = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled withDetailedDescription:@"Request was cancelled"];
-        completionBlock(nil, cmisError);
+        if (completionBlock) {
+            NSError *cmisError = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled withDetailedDescription:@"Request was cancelled"];
+            completionBlock(nil, cmisError);
+        }
+    }
+}
+
+
+- (void)suspend
+{
+    if (self.connection && !self.isSuspended) {
+        [self.connection unscheduleFromRunLoop:self.runLoop forMode:NSDefaultRunLoopMode];
+        self.suspended = YES;
+    }
+}
+
+- (void)resume
+{
+    if (self.connection && self.isSuspended) {
+        [self.connection scheduleInRunLoop:self.runLoop forMode:NSDefaultRunLoopMode];
+        self.suspended = NO;
     }
 }
 
@@ -129,6 +177,10 @@ NSString * const kCMISExceptionVersioning              = @"versioning";
     if ([response isKindOfClass:NSHTTPURLResponse.class]) {
         self.response = (NSHTTPURLResponse*)response;
     }
+    
+    if (self.responseReceivedBlock) {
+        self.responseReceivedBlock(self.response);
+    }
 }
 
 
@@ -140,6 +192,10 @@ NSString * const kCMISExceptionVersioning              = @"versioning";
 
 - (void)connection:(NSURLConnection *)connection didFailWithError:(NSError *)error
 {
+    if ([self retryAfterError:error]) {
+        return;
+    }
+    
     [self.authenticationProvider updateWithHttpURLResponse:self.response];
 
     if (self.completionBlock) {
@@ -156,6 +212,10 @@ NSString * const kCMISExceptionVersioning              = @"versioning";
 
 - (void)connectionDidFinishLoading:(NSURLConnection *)connection
 {
+    if ([self retryAfterError:nil]) {
+        return;
+    }
+    
     [self.authenticationProvider updateWithHttpURLResponse:self.response];
     
     if (self.completionBlock) {
@@ -173,11 +233,63 @@ NSString * const kCMISExceptionVersioning              = @"versioning";
     self.connection = nil;
 }
 
+#pragma mark Retries
+
+- (BOOL)retryAfterError:(NSError *)error
+{
+    if (self.retryPolicy == nil || self.completionBlock == nil || self.retryDeclined) {
+        return NO;
+    }
+    if (error == nil && (self.response == nil || self.response.statusCode < 400)) {
+        return NO; // success
+    }
+    
+    NSTimeInterval delay = -1;
+    if ([self canRetry]) {
+        delay = [self.retryPolicy delayBeforeRetryingRequestWithMethod:self.requestMethod
+                                                               attempt:self.attemptCount
+                                                                 error:error
+                                                              response:self.response];
+    }
+    if (delay < 0) {
+        self.retryDeclined = YES;
+        return NO;
+    }
+    
+    log(@"Attempt %lu to %@ failed (%@), retrying in %.1f seconds", (unsigned long)self.attemptCount, self.urlRequest.URL,
+        error ? error.localizedDescription : [NSString stringWithFormat:@"status %ld", (long)self.response.statusCode], delay);
+    [self.connection cancel];
+    self.connection = nil;
+    self.response = nil;
+    self.responseBody = nil;
+    [self prepareForRetry];
+    
+    self.retryTimer = [NSTimer timerWithTimeInterval:delay target:self selector:@selector(retryTimerFired:) userInfo:nil repeats:NO];
+    [self.runLoop addTimer:self.retryTimer forMode:NSDefaultRunLoopMode];
+    return YES;
+}
+
+- (BOOL)canRetry
+{
+    return YES; // the body, if any, is kept in memory
+}
+
+- (void)prepareForRetry
+{
+}
+
+- (void)retryTimerFired:(NSTimer *)timer
+{
+    self.retryTimer = nil;
+    [self startRequest:self.urlRequest];
+}
+
 - (BOOL)checkStatusCodeForResponse:(CMISHttpResponse *)response withHttpRequestMethod:(CMISHttpRequestMethod)httpRequestMethod error:(NSError **)error
 {
-    if ( (httpRequestMethod == HTTP_GET && response.statusCode != 200)
+    if ( (httpRequestMethod == HTTP_GET && response.statusCode != 200 && response.statusCode != 206)
         || (httpRequestMethod == HTTP_POST && response.statusCode != 201)
         || (httpRequestMethod == HTTP_DELETE && response.statusCode != 204)
+        || (httpRequestMethod == HTTP_HEAD && response.statusCode != 200)
         || (httpRequestMethod == HTTP_PUT && ((response.statusCode < 200 || response.statusCode > 299))))
     {
         log(@"Error content: %@", [[NSString alloc] initWithData:response.data encoding:NSUTF8StringEncoding]);
@@ -243,6 +355,10 @@ NSString * const kCMISExceptionVersioning              = @"versioning";
                                              withDetailedDescription:errorMessage];
                     }
                     break;
+                case 415:
+                    *error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeNotSupported
+                                         withDetailedDescription:errorMessage];
+                    break;
                 default:
                     if ([exception isEqualToString:kCMISExceptionStorage]) {
                         *error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeStorage
@@ -252,6 +368,11 @@ NSString * const kCMISExceptionVersioning              = @"versioning";
                                              withDetailedDescription:response.errorMessage];
                     }
             }
+            
+            // several statuses map to the same error code, the status itself tells them apart
+            NSMutableDictionary *userInfo = [(*error).userInfo mutableCopy];
+            [userInfo setObject:[NSNumber numberWithInteger:response.statusCode] forKey:kCMISErrorKeyHttpStatusCode];
+            *error = [NSError errorWithDomain:(*error).domain code:(*error).code userInfo:userInfo];
         }
         return NO;
     } else {
@@ -18,9 +18,15 @@
 @property NSInteger statusCode;
 @property (nonatomic, strong) NSString *statusCodeMessage;
 @property (nonatomic, strong, readonly) NSData *data;
+@property (nonatomic, strong, readonly) NSDictionary *responseHeaders;
 
 + (CMISHttpResponse *)responseUsingURLHTTPResponse:(NSHTTPURLResponse *)HTTPURLResponse andData:(NSData *)data;
 
+// Looks up a header field case-insensitively, as servers and proxies do not agree on the capitalization
++ (NSString *)valueForHeaderField:(NSString *)headerField inHeaders:(NSDictionary *)headers;
+
+- (NSString *)valueForHeaderField:(NSString *)headerField;
+
 - (NSString*)exception;
 - (NSString*)errorMessage;
 
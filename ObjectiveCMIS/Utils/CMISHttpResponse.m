@@ -17,6 +17,7 @@
 @interface CMISHttpResponse ()
 
 @property (nonatomic, strong) NSData *data;
+@property (nonatomic, strong) NSDictionary *responseHeaders;
 @property (nonatomic, strong) NSString *responseString;
 
 @end
@@ -26,6 +27,7 @@
 
 @synthesize statusCode = _statusCode;
 @synthesize data = _data;
+@synthesize responseHeaders = _responseHeaders;
 @synthesize statusCodeMessage = _statusCodeMessage;
 @synthesize responseString = _responseString;
 
@@ -34,11 +36,32 @@
     CMISHttpResponse *httpResponse = [[CMISHttpResponse alloc] init];
     httpResponse.statusCode = httpUrlResponse.statusCode;
     httpResponse.data = data;
+    httpResponse.responseHeaders = httpUrlResponse.allHeaderFields;
     httpResponse.statusCodeMessage = [NSHTTPURLResponse localizedStringForStatusCode:[httpUrlResponse statusCode]];
     return httpResponse;
 }
 
 
++ (NSString *)valueForHeaderField:(NSString *)headerField inHeaders:(NSDictionary *)headers
+{
+    NSString *value = [headers objectForKey:headerField];
+    if (value == nil) {
+        for (NSString *key in headers) {
+            if ([key caseInsensitiveCompare:headerField] == NSOrderedSame) {
+                return [headers objectForKey:key];
+            }
+        }
+    }
+    return value;
+}
+
+
+- (NSString *)valueForHeaderField:(NSString *)headerField
+{
+    return [CMISHttpResponse valueForHeaderField:headerField inHeaders:self.responseHeaders];
+}
+
+
 - (NSString*)responseString
 {
     if (_responseString == nil) {
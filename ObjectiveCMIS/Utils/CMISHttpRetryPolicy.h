@@ -0,0 +1,70 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+#import "CMISHttpUtil.h"
+
+/**
+ * Decides whether a failed HTTP request is sent again, and after which delay.
+ *
+ * Transient failures (timeouts, dropped connections, 502/503/504 and 429) are retried with exponential backoff
+ * and full jitter, or after the delay the server asks for in a Retry-After header. GET, HEAD, PUT and DELETE are
+ * retried freely; POST only if the server can not have processed it, i.e. the connection never reached the
+ * server or the server refused it with 503 or 429.
+ *
+ * Every request adds a fraction of a retry to a budget and every retry takes one, so that an outage does not
+ * multiply the load on the repository. One policy is shared by all requests of a session and is thread-safe.
+ */
+@interface CMISHttpRetryPolicy : NSObject
+
+// total number of attempts, including the first one; 1 disables retries. Defaults to 3
+@property (nonatomic, assign) NSUInteger maxAttempts;
+
+// delay before the first retry, doubled for every further one. Defaults to 0.5 seconds
+@property (nonatomic, assign) NSTimeInterval initialDelay;
+
+// upper limit for the delay; a Retry-After asking for a longer wait is not honoured but ends the retries. Defaults to 30 seconds
+@property (nonatomic, assign) NSTimeInterval maxDelay;
+
+// retries earned by every request. Defaults to 0.1, i.e. at most one request in ten is retried in the long run
+@property (nonatomic, assign) double budgetPerRequest;
+
+// retries that can be saved up while all goes well. Defaults to 10
+@property (nonatomic, assign) double maxBudget;
+
+// metrics
+@property (nonatomic, assign, readonly) unsigned long long requestCount;
+@property (nonatomic, assign, readonly) unsigned long long retryCount;
+@property (nonatomic, assign, readonly) unsigned long long retriesExhaustedCount; // failures given up after maxAttempts
+@property (nonatomic, assign, readonly) unsigned long long budgetExhaustedCount;  // retries refused because the budget was spent
+
+// Returns the policy set with kCMISSessionParameterRetryPolicy, or a default policy that is kept in the session
++ (CMISHttpRetryPolicy *)retryPolicyForSession:(CMISBindingSession *)session;
+
+// Called for every new request, adds to the retry budget
+- (void)recordRequest;
+
+/**
+ * Returns the delay after which a request that failed on the given attempt (1 for the first) should be sent again,
+ * or a negative value if it should not be retried. The error is the transport error, if any, the response the
+ * HTTP response, if any. Every positive answer counts as a retry and is taken from the budget.
+ */
+- (NSTimeInterval)delayBeforeRetryingRequestWithMethod:(CMISHttpRequestMethod)httpRequestMethod
+                                               attempt:(NSUInteger)attempt
+                                                 error:(NSError *)error
+                                              response:(NSHTTPURLResponse *)response;
+
+- (void)resetMetrics;
+
+@end
@@ -0,0 +1,192 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISHttpRetryPolicy.h"
+#import "CMISHttpResponse.h"
+#import "CMISSessionParameters.h"
+
+#define DEFAULT_MAX_ATTEMPTS 3
+#define DEFAULT_INITIAL_DELAY 0.5
+#define DEFAULT_MAX_DELAY 30.0
+#define DEFAULT_BUDGET_PER_REQUEST 0.1
+#define DEFAULT_MAX_BUDGET 10.0
+
+@interface CMISHttpRetryPolicy ()
+
+@property (nonatomic, assign, readwrite) unsigned long long requestCount;
+@property (nonatomic, assign, readwrite) unsigned long long retryCount;
+@property (nonatomic, assign, readwrite) unsigned long long retriesExhaustedCount;
+@property (nonatomic, assign, readwrite) unsigned long long budgetExhaustedCount;
+@property (nonatomic, assign) double budget;
+
+@end
+
+@implementation CMISHttpRetryPolicy
+
+@synthesize maxAttempts = _maxAttempts;
+@synthesize initialDelay = _initialDelay;
+@synthesize maxDelay = _maxDelay;
+@synthesize budgetPerRequest = _budgetPerRequest;
+@synthesize maxBudget = _maxBudget;
+@synthesize requestCount = _requestCount;
+@synthesize retryCount = _retryCount;
+@synthesize retriesExhaustedCount = _retriesExhaustedCount;
+@synthesize budgetExhaustedCount = _budgetExhaustedCount;
+@synthesize budget = _budget;
+
++ (CMISHttpRetryPolicy *)retryPolicyForSession:(CMISBindingSession *)session
+{
+    CMISHttpRetryPolicy *retryPolicy = [session objectForKey:kCMISSessionParameterRetryPolicy];
+    if (retryPolicy == nil) {
+        retryPolicy = [session objectForKey:kCMISBindingSessionKeyRetryPolicy];
+        if (retryPolicy == nil) {
+            retryPolicy = [session setObject:[[CMISHttpRetryPolicy alloc] init] forKeyIfAbsent:kCMISBindingSessionKeyRetryPolicy];
+        }
+    }
+    return retryPolicy;
+}
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        _maxAttempts = DEFAULT_MAX_ATTEMPTS;
+        _initialDelay = DEFAULT_INITIAL_DELAY;
+        _maxDelay = DEFAULT_MAX_DELAY;
+        _budgetPerRequest = DEFAULT_BUDGET_PER_REQUEST;
+        _maxBudget = DEFAULT_MAX_BUDGET;
+        _budget = DEFAULT_MAX_BUDGET;
+    }
+    return self;
+}
+
+- (void)recordRequest
+{
+    @synchronized(self) {
+        self.requestCount++;
+        self.budget = MIN(self.budget + self.budgetPerRequest, self.maxBudget);
+    }
+}
+
+- (NSTimeInterval)delayBeforeRetryingRequestWithMethod:(CMISHttpRequestMethod)httpRequestMethod
+                                               attempt:(NSUInteger)attempt
+                                                 error:(NSError *)error
+                                              response:(NSHTTPURLResponse *)response
+{
+    NSInteger statusCode = (error == nil) ? response.statusCode : 0;
+    if (![self isTransientError:error statusCode:statusCode]) {
+        return -1;
+    }
+    
+    // a POST that reached the server may have been processed already, sending it again could create a duplicate
+    BOOL idempotent = (httpRequestMethod != HTTP_POST);
+    BOOL notProcessed = [self isConnectionError:error] || statusCode == 503 || statusCode == 429;
+    if (!idempotent && !notProcessed) {
+        return -1;
+    }
+    
+    NSTimeInterval delay = [self backoffDelayForAttempt:attempt];
+    NSString *retryAfter = [CMISHttpResponse valueForHeaderField:@"Retry-After" inHeaders:response.allHeaderFields];
+    if (retryAfter) {
+        NSTimeInterval requestedDelay = [self delayForRetryAfterHeader:retryAfter];
+        if (requestedDelay > self.maxDelay) {
+            log(@"Server asks to retry after %.0f seconds, not waiting that long", requestedDelay);
+            return -1;
+        }
+        delay = MAX(delay, requestedDelay);
+    }
+    
+    @synchronized(self) {
+        if (attempt >= self.maxAttempts) {
+            self.retriesExhaustedCount++;
+            return -1;
+        }
+        if (self.budget < 1.0) {
+            self.budgetExhaustedCount++;
+            return -1;
+        }
+        self.budget -= 1.0;
+        self.retryCount++;
+    }
+    return delay;
+}
+
+- (void)resetMetrics
+{
+    @synchronized(self) {
+        self.requestCount = 0;
+        self.retryCount = 0;
+        self.retriesExhaustedCount = 0;
+        self.budgetExhaustedCount = 0;
+    }
+}
+
+#pragma mark Helpers
+
+- (BOOL)isTransientError:(NSError *)error statusCode:(NSInteger)statusCode
+{
+    if (error) {
+        if (![error.domain isEqualToString:NSURLErrorDomain]) {
+            return NO;
+        }
+        switch (error.code) {
+            case NSURLErrorTimedOut:
+            case NSURLErrorNetworkConnectionLost:
+            case NSURLErrorNotConnectedToInternet:
+            case NSURLErrorCannotConnectToHost:
+            case NSURLErrorCannotFindHost:
+            case NSURLErrorDNSLookupFailed:
+                return YES;
+            default:
+                return NO;
+        }
+    }
+    return statusCode == 429 || statusCode == 502 || statusCode == 503 || statusCode == 504;
+}
+
+// errors raised before the request could be sent to the server
+- (BOOL)isConnectionError:(NSError *)error
+{
+    return [error.domain isEqualToString:NSURLErrorDomain]
+        && (error.code == NSURLErrorCannotConnectToHost
+            || error.code == NSURLErrorCannotFindHost
+            || error.code == NSURLErrorDNSLookupFailed
+            || error.code == NSURLErrorNotConnectedToInternet);
+}
+
+// exponential backoff with full jitter: a random delay between 0 and initialDelay * 2^(attempt-1), capped at maxDelay
+- (NSTimeInterval)backoffDelayForAttempt:(NSUInteger)attempt
+{
+    NSTimeInterval ceiling = MIN(self.initialDelay * pow(2.0, (double)(attempt - 1)), self.maxDelay);
+    return ceiling * ((double)arc4random() / UINT32_MAX);
+}
+
+// Retry-After is either a number of seconds or an HTTP date
+- (NSTimeInterval)delayForRetryAfterHeader:(NSString *)retryAfter
+{
+    NSScanner *scanner = [NSScanner scannerWithString:retryAfter];
+    NSInteger seconds = 0;
+    if ([scanner scanInteger:&seconds] && scanner.isAtEnd) {
+        return MAX(seconds, 0);
+    }
+    
+    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
+    dateFormatter.locale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+    dateFormatter.timeZone = [NSTimeZone timeZoneWithAbbreviation:@"GMT"];
+    dateFormatter.dateFormat = @"EEE, dd MMM yyyy HH:mm:ss zzz";
+    NSDate *date = [dateFormatter dateFromString:retryAfter];
+    return date ? MAX([date timeIntervalSinceNow], 0) : 0;
+}
+
+@end
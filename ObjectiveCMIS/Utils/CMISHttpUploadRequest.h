@@ -17,14 +17,44 @@
 @interface CMISHttpUploadRequest : CMISHttpRequest
 
 @property (nonatomic, strong) NSInputStream *inputStream;
+// alternative to the inputStream: the body is read from this file, with a fresh stream for every attempt,
+// which makes the request replayable if it has to be retried
+@property (nonatomic, strong) NSString *bodyFilePath;
 @property (nonatomic, assign) unsigned long long bytesExpected; // optional; if not set, expected content length from HTTP header is used
 @property (nonatomic, readonly) unsigned long long bytesUploaded;
 
+// if greater than 0, the request is sent with "Expect: 100-continue" and the body is held back for up to this
+// many seconds, so a server rejecting the request (e.g. 401, 403, 409, 413) can do so before any content is sent.
+// NSURLConnection does not report interim 100 responses, so the timeout is what eventually releases the body:
+// every accepted upload is delayed by the full timeout. Off by default; HttpUtil only sets it for sessions
+// that opt in with kCMISSessionParameterExpectContinueThreshold, and for bodies of at least that size
+@property (nonatomic, assign) NSTimeInterval expectContinueTimeout;
+
++ (CMISHttpUploadRequest*)startRequest:(NSMutableURLRequest *)urlRequest
+                        withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+                           inputStream:(NSInputStream*)inputStream
+                               headers:(NSDictionary*)addionalHeaders
+                         bytesExpected:(unsigned long long)bytesExpected
+                authenticationProvider:(id<CMISAuthenticationProvider>) authenticationProvider
+                       completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+                         progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock;
+
 + (CMISHttpUploadRequest*)startRequest:(NSMutableURLRequest *)urlRequest
                         withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
                            inputStream:(NSInputStream*)inputStream
                                headers:(NSDictionary*)addionalHeaders
                          bytesExpected:(unsigned long long)bytesExpected
+                 expectContinueTimeout:(NSTimeInterval)expectContinueTimeout
+                authenticationProvider:(id<CMISAuthenticationProvider>) authenticationProvider
+                       completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+                         progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock;
+
++ (CMISHttpUploadRequest*)startRequest:(NSMutableURLRequest *)urlRequest
+                        withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+                              bodyFile:(NSString*)bodyFilePath
+                               headers:(NSDictionary*)addionalHeaders
+                         bytesExpected:(unsigned long long)bytesExpected
+                 expectContinueTimeout:(NSTimeInterval)expectContinueTimeout
                 authenticationProvider:(id<CMISAuthenticationProvider>) authenticationProvider
                        completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
                          progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock;
@@ -13,11 +13,21 @@
  */
 #import "CMISHttpUploadRequest.h"
 
-@interface CMISHttpUploadRequest ()
+// size of the buffer between the input stream and the connection when the body is held back for 100-continue
+#define BODY_BUFFER_SIZE 65536
+
+@interface CMISHttpUploadRequest () <NSStreamDelegate>
 
 @property (nonatomic, assign) unsigned long long bytesUploaded;
 @property (nonatomic, copy) void (^progressBlock)(unsigned long long bytesUploaded, unsigned long long bytesTotal);
 
+// 100-continue: the connection reads the body from a bound stream pair, which is only fed once the body is released
+@property (nonatomic, strong) NSOutputStream *bodyWriteStream;
+@property (nonatomic, strong) NSMutableData *bodyBuffer;
+@property (nonatomic, strong) NSTimer *continueTimer;
+@property (nonatomic, assign) BOOL bodyReleased;
+@property (nonatomic, assign) unsigned long long bodyBytesPumped;
+
 @end
 
 
@@ -27,6 +37,13 @@
 @synthesize progressBlock = _progressBlock;
 @synthesize bytesExpected = _bytesExpected;
 @synthesize bytesUploaded = _bytesUploaded;
+@synthesize expectContinueTimeout = _expectContinueTimeout;
+@synthesize bodyFilePath = _bodyFilePath;
+@synthesize bodyWriteStream = _bodyWriteStream;
+@synthesize bodyBuffer = _bodyBuffer;
+@synthesize continueTimer = _continueTimer;
+@synthesize bodyReleased = _bodyReleased;
+@synthesize bodyBytesPumped = _bodyBytesPumped;
 
 + (CMISHttpUploadRequest*)startRequest:(NSMutableURLRequest *)urlRequest
                         withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
@@ -36,6 +53,28 @@
                 authenticationProvider:(id<CMISAuthenticationProvider>) authenticationProvider
                        completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
                          progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock
+{
+    return [self startRequest:urlRequest
+               withHttpMethod:httpRequestMethod
+                  inputStream:inputStream
+                      headers:additionalHeaders
+                bytesExpected:bytesExpected
+        expectContinueTimeout:0
+       authenticationProvider:authenticationProvider
+              completionBlock:completionBlock
+                progressBlock:progressBlock];
+}
+
+
++ (CMISHttpUploadRequest*)startRequest:(NSMutableURLRequest *)urlRequest
+                        withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+                           inputStream:(NSInputStream*)inputStream
+                               headers:(NSDictionary*)additionalHeaders
+                         bytesExpected:(unsigned long long)bytesExpected
+                 expectContinueTimeout:(NSTimeInterval)expectContinueTimeout
+                authenticationProvider:(id<CMISAuthenticationProvider>) authenticationProvider
+                       completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+                         progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock
 {
     CMISHttpUploadRequest *httpRequest = [[self alloc] initWithHttpMethod:httpRequestMethod
                                                           completionBlock:completionBlock
@@ -43,9 +82,37 @@
     httpRequest.inputStream = inputStream;
     httpRequest.additionalHeaders = additionalHeaders;
     httpRequest.bytesExpected = bytesExpected;
+    httpRequest.expectContinueTimeout = expectContinueTimeout;
+    httpRequest.authenticationProvider = authenticationProvider;
+    
+    if ([httpRequest startRequest:urlRequest] == NO) {
+        httpRequest = nil;
+    }
+    
+    return httpRequest;
+}
+
+
++ (CMISHttpUploadRequest*)startRequest:(NSMutableURLRequest *)urlRequest
+                        withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+                              bodyFile:(NSString*)bodyFilePath
+                               headers:(NSDictionary*)additionalHeaders
+                         bytesExpected:(unsigned long long)bytesExpected
+                 expectContinueTimeout:(NSTimeInterval)expectContinueTimeout
+                authenticationProvider:(id<CMISAuthenticationProvider>) authenticationProvider
+                       completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+                         progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock
+{
+    CMISHttpUploadRequest *httpRequest = [[self alloc] initWithHttpMethod:httpRequestMethod
+                                                          completionBlock:completionBlock
+                                                            progressBlock:progressBlock];
+    httpRequest.bodyFilePath = bodyFilePath;
+    httpRequest.additionalHeaders = additionalHeaders;
+    httpRequest.bytesExpected = bytesExpected;
+    httpRequest.expectContinueTimeout = expectContinueTimeout;
     httpRequest.authenticationProvider = authenticationProvider;
     
-    if ([httpRequest startRequest:urlRequest]) {
+    if ([httpRequest startRequest:urlRequest] == NO) {
         httpRequest = nil;
     }
     
@@ -68,7 +135,19 @@
 
 - (BOOL)startRequest:(NSMutableURLRequest*)urlRequest
 {
-    if (self.inputStream) {
+    if (self.bodyFilePath && self.inputStream == nil) {
+        self.inputStream = [NSInputStream inputStreamWithFileAtPath:self.bodyFilePath];
+    }
+    
+    if (self.inputStream && self.expectContinueTimeout > 0) {
+        [urlRequest setValue:@"100-continue" forHTTPHeaderField:@"Expect"];
+        urlRequest.HTTPBodyStream = [self createBodyStream];
+        self.continueTimer = [NSTimer scheduledTimerWithTimeInterval:self.expectContinueTimeout
+                                                              target:self
+                                                            selector:@selector(releaseBody)
+                                                            userInfo:nil
+                                                             repeats:NO];
+    } else if (self.inputStream) {
         urlRequest.HTTPBodyStream = self.inputStream;
     }
 
@@ -79,6 +158,8 @@
 - (void)cancel
 {
     self.progressBlock = nil;
+    [self closeBodyStreams];
+    [self closeBodyFile];
     
     [super cancel];
 }
@@ -88,9 +169,28 @@
 {
     [super connection:connection didReceiveResponse:response];
     
+    if (self.bodyWriteStream && self.response.statusCode >= 400) {
+        // the server has made up its mind already, there is no point in sending (the rest of) the body
+        log(@"Upload rejected with status %ld after %llu bytes of the body", (long)self.response.statusCode, self.bodyBytesPumped);
+        [self closeBodyStreams];
+    }
+    
     self.bytesUploaded = 0;
 }
 
+
+- (NSInputStream *)connection:(NSURLConnection *)connection needNewBodyStream:(NSURLRequest *)request
+{
+    // e.g. after an authentication challenge: only possible as long as nothing of the input stream has been consumed
+    if (self.bodyWriteStream && self.bodyBytesPumped == 0) {
+        [self.bodyWriteStream close];
+        self.bodyWriteStream = nil;
+        return [self createBodyStream];
+    }
+    log(@"Can not resend the body of the request to %@", request.URL);
+    return nil;
+}
+
 - (void)connection:(NSURLConnection *)connection
    didSendBodyData:(NSInteger)bytesWritten
  totalBytesWritten:(NSInteger)totalBytesWritten
@@ -108,6 +208,12 @@ totalBytesExpectedToWrite:(NSInteger)totalBytesExpectedToWrite
 
 - (void)connection:(NSURLConnection *)connection didFailWithError:(NSError *)error
 {
+    if ([self retryAfterError:error]) {
+        return;
+    }
+    
+    [self closeBodyStreams];
+    [self closeBodyFile];
     [super connection:connection didFailWithError:error];
     
     self.progressBlock = nil;
@@ -116,10 +222,141 @@ totalBytesExpectedToWrite:(NSInteger)totalBytesExpectedToWrite
 
 - (void)connectionDidFinishLoading:(NSURLConnection *)connection
 {
+    if ([self retryAfterError:nil]) {
+        return;
+    }
+    
+    [self closeBodyStreams];
+    [self closeBodyFile];
     [super connectionDidFinishLoading:connection];
     
     self.progressBlock = nil;
 }
 
 
+#pragma mark Retries
+
+- (BOOL)canRetry
+{
+    if (self.inputStream == nil || self.bodyFilePath) {
+        return YES;
+    }
+    // a held back body can be sent again as long as nothing has been read from the input stream
+    return self.expectContinueTimeout > 0 && self.inputStream.streamStatus == NSStreamStatusNotOpen;
+}
+
+
+- (void)prepareForRetry
+{
+    [self closeBodyStreams];
+    [self closeBodyFile];
+    self.bodyReleased = NO;
+    self.bodyBytesPumped = 0;
+    self.bytesUploaded = 0;
+}
+
+
+- (void)closeBodyFile
+{
+    if (self.bodyFilePath) {
+        [self.inputStream close];
+        self.inputStream = nil;
+    }
+}
+
+
+#pragma mark 100-continue body
+
+- (NSInputStream *)createBodyStream
+{
+    CFReadStreamRef readStream = NULL;
+    CFWriteStreamRef writeStream = NULL;
+    CFStreamCreateBoundPair(NULL, &readStream, &writeStream, BODY_BUFFER_SIZE);
+    
+    self.bodyWriteStream = CFBridgingRelease(writeStream);
+    self.bodyWriteStream.delegate = self;
+    [self.bodyWriteStream scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
+    [self.bodyWriteStream open];
+    
+    return CFBridgingRelease(readStream);
+}
+
+
+- (void)releaseBody
+{
+    [self.continueTimer invalidate];
+    self.continueTimer = nil;
+    
+    if (!self.bodyReleased) {
+        log(@"No early response from the server, sending the body");
+        self.bodyReleased = YES;
+        [self pumpBody];
+    }
+}
+
+
+- (void)stream:(NSStream *)stream handleEvent:(NSStreamEvent)eventCode
+{
+    if (stream != self.bodyWriteStream) {
+        return;
+    }
+    
+    if (eventCode == NSStreamEventHasSpaceAvailable) {
+        [self pumpBody];
+    } else if (eventCode == NSStreamEventErrorOccurred) {
+        log(@"Error while passing the request body to the connection: %@", stream.streamError);
+        [self closeBodyStreams];
+    }
+}
+
+
+// moves data from the input stream to the connection for as long as the connection takes it
+- (void)pumpBody
+{
+    if (!self.bodyReleased || self.bodyWriteStream == nil) {
+        return;
+    }
+    if (self.inputStream.streamStatus == NSStreamStatusNotOpen) {
+        [self.inputStream open];
+    }
+    
+    while (self.bodyWriteStream.hasSpaceAvailable) {
+        if (self.bodyBuffer.length == 0) {
+            uint8_t buffer[BODY_BUFFER_SIZE];
+            NSInteger bytesRead = [self.inputStream read:buffer maxLength:sizeof(buffer)];
+            if (bytesRead < 0) {
+                log(@"Could not read the request body: %@", self.inputStream.streamError);
+                [self closeBodyStreams]; // the truncated body makes the request fail on the server
+                return;
+            } else if (bytesRead == 0) {
+                [self closeBodyStreams]; // end of body
+                return;
+            }
+            self.bodyBuffer = [NSMutableData dataWithBytes:buffer length:bytesRead];
+        }
+        
+        NSInteger bytesWritten = [self.bodyWriteStream write:self.bodyBuffer.bytes maxLength:self.bodyBuffer.length];
+        if (bytesWritten <= 0) {
+            return;
+        }
+        [self.bodyBuffer replaceBytesInRange:NSMakeRange(0, bytesWritten) withBytes:NULL length:0];
+        self.bodyBytesPumped += bytesWritten;
+    }
+}
+
+
+- (void)closeBodyStreams
+{
+    [self.continueTimer invalidate];
+    self.continueTimer = nil;
+    
+    if (self.bodyWriteStream) {
+        self.bodyWriteStream.delegate = nil;
+        [self.bodyWriteStream close];
+        [self.bodyWriteStream removeFromRunLoop:(self.runLoop ? self.runLoop : [NSRunLoop currentRunLoop]) forMode:NSDefaultRunLoopMode];
+        self.bodyWriteStream = nil;
+        self.bodyBuffer = nil;
+    }
+}
+
 @end
@@ -19,11 +19,14 @@ typedef enum {
     HTTP_GET,
     HTTP_POST,
     HTTP_PUT,
-    HTTP_DELETE
+    HTTP_DELETE,
+    HTTP_HEAD
 } CMISHttpRequestMethod;
 
 @class CMISHttpResponse;
 @class CMISRequest;
+@class CMISDownloadResumeRecord;
+@protocol CMISDownloadSink;
 
 @interface HttpUtil : NSObject
 
@@ -43,6 +46,17 @@ withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
        headers:(NSDictionary *)additionalHeaders 
 completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock;
 
+// generic invoke as part of the operation of the request object: it is not sent if the request object is cancelled
+// (or timed out), and the response is reported as cancelled if the request object is cancelled while waiting for it
+
++ (void)invoke:(NSURL *)url
+withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+   withSession:(CMISBindingSession *)session
+          body:(NSData *)body
+       headers:(NSDictionary *)additionalHeaders
+completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+ requestObject:(CMISRequest *)requestObject;
+
 // generic invokes with progress block
 
 + (void)invoke:(NSURL *)url
@@ -55,15 +69,63 @@ completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))comple
  progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
  requestObject:(CMISRequest *)requestObject;
 
+// the body is read from the file; unlike a stream, it can be sent again if the request is retried
++ (void)invoke:(NSURL *)url
+withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+   withSession:(CMISBindingSession *)session
+      bodyFile:(NSString *)bodyFilePath
+       headers:(NSDictionary *)additionalHeaders
+ bytesExpected:(unsigned long long)bytesExpected
+completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+ progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock
+ requestObject:(CMISRequest *)requestObject;
+
++ (void)invoke:(NSURL *)url
+withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+   withSession:(CMISBindingSession *)session
+  outputStream:(NSOutputStream *)outputStream
+ bytesExpected:(unsigned long long)bytesExpected
+completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+ progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+ requestObject:(CMISRequest*)requestObject;
+
 + (void)invoke:(NSURL *)url
 withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
    withSession:(CMISBindingSession *)session
   outputStream:(NSOutputStream *)outputStream
  bytesExpected:(unsigned long long)bytesExpected
+  resumeRecord:(CMISDownloadResumeRecord *)resumeRecord
+completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+ progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+ requestObject:(CMISRequest*)requestObject;
+
++ (void)invoke:(NSURL *)url
+withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+   withSession:(CMISBindingSession *)session
+          sink:(id<CMISDownloadSink>)sink
+ bytesExpected:(unsigned long long)bytesExpected
 completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
  progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
  requestObject:(CMISRequest*)requestObject;
 
+// downloads the content at the url into the file at the given path, using several concurrent Range requests;
+// the server must accept byte ranges and bytesExpected must be the exact content length
++ (void)invoke:(NSURL *)url
+   withSession:(CMISBindingSession *)session
+  toFileAtPath:(NSString *)filePath
+ bytesExpected:(unsigned long long)bytesExpected
+  segmentCount:(NSUInteger)segmentCount
+completionBlock:(void (^)(NSError *error))completionBlock
+ progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+ requestObject:(CMISRequest *)requestObject;
+
+// asks for the first byte of the content at the url: the server accepts byte ranges if it answers with partial content.
+// A server sending the complete content instead is cut off as soon as its response starts
++ (void)invokeRangeProbe:(NSURL *)url
+             withSession:(CMISBindingSession *)session
+         completionBlock:(void (^)(BOOL rangeRequestsSupported, NSError *error))completionBlock
+           requestObject:(CMISRequest *)requestObject;
+
 // convenience invokes
 
 + (void)invokeGET:(NSURL *)url
@@ -86,4 +148,40 @@ completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))comple
          withSession:(CMISBindingSession *)session 
      completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock;
 
+// convenience invokes as part of the operation of the request object
+
++ (void)invokeGET:(NSURL *)url
+      withSession:(CMISBindingSession *)session
+  completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+    requestObject:(CMISRequest *)requestObject;
+
++ (void)invokePOST:(NSURL *)url
+       withSession:(CMISBindingSession *)session
+              body:(NSData *)body
+           headers:(NSDictionary *)additionalHeaders
+   completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+     requestObject:(CMISRequest *)requestObject;
+
++ (void)invokePUT:(NSURL *)url
+      withSession:(CMISBindingSession *)session
+             body:(NSData *)body
+          headers:(NSDictionary *)additionalHeaders
+  completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+    requestObject:(CMISRequest *)requestObject;
+
++ (void)invokeDELETE:(NSURL *)url
+         withSession:(CMISBindingSession *)session
+     completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+       requestObject:(CMISRequest *)requestObject;
+
+// helper
+
++ (NSMutableURLRequest *)createRequestForUrl:(NSURL *)url
+                              withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+                                usingSession:(CMISBindingSession *)session;
+
+// for progress not reported through the invokes above: returns a block delivering it on the callback queue of the session, if it has one
++ (void (^)(unsigned long long bytesTransferred, unsigned long long bytesTotal))progressBlock:(void (^)(unsigned long long bytesTransferred, unsigned long long bytesTotal))progressBlock
+                                                                   onCallbackQueueOfSession:(CMISBindingSession *)session;
+
 @end
@@ -18,7 +18,105 @@
 #import "CMISHttpRequest.h"
 #import "CMISHttpDownloadRequest.h"
 #import "CMISHttpUploadRequest.h"
+#import "CMISSegmentedDownloadRequest.h"
+#import "CMISDownloadSink.h"
 #import "CMISRequest.h"
+#import "CMISSessionParameters.h"
+#import "CMISHttpRetryPolicy.h"
+#import "CMISHedgingPolicy.h"
+#import "CMISHedgedRequest.h"
+#import "CMISNetworkThread.h"
+
+#define DEFAULT_EXPECT_CONTINUE_TIMEOUT 1.0
+
+/**
+ * Delivers the callbacks of one request, each one after the previous has run, so progress and completion keep their order
+ * on concurrent queues. Progress blocks, which come from the application, run on the callback queue of the session;
+ * completion blocks, which parse and convert the response before calling the application, run on the worker pool.
+ * Without queues, blocks are left as they are.
+ */
+@interface CMISHttpCallbackChain : NSObject
+
+@property (nonatomic, strong) NSOperationQueue *completionQueue;
+@property (nonatomic, strong) NSOperationQueue *progressQueue;
+@property (nonatomic, strong) NSOperation *lastOperation;
+
+- (id)initWithCompletionQueue:(NSOperationQueue *)completionQueue progressQueue:(NSOperationQueue *)progressQueue;
+
+- (void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock;
+
+- (void (^)(NSError *error))errorCompletionBlock:(void (^)(NSError *error))completionBlock;
+
+- (void (^)(unsigned long long bytesTransferred, unsigned long long bytesTotal))progressBlock:(void (^)(unsigned long long bytesTransferred, unsigned long long bytesTotal))progressBlock;
+
+@end
+
+@implementation CMISHttpCallbackChain
+
+@synthesize completionQueue = _completionQueue;
+@synthesize progressQueue = _progressQueue;
+@synthesize lastOperation = _lastOperation;
+
+- (id)initWithCompletionQueue:(NSOperationQueue *)completionQueue progressQueue:(NSOperationQueue *)progressQueue
+{
+    self = [super init];
+    if (self) {
+        _completionQueue = completionQueue;
+        _progressQueue = progressQueue;
+    }
+    return self;
+}
+
+- (void)performBlock:(void (^)(void))block onQueue:(NSOperationQueue *)queue
+{
+    NSBlockOperation *operation = [NSBlockOperation blockOperationWithBlock:block];
+    @synchronized(self) {
+        if (self.lastOperation && !self.lastOperation.isFinished) {
+            [operation addDependency:self.lastOperation];
+        }
+        self.lastOperation = operation;
+    }
+    [queue addOperation:operation];
+}
+
+- (void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+{
+    if (self.completionQueue == nil || completionBlock == nil) {
+        return completionBlock;
+    }
+    return ^(CMISHttpResponse *httpResponse, NSError *error) {
+        [self performBlock:^{
+            completionBlock(httpResponse, error);
+        } onQueue:self.completionQueue];
+    };
+}
+
+- (void (^)(NSError *error))errorCompletionBlock:(void (^)(NSError *error))completionBlock
+{
+    if (self.completionQueue == nil || completionBlock == nil) {
+        return completionBlock;
+    }
+    return ^(NSError *error) {
+        [self performBlock:^{
+            completionBlock(error);
+        } onQueue:self.completionQueue];
+    };
+}
+
+- (void (^)(unsigned long long bytesTransferred, unsigned long long bytesTotal))progressBlock:(void (^)(unsigned long long bytesTransferred, unsigned long long bytesTotal))progressBlock
+{
+    if (self.progressQueue == nil || progressBlock == nil) {
+        return progressBlock;
+    }
+    return ^(unsigned long long bytesTransferred, unsigned long long bytesTotal) {
+        [self performBlock:^{
+            progressBlock(bytesTransferred, bytesTotal);
+        } onQueue:self.progressQueue];
+    };
+}
+
+@end
+
 
 
 @implementation HttpUtil
@@ -32,37 +130,47 @@ withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
        headers:(NSDictionary *)additionalHeaders
 completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
 {
-    NSMutableURLRequest *urlRequest = [self createRequestForUrl:url
-                                                 withHttpMethod:httpRequestMethod
-                                                   usingSession:session];
-    
-    [CMISHttpRequest startRequest:urlRequest
-                   withHttpMethod:httpRequestMethod
-                      requestBody:body
-                          headers:additionalHeaders
-           authenticationProvider:session.authenticationProvider
-                  completionBlock:completionBlock];
+    [self invoke:url
+  withHttpMethod:httpRequestMethod
+     withSession:session
+            body:body
+         headers:additionalHeaders
+ completionBlock:completionBlock
+   requestObject:nil];
 }
 
 + (void)invoke:(NSURL *)url
 withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
    withSession:(CMISBindingSession *)session
-   inputStream:(NSInputStream *)inputStream
+          body:(NSData *)body
        headers:(NSDictionary *)additionalHeaders
 completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+ requestObject:(CMISRequest *)requestObject
 {
-    NSMutableURLRequest *urlRequest = [self createRequestForUrl:url
-                                                 withHttpMethod:httpRequestMethod
-                                                   usingSession:session];
+    CMISHttpCallbackChain *callbackChain = [self callbackChainForSession:session];
+    completionBlock = [callbackChain completionBlock:[self completionBlock:completionBlock forRequestObject:requestObject]];
     
-    [CMISHttpUploadRequest startRequest:urlRequest
-                         withHttpMethod:httpRequestMethod
-                            inputStream:inputStream
-                                headers:additionalHeaders
-                          bytesExpected:0
-                 authenticationProvider:session.authenticationProvider
-                        completionBlock:completionBlock
-                          progressBlock:nil];
+    if (!requestObject.isCancelled) {
+        [self performOnNetworkThreadOfSession:session block:^{
+            NSMutableURLRequest *urlRequest = [self createRequestForUrl:url
+                                                         withHttpMethod:httpRequestMethod
+                                                           usingSession:session];
+            [self applyDeadlineOfRequestObject:requestObject toUrlRequest:urlRequest];
+            
+            CMISHttpRequest *request = [CMISHttpRequest startRequest:urlRequest
+                                                      withHttpMethod:httpRequestMethod
+                                                         requestBody:body
+                                                             headers:additionalHeaders
+                                              authenticationProvider:session.authenticationProvider
+                                                     completionBlock:completionBlock];
+            [self applyRetryPolicyOfSession:session toRequest:request];
+            requestObject.httpRequest = request;
+        }];
+    } else {
+        if (completionBlock) {
+            completionBlock(nil, [requestObject cancellationError]);
+        }
+    }
 }
 
 + (void)invoke:(NSURL *)url
@@ -70,12 +178,12 @@ withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
    withSession:(CMISBindingSession *)session
    inputStream:(NSInputStream *)inputStream
        headers:(NSDictionary *)additionalHeaders
- bytesExpected:(unsigned long long)bytesExpected
 completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
- progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
- requestObject:(CMISRequest *)requestObject
 {
-    if (!requestObject.isCancelled) {
+    CMISHttpCallbackChain *callbackChain = [self callbackChainForSession:session];
+    completionBlock = [callbackChain completionBlock:completionBlock];
+    
+    [self performOnNetworkThreadOfSession:session block:^{
         NSMutableURLRequest *urlRequest = [self createRequestForUrl:url
                                                      withHttpMethod:httpRequestMethod
                                                        usingSession:session];
@@ -84,15 +192,92 @@ completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))comple
                                                                     withHttpMethod:httpRequestMethod
                                                                        inputStream:inputStream
                                                                            headers:additionalHeaders
-                                                                     bytesExpected:bytesExpected
+                                                                     bytesExpected:0
                                                             authenticationProvider:session.authenticationProvider
                                                                    completionBlock:completionBlock
-                                                                     progressBlock:progressBlock];
-        requestObject.httpRequest = uploadRequest;
+                                                                     progressBlock:nil];
+        [self applyRetryPolicyOfSession:session toRequest:uploadRequest];
+    }];
+}
+
++ (void)invoke:(NSURL *)url
+withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+   withSession:(CMISBindingSession *)session
+   inputStream:(NSInputStream *)inputStream
+       headers:(NSDictionary *)additionalHeaders
+ bytesExpected:(unsigned long long)bytesExpected
+completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+ progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+ requestObject:(CMISRequest *)requestObject
+{
+    CMISHttpCallbackChain *callbackChain = [self callbackChainForSession:session];
+    completionBlock = [callbackChain completionBlock:[self completionBlock:completionBlock forRequestObject:requestObject]];
+    progressBlock = [callbackChain progressBlock:progressBlock];
+    
+    if (!requestObject.isCancelled) {
+        [self performOnNetworkThreadOfSession:session block:^{
+            NSMutableURLRequest *urlRequest = [self createRequestForUrl:url
+                                                         withHttpMethod:httpRequestMethod
+                                                           usingSession:session];
+            [self applyDeadlineOfRequestObject:requestObject toUrlRequest:urlRequest];
+            
+            CMISHttpUploadRequest *uploadRequest = [CMISHttpUploadRequest startRequest:urlRequest
+                                                                        withHttpMethod:httpRequestMethod
+                                                                           inputStream:inputStream
+                                                                               headers:additionalHeaders
+                                                                         bytesExpected:bytesExpected
+                                                                 expectContinueTimeout:[self expectContinueTimeoutForBodySize:bytesExpected
+                                                                                                                   usingSession:session]
+                                                                authenticationProvider:session.authenticationProvider
+                                                                       completionBlock:completionBlock
+                                                                         progressBlock:progressBlock];
+            [self applyRetryPolicyOfSession:session toRequest:uploadRequest];
+            requestObject.httpRequest = uploadRequest;
+        }];
+    } else {
+        if (completionBlock) {
+            completionBlock(nil, [requestObject cancellationError]);
+        }
+    }
+}
+
++ (void)invoke:(NSURL *)url
+withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+   withSession:(CMISBindingSession *)session
+      bodyFile:(NSString *)bodyFilePath
+       headers:(NSDictionary *)additionalHeaders
+ bytesExpected:(unsigned long long)bytesExpected
+completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+ progressBlock:(void (^)(unsigned long long bytesUploaded, unsigned long long bytesTotal))progressBlock
+ requestObject:(CMISRequest *)requestObject
+{
+    CMISHttpCallbackChain *callbackChain = [self callbackChainForSession:session];
+    completionBlock = [callbackChain completionBlock:[self completionBlock:completionBlock forRequestObject:requestObject]];
+    progressBlock = [callbackChain progressBlock:progressBlock];
+    
+    if (!requestObject.isCancelled) {
+        [self performOnNetworkThreadOfSession:session block:^{
+            NSMutableURLRequest *urlRequest = [self createRequestForUrl:url
+                                                         withHttpMethod:httpRequestMethod
+                                                           usingSession:session];
+            [self applyDeadlineOfRequestObject:requestObject toUrlRequest:urlRequest];
+            
+            CMISHttpUploadRequest *uploadRequest = [CMISHttpUploadRequest startRequest:urlRequest
+                                                                        withHttpMethod:httpRequestMethod
+                                                                              bodyFile:bodyFilePath
+                                                                               headers:additionalHeaders
+                                                                         bytesExpected:bytesExpected
+                                                                 expectContinueTimeout:[self expectContinueTimeoutForBodySize:bytesExpected
+                                                                                                                   usingSession:session]
+                                                                authenticationProvider:session.authenticationProvider
+                                                                       completionBlock:completionBlock
+                                                                         progressBlock:progressBlock];
+            [self applyRetryPolicyOfSession:session toRequest:uploadRequest];
+            requestObject.httpRequest = uploadRequest;
+        }];
     } else {
         if (completionBlock) {
-            completionBlock(nil, [CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled
-                                             withDetailedDescription:@"Request was cancelled"]);
+            completionBlock(nil, [requestObject cancellationError]);
         }
     }
 }
@@ -106,24 +291,172 @@ completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))comple
     progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
     requestObject:(CMISRequest *)requestObject
 {
+    [self invoke:url
+  withHttpMethod:httpRequestMethod
+     withSession:session
+    outputStream:outputStream
+   bytesExpected:bytesExpected
+    resumeRecord:nil
+ completionBlock:completionBlock
+   progressBlock:progressBlock
+   requestObject:requestObject];
+}
+
++ (void)invoke:(NSURL *)url
+withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+   withSession:(CMISBindingSession *)session
+  outputStream:(NSOutputStream *)outputStream
+ bytesExpected:(unsigned long long)bytesExpected
+  resumeRecord:(CMISDownloadResumeRecord *)resumeRecord
+completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+ progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+ requestObject:(CMISRequest *)requestObject
+{
+    CMISHttpCallbackChain *callbackChain = [self callbackChainForSession:session];
+    completionBlock = [callbackChain completionBlock:[self completionBlock:completionBlock forRequestObject:requestObject]];
+    progressBlock = [callbackChain progressBlock:progressBlock];
+    
     if (!requestObject.isCancelled) {
-        NSMutableURLRequest *urlRequest = [self createRequestForUrl:url
-                                                     withHttpMethod:HTTP_GET
-                                                       usingSession:session];
+        [self performOnNetworkThreadOfSession:session block:^{
+            NSMutableURLRequest *urlRequest = [self createRequestForUrl:url
+                                                         withHttpMethod:HTTP_GET
+                                                           usingSession:session];
+            [self applyDeadlineOfRequestObject:requestObject toUrlRequest:urlRequest];
+            
+            CMISHttpDownloadRequest *downloadRequest = [CMISHttpDownloadRequest startRequest:urlRequest
+                                                                              withHttpMethod:httpRequestMethod
+                                                                                outputStream:outputStream
+                                                                               bytesExpected:bytesExpected
+                                                                                resumeRecord:resumeRecord
+                                                                      authenticationProvider:session.authenticationProvider
+                                                                             completionBlock:completionBlock
+                                                                               progressBlock:progressBlock];
+            [self applyRetryPolicyOfSession:session toRequest:downloadRequest];
+            requestObject.httpRequest = downloadRequest;
+        }];
+    } else {
+        if (completionBlock) {
+            completionBlock(nil, [requestObject cancellationError]);
+
+        }
+    }
+}
+
++ (void)invoke:(NSURL *)url
+withHttpMethod:(CMISHttpRequestMethod)httpRequestMethod
+   withSession:(CMISBindingSession *)session
+          sink:(id<CMISDownloadSink>)sink
+ bytesExpected:(unsigned long long)bytesExpected
+completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+ progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+ requestObject:(CMISRequest *)requestObject
+{
+    CMISHttpCallbackChain *callbackChain = [self callbackChainForSession:session];
+    completionBlock = [callbackChain completionBlock:[self completionBlock:completionBlock forRequestObject:requestObject]];
+    progressBlock = [callbackChain progressBlock:progressBlock];
     
-        CMISHttpDownloadRequest *downloadRequest = [CMISHttpDownloadRequest startRequest:urlRequest
-                                                                          withHttpMethod:httpRequestMethod
-                                                                            outputStream:outputStream
-                                                                           bytesExpected:bytesExpected
-                                                                  authenticationProvider:session.authenticationProvider
-                                                                         completionBlock:completionBlock
-                                                                           progressBlock:progressBlock];
-        requestObject.httpRequest = downloadRequest;
+    if (!requestObject.isCancelled) {
+        [self performOnNetworkThreadOfSession:session block:^{
+            NSMutableURLRequest *urlRequest = [self createRequestForUrl:url
+                                                         withHttpMethod:httpRequestMethod
+                                                           usingSession:session];
+            [self applyDeadlineOfRequestObject:requestObject toUrlRequest:urlRequest];
+            
+            CMISHttpDownloadRequest *downloadRequest = [CMISHttpDownloadRequest startRequest:urlRequest
+                                                                              withHttpMethod:httpRequestMethod
+                                                                                        sink:sink
+                                                                               bytesExpected:bytesExpected
+                                                                      authenticationProvider:session.authenticationProvider
+                                                                             completionBlock:completionBlock
+                                                                               progressBlock:progressBlock];
+            [self applyRetryPolicyOfSession:session toRequest:downloadRequest];
+            requestObject.httpRequest = downloadRequest;
+        }];
     } else {
+        NSError *error = [requestObject cancellationError];
+        [sink closeWithError:error completionBlock:nil];
         if (completionBlock) {
-            completionBlock(nil, [CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled
-                                             withDetailedDescription:@"Request was cancelled"]);
+            completionBlock(nil, error);
+        }
+    }
+}
+
++ (void)invoke:(NSURL *)url
+   withSession:(CMISBindingSession *)session
+  toFileAtPath:(NSString *)filePath
+ bytesExpected:(unsigned long long)bytesExpected
+  segmentCount:(NSUInteger)segmentCount
+completionBlock:(void (^)(NSError *error))completionBlock
+ progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+ requestObject:(CMISRequest *)requestObject
+{
+    CMISHttpCallbackChain *callbackChain = [self callbackChainForSession:session];
+    completionBlock = [callbackChain errorCompletionBlock:[self errorCompletionBlock:completionBlock forRequestObject:requestObject]];
+    progressBlock = [callbackChain progressBlock:progressBlock];
+    
+    if (!requestObject.isCancelled) {
+        [self performOnNetworkThreadOfSession:session block:^{
+            CMISSegmentedDownloadRequest *downloadRequest = [CMISSegmentedDownloadRequest startRequestForUrl:url
+                                                                                                 withSession:session
+                                                                                                toFileAtPath:filePath
+                                                                                               bytesExpected:bytesExpected
+                                                                                                segmentCount:segmentCount
+                                                                                             completionBlock:completionBlock
+                                                                                               progressBlock:progressBlock];
+            requestObject.httpRequest = downloadRequest;
+        }];
+    } else {
+        if (completionBlock) {
+            completionBlock([requestObject cancellationError]);
+        }
+    }
+}
 
++ (void)invokeRangeProbe:(NSURL *)url
+             withSession:(CMISBindingSession *)session
+         completionBlock:(void (^)(BOOL rangeRequestsSupported, NSError *error))completionBlock
+           requestObject:(CMISRequest *)requestObject
+{
+    __block BOOL rangeIgnored = NO;
+    void (^probeCompletionBlock)(CMISHttpResponse *httpResponse, NSError *error) = ^(CMISHttpResponse *httpResponse, NSError *error) {
+        if (rangeIgnored && !requestObject.isCancelled) {
+            completionBlock(NO, nil); // the cancel below, not a failure
+        } else if (error) {
+            completionBlock(NO, error);
+        } else {
+            completionBlock(httpResponse.statusCode == 206, nil);
+        }
+    };
+    CMISHttpCallbackChain *callbackChain = [self callbackChainForSession:session];
+    probeCompletionBlock = [callbackChain completionBlock:[self completionBlock:probeCompletionBlock forRequestObject:requestObject]];
+    
+    if (!requestObject.isCancelled) {
+        [self performOnNetworkThreadOfSession:session block:^{
+            NSMutableURLRequest *urlRequest = [self createRequestForUrl:url
+                                                         withHttpMethod:HTTP_GET
+                                                           usingSession:session];
+            [self applyDeadlineOfRequestObject:requestObject toUrlRequest:urlRequest];
+            
+            CMISHttpRequest *request = [CMISHttpRequest startRequest:urlRequest
+                                                      withHttpMethod:HTTP_GET
+                                                         requestBody:nil
+                                                             headers:[NSDictionary dictionaryWithObject:@"bytes=0-0" forKey:@"Range"]
+                                              authenticationProvider:session.authenticationProvider
+                                                     completionBlock:probeCompletionBlock];
+            // the callbacks of the connection come from this run loop, so none can arrive before the block is set
+            __weak CMISHttpRequest *weakRequest = request;
+            request.responseReceivedBlock = ^(NSHTTPURLResponse *response) {
+                if (response.statusCode == 200) {
+                    rangeIgnored = YES;
+                    [weakRequest cancel];
+                }
+            };
+            [self applyRetryPolicyOfSession:session toRequest:request];
+            requestObject.httpRequest = request;
+        }];
+    } else {
+        if (probeCompletionBlock) {
+            probeCompletionBlock(nil, [requestObject cancellationError]);
         }
     }
 }
@@ -132,12 +465,58 @@ completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))comple
       withSession:(CMISBindingSession *)session
   completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
 {
+    [self invokeGET:url withSession:session completionBlock:completionBlock requestObject:nil];
+}
+
++ (void)invokeGET:(NSURL *)url
+      withSession:(CMISBindingSession *)session
+  completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+    requestObject:(CMISRequest *)requestObject
+{
+    // metadata reads are idempotent and small, so a slow one can be hedged with a second request
+    CMISHedgingPolicy *hedgingPolicy = [session objectForKey:kCMISSessionParameterHedgingPolicy];
+    if (hedgingPolicy && !requestObject.isCancelled) {
+        CMISHttpCallbackChain *callbackChain = [self callbackChainForSession:session];
+        completionBlock = [callbackChain completionBlock:[self completionBlock:completionBlock forRequestObject:requestObject]];
+        
+        [self performOnNetworkThreadOfSession:session block:^{
+            [CMISHedgedRequest startRequestWithHedgingPolicy:hedgingPolicy
+                                                  startBlock:^CMISHttpRequest *(void (^requestCompletionBlock)(CMISHttpResponse *, NSError *)) {
+                                                      NSMutableURLRequest *urlRequest = [self createRequestForUrl:url
+                                                                                                   withHttpMethod:HTTP_GET
+                                                                                                     usingSession:session];
+                                                      [self applyDeadlineOfRequestObject:requestObject toUrlRequest:urlRequest];
+                                                      CMISHttpRequest *request = [CMISHttpRequest startRequest:urlRequest
+                                                                                                withHttpMethod:HTTP_GET
+                                                                                                   requestBody:nil
+                                                                                                       headers:nil
+                                                                                        authenticationProvider:session.authenticationProvider
+                                                                                               completionBlock:requestCompletionBlock];
+                                                      [self applyRetryPolicyOfSession:session toRequest:request];
+                                                      return request;
+                                                  }
+                                             completionBlock:completionBlock
+                                               requestObject:requestObject];
+        }];
+        return;
+    }
+    
     return [self invoke:url
          withHttpMethod:HTTP_GET
             withSession:session
                    body:nil
                 headers:nil
-        completionBlock:completionBlock];
+        completionBlock:completionBlock
+          requestObject:requestObject];
+}
+
++ (void)invokePOST:(NSURL *)url
+       withSession:(CMISBindingSession *)session
+              body:(NSData *)body
+           headers:(NSDictionary *)additionalHeaders
+   completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+{
+    [self invokePOST:url withSession:session body:body headers:additionalHeaders completionBlock:completionBlock requestObject:nil];
 }
 
 + (void)invokePOST:(NSURL *)url
@@ -145,13 +524,24 @@ completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))comple
               body:(NSData *)body
            headers:(NSDictionary *)additionalHeaders
    completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+     requestObject:(CMISRequest *)requestObject
 {
     return [self invoke:url
          withHttpMethod:HTTP_POST
             withSession:session
                    body:body
                 headers:additionalHeaders
-        completionBlock:completionBlock];
+        completionBlock:completionBlock
+          requestObject:requestObject];
+}
+
++ (void)invokePUT:(NSURL *)url
+      withSession:(CMISBindingSession *)session
+             body:(NSData *)body
+          headers:(NSDictionary *)additionalHeaders
+  completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+{
+    [self invokePUT:url withSession:session body:body headers:additionalHeaders completionBlock:completionBlock requestObject:nil];
 }
 
 + (void)invokePUT:(NSURL *)url
@@ -159,25 +549,36 @@ completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))comple
              body:(NSData *)body
           headers:(NSDictionary *)additionalHeaders
   completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+    requestObject:(CMISRequest *)requestObject
 {
     return [self invoke:url
          withHttpMethod:HTTP_PUT
             withSession:session
                    body:body
                 headers:additionalHeaders
-        completionBlock:completionBlock];
+        completionBlock:completionBlock
+          requestObject:requestObject];
+}
+
++ (void)invokeDELETE:(NSURL *)url
+         withSession:(CMISBindingSession *)session
+     completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+{
+    [self invokeDELETE:url withSession:session completionBlock:completionBlock requestObject:nil];
 }
 
 + (void)invokeDELETE:(NSURL *)url
          withSession:(CMISBindingSession *)session
      completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+       requestObject:(CMISRequest *)requestObject
 {
     return [self invoke:url
          withHttpMethod:HTTP_DELETE
             withSession:session
                    body:nil
                 headers:nil
-        completionBlock:completionBlock];
+        completionBlock:completionBlock
+          requestObject:requestObject];
 }
 
 #pragma mark Helper methods
@@ -203,6 +604,9 @@ completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))comple
         case HTTP_PUT:
             httpMethod = @"PUT";
             break;
+        case HTTP_HEAD:
+            httpMethod = @"HEAD";
+            break;
         default:
             log(@"Invalid http request method: %d", httpRequestMethod);
             return nil;
@@ -214,6 +618,95 @@ completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))comple
     return request;
 }
 
+// large bodies are held back until the server had a chance to reject the request
++ (NSTimeInterval)expectContinueTimeoutForBodySize:(unsigned long long)bodySize usingSession:(CMISBindingSession *)session
+{
+    NSNumber *expectContinueThreshold = [session objectForKey:kCMISSessionParameterExpectContinueThreshold];
+    if (expectContinueThreshold == nil || bodySize < [expectContinueThreshold unsignedLongLongValue]) {
+        return 0;
+    }
+    return [[session objectForKey:kCMISSessionParameterExpectContinueTimeout
+                 withDefaultValue:[NSNumber numberWithDouble:DEFAULT_EXPECT_CONTINUE_TIMEOUT]] doubleValue];
+}
+
+// a response that arrives after the request object was cancelled is not passed on, so it is neither parsed nor acted upon
++ (void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock:(void (^)(CMISHttpResponse *httpResponse, NSError *error))completionBlock
+                                                           forRequestObject:(CMISRequest *)requestObject
+{
+    if (requestObject == nil || completionBlock == nil) {
+        return completionBlock;
+    }
+    return ^(CMISHttpResponse *httpResponse, NSError *error) {
+        if (requestObject.isCancelled) {
+            completionBlock(nil, [requestObject cancellationError]);
+        } else {
+            completionBlock(httpResponse, error);
+        }
+    };
+}
+
++ (void (^)(NSError *error))errorCompletionBlock:(void (^)(NSError *error))completionBlock
+                                forRequestObject:(CMISRequest *)requestObject
+{
+    if (requestObject == nil || completionBlock == nil) {
+        return completionBlock;
+    }
+    return ^(NSError *error) {
+        completionBlock(requestObject.isCancelled ? [requestObject cancellationError] : error);
+    };
+}
+
+// the connection gives up on its own no later than the deadline, even if the deadline timer is held up
++ (void)applyDeadlineOfRequestObject:(CMISRequest *)requestObject toUrlRequest:(NSMutableURLRequest *)urlRequest
+{
+    if (requestObject.deadline) {
+        urlRequest.timeoutInterval = MAX(MIN(urlRequest.timeoutInterval, [requestObject remainingTime]), 1);
+    }
+}
+
++ (void (^)(unsigned long long bytesTransferred, unsigned long long bytesTotal))progressBlock:(void (^)(unsigned long long bytesTransferred, unsigned long long bytesTotal))progressBlock
+                                                                   onCallbackQueueOfSession:(CMISBindingSession *)session
+{
+    return [[self callbackChainForSession:session] progressBlock:progressBlock];
+}
+
++ (NSOperationQueue *)callbackQueueOfSession:(CMISBindingSession *)session
+{
+    NSOperationQueue *callbackQueue = [session objectForKey:kCMISSessionParameterCallbackQueue];
+    if (callbackQueue == nil && [[session objectForKey:kCMISSessionParameterNetworkThread] boolValue]) {
+        callbackQueue = [CMISNetworkThread workerQueue];
+    }
+    return callbackQueue;
+}
+
+// responses are parsed and converted on the worker pool, only the blocks of the application go to the callback queue
++ (CMISHttpCallbackChain *)callbackChainForSession:(CMISBindingSession *)session
+{
+    NSOperationQueue *callbackQueue = [self callbackQueueOfSession:session];
+    return [[CMISHttpCallbackChain alloc] initWithCompletionQueue:(callbackQueue ? [CMISNetworkThread workerQueue] : nil)
+                                                    progressQueue:callbackQueue];
+}
+
+// callback queue threads have no run loop of their own: the connection, its timers and streams live on the network thread.
+// The caller does not wait for the connection to be started there
++ (void)performOnNetworkThreadOfSession:(CMISBindingSession *)session block:(void (^)(void))block
+{
+    if ([self callbackQueueOfSession:session]) {
+        [CMISNetworkThread performBlock:block];
+    } else {
+        block();
+    }
+}
+
++ (void)applyRetryPolicyOfSession:(CMISBindingSession *)session toRequest:(CMISHttpRequest *)request
+{
+    if (request) {
+        CMISHttpRetryPolicy *retryPolicy = [CMISHttpRetryPolicy retryPolicyForSession:session];
+        [retryPolicy recordRequest];
+        request.retryPolicy = retryPolicy;
+    }
+}
+
 @end
 
 
@@ -0,0 +1,39 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * The thread HTTP connections run on when a session is configured with kCMISSessionParameterNetworkThread
+ * or kCMISSessionParameterCallbackQueue, and the worker pool responses are processed on by default.
+ * The thread is started the first time it is needed and runs its run loop for the lifetime of the process.
+ */
+@interface CMISNetworkThread : NSObject
+
++ (NSThread *)thread;
+
+// YES if called on the network thread; does not start it
++ (BOOL)isCurrentThread;
+
+// performs the block on the network thread and returns once it has run; runs it right away when called on the network thread
++ (void)performBlockAndWait:(void (^)(void))block;
+
+// performs the block on the network thread without waiting for it; runs it right away when called on the network thread
++ (void)performBlock:(void (^)(void))block;
+
+// concurrent queue parsing responses and converting objects; the completion blocks of the application go to the callback
+// queue of the session, if it sets one
++ (NSOperationQueue *)workerQueue;
+
+@end
@@ -0,0 +1,97 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISNetworkThread.h"
+
+static NSThread *networkThread = nil;
+static dispatch_semaphore_t networkThreadStarted = NULL;
+
+@implementation CMISNetworkThread
+
++ (NSThread *)thread
+{
+    static dispatch_once_t predicate = 0;
+    dispatch_once(&predicate, ^{
+        networkThreadStarted = dispatch_semaphore_create(0);
+        networkThread = [[NSThread alloc] initWithTarget:self selector:@selector(networkThreadMain) object:nil];
+        networkThread.name = @"org.apache.chemistry.opencmis.network";
+        [networkThread start];
+        
+        // blocks may only be performed once the run loop has an input source and runs
+        dispatch_semaphore_wait(networkThreadStarted, DISPATCH_TIME_FOREVER);
+#if !OS_OBJECT_USE_OBJC
+        dispatch_release(networkThreadStarted);
+#endif
+        networkThreadStarted = NULL;
+    });
+    return networkThread;
+}
+
++ (BOOL)isCurrentThread
+{
+    return networkThread != nil && [NSThread currentThread] == networkThread;
+}
+
++ (void)networkThreadMain
+{
+    @autoreleasepool {
+        // the port keeps the run loop from returning while no connection is scheduled
+        [[NSRunLoop currentRunLoop] addPort:[NSMachPort port] forMode:NSDefaultRunLoopMode];
+        dispatch_semaphore_signal(networkThreadStarted);
+    }
+    
+    while (YES) {
+        @autoreleasepool {
+            [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate distantFuture]];
+        }
+    }
+}
+
++ (void)performBlockAndWait:(void (^)(void))block
+{
+    NSThread *thread = [self thread];
+    if ([NSThread currentThread] == thread) {
+        block();
+    } else {
+        [self performSelector:@selector(runBlock:) onThread:thread withObject:[block copy] waitUntilDone:YES];
+    }
+}
+
++ (void)performBlock:(void (^)(void))block
+{
+    NSThread *thread = [self thread];
+    if ([NSThread currentThread] == thread) {
+        block();
+    } else {
+        [self performSelector:@selector(runBlock:) onThread:thread withObject:[block copy] waitUntilDone:NO];
+    }
+}
+
++ (void)runBlock:(void (^)(void))block
+{
+    block();
+}
+
++ (NSOperationQueue *)workerQueue
+{
+    static NSOperationQueue *workerQueue = nil;
+    static dispatch_once_t predicate = 0;
+    dispatch_once(&predicate, ^{
+        workerQueue = [[NSOperationQueue alloc] init];
+        workerQueue.name = @"org.apache.chemistry.opencmis.worker";
+    });
+    return workerQueue;
+}
+
+@end
@@ -0,0 +1,39 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Fixed capacity FIFO byte buffer.
+ *
+ * One producer thread may write while one consumer thread reads without any locking: the producer only
+ * advances the write position and the consumer only the read position, with acquire/release atomics in between.
+ * More than one producer or consumer have to synchronize among themselves.
+ */
+@interface CMISRingBuffer : NSObject
+
+// the capacity is rounded up to a power of two
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+@property (nonatomic, assign, readonly) NSUInteger bytesAvailable;
+@property (nonatomic, assign, readonly) NSUInteger spaceAvailable;
+
+- (id)initWithCapacity:(NSUInteger)capacity;
+
+// producer: copies as many bytes as fit and returns their number
+- (NSUInteger)writeBytes:(const uint8_t *)bytes maxLength:(NSUInteger)length;
+
+// consumer: copies up to length of the oldest bytes into the buffer and returns their number
+- (NSUInteger)readBytes:(uint8_t *)buffer maxLength:(NSUInteger)length;
+
+@end
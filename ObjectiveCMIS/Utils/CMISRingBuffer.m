@@ -0,0 +1,102 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISRingBuffer.h"
+
+@interface CMISRingBuffer ()
+{
+    // total number of bytes ever written and read; their difference is the fill level.
+    // Unsigned overflow is harmless as the capacity is a power of two.
+    // Each count is stored with release and loaded by the other side with acquire semantics, so the bytes
+    // are copied before the count that hands them over becomes visible
+    NSUInteger _writeCount;
+    NSUInteger _readCount;
+}
+
+@property (nonatomic, assign, readwrite) NSUInteger capacity;
+@property (nonatomic, strong) NSMutableData *storage;
+
+@end
+
+
+@implementation CMISRingBuffer
+
+@synthesize capacity = _capacity;
+@synthesize storage = _storage;
+
+- (id)initWithCapacity:(NSUInteger)capacity
+{
+    self = [super init];
+    if (self) {
+        _capacity = 1;
+        while (_capacity < capacity) {
+            _capacity <<= 1;
+        }
+        _storage = [NSMutableData dataWithLength:_capacity];
+    }
+    return self;
+}
+
+- (NSUInteger)bytesAvailable
+{
+    NSUInteger writeCount = __atomic_load_n(&_writeCount, __ATOMIC_ACQUIRE);
+    NSUInteger readCount = __atomic_load_n(&_readCount, __ATOMIC_ACQUIRE);
+    return writeCount - readCount;
+}
+
+- (NSUInteger)spaceAvailable
+{
+    return self.capacity - self.bytesAvailable;
+}
+
+- (NSUInteger)writeBytes:(const uint8_t *)bytes maxLength:(NSUInteger)length
+{
+    // the consumer must be done with the space before it is overwritten
+    NSUInteger readCount = __atomic_load_n(&_readCount, __ATOMIC_ACQUIRE);
+    NSUInteger writeCount = _writeCount; // only ever changed by this side
+    
+    NSUInteger count = MIN(length, self.capacity - (writeCount - readCount));
+    uint8_t *storage = self.storage.mutableBytes;
+    NSUInteger writePosition = writeCount & (self.capacity - 1);
+    
+    // the free space may wrap around the end of the storage
+    NSUInteger firstPart = MIN(count, self.capacity - writePosition);
+    memcpy(storage + writePosition, bytes, firstPart);
+    memcpy(storage, bytes + firstPart, count - firstPart);
+    
+    // publish the data before the new write position
+    __atomic_store_n(&_writeCount, writeCount + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+- (NSUInteger)readBytes:(uint8_t *)buffer maxLength:(NSUInteger)length
+{
+    // see the data up to the write position
+    NSUInteger writeCount = __atomic_load_n(&_writeCount, __ATOMIC_ACQUIRE);
+    NSUInteger readCount = _readCount; // only ever changed by this side
+    
+    NSUInteger count = MIN(length, writeCount - readCount);
+    const uint8_t *storage = self.storage.bytes;
+    NSUInteger readPosition = readCount & (self.capacity - 1);
+    
+    NSUInteger firstPart = MIN(count, self.capacity - readPosition);
+    memcpy(buffer, storage + readPosition, firstPart);
+    memcpy(buffer + firstPart, storage, count - firstPart);
+    
+    // finish reading before the space is handed back to the producer
+    __atomic_store_n(&_readCount, readCount + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+@end
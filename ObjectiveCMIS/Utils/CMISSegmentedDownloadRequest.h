@@ -0,0 +1,40 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+#import "CMISRequest.h"
+
+@class CMISBindingSession;
+
+/**
+ * Downloads a content stream as several byte ranges fetched concurrently.
+ * Every range is written at its own offset of the target file, which is preallocated to the full content length.
+ * The server must support Range requests; use a regular download otherwise.
+ */
+@interface CMISSegmentedDownloadRequest : NSObject <CMISCancellableRequest>
+
+@property (nonatomic, assign, readonly) unsigned long long bytesExpected;
+@property (nonatomic, assign, readonly) unsigned long long bytesDownloaded;
+
++ (CMISSegmentedDownloadRequest *)startRequestForUrl:(NSURL *)url
+                                         withSession:(CMISBindingSession *)session
+                                        toFileAtPath:(NSString *)filePath
+                                       bytesExpected:(unsigned long long)bytesExpected
+                                        segmentCount:(NSUInteger)segmentCount
+                                     completionBlock:(void (^)(NSError *error))completionBlock
+                                       progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock;
+
+- (void)cancel;
+
+@end
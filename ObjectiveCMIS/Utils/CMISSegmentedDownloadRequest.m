@@ -0,0 +1,243 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISSegmentedDownloadRequest.h"
+#import "CMISBindingSession.h"
+#import "CMISHttpUtil.h"
+#import "CMISHttpResponse.h"
+#import "CMISHttpDownloadRequest.h"
+#import "CMISFileSegmentOutputStream.h"
+#import "CMISErrors.h"
+#import "CMISFileUtil.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+// segments smaller than this are not worth an extra connection
+#define MINIMUM_SEGMENT_SIZE 1048576 // 1 mb
+
+@interface CMISSegmentedDownloadRequest ()
+
+@property (nonatomic, strong) NSURL *url;
+@property (nonatomic, strong) CMISBindingSession *session;
+@property (nonatomic, strong) NSString *filePath;
+@property (nonatomic, assign) int fileDescriptor;
+@property (nonatomic, assign, readwrite) unsigned long long bytesExpected;
+@property (nonatomic, assign, readwrite) unsigned long long bytesDownloaded;
+@property (nonatomic, strong) NSMutableArray *segmentRequests;
+@property (nonatomic, strong) NSMutableArray *segmentBytesDownloaded;
+@property (nonatomic, assign) NSUInteger pendingSegmentCount;
+@property (nonatomic, assign, getter = isFinished) BOOL finished;
+@property (nonatomic, copy) void (^completionBlock)(NSError *error);
+@property (nonatomic, copy) void (^progressBlock)(unsigned long long bytesDownloaded, unsigned long long bytesTotal);
+
+@end
+
+
+@implementation CMISSegmentedDownloadRequest
+
+@synthesize url = _url;
+@synthesize session = _session;
+@synthesize filePath = _filePath;
+@synthesize fileDescriptor = _fileDescriptor;
+@synthesize bytesExpected = _bytesExpected;
+@synthesize bytesDownloaded = _bytesDownloaded;
+@synthesize segmentRequests = _segmentRequests;
+@synthesize segmentBytesDownloaded = _segmentBytesDownloaded;
+@synthesize pendingSegmentCount = _pendingSegmentCount;
+@synthesize finished = _finished;
+@synthesize completionBlock = _completionBlock;
+@synthesize progressBlock = _progressBlock;
+
++ (CMISSegmentedDownloadRequest *)startRequestForUrl:(NSURL *)url
+                                         withSession:(CMISBindingSession *)session
+                                        toFileAtPath:(NSString *)filePath
+                                       bytesExpected:(unsigned long long)bytesExpected
+                                        segmentCount:(NSUInteger)segmentCount
+                                     completionBlock:(void (^)(NSError *error))completionBlock
+                                       progressBlock:(void (^)(unsigned long long bytesDownloaded, unsigned long long bytesTotal))progressBlock
+{
+    CMISSegmentedDownloadRequest *request = [[CMISSegmentedDownloadRequest alloc] init];
+    request.url = url;
+    request.session = session;
+    request.filePath = filePath;
+    request.bytesExpected = bytesExpected;
+    request.completionBlock = completionBlock;
+    request.progressBlock = progressBlock;
+    
+    if ([request startWithSegmentCount:segmentCount] == NO) {
+        request = nil;
+    }
+    return request;
+}
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        _fileDescriptor = -1;
+    }
+    return self;
+}
+
+- (BOOL)startWithSegmentCount:(NSUInteger)segmentCount
+{
+    if (![self createTargetFile]) {
+        [self finishWithError:[CMISErrors createCMISErrorWithCode:kCMISErrorCodeStorage
+                                          withDetailedDescription:[NSString stringWithFormat:@"Could not create file %@", self.filePath]]];
+        return NO;
+    }
+    
+    segmentCount = MAX(1, MIN(segmentCount, (NSUInteger)(self.bytesExpected / MINIMUM_SEGMENT_SIZE)));
+    unsigned long long segmentLength = (self.bytesExpected + segmentCount - 1) / segmentCount;
+    
+    self.segmentRequests = [NSMutableArray arrayWithCapacity:segmentCount];
+    self.segmentBytesDownloaded = [NSMutableArray arrayWithCapacity:segmentCount];
+    self.pendingSegmentCount = segmentCount;
+    
+    for (NSUInteger segment = 0; segment < segmentCount; segment++) {
+        unsigned long long offset = segment * segmentLength;
+        unsigned long long length = MIN(segmentLength, self.bytesExpected - offset);
+        [self.segmentBytesDownloaded addObject:[NSNumber numberWithUnsignedLongLong:0]];
+        
+        if (![self startSegment:segment atOffset:offset length:length]) {
+            return NO;
+        }
+    }
+    
+    return YES;
+}
+
+- (BOOL)createTargetFile
+{
+    self.fileDescriptor = open([self.filePath fileSystemRepresentation], O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (self.fileDescriptor < 0) {
+        log(@"Could not open %@ for segmented download: %s", self.filePath, strerror(errno));
+        return NO;
+    }
+    
+    if (![FileUtil preallocateFileDescriptor:self.fileDescriptor length:self.bytesExpected]) {
+        log(@"Could not preallocate %llu bytes for %@: %s", self.bytesExpected, self.filePath, strerror(errno));
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL)startSegment:(NSUInteger)segment atOffset:(unsigned long long)offset length:(unsigned long long)length
+{
+    NSMutableURLRequest *urlRequest = [HttpUtil createRequestForUrl:self.url
+                                                     withHttpMethod:HTTP_GET
+                                                       usingSession:self.session];
+    [urlRequest setValue:[NSString stringWithFormat:@"bytes=%llu-%llu", offset, offset + length - 1] forHTTPHeaderField:@"Range"];
+    
+    CMISFileSegmentOutputStream *outputStream = [[CMISFileSegmentOutputStream alloc] initWithFileDescriptor:self.fileDescriptor
+                                                                                                    offset:offset
+                                                                                                    length:length];
+    
+    CMISHttpDownloadRequest *segmentRequest = [CMISHttpDownloadRequest startRequest:urlRequest
+                                                                     withHttpMethod:HTTP_GET
+                                                                       outputStream:outputStream
+                                                                      bytesExpected:length
+                                                             authenticationProvider:self.session.authenticationProvider
+                                                                    completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
+                                                                        [self segment:segment didCompleteWithResponse:httpResponse
+                                                                         bytesWritten:outputStream.bytesWritten
+                                                                       expectedLength:length
+                                                                                error:error];
+                                                                    }
+                                                                      progressBlock:^(unsigned long long bytesDownloaded, unsigned long long bytesTotal) {
+                                                                          [self segment:segment didDownloadBytes:bytesDownloaded];
+                                                                      }];
+    if (segmentRequest == nil) {
+        return NO; // the failure has been reported through the completion block already
+    }
+    [self.segmentRequests addObject:segmentRequest];
+    return YES;
+}
+
+- (void)segment:(NSUInteger)segment didDownloadBytes:(unsigned long long)bytesDownloaded
+{
+    if (self.isFinished) {
+        return;
+    }
+    unsigned long long previousBytesDownloaded = [[self.segmentBytesDownloaded objectAtIndex:segment] unsignedLongLongValue];
+    [self.segmentBytesDownloaded replaceObjectAtIndex:segment withObject:[NSNumber numberWithUnsignedLongLong:bytesDownloaded]];
+    self.bytesDownloaded += bytesDownloaded - previousBytesDownloaded;
+    
+    if (self.progressBlock) {
+        self.progressBlock(self.bytesDownloaded, self.bytesExpected);
+    }
+}
+
+- (void)segment:(NSUInteger)segment didCompleteWithResponse:(CMISHttpResponse *)httpResponse
+   bytesWritten:(unsigned long long)bytesWritten
+ expectedLength:(unsigned long long)expectedLength
+          error:(NSError *)error
+{
+    if (error == nil && httpResponse.statusCode != 206) {
+        error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeNotSupported
+                            withDetailedDescription:@"Server did not honour the requested byte range"];
+    } else if (error == nil && bytesWritten != expectedLength) {
+        error = [CMISErrors createCMISErrorWithCode:kCMISErrorCodeConnection
+                            withDetailedDescription:[NSString stringWithFormat:@"Segment %lu is incomplete: received %llu of %llu bytes",
+                                                     (unsigned long)segment, bytesWritten, expectedLength]];
+    }
+    
+    if (error) {
+        [self finishWithError:error];
+    } else {
+        self.pendingSegmentCount--;
+        if (self.pendingSegmentCount == 0) {
+            [self finishWithError:nil];
+        }
+    }
+}
+
+- (void)cancel
+{
+    [self finishWithError:[CMISErrors createCMISErrorWithCode:kCMISErrorCodeCancelled withDetailedDescription:@"Request was cancelled"]];
+}
+
+- (void)finishWithError:(NSError *)error
+{
+    if (self.isFinished) {
+        return;
+    }
+    self.finished = YES;
+    void (^completionBlock)(NSError *error) = self.completionBlock;
+    self.completionBlock = nil;
+    self.progressBlock = nil;
+    
+    // stop the remaining segments; their own completion is ignored from now on
+    NSArray *segmentRequests = self.segmentRequests;
+    self.segmentRequests = nil;
+    for (CMISHttpDownloadRequest *segmentRequest in segmentRequests) {
+        [segmentRequest cancel];
+    }
+    
+    if (self.fileDescriptor >= 0) {
+        close(self.fileDescriptor);
+        self.fileDescriptor = -1;
+    }
+    
+    // the segments fill the preallocated file out of order, so a partial file has zero-filled holes and can not be resumed
+    if (error) {
+        [[NSFileManager defaultManager] removeItemAtPath:self.filePath error:nil];
+    }
+    
+    if (completionBlock) {
+        completionBlock(error);
+    }
+}
+
+@end
@@ -0,0 +1,35 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * A token bucket limiting a byte rate: tokens flow in at `rate` bytes per second up to `burstSize`,
+ * and every transferred byte takes one. Consuming more than is available puts the bucket in debt,
+ * and the caller is told how long to pause until the debt is paid off. Thread-safe.
+ */
+@interface CMISTokenBucket : NSObject
+
+// bytes per second; 0 means unlimited
+@property (nonatomic, assign) double rate;
+
+// the most tokens that can pile up while idle. Defaults to one second worth of the rate
+@property (nonatomic, assign) double burstSize;
+
+- (id)initWithRate:(double)rate;
+
+// takes byteCount tokens and returns how long to wait before transferring more, 0 if no pause is needed
+- (NSTimeInterval)consume:(unsigned long long)byteCount;
+
+@end
@@ -0,0 +1,69 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISTokenBucket.h"
+
+@interface CMISTokenBucket ()
+
+@property (nonatomic, assign) double tokens;
+@property (nonatomic, strong) NSDate *lastRefill;
+
+@end
+
+
+@implementation CMISTokenBucket
+
+@synthesize rate = _rate;
+@synthesize burstSize = _burstSize;
+@synthesize tokens = _tokens;
+@synthesize lastRefill = _lastRefill;
+
+- (id)initWithRate:(double)rate
+{
+    self = [super init];
+    if (self) {
+        _rate = rate;
+        _burstSize = rate;
+        _tokens = rate;
+        _lastRefill = [NSDate date];
+    }
+    return self;
+}
+
+- (void)setRate:(double)rate
+{
+    @synchronized(self) {
+        _rate = rate;
+        _burstSize = rate;
+        _tokens = MIN(_tokens, rate);
+    }
+}
+
+- (NSTimeInterval)consume:(unsigned long long)byteCount
+{
+    @synchronized(self) {
+        if (self.rate <= 0) {
+            return 0;
+        }
+        
+        NSDate *now = [NSDate date];
+        self.tokens = MIN(self.tokens + [now timeIntervalSinceDate:self.lastRefill] * self.rate, self.burstSize);
+        self.lastRefill = now;
+        
+        self.tokens -= byteCount;
+        return self.tokens < 0 ? -self.tokens / self.rate : 0;
+    }
+}
+
+@end
@@ -0,0 +1,42 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * A URI template (RFC 6570, up to level 4) compiled once into literal and expression segments,
+ * so each expansion is a single pass into one buffer. Immutable and thread-safe.
+ *
+ * Values are NSString or NSNumber for simple variables, NSArray for lists and NSDictionary for associative arrays.
+ * Variables without a value (missing or NSNull) and empty lists are left out, as the RFC defines for undefined variables.
+ */
+@interface CMISURITemplate : NSObject
+
+@property (nonatomic, strong, readonly) NSString *templateString;
+
+// the names of all variables in the template, in order of appearance
+@property (nonatomic, strong, readonly) NSArray *variableNames;
+
++ (CMISURITemplate *)templateWithString:(NSString *)templateString;
+
+- (id)initWithString:(NSString *)templateString;
+
+- (NSString *)expandWithValues:(NSDictionary *)values;
+
+- (NSURL *)urlWithValues:(NSDictionary *)values;
+
+// percent-encodes everything but unreserved characters, and when allowReserved is set, reserved characters and existing escapes
++ (void)appendString:(NSString *)string toBuffer:(NSMutableString *)buffer allowReserved:(BOOL)allowReserved;
+
+@end
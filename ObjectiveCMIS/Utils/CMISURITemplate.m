@@ -0,0 +1,355 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISURITemplate.h"
+
+// stack buffer for encoding short values without a heap allocation
+#define ENCODE_STACK_BUFFER_SIZE 256
+
+static const char kCMISHexDigits[] = "0123456789ABCDEF";
+
+/**
+ * A variable of an expression: {name}, {name*} (explode) or {name:3} (prefix).
+ */
+@interface CMISURITemplateVariable : NSObject
+
+@property (nonatomic, strong) NSString *name;
+@property (nonatomic, assign) BOOL explode;
+@property (nonatomic, assign) NSUInteger prefixLength; // 0 for the whole value
+
+@end
+
+@implementation CMISURITemplateVariable
+
+@synthesize name = _name;
+@synthesize explode = _explode;
+@synthesize prefixLength = _prefixLength;
+
+@end
+
+
+/**
+ * An expression between braces, with the expansion rules of its operator (RFC 6570, appendix A).
+ */
+@interface CMISURITemplateExpression : NSObject
+
+@property (nonatomic, strong) NSArray *variables;
+@property (nonatomic, strong) NSString *first;
+@property (nonatomic, strong) NSString *separator;
+@property (nonatomic, assign) BOOL named;
+@property (nonatomic, strong) NSString *ifEmpty;
+@property (nonatomic, assign) BOOL allowReserved;
+
+- (id)initWithOperator:(unichar)operator;
+
+@end
+
+@implementation CMISURITemplateExpression
+
+@synthesize variables = _variables;
+@synthesize first = _first;
+@synthesize separator = _separator;
+@synthesize named = _named;
+@synthesize ifEmpty = _ifEmpty;
+@synthesize allowReserved = _allowReserved;
+
+- (id)initWithOperator:(unichar)operator
+{
+    self = [super init];
+    if (self) {
+        _first = @"";
+        _separator = @",";
+        _ifEmpty = @"";
+        switch (operator) {
+            case '+':
+                _allowReserved = YES;
+                break;
+            case '#':
+                _first = @"#";
+                _allowReserved = YES;
+                break;
+            case '.':
+                _first = @".";
+                _separator = @".";
+                break;
+            case '/':
+                _first = @"/";
+                _separator = @"/";
+                break;
+            case ';':
+                _first = @";";
+                _separator = @";";
+                _named = YES;
+                break;
+            case '?':
+                _first = @"?";
+                _separator = @"&";
+                _named = YES;
+                _ifEmpty = @"=";
+                break;
+            case '&':
+                _first = @"&";
+                _separator = @"&";
+                _named = YES;
+                _ifEmpty = @"=";
+                break;
+        }
+    }
+    return self;
+}
+
+@end
+
+
+@interface CMISURITemplate ()
+
+@property (nonatomic, strong, readwrite) NSString *templateString;
+@property (nonatomic, strong, readwrite) NSArray *variableNames;
+@property (nonatomic, strong) NSArray *segments; // NSString literals and CMISURITemplateExpressions
+
+@end
+
+@implementation CMISURITemplate
+
+@synthesize templateString = _templateString;
+@synthesize variableNames = _variableNames;
+@synthesize segments = _segments;
+
++ (CMISURITemplate *)templateWithString:(NSString *)templateString
+{
+    return [[self alloc] initWithString:templateString];
+}
+
+- (id)initWithString:(NSString *)templateString
+{
+    self = [super init];
+    if (self) {
+        _templateString = templateString;
+        [self compile];
+    }
+    return self;
+}
+
+#pragma mark Compilation
+
+- (void)compile
+{
+    NSMutableArray *segments = [NSMutableArray array];
+    NSMutableArray *variableNames = [NSMutableArray array];
+    
+    NSUInteger length = self.templateString.length;
+    NSUInteger location = 0;
+    while (location < length) {
+        NSRange openRange = [self.templateString rangeOfString:@"{" options:NSLiteralSearch range:NSMakeRange(location, length - location)];
+        NSRange closeRange = openRange.location == NSNotFound ? openRange :
+            [self.templateString rangeOfString:@"}" options:NSLiteralSearch range:NSMakeRange(openRange.location, length - openRange.location)];
+        if (closeRange.location == NSNotFound) {
+            // no more expressions; an unterminated one is kept as a literal
+            [segments addObject:[self.templateString substringFromIndex:location]];
+            break;
+        }
+        
+        if (openRange.location > location) {
+            [segments addObject:[self.templateString substringWithRange:NSMakeRange(location, openRange.location - location)]];
+        }
+        
+        NSString *expressionString = [self.templateString substringWithRange:NSMakeRange(openRange.location + 1, closeRange.location - openRange.location - 1)];
+        CMISURITemplateExpression *expression = [self compileExpression:expressionString];
+        [segments addObject:expression];
+        for (CMISURITemplateVariable *variable in expression.variables) {
+            [variableNames addObject:variable.name];
+        }
+        
+        location = closeRange.location + 1;
+    }
+    
+    self.segments = segments;
+    self.variableNames = variableNames;
+}
+
+- (CMISURITemplateExpression *)compileExpression:(NSString *)expressionString
+{
+    unichar operator = expressionString.length > 0 ? [expressionString characterAtIndex:0] : 0;
+    BOOL hasOperator = (operator != 0 && strchr("+#./;?&", operator) != NULL);
+    CMISURITemplateExpression *expression = [[CMISURITemplateExpression alloc] initWithOperator:(hasOperator ? operator : 0)];
+    
+    NSString *variableList = hasOperator ? [expressionString substringFromIndex:1] : expressionString;
+    NSMutableArray *variables = [NSMutableArray array];
+    for (NSString *variableSpec in [variableList componentsSeparatedByString:@","]) {
+        CMISURITemplateVariable *variable = [[CMISURITemplateVariable alloc] init];
+        NSRange prefixRange = [variableSpec rangeOfString:@":"];
+        if ([variableSpec hasSuffix:@"*"]) {
+            variable.name = [variableSpec substringToIndex:variableSpec.length - 1];
+            variable.explode = YES;
+        } else if (prefixRange.location != NSNotFound) {
+            variable.name = [variableSpec substringToIndex:prefixRange.location];
+            variable.prefixLength = (NSUInteger)[[variableSpec substringFromIndex:prefixRange.location + 1] integerValue];
+        } else {
+            variable.name = variableSpec;
+        }
+        [variables addObject:variable];
+    }
+    expression.variables = variables;
+    return expression;
+}
+
+#pragma mark Expansion
+
+- (NSString *)expandWithValues:(NSDictionary *)values
+{
+    NSMutableString *buffer = [NSMutableString stringWithCapacity:self.templateString.length * 2];
+    for (id segment in self.segments) {
+        if ([segment isKindOfClass:[NSString class]]) {
+            [buffer appendString:segment];
+        } else {
+            [self appendExpression:segment withValues:values toBuffer:buffer];
+        }
+    }
+    return buffer;
+}
+
+- (NSURL *)urlWithValues:(NSDictionary *)values
+{
+    return [NSURL URLWithString:[self expandWithValues:values]];
+}
+
+- (void)appendExpression:(CMISURITemplateExpression *)expression withValues:(NSDictionary *)values toBuffer:(NSMutableString *)buffer
+{
+    BOOL first = YES;
+    for (CMISURITemplateVariable *variable in expression.variables) {
+        id value = [values objectForKey:variable.name];
+        if (value == nil || value == [NSNull null] ||
+            ([value isKindOfClass:[NSArray class]] && [value count] == 0) ||
+            ([value isKindOfClass:[NSDictionary class]] && [value count] == 0)) {
+            continue;
+        }
+        
+        [buffer appendString:(first ? expression.first : expression.separator)];
+        first = NO;
+        
+        if ([value isKindOfClass:[NSArray class]]) {
+            [self appendList:value ofVariable:variable forExpression:expression toBuffer:buffer];
+        } else if ([value isKindOfClass:[NSDictionary class]]) {
+            [self appendDictionary:value ofVariable:variable forExpression:expression toBuffer:buffer];
+        } else {
+            NSString *string = [value isKindOfClass:[NSString class]] ? value : [value description];
+            if (variable.prefixLength > 0 && string.length > variable.prefixLength) {
+                string = [string substringToIndex:[string rangeOfComposedCharacterSequenceAtIndex:variable.prefixLength].location];
+            }
+            if (expression.named) {
+                [buffer appendString:variable.name];
+                [buffer appendString:(string.length == 0 ? expression.ifEmpty : @"=")];
+            }
+            [CMISURITemplate appendString:string toBuffer:buffer allowReserved:expression.allowReserved];
+        }
+    }
+}
+
+- (void)appendList:(NSArray *)list ofVariable:(CMISURITemplateVariable *)variable
+     forExpression:(CMISURITemplateExpression *)expression toBuffer:(NSMutableString *)buffer
+{
+    if (expression.named && !variable.explode) {
+        [buffer appendString:variable.name];
+        [buffer appendString:@"="];
+    }
+    
+    NSString *separator = variable.explode ? expression.separator : @",";
+    BOOL first = YES;
+    for (id item in list) {
+        if (!first) {
+            [buffer appendString:separator];
+        }
+        first = NO;
+        
+        NSString *string = [item isKindOfClass:[NSString class]] ? item : [item description];
+        if (expression.named && variable.explode) {
+            [buffer appendString:variable.name];
+            [buffer appendString:(string.length == 0 ? expression.ifEmpty : @"=")];
+        }
+        [CMISURITemplate appendString:string toBuffer:buffer allowReserved:expression.allowReserved];
+    }
+}
+
+- (void)appendDictionary:(NSDictionary *)dictionary ofVariable:(CMISURITemplateVariable *)variable
+           forExpression:(CMISURITemplateExpression *)expression toBuffer:(NSMutableString *)buffer
+{
+    if (expression.named && !variable.explode) {
+        [buffer appendString:variable.name];
+        [buffer appendString:@"="];
+    }
+    
+    // keys are sorted, so an expansion does not depend on the hashing of the dictionary
+    NSString *separator = variable.explode ? expression.separator : @",";
+    BOOL first = YES;
+    for (id key in [[dictionary allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        if (!first) {
+            [buffer appendString:separator];
+        }
+        first = NO;
+        
+        id item = [dictionary objectForKey:key];
+        NSString *string = [item isKindOfClass:[NSString class]] ? item : [item description];
+        [CMISURITemplate appendString:[key description] toBuffer:buffer allowReserved:expression.allowReserved];
+        [buffer appendString:(variable.explode ? @"=" : @",")];
+        [CMISURITemplate appendString:string toBuffer:buffer allowReserved:expression.allowReserved];
+    }
+}
+
+#pragma mark Encoding
+
+static inline BOOL isUnreserved(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' || c == '~';
+}
+
+static inline BOOL isReserved(unsigned char c)
+{
+    return c != 0 && strchr(":/?#[]@!$&'()*+,;=", c) != NULL;
+}
+
+static inline BOOL isHexDigit(unsigned char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+}
+
++ (void)appendString:(NSString *)string toBuffer:(NSMutableString *)buffer allowReserved:(BOOL)allowReserved
+{
+    const unsigned char *bytes = (const unsigned char *)[string UTF8String];
+    size_t length = strlen((const char *)bytes);
+    
+    // every byte takes at most three characters
+    char stackBuffer[ENCODE_STACK_BUFFER_SIZE];
+    char *encoded = (length * 3 + 1 <= ENCODE_STACK_BUFFER_SIZE) ? stackBuffer : malloc(length * 3 + 1);
+    size_t encodedLength = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = bytes[i];
+        if (isUnreserved(c) || (allowReserved && isReserved(c))) {
+            encoded[encodedLength++] = c;
+        } else if (allowReserved && c == '%' && i + 2 < length && isHexDigit(bytes[i + 1]) && isHexDigit(bytes[i + 2])) {
+            encoded[encodedLength++] = c;
+        } else {
+            encoded[encodedLength++] = '%';
+            encoded[encodedLength++] = kCMISHexDigits[c >> 4];
+            encoded[encodedLength++] = kCMISHexDigits[c & 0x0F];
+        }
+    }
+    encoded[encodedLength] = '\0';
+    
+    CFStringAppendCString((__bridge CFMutableStringRef)buffer, encoded, kCFStringEncodingASCII);
+    if (encoded != stackBuffer) {
+        free(encoded);
+    }
+}
+
+@end
@@ -0,0 +1,38 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Assembles a url with query parameters in a single buffer.
+ * The base url is scanned for an existing query once, instead of once per appended parameter.
+ */
+@interface CMISURLBuilder : NSObject
+
+- (id)initWithUrlString:(NSString *)urlString;
+
+- (id)initWithUrl:(NSURL *)url;
+
+// parameters with a nil name or value are skipped
+- (void)addParameter:(NSString *)parameterName withValue:(NSString *)parameterValue;
+
+- (void)addParameter:(NSString *)parameterName withBoolValue:(BOOL)parameterValue;
+
+- (void)addParameter:(NSString *)parameterName withNumberValue:(NSNumber *)parameterValue;
+
+- (NSString *)urlString;
+
+- (NSURL *)url;
+
+@end
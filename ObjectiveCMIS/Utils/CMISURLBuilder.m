@@ -0,0 +1,82 @@
+/*
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ */
+
+#import "CMISURLBuilder.h"
+#import "CMISURITemplate.h"
+
+@interface CMISURLBuilder ()
+
+@property (nonatomic, strong) NSMutableString *buffer;
+@property (nonatomic, assign) BOOL hasQuery;
+
+@end
+
+@implementation CMISURLBuilder
+
+@synthesize buffer = _buffer;
+@synthesize hasQuery = _hasQuery;
+
+- (id)initWithUrlString:(NSString *)urlString
+{
+    self = [super init];
+    if (self)
+    {
+        self.buffer = [NSMutableString stringWithCapacity:urlString.length + 128];
+        [self.buffer appendString:urlString];
+        self.hasQuery = [urlString rangeOfString:@"?"].location != NSNotFound;
+    }
+    return self;
+}
+
+- (id)initWithUrl:(NSURL *)url
+{
+    return [self initWithUrlString:[url absoluteString]];
+}
+
+- (void)addParameter:(NSString *)parameterName withValue:(NSString *)parameterValue
+{
+    if (parameterName == nil || parameterValue == nil)
+    {
+        return;
+    }
+
+    [self.buffer appendString:(self.hasQuery ? @"&" : @"?")];
+    self.hasQuery = YES;
+
+    [self.buffer appendString:parameterName];
+    [self.buffer appendString:@"="];
+    [CMISURITemplate appendString:parameterValue toBuffer:self.buffer allowReserved:NO];
+}
+
+- (void)addParameter:(NSString *)parameterName withBoolValue:(BOOL)parameterValue
+{
+    [self addParameter:parameterName withValue:(parameterValue ? @"true" : @"false")];
+}
+
+- (void)addParameter:(NSString *)parameterName withNumberValue:(NSNumber *)parameterValue
+{
+    [self addParameter:parameterName withValue:[parameterValue stringValue]];
+}
+
+- (NSString *)urlString
+{
+    return [self.buffer copy];
+}
+
+- (NSURL *)url
+{
+    return [NSURL URLWithString:self.buffer];
+}
+
+@end
@@ -13,35 +13,17 @@
  */
 #import <Foundation/Foundation.h>
 #import "CMISURLUtil.h"
+#import "CMISURLBuilder.h"
 
 
 @implementation CMISURLUtil
 
 + (NSString *)urlStringByAppendingParameter:(NSString *)parameterName withValue:(NSString *)parameterValue toUrlString:(NSString *)urlString
 {
-    if (parameterName == nil || parameterValue == nil)
-    {
-        return urlString;
-    }
-
-    NSMutableString *result = [NSMutableString stringWithString:urlString];
-
-    // Append '?' if not yet in url, else append ampersand
-    if ([result rangeOfString:@"?"].location == NSNotFound)
-    {
-        [result appendString:@"?"];
-    }
-    else
-    {
-        [result appendString:@"&"];
-    }
-
-    // Append param
-    [result appendString:parameterName];
-    [result appendString:@"="];
-    [result appendString:[parameterValue stringByAddingPercentEscapesUsingEncoding:NSASCIIStringEncoding]];
-
-    return result;
+    // Callers appending several parameters should use a CMISURLBuilder, which scans the url only once
+    CMISURLBuilder *urlBuilder = [[CMISURLBuilder alloc] initWithUrlString:urlString];
+    [urlBuilder addParameter:parameterName withValue:parameterValue];
+    return [urlBuilder urlString];
 }
 
 + (NSURL *)urlStringByAppendingParameter:(NSString *)parameterName withValue:(NSString *)parameterValue toUrl:(NSURL *)url
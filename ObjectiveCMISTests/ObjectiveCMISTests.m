@@ -37,6 +37,32 @@
 #import "CMISRequest.h"
 #import "CMISErrors.h"
 #import "CMISDateUtil.h"
+#import "CMISDownloadResumeRecord.h"
+#import "CMISContentReader.h"
+#import "CMISHttpRetryPolicy.h"
+#import "CMISHedgingPolicy.h"
+#import "CMISTokenBucket.h"
+#import "CMISNetworkThread.h"
+#import "CMISURITemplate.h"
+#import "CMISURLBuilder.h"
+#import "CMISHttpUtil.h"
+#import "CMISPagedView.h"
+#import "CMISObjectInFolderContainer.h"
+#import "CMISCrawler.h"
+#import "CMISObjectIdAndChangeToken.h"
+#import "CMISHttpRequest.h"
+#import "CMISHttpResponse.h"
+#import "CMISAtomPubObjectService.h"
+#import "CMISSegmentedDownloadRequest.h"
+#import "CMISAsyncFileWriter.h"
+#import "CMISAdaptiveController.h"
+#import "CMISTransferManager.h"
+#import "CMISBindingSession.h"
+#import "CMISAtomPubNavigationService.h"
+#import "CMISAtomPubBaseService+Protected.h"
+#import "CMISPageLinks.h"
+#import "CMISKeysetQuery.h"
+#include <fcntl.h>
 
 @interface ObjectiveCMISTests ()
 
@@ -200,6 +226,202 @@
     }];
 }
 
+- (void)testCrawlTestFolder
+{
+    [self runTest:^
+    {
+        [self.session retrieveObjectByPath:@"/ios-test" completionBlock:^(CMISObject *object, NSError *error) {
+            STAssertNil(error, @"Got error while retrieving test folder: %@", [error description]);
+            CMISFolder *testFolder = (CMISFolder *)object;
+            
+            // Small pages and two listings at once, over the test folder and its subfolders
+            CMISCrawler *crawler = [[CMISCrawler alloc] initWithSession:self.session];
+            crawler.maximumConcurrentListings = 2;
+            crawler.operationContext.maxItemsPerPage = 5;
+            NSMutableSet *objectIds = [NSMutableSet set];
+            crawler.objectBlock = ^(CMISObject *object) {
+                STAssertFalse([objectIds containsObject:object.identifier], @"Object %@ was delivered twice", object.identifier);
+                [objectIds addObject:object.identifier];
+            };
+            
+            [crawler crawlFolder:testFolder completionBlock:^(NSError *error) {
+                STAssertNil(error, @"Got error while crawling: %@", [error description]);
+                STAssertTrue(objectIds.count > 6, @"The test folder should have more than 6 objects below it");
+                
+                NSDictionary *checkpoint = [crawler checkpoint];
+                STAssertTrue([[checkpoint objectForKey:kCMISCrawlerCheckpointPendingFolderIds] count] == 0, @"Nothing should be left to crawl");
+                STAssertTrue([[checkpoint objectForKey:kCMISCrawlerCheckpointSeenObjectIds] count] == objectIds.count + 1,
+                             @"All objects and the test folder should be in the checkpoint");
+                self.testCompleted = YES;
+            }];
+        }];
+    }];
+}
+
+- (void)testCrawlResumeFromCheckpoint
+{
+    [self runTest:^
+    {
+        [self.session retrieveObjectByPath:@"/ios-test" completionBlock:^(CMISObject *object, NSError *error) {
+            STAssertNil(error, @"Got error while retrieving test folder: %@", [error description]);
+            CMISFolder *testFolder = (CMISFolder *)object;
+            
+            // A full crawl first, to know what the interrupted and resumed crawls should deliver together
+            CMISCrawler *referenceCrawler = [[CMISCrawler alloc] initWithSession:self.session];
+            NSMutableSet *referenceObjectIds = [NSMutableSet set];
+            referenceCrawler.objectBlock = ^(CMISObject *object) {
+                [referenceObjectIds addObject:object.identifier];
+            };
+            [referenceCrawler crawlFolder:testFolder completionBlock:^(NSError *error) {
+                STAssertNil(error, @"Got error while crawling: %@", [error description]);
+                STAssertTrue(referenceObjectIds.count > 6, @"The test folder should have more than 6 objects below it");
+                
+                // One listing at a time over small pages, cancelled in the middle of a page
+                CMISCrawler *interruptedCrawler = [[CMISCrawler alloc] initWithSession:self.session];
+                interruptedCrawler.maximumConcurrentListings = 1;
+                interruptedCrawler.operationContext.maxItemsPerPage = 2;
+                NSMutableSet *deliveredObjectIds = [NSMutableSet set];
+                __weak CMISCrawler *weakInterruptedCrawler = interruptedCrawler;
+                interruptedCrawler.objectBlock = ^(CMISObject *object) {
+                    [deliveredObjectIds addObject:object.identifier];
+                    if (deliveredObjectIds.count == 3) {
+                        [weakInterruptedCrawler cancel];
+                    }
+                };
+                [interruptedCrawler crawlFolder:testFolder completionBlock:^(NSError *error) {
+                    STAssertTrue(error.code == kCMISErrorCodeCancelled, @"Crawl should have been cancelled, got: %@", [error description]);
+                    STAssertTrue(deliveredObjectIds.count == 3, @"No object should be delivered once the crawl is cancelled");
+                    
+                    NSDictionary *checkpoint = [weakInterruptedCrawler checkpoint];
+                    STAssertTrue([[checkpoint objectForKey:kCMISCrawlerCheckpointPendingFolderIds] count] > 0, @"The checkpoint should have folders left to crawl");
+                    
+                    // The resumed crawl lists the interrupted folder again, but must skip what was delivered before
+                    CMISCrawler *resumedCrawler = [[CMISCrawler alloc] initWithSession:self.session];
+                    resumedCrawler.operationContext.maxItemsPerPage = 2;
+                    resumedCrawler.objectBlock = ^(CMISObject *object) {
+                        STAssertFalse([deliveredObjectIds containsObject:object.identifier], @"Object %@ was delivered twice", object.identifier);
+                        [deliveredObjectIds addObject:object.identifier];
+                    };
+                    [resumedCrawler resumeFromCheckpoint:checkpoint completionBlock:^(NSError *error) {
+                        STAssertNil(error, @"Got error while resuming the crawl: %@", [error description]);
+                        STAssertEqualObjects(deliveredObjectIds, referenceObjectIds, @"The interrupted and resumed crawls should deliver every object once");
+                        self.testCompleted = YES;
+                    }];
+                }];
+            }];
+        }];
+    }];
+}
+
+- (void)testRetrieveObjects
+{
+    [self runTest:^
+    {
+        [self.session retrieveObjectByPath:@"/ios-test" completionBlock:^(CMISObject *object, NSError *error) {
+            STAssertNil(error, @"Got error while retrieving test folder: %@", [error description]);
+            CMISFolder *testFolder = (CMISFolder *)object;
+            
+            [testFolder retrieveChildrenWithCompletionBlock:^(CMISPagedResult *pagedResult, NSError *error) {
+                STAssertNil(error, @"Got error while retrieving children: %@", [error description]);
+                
+                // A folder, documents, an unknown id and a repeated one
+                NSMutableArray *objectIds = [NSMutableArray arrayWithObject:testFolder.identifier];
+                for (CMISObject *child in pagedResult.resultArray) {
+                    [objectIds addObject:child.identifier];
+                }
+                [objectIds addObject:@"unknown-object-id"];
+                [objectIds addObject:testFolder.identifier];
+                
+                [self.session retrieveObjects:objectIds
+                         withOperationContext:[CMISOperationContext defaultOperationContext]
+                              completionBlock:^(NSArray *objects, NSDictionary *errors) {
+                    STAssertTrue(objects.count == objectIds.count, @"There should be a result for every requested id");
+                    for (NSUInteger i = 0; i < objectIds.count - 2; i++) {
+                        CMISObject *object = [objects objectAtIndex:i];
+                        STAssertTrue([object isKindOfClass:[CMISObject class]], @"Object %@ should have been retrieved", [objectIds objectAtIndex:i]);
+                        STAssertEqualObjects(object.identifier, [objectIds objectAtIndex:i], @"Objects should be in the requested order");
+                    }
+                    STAssertTrue([objects objectAtIndex:(objectIds.count - 2)] == [NSNull null], @"The unknown id should not be retrieved");
+                    STAssertNotNil([errors objectForKey:@"unknown-object-id"], @"The unknown id should have an error");
+                    STAssertTrue(errors.count == 1, @"Only the unknown id should have an error");
+                    STAssertEqualObjects([[objects lastObject] identifier], testFolder.identifier, @"A repeated id should be retrieved again");
+                    self.testCompleted = YES;
+                }];
+            }];
+        }];
+    }];
+}
+
+- (void)testRetrieveObjectsWithoutQuery
+{
+    [self runTest:^
+    {
+        [self.session retrieveObjectByPath:@"/ios-test" completionBlock:^(CMISObject *object, NSError *error) {
+            STAssertNil(error, @"Got error while retrieving test folder: %@", [error description]);
+            CMISFolder *testFolder = (CMISFolder *)object;
+            
+            [testFolder retrieveChildrenWithCompletionBlock:^(CMISPagedResult *pagedResult, NSError *error) {
+                STAssertNil(error, @"Got error while retrieving children: %@", [error description]);
+                NSMutableArray *objectIds = [NSMutableArray arrayWithObject:testFolder.identifier];
+                for (CMISObject *child in pagedResult.resultArray) {
+                    [objectIds addObject:child.identifier];
+                }
+                
+                // without the query collection every batch query fails, so all objects must be retrieved by id
+                CMISBindingSession *bindingSession = [(CMISAtomPubBaseService *)self.session.binding.discoveryService bindingSession];
+                id queryCollection = [bindingSession objectForKey:kCMISBindingSessionKeyQueryCollection];
+                [bindingSession removeKey:kCMISBindingSessionKeyQueryCollection];
+                
+                [self.session retrieveObjects:objectIds
+                         withOperationContext:[CMISOperationContext defaultOperationContext]
+                              completionBlock:^(NSArray *objects, NSDictionary *errors) {
+                    [bindingSession setObject:queryCollection forKey:kCMISBindingSessionKeyQueryCollection];
+                    
+                    STAssertTrue(errors.count == 0, @"Unexpected errors: %@", errors);
+                    STAssertTrue(objects.count == objectIds.count, @"There should be a result for every requested id");
+                    for (NSUInteger i = 0; i < objectIds.count; i++) {
+                        STAssertEqualObjects([[objects objectAtIndex:i] identifier], [objectIds objectAtIndex:i], @"Objects should be retrieved in the requested order");
+                    }
+                    self.testCompleted = YES;
+                }];
+            }];
+        }];
+    }];
+}
+
+- (void)testRetrieveObjectsWithAclContext
+{
+    [self runTest:^
+    {
+        [self.session retrieveObjectByPath:@"/ios-test" completionBlock:^(CMISObject *object, NSError *error) {
+            STAssertNil(error, @"Got error while retrieving test folder: %@", [error description]);
+            CMISFolder *testFolder = (CMISFolder *)object;
+            
+            [testFolder retrieveChildrenWithCompletionBlock:^(CMISPagedResult *pagedResult, NSError *error) {
+                STAssertNil(error, @"Got error while retrieving children: %@", [error description]);
+                NSMutableArray *objectIds = [NSMutableArray arrayWithObject:testFolder.identifier];
+                for (CMISObject *child in pagedResult.resultArray) {
+                    [objectIds addObject:child.identifier];
+                }
+                
+                // a query result cannot carry ACLs, so every object must be retrieved by id
+                CMISOperationContext *operationContext = [CMISOperationContext defaultOperationContext];
+                operationContext.isIncluseACLs = YES;
+                [self.session retrieveObjects:objectIds
+                         withOperationContext:operationContext
+                              completionBlock:^(NSArray *objects, NSDictionary *errors) {
+                    STAssertTrue(errors.count == 0, @"Unexpected errors: %@", errors);
+                    STAssertTrue(objects.count == objectIds.count, @"There should be a result for every requested id");
+                    for (NSUInteger i = 0; i < objectIds.count; i++) {
+                        STAssertEqualObjects([[objects objectAtIndex:i] identifier], [objectIds objectAtIndex:i], @"Objects should be retrieved in the requested order");
+                    }
+                    self.testCompleted = YES;
+                }];
+            }];
+        }];
+    }];
+}
+
 - (void)testDocumentProperties
 {
     [self runTest:^
@@ -346,6 +568,311 @@
      }];
 }
 
+- (void)testResumeDownload
+{
+    [self runTest:^
+     {
+         [self.session retrieveObjectByPath:@"/ios-test/activiti-modeler.png" completionBlock:^(CMISObject *object, NSError *error) {
+             CMISDocument *document = (CMISDocument *)object;
+             STAssertNil(error, @"Error while retrieving object: %@", [error description]);
+
+             NSString *filePath = [NSString stringWithFormat:@"%@/testfile-resume", NSTemporaryDirectory()];
+             [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+             [[NSFileManager defaultManager] removeItemAtPath:[CMISDownloadResumeRecord recordPathForFileAtPath:filePath] error:nil];
+
+             // Interrupt a first download as soon as some data arrived
+             __block unsigned long long bytesBeforeCancel = 0;
+             self.request = [document downloadContentToFile:filePath completionBlock:^(NSError *error) {
+                 STAssertTrue(error.code == kCMISErrorCodeCancelled, @"Unexpected error: %@", [error description]);
+                 STAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:[CMISDownloadResumeRecord recordPathForFileAtPath:filePath]],
+                              @"Resume record should have been kept for the interrupted download");
+
+                 // The second download should continue where the first one stopped
+                 __block unsigned long long firstBytesReported = 0;
+                 STAssertTrue(bytesBeforeCancel < document.contentStreamLength, @"Download should have been interrupted");
+                 [document downloadContentToFile:filePath completionBlock:^(NSError *error) {
+                     STAssertNil(error, @"Error while resuming download: %@", [error description]);
+                     STAssertTrue(firstBytesReported > bytesBeforeCancel, @"Progress should have been seeded with the resumed offset");
+
+                     NSError *fileError = nil;
+                     NSDictionary *fileAttributes = [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:&fileError];
+                     STAssertNil(fileError, @"Could not verify attributes of file %@: %@", filePath, [fileError description]);
+                     STAssertTrue([fileAttributes fileSize] == document.contentStreamLength,
+                                  @"Expected %lld bytes but found %lld", document.contentStreamLength, [fileAttributes fileSize]);
+                     STAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:[CMISDownloadResumeRecord recordPathForFileAtPath:filePath]],
+                                   @"Resume record should have been removed after the download completed");
+
+                     [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+                     self.testCompleted = YES;
+                 } progressBlock:^(unsigned long long bytesDownloaded, unsigned long long bytesTotal) {
+                     if (firstBytesReported == 0) {
+                         firstBytesReported = bytesDownloaded;
+                     }
+                 }];
+             } progressBlock:^(unsigned long long bytesDownloaded, unsigned long long bytesTotal) {
+                 if (bytesDownloaded > 0 && self.request) {
+                     bytesBeforeCancel = bytesDownloaded;
+                     [self.request cancel];
+                     self.request = nil;
+                 }
+             }];
+         }];
+     }];
+}
+
+- (void)testDownloadResumeRecordValidation
+{
+    NSString *filePath = [NSString stringWithFormat:@"%@/testfile-resume-record", NSTemporaryDirectory()];
+    [[NSData dataWithBytes:"0123456789" length:10] writeToFile:filePath atomically:YES];
+    
+    CMISDownloadResumeRecord *record = [CMISDownloadResumeRecord resumeRecordForFileAtPath:filePath];
+    record.contentUrl = @"http://localhost/content";
+    record.bytesWritten = 10;
+    
+    // nothing could tell a modified document apart
+    STAssertFalse([record canResumeWithContentUrl:@"http://localhost/content" changeToken:nil], @"Resumed without change token or ETag");
+    
+    record.eTag = @"\"v1\"";
+    STAssertTrue([record canResumeWithContentUrl:@"http://localhost/content" changeToken:nil], @"The ETag should allow resuming");
+    STAssertFalse([record canResumeWithContentUrl:@"http://localhost/other" changeToken:nil], @"Resumed another content url");
+    
+    record.eTag = nil;
+    record.changeToken = @"1";
+    STAssertTrue([record canResumeWithContentUrl:@"http://localhost/content" changeToken:@"1"], @"A matching change token should allow resuming");
+    STAssertFalse([record canResumeWithContentUrl:@"http://localhost/content" changeToken:@"2"], @"Resumed a changed document");
+    STAssertFalse([record canResumeWithContentUrl:@"http://localhost/content" changeToken:nil], @"Resumed without the current change token");
+    
+    record.bytesWritten = 11;
+    STAssertFalse([record canResumeWithContentUrl:@"http://localhost/content" changeToken:@"1"], @"Resumed beyond the end of the file");
+    
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+- (void)testAsyncFileWriter
+{
+    NSString *filePath = [NSString stringWithFormat:@"%@/testfile-async-writer", NSTemporaryDirectory()];
+    NSUInteger length = 3 * 1048576 + 1000; // not a multiple of the write block size
+    NSMutableData *content = [NSMutableData dataWithLength:length];
+    uint8_t *bytes = content.mutableBytes;
+    for (NSUInteger i = 0; i < length; i++) {
+        bytes[i] = (uint8_t)(i % 251);
+    }
+    
+    // the expected length is too big on purpose: the file must still end where the content does
+    CMISAsyncFileWriter *writer = [[CMISAsyncFileWriter alloc] initWithFilePath:filePath bytesExpected:4 * 1048576];
+    STAssertNotNil(writer, @"Could not create writer for %@", filePath);
+    
+    NSUInteger offset = 0;
+    NSDate *timeoutDate = [NSDate dateWithTimeIntervalSinceNow:10];
+    while (offset < length && [timeoutDate timeIntervalSinceNow] > 0) {
+        NSInteger written = [writer writeBytes:bytes + offset maxLength:MIN(length - offset, 65536)];
+        STAssertTrue(written >= 0, @"Writer failed after %lu bytes", (unsigned long)offset);
+        if (written <= 0) {
+            [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+        }
+        offset += MAX(written, 0);
+        
+        // the count of bytes on disk may be read while the writer queue is updating it
+        STAssertTrue(writer.bytesWritten <= offset, @"More bytes on disk than were handed to the writer");
+    }
+    
+    [writer closeWithError:nil completionBlock:^(NSError *sinkError) {
+        STAssertNil(sinkError, @"Error while writing %@: %@", filePath, [sinkError description]);
+        self.testCompleted = YES;
+    }];
+    [self waitForCompletion:10];
+    
+    STAssertTrue(writer.bytesWritten == length, @"Expected %lu bytes written but got %llu", (unsigned long)length, writer.bytesWritten);
+    STAssertEqualObjects([NSData dataWithContentsOfFile:filePath], content, @"File content does not match what was written");
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+}
+
+- (void)testFailedSegmentedDownloadRemovesFile
+{
+    NSString *filePath = [NSString stringWithFormat:@"%@/testfile-segmented", NSTemporaryDirectory()];
+    unsigned long long length = 4 * 1048576;
+    
+    // the shared preallocation extends the file to its full length before anything is written
+    int fileDescriptor = open([filePath fileSystemRepresentation], O_RDWR | O_CREAT | O_TRUNC, 0644);
+    STAssertTrue(fileDescriptor >= 0, @"Could not create %@", filePath);
+    STAssertTrue([FileUtil preallocateFileDescriptor:fileDescriptor length:length], @"Could not preallocate %@", filePath);
+    close(fileDescriptor);
+    NSError *fileError = nil;
+    STAssertTrue([FileUtil fileSizeForFileAtPath:filePath error:&fileError] == length, @"Preallocated file has the wrong length");
+    
+    // a segmented download that ends early must not leave that zero-filled file behind
+    CMISSessionParameters *parameters = [[CMISSessionParameters alloc] initWithBindingType:CMISBindingTypeAtomPub];
+    parameters.atomPubUrl = [NSURL URLWithString:@"http://localhost/cmis"];
+    CMISBindingSession *bindingSession = [[CMISBindingSession alloc] initWithSessionParameters:parameters];
+    __block NSError *downloadError = nil;
+    CMISSegmentedDownloadRequest *request = [CMISSegmentedDownloadRequest startRequestForUrl:[NSURL URLWithString:@"http://localhost/content"]
+                                                                                 withSession:bindingSession
+                                                                                toFileAtPath:filePath
+                                                                               bytesExpected:length
+                                                                                segmentCount:4
+                                                                             completionBlock:^(NSError *error) {
+                                                                                 downloadError = error;
+                                                                             }
+                                                                               progressBlock:nil];
+    STAssertNotNil(request, @"Segmented download did not start");
+    STAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:filePath], @"Target file should have been created");
+    
+    [request cancel];
+    STAssertTrue(downloadError.code == kCMISErrorCodeCancelled, @"Unexpected error: %@", [downloadError description]);
+    STAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:filePath], @"Partial segmented download was kept");
+}
+
+- (void)testBindingSessionConcurrentAccess
+{
+    CMISSessionParameters *parameters = [[CMISSessionParameters alloc] initWithBindingType:CMISBindingTypeAtomPub];
+    parameters.atomPubUrl = [NSURL URLWithString:@"http://localhost/cmis"];
+    CMISBindingSession *bindingSession = [[CMISBindingSession alloc] initWithSessionParameters:parameters];
+    
+    // Many threads at once: each writes and reads back its own key, and all race for one shared key
+    NSUInteger iterations = 200;
+    NSMutableArray *winners = [NSMutableArray arrayWithCapacity:iterations];
+    for (NSUInteger index = 0; index < iterations; index++) {
+        [winners addObject:[NSNull null]];
+    }
+    __block BOOL ownWritesVisible = YES;
+    dispatch_apply(iterations, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index) {
+        NSString *key = [NSString stringWithFormat:@"test.key.%lu", (unsigned long)index];
+        NSNumber *value = [NSNumber numberWithUnsignedLong:index];
+        [bindingSession setObject:value forKey:key];
+        if (![[bindingSession objectForKey:key] isEqual:value]) {
+            ownWritesVisible = NO;
+        }
+        
+        id winner = [bindingSession setObject:value forKeyIfAbsent:@"test.shared.key"];
+        @synchronized(winners) {
+            [winners replaceObjectAtIndex:index withObject:winner];
+        }
+        
+        if (index % 10 == 0) {
+            [bindingSession addEntriesFromDictionary:[NSDictionary dictionaryWithObject:value forKey:[key stringByAppendingString:@".added"]]];
+        }
+    });
+    
+    STAssertTrue(ownWritesVisible, @"A write should be visible to the next read on the same thread");
+    id sharedValue = [bindingSession objectForKey:@"test.shared.key"];
+    STAssertNotNil(sharedValue, @"The shared key should have been set");
+    for (id winner in winners) {
+        STAssertEqualObjects(winner, sharedValue, @"Every thread should get the one value that was stored first");
+    }
+    for (NSUInteger index = 0; index < iterations; index++) {
+        NSString *key = [NSString stringWithFormat:@"test.key.%lu", (unsigned long)index];
+        STAssertEqualObjects([bindingSession objectForKey:key], [NSNumber numberWithUnsignedLong:index], @"Value of %@ was lost", key);
+    }
+    STAssertNotNil([bindingSession objectForKey:@"test.key.190.added"], @"Added entries should be visible");
+    
+    [bindingSession removeKey:@"test.shared.key"];
+    STAssertNil([bindingSession objectForKey:@"test.shared.key"], @"A removed key should not be visible to the next read");
+}
+
+- (void)testContentReader
+{
+    [self runTest:^
+     {
+         [self.session retrieveObjectByPath:@"/ios-test/activiti-modeler.png" completionBlock:^(CMISObject *object, NSError *error) {
+             CMISDocument *document = (CMISDocument *)object;
+             STAssertNil(error, @"Error while retrieving object: %@", [error description]);
+
+             NSString *filePath = [NSString stringWithFormat:@"%@/testfile-reader", NSTemporaryDirectory()];
+             [document downloadContentToFile:filePath completionBlock:^(NSError *error) {
+                 STAssertNil(error, @"Error while downloading content: %@", [error description]);
+                 NSData *content = [NSData dataWithContentsOfFile:filePath];
+
+                 CMISContentReader *reader = [[CMISContentReader alloc] initWithDocument:document];
+                 reader.blockSize = 1024;
+                 STAssertTrue(reader.length == content.length, @"Reader length %llu does not match content length %u", reader.length, content.length);
+
+                 // A range spanning several blocks
+                 NSRange range = NSMakeRange(1000, 3000);
+                 [reader readRange:range completionBlock:^(NSData *data, NSError *error) {
+                     STAssertNil(error, @"Error while reading range: %@", [error description]);
+                     STAssertEqualObjects(data, [content subdataWithRange:range], @"Range data does not match the content");
+
+                     // The tail of the content, read sequentially
+                     [reader seekToOffset:-100];
+                     [reader readDataOfLength:1000 completionBlock:^(NSData *data, NSError *error) {
+                         STAssertNil(error, @"Error while reading tail: %@", [error description]);
+                         STAssertEqualObjects(data, [content subdataWithRange:NSMakeRange(content.length - 100, 100)],
+                                              @"Tail data does not match the content");
+                         STAssertTrue(reader.offset == reader.length, @"Offset should be at the end of the content");
+
+                         [[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+                         self.testCompleted = YES;
+                     }];
+                 }];
+             } progressBlock:nil];
+         }];
+     }];
+}
+
+- (void)testContentInputStream
+{
+    [self runTest:^
+     {
+         [self.session retrieveObjectByPath:@"/ios-test/activiti-modeler.png" completionBlock:^(CMISObject *object, NSError *error) {
+             CMISDocument *document = (CMISDocument *)object;
+             STAssertNil(error, @"Error while retrieving object: %@", [error description]);
+
+             // A buffer much smaller than the content forces the download to be paused repeatedly
+             NSInputStream *inputStream = [self.session inputStreamForContentOfCMISObject:document.identifier
+                                                                               bufferSize:4096
+                                                                          completionBlock:^(NSError *error) {
+                 STAssertNil(error, @"Error while downloading content: %@", [error description]);
+             }];
+
+             dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                 [inputStream open];
+                 unsigned long long totalBytesRead = 0;
+                 uint8_t buffer[1000];
+                 NSInteger bytesRead;
+                 while ((bytesRead = [inputStream read:buffer maxLength:sizeof(buffer)]) > 0) {
+                     totalBytesRead += bytesRead;
+                     usleep(1000); // slow consumer
+                 }
+                 [inputStream close];
+
+                 dispatch_async(dispatch_get_main_queue(), ^{
+                     STAssertTrue(bytesRead == 0, @"Stream ended with an error: %@", [inputStream.streamError description]);
+                     STAssertTrue(totalBytesRead == document.contentStreamLength,
+                                  @"Expected %llu bytes but read %llu", document.contentStreamLength, totalBytesRead);
+                     self.testCompleted = YES;
+                 });
+             });
+         }];
+     }];
+}
+
+- (void)testContentInputStreamClosedEarly
+{
+    [self runTest:^
+     {
+         [self.session retrieveObjectByPath:@"/ios-test/activiti-modeler.png" completionBlock:^(CMISObject *object, NSError *error) {
+             CMISDocument *document = (CMISDocument *)object;
+             STAssertNil(error, @"Error while retrieving object: %@", [error description]);
+
+             // Giving up on the content is the consumer's choice, not a failure of the download
+             NSInputStream *inputStream = [self.session inputStreamForContentOfCMISObject:document.identifier
+                                                                               bufferSize:4096
+                                                                          completionBlock:^(NSError *error) {
+                 STAssertTrue(error.code == kCMISErrorCodeCancelled, @"Unexpected error: %@", [error description]);
+                 self.testCompleted = YES;
+             }];
+
+             dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                 [inputStream open];
+                 uint8_t buffer[1000];
+                 NSInteger bytesRead = [inputStream read:buffer maxLength:sizeof(buffer)];
+                 STAssertTrue(bytesRead > 0, @"Could not read from the stream: %@", [inputStream.streamError description]);
+                 [inputStream close];
+             });
+         }];
+     }];
+}
+
 - (void)testCreateAndDeleteDocument
 {
     [self runTest:^
@@ -448,6 +975,156 @@
     }];
 }
 
+- (void)testUploadPreflight
+{
+    NSDictionary *extraSessionParameters = [NSDictionary dictionaryWithObject:[NSNumber numberWithBool:YES]
+                                                                       forKey:kCMISSessionParameterUploadPreflight];
+    [self runTest:^
+     {
+         [self.session retrieveObjectByPath:@"/ios-test" completionBlock:^(CMISObject *object, NSError *error) {
+             CMISFolder *testFolder = (CMISFolder *)object;
+             STAssertNil(error, @"Error while retrieving folder: %@", [error description]);
+             
+             NSString *filePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"test_file.txt" ofType:nil];
+             id<CMISObjectService> objectService = self.session.binding.objectService;
+             CMISProperties *properties = [[CMISProperties alloc] init];
+             [properties addProperty:[CMISPropertyData createPropertyForId:kCMISPropertyName withStringValue:@"activiti-modeler.png"]];
+             [properties addProperty:[CMISPropertyData createPropertyForId:kCMISPropertyObjectTypeId withIdValue:kCMISPropertyObjectTypeIdValueDocument]];
+             
+             // The name is taken: the preflight refuses the upload before any content is sent
+             [objectService createDocumentFromFilePath:filePath withMimeType:@"text/plain" withProperties:properties inFolder:testFolder.identifier
+                                       completionBlock:^(NSString *objectId, NSError *error) {
+                 STAssertNil(objectId, @"Document should not have been created");
+                 STAssertTrue(error.code == kCMISErrorCodeNameConstraintViolation, @"Unexpected error: %@", [error description]);
+                 
+                 // The preflight requests belong to the upload's request, so cancelling it stops them too
+                 CMISProperties *newProperties = [[CMISProperties alloc] init];
+                 NSString *documentName = [NSString stringWithFormat:@"test_file_%@.txt", [self stringFromCurrentDate]];
+                 [newProperties addProperty:[CMISPropertyData createPropertyForId:kCMISPropertyName withStringValue:documentName]];
+                 [newProperties addProperty:[CMISPropertyData createPropertyForId:kCMISPropertyObjectTypeId withIdValue:kCMISPropertyObjectTypeIdValueDocument]];
+                 CMISRequest *request = [objectService createDocumentFromFilePath:filePath withMimeType:@"text/plain" withProperties:newProperties inFolder:testFolder.identifier
+                                                                  completionBlock:^(NSString *objectId, NSError *error) {
+                     STAssertNil(objectId, @"Document should not have been created");
+                     STAssertTrue(error.code == kCMISErrorCodeCancelled, @"Unexpected error: %@", [error description]);
+                     self.testCompleted = YES;
+                 } progressBlock:nil];
+                 [request cancel];
+             } progressBlock:nil];
+         }];
+     } withExtraSessionParameters:extraSessionParameters];
+}
+
+- (void)testUploadWithExpectContinue
+{
+    NSMutableDictionary *extraSessionParameters = [NSMutableDictionary dictionary];
+    [extraSessionParameters setObject:[NSNumber numberWithInt:1] forKey:kCMISSessionParameterExpectContinueThreshold];
+    [extraSessionParameters setObject:[NSNumber numberWithDouble:0.5] forKey:kCMISSessionParameterExpectContinueTimeout];
+    [self runTest:^
+     {
+         NSString *filePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"test_file.txt" ofType:nil];
+         unsigned long long fileSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:nil] fileSize];
+         NSString *documentName = [NSString stringWithFormat:@"test_file_%@.txt", [self stringFromCurrentDate]];
+         NSMutableDictionary *documentProperties = [NSMutableDictionary dictionary];
+         [documentProperties setObject:documentName forKey:kCMISPropertyName];
+         [documentProperties setObject:kCMISPropertyObjectTypeIdValueDocument forKey:kCMISPropertyObjectTypeId];
+         
+         // The body is held back until the server answers or the timeout passes, and must arrive complete either way
+         [self.session createDocumentFromFilePath:filePath withMimeType:@"text/plain" withProperties:documentProperties inFolder:self.rootFolder.identifier
+                                  completionBlock:^(NSString *objectId, NSError *error) {
+             STAssertNil(error, @"Got error while uploading document: %@", [error description]);
+             if (objectId == nil) {
+                 self.testCompleted = YES;
+                 return;
+             }
+             [self.session retrieveObject:objectId completionBlock:^(CMISObject *object, NSError *error) {
+                 CMISDocument *document = (CMISDocument *)object;
+                 STAssertNil(error, @"Got error while retrieving document: %@", [error description]);
+                 STAssertTrue(document.contentStreamLength == fileSize,
+                              @"Expected %llu bytes of content, but found %llu", fileSize, document.contentStreamLength);
+                 [self deleteDocumentAndVerify:document completionBlock:^{
+                     self.testCompleted = YES;
+                 }];
+             }];
+         } progressBlock:nil];
+     } withExtraSessionParameters:extraSessionParameters];
+}
+
+- (void)testTransferManagerJournalAndRecovery
+{
+    [self runTest:^
+     {
+         NSString *journalPath = [NSString stringWithFormat:@"%@/test-transfer-journal.plist", NSTemporaryDirectory()];
+         NSString *crashJournalPath = [NSString stringWithFormat:@"%@/test-transfer-journal-crash.plist", NSTemporaryDirectory()];
+         [[NSFileManager defaultManager] removeItemAtPath:journalPath error:nil];
+         [[NSFileManager defaultManager] removeItemAtPath:crashJournalPath error:nil];
+         
+         [self.session retrieveObjectByPath:@"/ios-test/activiti-modeler.png" completionBlock:^(CMISObject *object, NSError *error) {
+             STAssertNil(error, @"Error while retrieving object: %@", [error description]);
+             NSString *lowPriorityFilePath = [NSString stringWithFormat:@"%@/testfile-transfer-low", NSTemporaryDirectory()];
+             NSString *highPriorityFilePath = [NSString stringWithFormat:@"%@/testfile-transfer-high", NSTemporaryDirectory()];
+             NSMutableArray *managers = [NSMutableArray array]; // transfers only hold their manager weakly
+             
+             // A manager that never gets to start its transfers, as if the process ended right after they were queued
+             CMISTransferManager *firstManager = [[CMISTransferManager alloc] initWithSession:self.session journalPath:journalPath];
+             firstManager.maximumConcurrentTransfers = 0;
+             [firstManager enqueueDownloadOfObject:object.identifier toFile:lowPriorityFilePath priority:0 bandwidthLimit:0 completionBlock:nil progressBlock:nil];
+             [firstManager enqueueDownloadOfObject:object.identifier toFile:highPriorityFilePath priority:5 bandwidthLimit:0 completionBlock:nil progressBlock:nil];
+             STAssertTrue(firstManager.transfers.count == 2, @"Expected 2 queued transfers, but found %lu", (unsigned long)firstManager.transfers.count);
+             STAssertTrue([[NSArray arrayWithContentsOfFile:journalPath] count] == 2, @"Queued transfers were not journaled");
+             
+             // The next manager recovers them from the journal and runs the higher priority first
+             CMISTransferManager *secondManager = [[CMISTransferManager alloc] initWithSession:self.session journalPath:journalPath];
+             secondManager.maximumConcurrentTransfers = 1;
+             [managers addObject:secondManager];
+             NSMutableArray *completedFilePaths = [NSMutableArray array];
+             NSArray *resumedTransfers = [secondManager resumeJournaledTransfersWithCompletionBlock:^(CMISTransfer *transfer, NSError *error) {
+                 STAssertNil(error, @"Error while downloading %@: %@", transfer.filePath, [error description]);
+                 [completedFilePaths addObject:transfer.filePath];
+                 if (completedFilePaths.count < 2) {
+                     return;
+                 }
+                 
+                 STAssertEqualObjects([completedFilePaths objectAtIndex:0], highPriorityFilePath, @"Higher priority transfer should have run first");
+                 STAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:journalPath], @"Journal should be removed once all transfers finished");
+                 [[NSFileManager defaultManager] removeItemAtPath:lowPriorityFilePath error:nil];
+                 [[NSFileManager defaultManager] removeItemAtPath:highPriorityFilePath error:nil];
+                 
+                 // An upload that was sent before the process ended must not create a second document when recovered
+                 NSString *filePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"test_file.txt" ofType:nil];
+                 NSMutableDictionary *documentProperties = [NSMutableDictionary dictionary];
+                 [documentProperties setObject:[NSString stringWithFormat:@"test_file_%@.txt", [self stringFromCurrentDate]] forKey:kCMISPropertyName];
+                 [documentProperties setObject:kCMISPropertyObjectTypeIdValueDocument forKey:kCMISPropertyObjectTypeId];
+                 
+                 CMISTransferManager *uploadManager = [[CMISTransferManager alloc] initWithSession:self.session journalPath:journalPath];
+                 [managers addObject:uploadManager];
+                 [uploadManager enqueueUploadOfFile:filePath withMimeType:@"text/plain" withProperties:documentProperties inFolder:self.rootFolder.identifier
+                                           priority:0 bandwidthLimit:0 completionBlock:^(CMISTransfer *upload, NSError *error) {
+                     STAssertNil(error, @"Error while uploading: %@", [error description]);
+                     
+                     CMISTransferManager *recoveringManager = [[CMISTransferManager alloc] initWithSession:self.session journalPath:crashJournalPath];
+                     [managers addObject:recoveringManager];
+                     [recoveringManager resumeJournaledTransfersWithCompletionBlock:^(CMISTransfer *recoveredUpload, NSError *error) {
+                         STAssertNil(error, @"Error while recovering the upload: %@", [error description]);
+                         STAssertEqualObjects(recoveredUpload.objectId, upload.objectId, @"Recovered upload should have found the document created before");
+                         [[NSFileManager defaultManager] removeItemAtPath:crashJournalPath error:nil];
+                         
+                         [self.session retrieveObject:upload.objectId completionBlock:^(CMISObject *object, NSError *error) {
+                             [self deleteDocumentAndVerify:(CMISDocument *)object completionBlock:^{
+                                 [managers removeAllObjects];
+                                 self.testCompleted = YES;
+                             }];
+                         }];
+                     }];
+                 } progressBlock:nil];
+                 
+                 // the upload has been started and journaled as such: keep the journal as a crash at this point would leave it
+                 [[NSFileManager defaultManager] copyItemAtPath:journalPath toPath:crashJournalPath error:nil];
+             }];
+             STAssertTrue(resumedTransfers.count == 2, @"Expected 2 resumed transfers, but got %lu", (unsigned long)resumedTransfers.count);
+         }];
+     }];
+}
+
 - (void)testCreateBigDocument
 {
     [self runTest:^
@@ -836,6 +1513,72 @@
      }];
 }
 
+- (void)testKeysetQueryStatement
+{
+    CMISTypeDefinition *typeDefinition = [[CMISTypeDefinition alloc] init];
+    typeDefinition.queryName = @"cmis:document";
+    CMISPropertyDefinition *(^propertyDefinition)(NSString *, CMISPropertyType, BOOL) = ^(NSString *propertyId, CMISPropertyType propertyType, BOOL orderable) {
+        CMISPropertyDefinition *definition = [[CMISPropertyDefinition alloc] init];
+        definition.id = propertyId;
+        definition.propertyType = propertyType;
+        definition.cardinality = CMISCardinalitySingle;
+        definition.isQueryable = YES;
+        definition.isOrderable = orderable;
+        return definition;
+    };
+    [typeDefinition addPropertyDefinition:propertyDefinition(kCMISPropertyObjectId, CMISPropertyTypeId, YES)];
+    [typeDefinition addPropertyDefinition:propertyDefinition(kCMISPropertyCreationDate, CMISPropertyTypeDateTime, YES)];
+    [typeDefinition addPropertyDefinition:propertyDefinition(kCMISPropertyModificationDate, CMISPropertyTypeDateTime, NO)];
+    
+    // ids only support =, <> and IN, and the key must be orderable
+    STAssertFalse([CMISKeysetQuery canPageTypeDefinition:typeDefinition byProperty:kCMISPropertyObjectId], @"Ids cannot be paged by range");
+    STAssertFalse([CMISKeysetQuery canPageTypeDefinition:typeDefinition byProperty:kCMISPropertyModificationDate], @"The key must be orderable");
+    STAssertFalse([CMISKeysetQuery canPageTypeDefinition:typeDefinition byProperty:kCMISPropertyName], @"The key must be defined by the type");
+    STAssertTrue([CMISKeysetQuery canPageTypeDefinition:typeDefinition byProperty:kCMISPropertyCreationDate], @"The creation date should be a key");
+    
+    CMISOperationContext *operationContext = [CMISOperationContext defaultOperationContext];
+    operationContext.filterString = kCMISPropertyName;
+    operationContext.keysetPagingProperty = kCMISPropertyCreationDate;
+    CMISKeysetQuery *keysetQuery = [[CMISKeysetQuery alloc] initWithTypeDefinition:typeDefinition whereClause:@"cmis:name LIKE 'a%'" operationContext:operationContext];
+    
+    // a page not following a fetched one skips, over the stable order
+    NSInteger remainingSkipCount = -1;
+    NSString *statement = [keysetQuery statementForSkipCount:0 remainingSkipCount:&remainingSkipCount];
+    STAssertEqualObjects(statement, @"SELECT cmis:name,cmis:objectId,cmis:creationDate FROM cmis:document WHERE cmis:name LIKE 'a%' "
+                         "ORDER BY cmis:creationDate ASC,cmis:objectId ASC", @"Unexpected first statement");
+    STAssertTrue(remainingSkipCount == 0, @"Expected skip count 0, but got %d", remainingSkipCount);
+    
+    // the page after a fetched one starts at its last key, without the objects that have it already
+    CMISObject *(^objectWithCreationDate)(NSString *, NSTimeInterval) = ^(NSString *objectId, NSTimeInterval seconds) {
+        CMISObjectData *objectData = [[CMISObjectData alloc] init];
+        objectData.identifier = objectId;
+        objectData.properties = [[CMISProperties alloc] init];
+        [objectData.properties addProperty:[CMISPropertyData createPropertyForId:kCMISPropertyObjectId withIdValue:objectId]];
+        [objectData.properties addProperty:[CMISPropertyData createPropertyForId:kCMISPropertyCreationDate
+                                                               withDateTimeValue:[NSDate dateWithTimeIntervalSince1970:seconds]]];
+        return [[CMISObject alloc] initWithObjectData:objectData withSession:nil];
+    };
+    [keysetQuery addPage:[NSArray arrayWithObjects:objectWithCreationDate(@"o'1", 10), objectWithCreationDate(@"o2", 20.5),
+                          objectWithCreationDate(@"o3", 20.5), nil] atSkipCount:0];
+    statement = [keysetQuery statementForSkipCount:3 remainingSkipCount:&remainingSkipCount];
+    STAssertEqualObjects(statement, @"SELECT cmis:name,cmis:objectId,cmis:creationDate FROM cmis:document WHERE (cmis:name LIKE 'a%') "
+                         "AND cmis:creationDate >= TIMESTAMP '1970-01-01T00:00:20.500Z' AND cmis:objectId NOT IN ('o2','o3') "
+                         "ORDER BY cmis:creationDate ASC,cmis:objectId ASC", @"Unexpected statement following a page");
+    STAssertTrue(remainingSkipCount == 0, @"A page following a fetched one should not skip, but skips %d", remainingSkipCount);
+    
+    // a page made of ties only keeps excluding the ties of the pages before it
+    [keysetQuery addPage:[NSArray arrayWithObjects:objectWithCreationDate(@"o4", 20.5), nil] atSkipCount:3];
+    statement = [keysetQuery statementForSkipCount:4 remainingSkipCount:&remainingSkipCount];
+    STAssertTrue([statement rangeOfString:@"NOT IN ('o4','o2','o3')"].location != NSNotFound, @"Ties of earlier pages should stay excluded: %@", statement);
+    
+    // a page asked for again, or out of order, falls back to its skip count
+    statement = [keysetQuery statementForSkipCount:3 remainingSkipCount:&remainingSkipCount];
+    STAssertTrue([statement rangeOfString:@"TIMESTAMP"].location == NSNotFound, @"Unknown page should not use a key: %@", statement);
+    STAssertTrue(remainingSkipCount == 3, @"Expected skip count 3, but got %d", remainingSkipCount);
+    
+    STAssertEqualObjects([CMISKeysetQuery stringLiteral:@"it's a \\ test"], @"'it\\'s a \\\\ test'", @"Quotes and backslashes should be escaped");
+}
+
 - (void)testRetrieveParents
 {
     [self runTest:^
@@ -1163,6 +1906,69 @@
      }];
 }
 
+// Helper method: updates the name of a new test document, listed twice, and checks the result of the update
+- (void)bulkUpdateTestDocumentWithCompletionBlock:(void (^)(void))completionBlock
+{
+    [self uploadTestFileWithCompletionBlock:^(CMISDocument *document) {
+        NSString *newName = @"testBulkUpdateProperties";
+        NSDictionary *properties = [NSDictionary dictionaryWithObject:newName forKey:kCMISPropertyName];
+        
+        // The document is listed twice, but updated once
+        NSArray *objects = [NSArray arrayWithObjects:document, document, nil];
+        [self.session bulkUpdateProperties:properties forObjects:objects completionBlock:^(NSArray *results, NSDictionary *errors) {
+            STAssertTrue(errors.count == 0, @"Got errors while updating: %@", errors);
+            STAssertTrue(results.count == 2, @"There should be a result for every given object");
+            CMISObjectIdAndChangeToken *result = [results objectAtIndex:0];
+            STAssertTrue([result isKindOfClass:[CMISObjectIdAndChangeToken class]], @"The document should have been updated");
+            STAssertTrue([results objectAtIndex:1] == result, @"Both entries of the document should have the same result");
+            
+            // The id of the result is the one of a new version if the update created one
+            [self.session retrieveObject:result.objectId completionBlock:^(CMISObject *object, NSError *error) {
+                STAssertNil(error, @"Got error while retrieving updated document: %@", [error description]);
+                STAssertEqualObjects(newName, object.name, @"Name was not updated");
+                STAssertEqualObjects(((CMISDocument *)object).versionSeriesId, document.versionSeriesId, @"The result should be the one of the updated document");
+                
+                // Cleanup
+                [self deleteDocumentAndVerify:(CMISDocument *)object completionBlock:completionBlock];
+            }];
+        }];
+    }];
+}
+
+- (void)testBulkUpdateProperties
+{
+    [self runTest:^
+     {
+         CMISBindingSession *bindingSession = [(CMISAtomPubBaseService *)self.session.binding.objectService bindingSession];
+         if ([bindingSession objectForKey:kCMISBindingSessionKeyBulkUpdateCollection] == nil) {
+             log(@"Repository does not support bulk updates, skipping test");
+             self.testCompleted = YES;
+             return;
+         }
+         
+         [self bulkUpdateTestDocumentWithCompletionBlock:^{
+             self.testCompleted = YES;
+         }];
+     }];
+}
+
+- (void)testBulkUpdatePropertiesWithoutBulkUpdates
+{
+    [self runTest:^
+     {
+         // without the bulk update collection every object is updated by a request of its own
+         CMISBindingSession *bindingSession = [(CMISAtomPubBaseService *)self.session.binding.objectService bindingSession];
+         id bulkUpdateCollection = [bindingSession objectForKey:kCMISBindingSessionKeyBulkUpdateCollection];
+         [bindingSession removeKey:kCMISBindingSessionKeyBulkUpdateCollection];
+         
+         [self bulkUpdateTestDocumentWithCompletionBlock:^{
+             if (bulkUpdateCollection != nil) {
+                 [bindingSession setObject:bulkUpdateCollection forKey:kCMISBindingSessionKeyBulkUpdateCollection];
+             }
+             self.testCompleted = YES;
+         }];
+     }];
+}
 
 // Helper method used by the extension element parse tests
 - (void)checkExtensionElement:(CMISExtensionElement *)extElement withName:(NSString *)expectedName namespaceUri:(NSString *)expectedNamespaceUri
@@ -1274,6 +2080,42 @@
     testFolderChildrenXml(@"FolderChildren-opencmis", YES);
 }
 
+- (void)testParsedDescendantsFeed
+{
+    // Entries of a descendants feed hold the feed of their own children, nested to the depth asked for
+    NSString *(^entryXml)(NSString *, NSString *) = ^(NSString *objectId, NSString *childrenXml) {
+        return [NSString stringWithFormat:@"<atom:entry><atom:id>%@</atom:id><cmisra:object><cmis:properties>"
+                "<cmis:propertyId propertyDefinitionId=\"cmis:objectId\"><cmis:value>%@</cmis:value></cmis:propertyId>"
+                "</cmis:properties></cmisra:object>%@</atom:entry>", objectId, objectId,
+                (childrenXml ? [NSString stringWithFormat:@"<cmisra:children><atom:feed>%@</atom:feed></cmisra:children>", childrenXml] : @"")];
+    };
+    NSString *feedXml = [NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                         "<atom:feed xmlns:atom=\"http://www.w3.org/2005/Atom\" xmlns:cmis=\"http://docs.oasis-open.org/ns/cmis/core/200908/\" "
+                         "xmlns:cmisra=\"http://docs.oasis-open.org/ns/cmis/restatom/200908/\">%@%@</atom:feed>",
+                         entryXml(@"folderA", [entryXml(@"folderB", entryXml(@"documentC", nil)) stringByAppendingString:entryXml(@"documentD", nil)]),
+                         entryXml(@"documentE", nil)];
+    
+    NSError *error = nil;
+    CMISAtomFeedParser *feedParser = [[CMISAtomFeedParser alloc] initWithData:[feedXml dataUsingEncoding:NSUTF8StringEncoding]];
+    STAssertTrue([feedParser parseAndReturnError:&error], @"Failed to parse descendants feed: %@", error);
+    
+    NSArray *containers = feedParser.objectInFolderContainers;
+    STAssertTrue(containers.count == 2, @"Expected 2 top level objects, but found %d", containers.count);
+    CMISObjectInFolderContainer *folderA = [containers objectAtIndex:0];
+    STAssertTrue([folderA.objectData.identifier isEqualToString:@"folderA"], @"Wrong first object %@", folderA.objectData.identifier);
+    STAssertTrue(folderA.children.count == 2, @"Expected 2 children of folderA, but found %d", folderA.children.count);
+    
+    CMISObjectInFolderContainer *folderB = [folderA.children objectAtIndex:0];
+    STAssertTrue([folderB.objectData.identifier isEqualToString:@"folderB"], @"Wrong child %@", folderB.objectData.identifier);
+    STAssertTrue(folderB.children.count == 1, @"Expected 1 child of folderB, but found %d", folderB.children.count);
+    STAssertTrue([[[folderB.children objectAtIndex:0] objectData].identifier isEqualToString:@"documentC"], @"Wrong grandchild");
+    STAssertTrue([[[folderA.children objectAtIndex:1] objectData].identifier isEqualToString:@"documentD"], @"Wrong second child");
+    
+    CMISObjectInFolderContainer *documentE = [containers objectAtIndex:1];
+    STAssertTrue([documentE.objectData.identifier isEqualToString:@"documentE"], @"Nested entries should not end the outer one");
+    STAssertTrue(documentE.children.count == 0, @"Expected no children of documentE");
+}
+
 // This test test the extension levels Allowable Actions, Object, and Properties, with simplicity
 // the same extension elements are used at each of the different levels
 - (void)testParsedExtensionElementsFromAtomFeedXml
@@ -1428,6 +2270,61 @@
 //}
 
 
+- (void)testNextPageLinksScoping
+{
+    CMISSessionParameters *parameters = [[CMISSessionParameters alloc] initWithBindingType:CMISBindingTypeAtomPub];
+    parameters.atomPubUrl = [NSURL URLWithString:@"http://localhost/cmis"];
+    CMISBindingSession *bindingSession = [[CMISBindingSession alloc] initWithSessionParameters:parameters];
+    CMISAtomPubNavigationService *navigationService = [[CMISAtomPubNavigationService alloc] initWithBindingSession:bindingSession];
+    
+    // the page links of one listing, and of another listing of the same folder
+    CMISPageLinks *pageLinks = [[CMISPageLinks alloc] init];
+    CMISPageLinks *otherListingPageLinks = [[CMISPageLinks alloc] init];
+    
+    NSString *(^feedXml)(NSUInteger, NSString *) = ^(NSUInteger entryCount, NSString *nextLink) {
+        NSMutableString *entriesXml = [NSMutableString string];
+        for (NSUInteger index = 0; index < entryCount; index++) {
+            [entriesXml appendFormat:@"<atom:entry><atom:id>object%lu</atom:id><cmisra:object><cmis:properties>"
+             "<cmis:propertyId propertyDefinitionId=\"cmis:objectId\"><cmis:value>object%lu</cmis:value></cmis:propertyId>"
+             "</cmis:properties></cmisra:object></atom:entry>", (unsigned long)index, (unsigned long)index];
+        }
+        return [NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                "<atom:feed xmlns:atom=\"http://www.w3.org/2005/Atom\" xmlns:cmis=\"http://docs.oasis-open.org/ns/cmis/core/200908/\" "
+                "xmlns:cmisra=\"http://docs.oasis-open.org/ns/cmis/restatom/200908/\">%@%@</atom:feed>",
+                (nextLink ? [NSString stringWithFormat:@"<atom:link rel=\"next\" href=\"%@\"/>", nextLink] : @""), entriesXml];
+    };
+    
+    // the next link of the page at skip count 6 continues the request at skip count 9 of the same listing, and only that one
+    NSError *error = nil;
+    CMISAtomFeedParser *feedParser = [[CMISAtomFeedParser alloc] initWithData:[feedXml(3, @"http://localhost/cmis/cursor/9") dataUsingEncoding:NSUTF8StringEncoding]];
+    STAssertTrue([feedParser parseAndReturnError:&error], @"Failed to parse feed: %@", error);
+    CMISObjectList *objectList = [navigationService objectListFromFeedParser:feedParser skipCount:6 maxItems:3 pageLinks:pageLinks];
+    STAssertTrue(objectList.hasMoreItems, @"A page with a next link should have more items");
+    
+    STAssertEqualObjects([pageLinks linkForPageAtSkipCount:9 maxItems:3], @"http://localhost/cmis/cursor/9", @"Next link should continue the page");
+    STAssertNil([pageLinks linkForPageAtSkipCount:6 maxItems:3], @"Next link should not be used for the page itself");
+    STAssertNil([pageLinks linkForPageAtSkipCount:10 maxItems:3], @"Next link should not be used for another offset");
+    STAssertNil([pageLinks linkForPageAtSkipCount:9 maxItems:5], @"Next link should not be used for another page size");
+    STAssertNil([otherListingPageLinks linkForPageAtSkipCount:9 maxItems:3], @"Next link should not be used by another listing");
+    
+    // a listing without page links leaves nothing behind
+    feedParser = [[CMISAtomFeedParser alloc] initWithData:[feedXml(3, @"http://localhost/cmis/cursor/12") dataUsingEncoding:NSUTF8StringEncoding]];
+    STAssertTrue([feedParser parseAndReturnError:&error], @"Failed to parse feed: %@", error);
+    objectList = [navigationService objectListFromFeedParser:feedParser skipCount:9 maxItems:3 pageLinks:nil];
+    STAssertTrue(objectList.hasMoreItems, @"A page with a next link should have more items");
+    STAssertNil([pageLinks linkForPageAtSkipCount:12 maxItems:3], @"Next link should only be kept by the listing of its page");
+    
+    // the last page leaves no link behind, and a link the server refused can be forgotten
+    feedParser = [[CMISAtomFeedParser alloc] initWithData:[feedXml(2, nil) dataUsingEncoding:NSUTF8StringEncoding]];
+    STAssertTrue([feedParser parseAndReturnError:&error], @"Failed to parse feed: %@", error);
+    objectList = [navigationService objectListFromFeedParser:feedParser skipCount:9 maxItems:3 pageLinks:pageLinks];
+    STAssertFalse(objectList.hasMoreItems, @"The last page should not have more items");
+    STAssertNil([pageLinks linkForPageAtSkipCount:11 maxItems:3], @"The last page should not store a next link");
+    
+    [pageLinks removeLinkForPageAtSkipCount:9 maxItems:3];
+    STAssertNil([pageLinks linkForPageAtSkipCount:9 maxItems:3], @"A removed next link should be gone");
+}
+
 - (void)testPropertiesConversion
 {
     [self runTest:^
@@ -1662,4 +2559,525 @@
      }];
 }
 
+- (void)testRetryPolicy
+{
+    CMISHttpRetryPolicy *retryPolicy = [[CMISHttpRetryPolicy alloc] init];
+    retryPolicy.initialDelay = 0.1;
+    NSURL *url = [NSURL URLWithString:@"http://localhost/cmis"];
+    NSHTTPURLResponse *unavailable = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:503 HTTPVersion:@"HTTP/1.1"
+                                                              headerFields:[NSDictionary dictionaryWithObject:@"2" forKey:@"Retry-After"]];
+    NSHTTPURLResponse *badGateway = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:502 HTTPVersion:@"HTTP/1.1" headerFields:nil];
+    NSHTTPURLResponse *notFound = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:404 HTTPVersion:@"HTTP/1.1" headerFields:nil];
+    NSError *timeout = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorTimedOut userInfo:nil];
+    NSError *cannotConnect = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCannotConnectToHost userInfo:nil];
+    
+    // transient failures are retried, honouring Retry-After
+    NSTimeInterval delay = [retryPolicy delayBeforeRetryingRequestWithMethod:HTTP_GET attempt:1 error:nil response:unavailable];
+    STAssertTrue(delay >= 2.0, @"Retry-After not honoured, delay was %f", delay);
+    delay = [retryPolicy delayBeforeRetryingRequestWithMethod:HTTP_PUT attempt:1 error:timeout response:nil];
+    STAssertTrue(delay >= 0 && delay <= 0.1, @"Unexpected backoff delay %f", delay);
+    
+    // other failures and exhausted attempts are not
+    STAssertTrue([retryPolicy delayBeforeRetryingRequestWithMethod:HTTP_GET attempt:1 error:nil response:notFound] < 0, @"404 should not be retried");
+    STAssertTrue([retryPolicy delayBeforeRetryingRequestWithMethod:HTTP_GET attempt:3 error:timeout response:nil] < 0, @"Retried beyond maxAttempts");
+    
+    // a POST only if the server can not have processed it
+    STAssertTrue([retryPolicy delayBeforeRetryingRequestWithMethod:HTTP_POST attempt:1 error:timeout response:nil] < 0, @"POST retried after a timeout");
+    STAssertTrue([retryPolicy delayBeforeRetryingRequestWithMethod:HTTP_POST attempt:1 error:nil response:badGateway] < 0, @"POST retried after a 502");
+    STAssertTrue([retryPolicy delayBeforeRetryingRequestWithMethod:HTTP_POST attempt:1 error:cannotConnect response:nil] >= 0, @"POST not retried after connection failure");
+    
+    STAssertTrue(retryPolicy.retryCount == 3, @"Expected 3 retries, but counted %llu", retryPolicy.retryCount);
+    STAssertTrue(retryPolicy.retriesExhaustedCount == 1, @"Expected 1 exhausted request, but counted %llu", retryPolicy.retriesExhaustedCount);
+    
+    // the budget runs out
+    retryPolicy.maxBudget = 1.0;
+    retryPolicy.budgetPerRequest = 0;
+    [retryPolicy recordRequest];
+    [retryPolicy delayBeforeRetryingRequestWithMethod:HTTP_GET attempt:1 error:timeout response:nil];
+    STAssertTrue([retryPolicy delayBeforeRetryingRequestWithMethod:HTTP_GET attempt:1 error:timeout response:nil] < 0, @"Retry budget not enforced");
+    STAssertTrue(retryPolicy.budgetExhaustedCount == 1, @"Expected 1 refused retry, but counted %llu", retryPolicy.budgetExhaustedCount);
+}
+
+- (void)testRequestCompressionRejection
+{
+    NSURL *url = [NSURL URLWithString:@"http://localhost/cmis"];
+    CMISHttpRequest *request = [[CMISHttpRequest alloc] initWithHttpMethod:HTTP_POST completionBlock:nil];
+    NSMutableDictionary *errorsByStatusCode = [NSMutableDictionary dictionary];
+    for (NSNumber *statusCode in [NSArray arrayWithObjects:[NSNumber numberWithInt:400], [NSNumber numberWithInt:405],
+                                  [NSNumber numberWithInt:415], [NSNumber numberWithInt:500], nil]) {
+        NSHTTPURLResponse *urlResponse = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:statusCode.integerValue HTTPVersion:@"HTTP/1.1" headerFields:nil];
+        CMISHttpResponse *response = [CMISHttpResponse responseUsingURLHTTPResponse:urlResponse andData:[NSData data]];
+        NSError *error = nil;
+        STAssertFalse([request checkStatusCodeForResponse:response withHttpRequestMethod:HTTP_POST error:&error], @"Status %@ should fail a POST", statusCode);
+        STAssertEqualObjects([error.userInfo objectForKey:kCMISErrorKeyHttpStatusCode], statusCode, @"The error should carry the status");
+        [errorsByStatusCode setObject:error forKey:statusCode];
+    }
+    
+    // only a refused media type is safe to send again uncompressed: after a 400 or 500 the entry might have been stored
+    STAssertTrue([CMISAtomPubObjectService isRequestCompressionRejectedError:[errorsByStatusCode objectForKey:[NSNumber numberWithInt:415]]], @"415 should be a rejection");
+    STAssertFalse([CMISAtomPubObjectService isRequestCompressionRejectedError:[errorsByStatusCode objectForKey:[NSNumber numberWithInt:405]]], @"405 is not a rejection");
+    STAssertFalse([CMISAtomPubObjectService isRequestCompressionRejectedError:[errorsByStatusCode objectForKey:[NSNumber numberWithInt:400]]], @"400 is not a rejection");
+    STAssertFalse([CMISAtomPubObjectService isRequestCompressionRejectedError:[errorsByStatusCode objectForKey:[NSNumber numberWithInt:500]]], @"500 is not a rejection");
+    STAssertFalse([CMISAtomPubObjectService isRequestCompressionRejectedError:[CMISErrors createCMISErrorWithCode:kCMISErrorCodeNotSupported withDetailedDescription:nil]],
+                  @"An error without status is not a rejection");
+}
+
+- (void)testHedgingPolicy
+{
+    CMISHedgingPolicy *hedgingPolicy = [[CMISHedgingPolicy alloc] init];
+    hedgingPolicy.sampleSize = 20;
+    hedgingPolicy.percentile = 0.9;
+    hedgingPolicy.maxExtraLoad = 0.1;
+    
+    // no hedging without enough latencies to compare with
+    STAssertTrue([hedgingPolicy hedgeDelayForNewRequest] < 0, @"Hedge delay without latency data");
+    
+    for (NSUInteger i = 1; i <= 20; i++) {
+        [hedgingPolicy recordLatency:i / 10.0];
+    }
+    NSTimeInterval delay = [hedgingPolicy hedgeDelayForNewRequest];
+    STAssertEqualsWithAccuracy(delay, 1.9, 0.001, @"Expected the 90th percentile, but got %f", delay);
+    
+    // at most one hedge for every ten requests
+    for (NSUInteger i = 0; i < 8; i++) {
+        [hedgingPolicy hedgeDelayForNewRequest];
+    }
+    STAssertFalse([hedgingPolicy acquireHedge], @"Hedge allowed before the budget was earned");
+    [hedgingPolicy hedgeDelayForNewRequest];
+    STAssertTrue([hedgingPolicy acquireHedge], @"Hedge not allowed after more than ten requests");
+    STAssertFalse([hedgingPolicy acquireHedge], @"Second hedge allowed after eleven requests");
+    STAssertTrue(hedgingPolicy.requestCount == 11, @"Expected 11 requests, but counted %llu", hedgingPolicy.requestCount);
+    
+    // a quiet period does not save up a burst of hedges
+    for (NSUInteger i = 0; i < 100; i++) {
+        [hedgingPolicy hedgeDelayForNewRequest];
+    }
+    STAssertTrue([hedgingPolicy acquireHedge], @"Hedge not allowed after a quiet period");
+    STAssertFalse([hedgingPolicy acquireHedge], @"Burst of hedges allowed after a quiet period");
+    
+    // latencies of cancelled losers count as well, so the percentile moves up when requests get slower
+    for (NSUInteger i = 0; i < 20; i++) {
+        [hedgingPolicy recordLatency:5.0];
+    }
+    delay = [hedgingPolicy hedgeDelayForNewRequest];
+    STAssertEqualsWithAccuracy(delay, 5.0, 0.001, @"Expected the recorded latency, but got %f", delay);
+}
+
+- (void)testAdaptiveController
+{
+    CMISAdaptiveController *controller = [[CMISAdaptiveController alloc] init];
+    controller.latencyTolerance = 1000.0; // latencies of blocks completing immediately are just noise
+    
+    // the page size grows with every success, but never beyond what the caller asked for
+    for (NSUInteger i = 0; i < 5; i++) {
+        [controller performOperationOfClass:kCMISOperationClassQuery requestedPageSize:50
+                                 usingBlock:^(NSInteger pageSize, void (^completionBlock)(NSUInteger itemCount, NSError *error)) {
+            STAssertTrue(pageSize <= 50, @"Page size %ld is larger than requested", (long)pageSize);
+            completionBlock(pageSize, nil);
+        }];
+    }
+    STAssertTrue([controller pageSizeForOperationClass:kCMISOperationClassQuery requestedPageSize:50] == 50, @"Page size should have stayed at 50");
+    STAssertTrue([controller pageSizeForOperationClass:kCMISOperationClassQuery requestedPageSize:30] == 30, @"Page size should be capped at 30");
+    STAssertTrue([controller concurrencyLimitForOperationClass:kCMISOperationClassQuery] > 1, @"Concurrency should have grown");
+    
+    // an error of another domain that happens to share the code is no sign of overload
+    [controller performOperationOfClass:kCMISOperationClassQuery requestedPageSize:50
+                             usingBlock:^(NSInteger pageSize, void (^completionBlock)(NSUInteger itemCount, NSError *error)) {
+        completionBlock(0, [NSError errorWithDomain:NSURLErrorDomain code:kCMISErrorCodeConnection userInfo:nil]);
+    }];
+    STAssertTrue([controller pageSizeForOperationClass:kCMISOperationClassQuery requestedPageSize:50] == 50, @"Backed off on a foreign error");
+    
+    [controller performOperationOfClass:kCMISOperationClassQuery requestedPageSize:50
+                             usingBlock:^(NSInteger pageSize, void (^completionBlock)(NSUInteger itemCount, NSError *error)) {
+        completionBlock(0, [CMISErrors createCMISErrorWithCode:kCMISErrorCodeConnection withDetailedDescription:nil]);
+    }];
+    STAssertTrue([controller pageSizeForOperationClass:kCMISOperationClassQuery requestedPageSize:50] == 25, @"Page size should have been halved");
+    
+    // an operation waiting for a slot is resumed when the one in flight completes, even from a thread without run loop
+    NSUInteger concurrencyLimit = [controller concurrencyLimitForOperationClass:kCMISOperationClassQuery];
+    NSMutableArray *pendingCompletionBlocks = [NSMutableArray array];
+    for (NSUInteger i = 0; i < concurrencyLimit; i++) {
+        [controller performOperationOfClass:kCMISOperationClassQuery requestedPageSize:50
+                                 usingBlock:^(NSInteger pageSize, void (^completionBlock)(NSUInteger itemCount, NSError *error)) {
+            [pendingCompletionBlocks addObject:[completionBlock copy]];
+        }];
+    }
+    __block BOOL waitingOperationStarted = NO;
+    [controller performOperationOfClass:kCMISOperationClassQuery requestedPageSize:50
+                             usingBlock:^(NSInteger pageSize, void (^completionBlock)(NSUInteger itemCount, NSError *error)) {
+        waitingOperationStarted = YES;
+        completionBlock(pageSize, nil);
+        self.testCompleted = YES;
+    }];
+    STAssertFalse(waitingOperationStarted, @"Operation started beyond the concurrency limit");
+    
+    void (^completionBlock)(NSUInteger itemCount, NSError *error) = [pendingCompletionBlocks objectAtIndex:0];
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        completionBlock(25, nil);
+    });
+    [self waitForCompletion:5];
+    STAssertTrue(waitingOperationStarted, @"Waiting operation was not resumed");
+}
+
+- (void)testTokenBucket
+{
+    CMISTokenBucket *unlimitedBucket = [[CMISTokenBucket alloc] initWithRate:0];
+    STAssertTrue([unlimitedBucket consume:1000000000] == 0, @"An unlimited bucket should never ask for a pause");
+    
+    CMISTokenBucket *bucket = [[CMISTokenBucket alloc] initWithRate:1000];
+    STAssertTrue([bucket consume:500] == 0, @"The burst should be available right away");
+    
+    // 500 tokens left, 1000 bytes more leave a debt of about half a second
+    NSTimeInterval delay = [bucket consume:1000];
+    STAssertEqualsWithAccuracy(delay, 0.5, 0.05, @"Expected a pause of half a second, but got %f", delay);
+}
+
+- (void)testNetworkThread
+{
+    STAssertFalse([CMISNetworkThread isCurrentThread], @"Test should not run on the network thread");
+    
+    __block NSThread *blockThread = nil;
+    [CMISNetworkThread performBlockAndWait:^{
+        blockThread = [NSThread currentThread];
+        STAssertTrue([CMISNetworkThread isCurrentThread], @"Block should run on the network thread");
+    }];
+    STAssertTrue(blockThread == [CMISNetworkThread thread], @"Block did not run or ran on another thread");
+    STAssertTrue([CMISNetworkThread workerQueue].maxConcurrentOperationCount != 1, @"Worker queue should be concurrent");
+}
+
+- (void)testURITemplateExpansion
+{
+    NSDictionary *values = [NSDictionary dictionaryWithObjectsAndKeys:
+                            @"cmis:name ASC", @"orderBy",
+                            @"/Sites/swsdp", @"path",
+                            [NSArray arrayWithObjects:@"red", @"green", nil], @"list",
+                            @"", @"empty", nil];
+    
+    CMISURITemplate *simpleTemplate = [CMISURITemplate templateWithString:@"http://host/cmis?orderBy={orderBy}&path={path}&filter={filter}"];
+    STAssertEqualObjects([simpleTemplate expandWithValues:values], @"http://host/cmis?orderBy=cmis%3Aname%20ASC&path=%2FSites%2Fswsdp&filter=", nil);
+    STAssertTrue(simpleTemplate.variableNames.count == 3, @"Expected 3 variables, but got %d", simpleTemplate.variableNames.count);
+    
+    STAssertEqualObjects([[CMISURITemplate templateWithString:@"{+path}/children"] expandWithValues:values], @"/Sites/swsdp/children", nil);
+    STAssertEqualObjects([[CMISURITemplate templateWithString:@"/items{?list,empty,undefined}"] expandWithValues:values], @"/items?list=red,green&empty=", nil);
+    STAssertEqualObjects([[CMISURITemplate templateWithString:@"/items{/list*}{.list}"] expandWithValues:values], @"/items/red/green.red,green", nil);
+    STAssertEqualObjects([[CMISURITemplate templateWithString:@"{orderBy:4}"] expandWithValues:values], @"cmis", nil);
+    
+    CMISURLBuilder *urlBuilder = [[CMISURLBuilder alloc] initWithUrlString:@"http://host/children?id=1"];
+    [urlBuilder addParameter:@"filter" withValue:nil];
+    [urlBuilder addParameter:@"orderBy" withValue:@"cmis:name ASC"];
+    [urlBuilder addParameter:@"maxItems" withNumberValue:[NSNumber numberWithInt:50]];
+    STAssertEqualObjects([urlBuilder urlString], @"http://host/children?id=1&orderBy=cmis%3Aname%20ASC&maxItems=50", nil);
+}
+
+- (void)testRequestDeadline
+{
+    CMISRequest *request = [[CMISRequest alloc] init];
+    STAssertFalse(request.isCancelled, @"Request without deadline should not be cancelled");
+    STAssertTrue(request.remainingTime == DBL_MAX, @"Request without deadline should have unlimited time");
+    
+    [request cancelAfterTimeInterval:-1];
+    STAssertTrue(request.isTimedOut, @"Request should be timed out once the deadline passed");
+    STAssertTrue(request.isCancelled, @"Timed out request should count as cancelled");
+    STAssertTrue([request cancellationError].code == kCMISErrorCodeCancelled, @"Expected cancelled error code");
+    
+    // no http request may be sent for an expired request, the completion block is called right away
+    __block NSError *invokeError = nil;
+    [HttpUtil invokeGET:[NSURL URLWithString:@"http://localhost/never-sent"]
+            withSession:nil
+        completionBlock:^(CMISHttpResponse *httpResponse, NSError *error) {
+            invokeError = error;
+        }
+          requestObject:request];
+    STAssertTrue(invokeError.code == kCMISErrorCodeCancelled, @"Expected the invoke to fail as cancelled");
+    
+    // an inner request is kept alive by the outer one and gets its deadline, unless its own is earlier
+    CMISRequest *outerRequest = [[CMISRequest alloc] init];
+    [outerRequest cancelAfterTimeInterval:60];
+    __weak CMISRequest *weakInnerRequest = nil;
+    @autoreleasepool {
+        CMISRequest *innerRequest = [[CMISRequest alloc] init];
+        weakInnerRequest = innerRequest;
+        outerRequest.httpRequest = innerRequest;
+    }
+    STAssertNotNil(weakInnerRequest, @"The outer request should hold its inner request");
+    STAssertEqualObjects(weakInnerRequest.deadline, outerRequest.deadline, @"The inner request should get the outer deadline");
+    
+    CMISRequest *earlierRequest = [[CMISRequest alloc] init];
+    [earlierRequest cancelAfterTimeInterval:10];
+    NSDate *earlierDeadline = earlierRequest.deadline;
+    outerRequest.httpRequest = earlierRequest;
+    STAssertEqualObjects(earlierRequest.deadline, earlierDeadline, @"An earlier inner deadline should be kept");
+    
+    // the deadline cancels the request without the main thread, which is blocked in this test
+    CMISRequest *shortRequest = [[CMISRequest alloc] init];
+    CMISRequest *shortInnerRequest = [[CMISRequest alloc] init];
+    shortRequest.httpRequest = shortInnerRequest;
+    [shortRequest cancelAfterTimeInterval:0.1];
+    [NSThread sleepForTimeInterval:0.5];
+    STAssertTrue(shortInnerRequest.isCancelled, @"The inner request should be cancelled when the deadline passed");
+}
+
+// A fetch block serving the numbers 0 to itemCount - 1, in pages of at most maximumPageSize items whatever the requested size.
+// It completes right away, or on the main queue after the delay when that is positive. The observer, if any, is told when
+// a fetch starts and when it completes.
+- (CMISFetchNextPageBlock)fetchBlockServingItemCount:(int)itemCount
+                                     maximumPageSize:(int)maximumPageSize
+                                               delay:(NSTimeInterval)delay
+                                       fetchObserver:(void (^)(int skipCount, BOOL completed))fetchObserver
+{
+    return ^(int skipCount, int maxItems, CMISFetchNextPageBlockCompletionBlock pageBlockCompletionBlock) {
+        if (fetchObserver) {
+            fetchObserver(skipCount, NO);
+        }
+        NSMutableArray *items = [NSMutableArray array];
+        for (int i = skipCount; i < MIN(skipCount + MIN(maxItems, maximumPageSize), itemCount); i++) {
+            [items addObject:[NSNumber numberWithInt:i]];
+        }
+        CMISFetchNextPageBlockResult *result = [[CMISFetchNextPageBlockResult alloc] init];
+        result.resultArray = items;
+        result.hasMoreItems = (skipCount + (int)items.count < itemCount);
+        result.numItems = itemCount;
+        
+        void (^completePage)(void) = ^{
+            if (fetchObserver) {
+                fetchObserver(skipCount, YES);
+            }
+            pageBlockCompletionBlock(result, nil);
+        };
+        if (delay > 0) {
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), completePage);
+        } else {
+            completePage();
+        }
+    };
+}
+
+// the first page of a result whose fetch block completes right away
+- (CMISPagedResult *)pagedResultUsingFetchBlock:(CMISFetchNextPageBlock)fetchNextPageBlock maxItems:(int)maxItems
+{
+    __block CMISPagedResult *pagedResult = nil;
+    [CMISPagedResult pagedResultUsingFetchBlock:fetchNextPageBlock andLimitToMaxItems:maxItems andStartFromSkipCount:0
+                                completionBlock:^(CMISPagedResult *result, NSError *error) {
+                                    STAssertNil(error, @"Fetching the first page failed: %@", error);
+                                    pagedResult = result;
+                                }];
+    STAssertNotNil(pagedResult, @"Expected a first page");
+    return pagedResult;
+}
+
+- (void)testPagedResultPrefetch
+{
+    // 25 numbers served in pages, synchronously
+    __block int fetchCount = 0;
+    CMISFetchNextPageBlock fetchNextPageBlock = [self fetchBlockServingItemCount:25 maximumPageSize:10 delay:0 fetchObserver:^(int skipCount, BOOL completed) {
+        fetchCount += (completed ? 0 : 1);
+    }];
+    CMISPagedResult *pagedResult = [self pagedResultUsingFetchBlock:fetchNextPageBlock maxItems:10];
+    pagedResult.prefetchDepth = 2;
+    
+    __block int expectedItem = 0;
+    __block BOOL enumerationCompleted = NO;
+    [pagedResult enumerateItemsUsingBlock:^(CMISObject *object, BOOL *stop) {
+        STAssertTrue([(NSNumber *)object intValue] == expectedItem, @"Items should be enumerated in order");
+        expectedItem++;
+    } completionBlock:^(NSError *error) {
+        STAssertNil(error, @"Enumeration failed: %@", error);
+        enumerationCompleted = YES;
+    }];
+    STAssertTrue(enumerationCompleted, @"Enumeration did not complete");
+    STAssertTrue(expectedItem == 25, @"Expected 25 items, but got %d", expectedItem);
+    STAssertTrue(fetchCount == 3, @"Expected 3 page fetches, but counted %d", fetchCount);
+}
+
+- (void)testPagedResultAsynchronousPrefetch
+{
+    // 25 numbers served in pages of 10, each arriving a moment later on the main queue
+    __block int fetchesInFlight = 0;
+    __block int fetchCount = 0;
+    CMISFetchNextPageBlock fetchNextPageBlock = [self fetchBlockServingItemCount:25 maximumPageSize:10 delay:0.05 fetchObserver:^(int skipCount, BOOL completed) {
+        fetchesInFlight += (completed ? -1 : 1);
+        fetchCount += (completed ? 0 : 1);
+    }];
+    
+    [CMISPagedResult pagedResultUsingFetchBlock:fetchNextPageBlock andLimitToMaxItems:10 andStartFromSkipCount:0
+                                completionBlock:^(CMISPagedResult *pagedResult, NSError *error) {
+        STAssertNil(error, @"Fetching the first page failed: %@", error);
+        pagedResult.prefetchDepth = 1;
+        
+        // while a page is enumerated the next one is already being fetched, except for the last page
+        __block int expectedItem = 0;
+        [pagedResult enumerateItemsUsingBlock:^(CMISObject *object, BOOL *stop) {
+            int item = [(NSNumber *)object intValue];
+            STAssertTrue(item == expectedItem, @"Items should be enumerated in order");
+            if (item < 20) {
+                STAssertTrue(fetchesInFlight == 1, @"Expected the next page to be fetched while item %d is enumerated", item);
+            } else {
+                STAssertTrue(fetchesInFlight == 0, @"Expected no fetch past the last page");
+            }
+            expectedItem++;
+        } completionBlock:^(NSError *error) {
+            STAssertNil(error, @"Enumeration failed: %@", error);
+            STAssertTrue(expectedItem == 25, @"Expected 25 items, but got %d", expectedItem);
+            STAssertTrue(fetchCount == 3, @"Expected 3 page fetches, but counted %d", fetchCount);
+            self.testCompleted = YES;
+        }];
+    }];
+    [self waitForCompletion:10];
+}
+
+- (void)testPagedResultIterativeEnumeration
+{
+    // 20000 numbers served synchronously in pages of one item: enumerating must not nest a call per page
+    __block int fetchCount = 0;
+    CMISFetchNextPageBlock fetchNextPageBlock = [self fetchBlockServingItemCount:20000 maximumPageSize:1 delay:0 fetchObserver:^(int skipCount, BOOL completed) {
+        fetchCount += (completed ? 0 : 1);
+    }];
+    CMISPagedResult *pagedResult = [self pagedResultUsingFetchBlock:fetchNextPageBlock maxItems:1];
+    
+    __block int expectedItem = 0;
+    __block BOOL enumerationCompleted = NO;
+    [pagedResult enumerateItemsUsingBlock:^(CMISObject *object, BOOL *stop) {
+        STAssertTrue([(NSNumber *)object intValue] == expectedItem, @"Items should be enumerated in order");
+        expectedItem++;
+    } completionBlock:^(NSError *error) {
+        STAssertNil(error, @"Enumeration failed: %@", error);
+        enumerationCompleted = YES;
+    }];
+    STAssertTrue(enumerationCompleted, @"Enumeration did not complete");
+    STAssertTrue(expectedItem == 20000, @"Expected 20000 items, but got %d", expectedItem);
+    STAssertTrue(fetchCount == 20000, @"Expected 20000 page fetches, but counted %d", fetchCount);
+}
+
+- (void)testPagedView
+{
+    // 1000 numbers served synchronously, in pages of at most 7 items whatever the requested size
+    __block int fetchCount = 0;
+    CMISFetchNextPageBlock fetchNextPageBlock = [self fetchBlockServingItemCount:1000 maximumPageSize:7 delay:0 fetchObserver:^(int skipCount, BOOL completed) {
+        fetchCount += (completed ? 0 : 1);
+    }];
+    CMISPagedResult *pagedResult = [self pagedResultUsingFetchBlock:fetchNextPageBlock maxItems:10];
+    
+    CMISPagedView *pagedView = [[CMISPagedView alloc] initWithPagedResult:pagedResult];
+    pagedView.maximumResidentPages = 3;
+    STAssertTrue(pagedView.count == 1000 && pagedView.isCountExact, @"Expected the reported number of items, but got %d", pagedView.count);
+    
+    // jumping anywhere fetches the page holding the index, completed from two short fetches
+    fetchCount = 0;
+    STAssertTrue([(NSNumber *)[pagedView objectAtIndex:555] intValue] == 555, @"Wrong item at index 555");
+    STAssertTrue([(NSNumber *)[pagedView objectAtIndex:559] intValue] == 559, @"Wrong item at index 559");
+    STAssertTrue(fetchCount == 2, @"Expected 2 fetches for one page, but counted %d", fetchCount);
+    
+    // only the most recently used pages stay
+    for (NSUInteger index = 0; index < 1000; index += 10) {
+        [pagedView objectAtIndex:index];
+    }
+    STAssertTrue(pagedView.residentPageCount == 3, @"Expected 3 resident pages, but got %d", pagedView.residentPageCount);
+    STAssertNil([pagedView objectAtIndex:1000], @"Expected no item beyond the last one");
+    
+    // the visible page and the ones around it never exceed the resident pages: three pages of two fetches each
+    pagedView = [[CMISPagedView alloc] initWithPagedResult:pagedResult];
+    pagedView.maximumResidentPages = 3;
+    pagedView.prefetchPageCount = 2;
+    fetchCount = 0;
+    [pagedView setVisibleRange:NSMakeRange(50, 10)];
+    STAssertTrue(fetchCount == 6, @"Expected 6 fetches for 3 pages, but counted %d", fetchCount);
+    for (NSUInteger index = 45; index < 70; index += 10) {
+        STAssertTrue([(NSNumber *)[pagedView objectAtIndex:index] intValue] == (int)index, @"Wrong item at index %d", index);
+    }
+    STAssertTrue(fetchCount == 6, @"The pages around the visible one should be resident, but counted %d fetches", fetchCount);
+}
+
+- (void)testPagedViewCountWithoutNumItems
+{
+    // 25 numbers in pages of 10, without the server reporting how many there are
+    __block int fetchCount = 0;
+    CMISFetchNextPageBlock servingBlock = [self fetchBlockServingItemCount:25 maximumPageSize:10 delay:0 fetchObserver:^(int skipCount, BOOL completed) {
+        fetchCount += (completed ? 0 : 1);
+    }];
+    CMISFetchNextPageBlock fetchNextPageBlock = ^(int skipCount, int maxItems, CMISFetchNextPageBlockCompletionBlock pageBlockCompletionBlock) {
+        servingBlock(skipCount, maxItems, ^(CMISFetchNextPageBlockResult *result, NSError *error) {
+            result.numItems = 0;
+            pageBlockCompletionBlock(result, error);
+        });
+    };
+    CMISPagedView *pagedView = [[CMISPagedView alloc] initWithPagedResult:[self pagedResultUsingFetchBlock:fetchNextPageBlock maxItems:10]];
+    STAssertTrue(pagedView.count == 10 && !pagedView.isCountExact, @"Expected 10 items known so far, but got %d", pagedView.count);
+    
+    // an empty page past the end only bounds the count, and nothing after it is fetched
+    fetchCount = 0;
+    STAssertNil([pagedView objectAtIndex:55], @"Expected no item at index 55");
+    STAssertFalse(pagedView.isCountExact, @"An empty page past the end should not make the count exact");
+    STAssertTrue(pagedView.count == 10, @"Expected 10 items known so far, but got %d", pagedView.count);
+    STAssertNil([pagedView objectAtIndex:65], @"Expected no item at index 65");
+    STAssertTrue(fetchCount == 1, @"Expected no fetch beyond the empty page, but counted %d", fetchCount);
+    
+    // the page holding the last item makes it exact
+    STAssertNotNil([pagedView objectAtIndex:22], @"Expected an item at index 22");
+    STAssertTrue(pagedView.count == 25 && pagedView.isCountExact, @"Expected exactly 25 items, but got %d", pagedView.count);
+}
+
+- (void)testPagedResultParallelEnumeration
+{
+    // 25 numbers served synchronously, in pages of at most 7 items whatever the requested size
+    CMISFetchNextPageBlock fetchNextPageBlock = [self fetchBlockServingItemCount:25 maximumPageSize:7 delay:0 fetchObserver:nil];
+    CMISPagedResult *pagedResult = [self pagedResultUsingFetchBlock:fetchNextPageBlock maxItems:10];
+    
+    // ordered: every item exactly once, in order, even though the pages come back short
+    __block int expectedItem = 0;
+    __block BOOL enumerationCompleted = NO;
+    [pagedResult enumerateItemsWithConcurrentPageCount:3 ordered:YES usingBlock:^(CMISObject *object, BOOL *stop) {
+        STAssertTrue([(NSNumber *)object intValue] == expectedItem, @"Items should be enumerated in order");
+        expectedItem++;
+    } completionBlock:^(NSError *error) {
+        STAssertNil(error, @"Enumeration failed: %@", error);
+        enumerationCompleted = YES;
+    }];
+    STAssertTrue(enumerationCompleted, @"Enumeration did not complete");
+    STAssertTrue(expectedItem == 25, @"Expected 25 items, but got %d", expectedItem);
+    
+    // unordered, stopped early
+    __block int itemCount = 0;
+    __block NSError *completionError = nil;
+    [pagedResult enumerateItemsWithConcurrentPageCount:3 ordered:NO usingBlock:^(CMISObject *object, BOOL *stop) {
+        itemCount++;
+        *stop = (itemCount == 12);
+    } completionBlock:^(NSError *error) {
+        completionError = error;
+    }];
+    STAssertTrue(itemCount == 12, @"Expected the enumeration to stop after 12 items, but got %d", itemCount);
+    STAssertTrue(completionError.code == kCMISErrorCodeCancelled, @"Expected a cancelled error, but got %@", completionError);
+}
+
+- (void)testPagedResultParallelEnumerationEmptyPage
+{
+    // 25 numbers are reported, but the server has nothing from offset 15 on while it still claims more items follow
+    CMISFetchNextPageBlock servingBlock = [self fetchBlockServingItemCount:25 maximumPageSize:5 delay:0 fetchObserver:nil];
+    CMISFetchNextPageBlock fetchNextPageBlock = ^(int skipCount, int maxItems, CMISFetchNextPageBlockCompletionBlock pageBlockCompletionBlock) {
+        if (skipCount < 15) {
+            servingBlock(skipCount, maxItems, pageBlockCompletionBlock);
+            return;
+        }
+        CMISFetchNextPageBlockResult *result = [[CMISFetchNextPageBlockResult alloc] init];
+        result.resultArray = [NSArray array];
+        result.hasMoreItems = YES;
+        result.numItems = 25;
+        pageBlockCompletionBlock(result, nil);
+    };
+    CMISPagedResult *pagedResult = [self pagedResultUsingFetchBlock:fetchNextPageBlock maxItems:5];
+    
+    // the empty page fails the enumeration, rather than being taken for its whole range
+    __block int itemCount = 0;
+    __block NSError *completionError = nil;
+    __block BOOL enumerationCompleted = NO;
+    [pagedResult enumerateItemsWithConcurrentPageCount:2 ordered:YES usingBlock:^(CMISObject *object, BOOL *stop) {
+        itemCount++;
+    } completionBlock:^(NSError *error) {
+        completionError = error;
+        enumerationCompleted = YES;
+    }];
+    STAssertTrue(enumerationCompleted, @"Enumeration did not complete");
+    STAssertTrue(completionError.code == kCMISErrorCodeRuntime, @"Expected a runtime error, but got %@", completionError);
+    STAssertTrue(itemCount <= 15, @"Expected no items past offset 15, but got %d", itemCount);
+}
+
 @end